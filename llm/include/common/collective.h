@@ -0,0 +1,17 @@
+#pragma once
+#include "nlohmann/json.hpp"
+
+#include <vector>
+
+using json = nlohmann::json;
+using namespace std;
+
+// 将worklist中的collective条目展开为当前核上的一串job（格式与worklist中的job相同）。
+// 参与的每个核都需要在自己的worklist中写上相同的collective条目，例如：
+// {"collective": {"type": "all_reduce", "algo": "ring", "group": [0, 1, 2, 3],
+//                 "size": "BTC", "indata": "matmul2_out", "outdata": "ar1_out",
+//                 "chunks": 0, "tag": 240, "cast": [{"dest": 4}]}}
+// size 为每个核输入的元素数；chunks 为每一步的流水分块数，0 表示自动分块；
+// indata 以 "_" 开头时保留输入，否则在最后一次使用后释放；
+// cast 写在最后一个job上，发送的是 outdata
+vector<json> ExpandCollective(const json &spec, int cid);
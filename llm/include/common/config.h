@@ -104,9 +104,15 @@ class StreamConfig {
 public:
     int id;
     int loop;
+    int sms; // 该stream最多同时占用的SM数（SM划分），0表示不限制
 
     vector<PrimBase *> prims;
     vector<pair<string, int>> sources;
+
+    // stream之间的依赖
+    vector<int> depends; // 需要等待这些stream全部完成之后才能开始
+    vector<pair<string, int>> record_events; // <事件名，原语编号>，原语完成后记录
+    vector<pair<string, int>> wait_events; // <事件名，原语编号>，原语开始前等待
 };
 
 void from_json(const json &j, StreamConfig &c);
@@ -10,11 +10,14 @@
 #include "memory/gpu/GPU_L1L2_Cache.h"
 #include "memory/sram/High_mem_access_unit.h"
 #include "memory/sram/Mem_access_unit.h"
+#include "memory/sram/sram_bank_model.h"
 #include "memory/sram_writer.h"
 #include "link/nb_global_memif_v2.h"
 
 using namespace std;
 
+class Prefetch_planner;
+
 class AddrDatapassLabel {
 public:
     string indata[MAX_SPLIT_NUM];
@@ -65,6 +68,10 @@ public:
     int loop_cnt;
     uint64_t MaxDramAddr; // 当前核最大的 dram 地址
     unsigned int defaultDataLength;
+    bool fast_forward = false; // 原语被采样快进，访存不推进时间
+    SramBankModel *sram_bank = nullptr;      // --sram-model bank 使用
+    SramBankModel *temp_sram_bank = nullptr; // temp sram 的bank模型
+    Prefetch_planner *prefetcher = nullptr;  // --prefetch-depth 大于0时使用
 
     NB_GlobalMemIF *nb_global_memif;
     sc_event *start_global_event;
@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -76,6 +77,8 @@ public:
     int visit;
     int cid; // 属于哪一个核
     SramManager* sram_manager_;
+    // 由计算核提供：各标签距下一次使用的原语条数，返回未出现的标签使用的距离
+    std::function<int(std::unordered_map<std::string, int> &)> reuse_distance;
 
     SramPosLocator(int id) {
         cid = id;
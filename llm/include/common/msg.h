@@ -18,6 +18,8 @@ public:
     bool refill_;          // 在end包中表示是否需要refill
     bool config_end_;      // 是否为一个原语config的最后一个包
     int roofline_packets_; // 视作发送X个数据包，加快模拟速度
+    int mcast_ = 0;        // 多播组编号，0表示单播
+    int vc_ = 0;           // 所在的虚通道，由上一跳router填写
     sc_bv<128> data_;
 
     Msg(bool e, MSG_TYPE m, int seq, int des, int offset, int tag, int length,
@@ -58,6 +58,32 @@ enum Directions {
     HOST,
 };
 
+// 片上网络路由算法，均为最小路径路由
+// ROUTE_XY：先X后Y；ROUTE_WEST_FIRST / ROUTE_ODD_EVEN：基于转向模型的部分自适应路由；
+// ROUTE_O1TURN：每条数据流随机选择XY或YX，两者使用不同的虚通道类
+enum ROUTING_ALGO {
+    ROUTE_XY = 0,
+    ROUTE_WEST_FIRST,
+    ROUTE_ODD_EVEN,
+    ROUTE_O1TURN,
+};
+
+// 行为级sram（USE_BEHA_SRAM == 1）的时序模型
+// SRAM_MODEL_ROW：每次访问按行（或字）计固定延迟；SRAM_MODEL_BANK：按地址模式计算bank冲突与端口竞争
+enum SRAM_MODEL {
+    SRAM_MODEL_ROW = 0,
+    SRAM_MODEL_BANK,
+};
+
+// sram放不下时选择spill对象的策略
+// LRU：最久未访问；BELADY：按原语队列得到的下一次使用距离最远；
+// COST：重新读入的dram时间按下一次使用距离折算之后最小
+enum SPILL_POLICY {
+    SPILL_LRU = 0,
+    SPILL_BELADY,
+    SPILL_COST,
+};
+
 // 消息（数据包）类型
 enum MSG_TYPE {
     CONFIG = 0,
@@ -74,11 +100,60 @@ enum MSG_TYPE {
 enum DATATYPE {
     INT8 = 0,
     FP16,
+    BF16,
+    FP8,
+    INT4,
+    DATATYPE_NUM,
 };
 
 // 通过硬件组件模拟原语
 enum HardwareConduct { SYSTOLIC_MATMUL, UNDEFINED };
 
+// 脉动阵列的数据流，DF_IDEAL 表示只按峰值算力与comp_util估算
+enum SYSTOLIC_DATAFLOW {
+    DF_IDEAL = 0,
+    DF_WEIGHT_STATIONARY,
+    DF_OUTPUT_STATIONARY,
+    DF_INPUT_STATIONARY,
+};
+
+// 集合通信的种类
+enum COLL_TYPE { COLL_ALL_REDUCE = 0, COLL_REDUCE_SCATTER, COLL_ALL_GATHER };
+
+// 集合通信的算法
+enum COLL_ALGO {
+    COLL_RING = 0,         // 单向环
+    COLL_BI_RING,          // 数据对半，两个方向的环同时进行
+    COLL_MESH2D,           // 先行内reduce-scatter，再列内all-reduce，再行内all-gather
+    COLL_HALVING_DOUBLING, // 递归减半/倍增，核数需为2的幂
+    COLL_TREE,             // 二叉树归约到根再广播，仅支持all-reduce
+};
+
+// Collective_f 原语的操作
+enum COLL_STEP_OP {
+    COLL_COPY = 0, // 拷贝一段数据（用于发送或者转发）
+    COLL_REDUCE,   // 将收到的K份数据与本地数据相加
+    COLL_CONCAT,   // 将一段数据拼接到累积结果之后
+};
+
+// 片间互联的拓扑
+enum CHIP_LINK_TOPO {
+    LINK_RING = 0, // 双向环，按最短方向经过中间芯片转发
+    LINK_FULL,     // 任意两个芯片之间都有直连链路
+    LINK_SWITCH,   // 所有芯片连接到一个交换机
+};
+
+// 片间数据包的操作类型（nvMsg header中的opcode）
+enum NV_OPCODE { NV_READ = 0, NV_WRITE, NV_ATOMIC, NV_ACK };
+
+// 分区并行仿真中父子进程之间的消息
+enum PARTITION_CMD { PART_RUN = 0, PART_EXIT };
+enum PARTITION_STATUS {
+    PART_RUNNING = 0, // 仍有待处理的事件
+    PART_IDLE,        // 没有待处理的事件，等待其他分区的数据
+    PART_STOPPED      // 已经调用sc_stop
+};
+
 // 原语config中执行完毕之后是否继续循环
 enum LOOP_TYPE { FALSE, TRUE, BOTH };
 
@@ -27,6 +27,19 @@ extern int CORE_ACC_PAYLOAD;
 class DramKVTable;
 extern DramKVTable** g_dram_kvtable;
 
+class WorkerCoreExecutor;
+extern WorkerCoreExecutor** g_core_executor;
+
+// 片间互联，config中没有link条目时为nullptr
+class ChipLinkNetwork;
+extern ChipLinkNetwork *g_chip_link;
+// 本进程仿真其核阵列的芯片编号，分区并行仿真时每个子进程各不相同
+extern int g_chip_id;
+
+// 检查点相关
+extern string g_checkpoint_file;
+extern int g_checkpoint_iter;
+
 extern sc_event kv_event;
 extern int dram_aligned;
 extern bool use_gpu;
@@ -86,6 +99,37 @@ extern int g_default_dram_bw;
 extern bool beha_dram;
 extern float beha_dram_util;
 
+// 片上网络多播：组编号 -> 目标核，0号组保留表示单播
+extern bool noc_multicast;
+extern vector<vector<int>> g_mcast_groups;
+
+// 片上网络路由算法与每个方向端口的虚通道数
+extern ROUTING_ALGO noc_routing;
+extern int noc_vcs;
+
+// host连接点：g_host_ports为带host端口的router，g_host_port_of为每个核注入数据使用的端口下标
+extern vector<int> g_host_ports;
+extern vector<int> g_host_port_of;
+// CONFIG包不经过片上网络，由host直接写入核的接收缓冲
+extern bool host_preload;
+
+// 行为级sram的时序模型
+extern SRAM_MODEL g_sram_model;
+
+// sram spill策略，spill_partial为true时只spill放下新数据所需的部分
+extern SPILL_POLICY g_spill_policy;
+extern bool spill_partial;
+
+// 核内DMA、EXU、SFU引擎并行执行原语，engine_window为同时在飞的计算原语数
+extern bool core_engines;
+extern int engine_window;
+
+// 权重预取向后查看的NPU原语条数，0表示不预取
+extern int prefetch_depth;
+
+// 无界面运行：不绘制数据流图、不创建VCD文件
+extern bool g_headless;
+
 #define RESET "\x1B[0m"  // 重置颜色
 #define RED "\x1B[1;31m"   // 红色
 #define GREEN "\x1B[1;32m" // 绿色
@@ -0,0 +1,91 @@
+#pragma once
+#include "systemc.h"
+
+#include "defs/enums.h"
+
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+class ExuConfig;
+class SfuConfig;
+class Stat_counter;
+
+// 计算代价的种类
+enum COMP_COST_OP {
+    COST_GEMM = 0, // [M, K] x [K, N]，在脉动阵列上按数据流建模
+    COST_EXU,      // 其他exu运算，只给出运算量
+    COST_SFU,      // sfu运算，只给出运算量
+    COST_OP_NUM,
+};
+
+class Comp_cost_key {
+public:
+    int op;
+    u_int64_t m, k, n; // gemm的形状；exu/sfu时m为运算量
+    int dtype;
+    int exu_x, exu_y, sfu_x;
+    int dataflow;
+
+    bool operator==(const Comp_cost_key &o) const {
+        return op == o.op && m == o.m && k == o.k && n == o.n &&
+               dtype == o.dtype && exu_x == o.exu_x && exu_y == o.exu_y &&
+               sfu_x == o.sfu_x && dataflow == o.dataflow;
+    }
+};
+
+class Comp_cost_key_hash {
+public:
+    size_t operator()(const Comp_cost_key &key) const {
+        size_t h = key.op;
+        for (u_int64_t v :
+             {key.m, key.k, key.n, (u_int64_t)key.dtype, (u_int64_t)key.exu_x,
+              (u_int64_t)key.exu_y, (u_int64_t)key.sfu_x,
+              (u_int64_t)key.dataflow})
+            h = h * 1000003 ^ hash<u_int64_t>()(v);
+        return h;
+    }
+};
+
+// 计算代价模型：根据(运算, 形状, 数据类型, 硬件配置)给出计算周期数（不含CYCLE）。
+// 结果保存在哈希表中，相同形状只计算一次。可以从实测表中校准：
+// 完全匹配的条目直接使用实测值，其余按照该类运算实测/模型的平均比例缩放
+class Comp_cost_model {
+public:
+    static Comp_cost_model &instance() {
+        static Comp_cost_model model;
+        return model;
+    }
+
+    u_int64_t gemm(int cid, u_int64_t M, u_int64_t K, u_int64_t N,
+                   DATATYPE dtype);
+    u_int64_t exu(int cid, u_int64_t ops, DATATYPE dtype);
+    u_int64_t sfu(int cid, u_int64_t ops, DATATYPE dtype);
+
+    void set_dataflow(SYSTOLIC_DATAFLOW df);
+    SYSTOLIC_DATAFLOW get_dataflow() const { return dataflow; }
+
+    // 实测表为csv：op,m,k,n,dtype,exu_x,exu_y,sfu_x,cycles，op 为 gemm/exu/sfu
+    bool load_calibration(const string &filename);
+
+private:
+    Comp_cost_model();
+
+    u_int64_t lookup(const Comp_cost_key &key);
+    double model_cycles(const Comp_cost_key &key) const;
+    Comp_cost_key make_key(int op, int cid, u_int64_t m, u_int64_t k,
+                           u_int64_t n, DATATYPE dtype) const;
+
+    SYSTOLIC_DATAFLOW dataflow;
+    unordered_map<Comp_cost_key, u_int64_t, Comp_cost_key_hash> memo;
+    unordered_map<Comp_cost_key, u_int64_t, Comp_cost_key_hash> measured;
+    double scale[COST_OP_NUM];
+
+    Stat_counter *stat_hits;
+    Stat_counter *stat_misses;
+};
+
+#define COMP_COST Comp_cost_model::instance()
+
+SYSTOLIC_DATAFLOW ParseDataflow(const string &name);
@@ -14,6 +14,7 @@ public:
     chip_config_helper(string filename, string font_ttf, int cid = 0);
 
     vector<chip_instr_base*> instr_list;
+    bool refill; // 执行完所有原语之后是否从头重复
 
     void printSelf();
 };
\ No newline at end of file
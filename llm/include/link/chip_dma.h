@@ -0,0 +1,44 @@
+#pragma once
+#include "systemc.h"
+
+#include <deque>
+#include <map>
+
+#include "link/chip_global_memory.h"
+#include "link/chip_link.h"
+#include "trace/Stats_registry.h"
+
+using namespace std;
+
+// 挂在芯片全局内存上的片间DMA引擎。发送时从全局内存按块读出数据并注入链路，
+// 接收端在数据全部写入全局内存之后触发 ChipGlobalMemory::write_received_event
+class ChipDmaEngine {
+public:
+    int chip_id;
+    ChipGlobalMemory *mem;
+    ChipLinkNetwork *network;
+
+    Stat_counter *send_bytes;
+    Stat_counter *recv_bytes;
+
+    ChipDmaEngine(int chip_id, ChipGlobalMemory *mem, ChipLinkNetwork *network);
+
+    // 阻塞直到最后一块数据离开本芯片，必须在SC_THREAD中调用
+    void send(int dst, int tag, u_int64_t bytes);
+    // 阻塞直到来自src、标记为tag的一次发送全部写入本芯片的全局内存
+    void recv(int src, int tag);
+    // 在本芯片全局内存中读写bytes字节（例如归约）
+    void access(u_int64_t bytes);
+
+    // done_ns为数据全部写入本芯片全局内存的时间
+    void deliver(int src, int tag, u_int64_t bytes, double done_ns);
+    // 由片间网络在窗口边界调用，一次发送的所有块到齐后交付
+    void arrive(const ChipFlow &flow);
+
+private:
+    map<pair<int, int>, deque<double>> mailbox;
+    // (源芯片, 序号) -> (已到达的块数, 最晚写完的时间)
+    map<pair<int, int64_t>, pair<int, double>> partial;
+    int64_t send_seq = 0;
+    sc_event ev_arrive;
+};
@@ -9,6 +9,7 @@
 #include <tlm_utils/simple_initiator_socket.h>
 #include <tlm_utils/simple_target_socket.h>
 
+#include "memory/dramsys_config.h"
 #include "memory/dramsys_wrapper.h"
 #include "nlohmann/json.hpp"
 #include "trace/Event_engine.h"
@@ -44,7 +45,7 @@ public:
           socket("chip_global_target_socket"),
           initiatorSocket("chip_global_initiator_socket"),
           globalMemoryConfig(
-              ::DRAMSys::Config::from_path(configuration, resource_directory)) {
+              LoadDramSysConfig(configuration, resource_directory)) {
         dramSysWrapper = new gem5::memory::DRAMSysWrapper(
             "GlobalDRAMSysWrapper", globalMemoryConfig, false);
         initiatorSocket.bind(dramSysWrapper->tSocket);
@@ -0,0 +1,122 @@
+#pragma once
+#include "nlohmann/json.hpp"
+#include "systemc.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "defs/enums.h"
+#include "link/base_component.h"
+#include "link/config_base.h"
+#include "trace/Stats_registry.h"
+
+using json = nlohmann::json;
+using namespace std;
+
+class ChipDmaEngine;
+
+// 片间互联的配置，写在config顶层的 "link" 条目中：
+// "link": {"topology": "ring", "bandwidth": 50, "latency": 500,
+//          "switch_latency": 200, "dma_bw": 128, "dma_latency": 100}
+// bandwidth 为每条单向链路的带宽（GB/s，即 byte/ns），latency 为每一跳的延迟（ns）
+class ChipLinkConfig : public BaseConfig {
+public:
+    int chip_num = 1;
+    CHIP_LINK_TOPO topology = LINK_RING;
+    double bandwidth = 50;
+    int latency = 500;
+    int switch_latency = 200;
+    double dma_bw = 128;
+    int dma_latency = 100;
+
+    void printSelf();
+    Type getType() const override { return TYPE_LINK; }
+};
+
+void from_json(const json &j, ChipLinkConfig &c);
+
+// 一条单向链路，按时间表记录占用情况
+class ChipLink {
+public:
+    int src, dst;
+    double free_at = 0; // ns，链路空闲的时间点
+
+    Stat_counter *bytes;
+    Stat_counter *packets;
+    Stat_counter *flits;
+
+    ChipLink(int src, int dst, string name);
+};
+
+// 分区并行仿真中在链路上传输的一块数据（一次DMA发送的一个块）。
+// ready 为每个包到达 node 的时间，owner 为负责处理下一跳的分区
+class ChipFlow {
+public:
+    int src, dst, tag;
+    int node;  // 当前所在节点
+    int owner; // 负责从node继续转发（或在dst接收）的芯片
+    int chunk, chunks;
+    int64_t seq; // 源芯片上的发送序号
+    u_int64_t bytes, msg_bytes;
+    vector<double> ready;
+
+    double head() const;
+    // 按 (最早到达时间, 源芯片, 序号, 块号) 排序，保证处理顺序与分区的调度无关
+    bool operator<(const ChipFlow &other) const;
+};
+
+// 片间网络：只负责计算数据包在链路上的占用与到达时间，不持有SystemC进程。
+// 交换机节点的编号为 chip_num
+class ChipLinkNetwork : public BaseComponent, public sc_module {
+public:
+    ChipLinkConfig config;
+
+    ChipLinkNetwork(const sc_module_name &n, const ChipLinkConfig &config);
+    ~ChipLinkNetwork();
+
+    Type getType() const override { return Type::TYPE_LINK; }
+
+    // 经过的节点序列（包含起点与终点）
+    vector<int> route(int src, int dst);
+
+    // 输出每条链路的利用率
+    void report(const string &filename);
+
+    // 每个芯片是一个分区，每条链路只由一个分区预约（源节点所在芯片，交换机的下行
+    // 链路归目的芯片），首跳在发送时预约，其余各跳与接收在窗口边界处理
+    int local_chip = 0;
+    vector<ChipFlow> pending;  // 由本分区在下一个窗口边界处理
+    vector<ChipFlow> outgoing; // 需要交给其他分区
+
+    // 跨分区数据最早的到达间隔，即并行仿真的窗口长度
+    double lookahead();
+    // 注入一块数据并预约首跳，返回最后一个包离开src的时间
+    double inject(int src, int dst, int tag, int64_t seq, int chunk,
+                  int chunks, u_int64_t bytes, u_int64_t msg_bytes,
+                  double ready_ns);
+    // 窗口边界：处理收到的与本地待处理的流
+    void sync(vector<ChipFlow> &incoming);
+
+    // 每个芯片的DMA引擎在创建时登记，发送方通过它把数据交给接收方
+    void attach(int chip_id, ChipDmaEngine *dma);
+    ChipDmaEngine *get_dma(int chip_id);
+
+private:
+    map<pair<int, int>, ChipLink *> links;
+    map<int, ChipDmaEngine *> dma_engines;
+
+    void add_link(int src, int dst);
+    ChipLink *get_link(int src, int dst);
+
+    // 从node出发前往dst的下一个节点
+    int next_hop(int node, int dst);
+    // 所有包依次经过一条链路，ready更新为到达to的时间，返回最后一个包离开from的时间
+    double hop(int from, int to, int tag, u_int64_t bytes,
+               vector<double> &ready);
+    // 设置负责处理下一跳的芯片，并放入pending或outgoing
+    void forward(ChipFlow &flow);
+};
+
+// 读取config中的link条目，若不存在则返回nullptr
+ChipLinkNetwork *InitChipLink(const char *config_file);
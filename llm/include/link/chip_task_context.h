@@ -6,14 +6,18 @@
 // Forward-declare to avoid pulling in heavy headers
 class GlobalMemInterface;
 class ChipGlobalMemory;
+class ChipDmaEngine;
 
 
 class TaskChipContext{
 public:
 
-    TaskChipContext() : mau(nullptr), chipGlobalMemory(nullptr) {}
+    TaskChipContext()
+        : mau(nullptr), chipGlobalMemory(nullptr), dma(nullptr), cid(0) {}
     mem_access_unit *mau;
     ChipGlobalMemory *chipGlobalMemory; // pointer to global memory interface
+    ChipDmaEngine *dma; // 片间DMA，没有配置link时为nullptr
+    int cid;            // 芯片编号
 };
 
 TaskChipContext generate_chip_context(GlobalMemInterface *global_mem_interface);
\ No newline at end of file
@@ -14,6 +14,7 @@ public:
         TYPE_TOP,
         TYPE_CHIP,
         TYPE_NODE,
+        TYPE_LINK,
     };
 
     virtual Type getType() const = 0;
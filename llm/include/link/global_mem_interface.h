@@ -17,8 +17,9 @@
 #include "trace/Event_engine.h"
 #include "monitor/config_helper_base.h"
 
-#include "link/chip_global_memory.h"
 #include "link/chip_config_helper.h"
+#include "link/chip_dma.h"
+#include "link/chip_global_memory.h"
 
 class Event_engine;
 class config_helper_base;
@@ -27,6 +28,7 @@ class GlobalMemInterface : public sc_module {
 public:
 
     ChipGlobalMemory *chipGlobalMemory;
+    ChipDmaEngine *dma; // 片间DMA，配置了link时才创建
     NB_GlobalMemIF *nb_global_mem_socket;
     Event_engine *event_engine;
     chip_config_helper *config_helper;
@@ -44,7 +46,8 @@ public:
 
     SC_HAS_PROCESS(GlobalMemInterface);  // Enable SystemC processes for this module
     GlobalMemInterface(const sc_module_name &n, Event_engine *event_engine,
-                        const char *config_name, const char *font_ttf);
+                        const char *config_name, const char *font_ttf,
+                        int cid = 0);
 
     GlobalMemInterface(const sc_module_name &n, Event_engine *event_engine,
                 config_helper_base *input_config);
@@ -0,0 +1,104 @@
+#pragma once
+#include "chip_instr.h"
+#include "link/chip_dma.h"
+#include "utils/config_utils.h"
+#include "utils/datatype_utils.h"
+
+#include <algorithm>
+
+// 片间的集合通信。环形拓扑按照group中的顺序成环；全连接与交换机拓扑中任意两个芯片
+// 之间只有一跳（或经过交换机），采用两两直接交换，第k步与相距k的芯片收发。
+// 片间DMA的发送不需要握手，因此每一步都是先发后收
+// {"type": "Chip_collective", "collective": "all_reduce", "group": [0, 1, 2, 3],
+//  "size": "BTC", "tag": 1, "datatype": "fp16"}
+// size 为每个芯片输入的元素数
+class Chip_collective : public chip_instr_base{
+public:
+    COLL_TYPE type;
+    std::vector<int> group;
+    int size;
+    int tag;
+    DATATYPE datatype;
+
+    Chip_collective() {
+        name = "Chip_collective";
+        instr_type = SEQ_EXEC;
+        id = -1;
+        datatype = INT8;
+    }
+
+    void parseJson(json j) override {
+        seq = j.contains("seq") && j["seq"].is_number_integer() ? j["seq"].get<int>() : -1;
+        string coll = j.value("collective", "all_reduce");
+        if (coll == "all_reduce")
+            type = COLL_ALL_REDUCE;
+        else if (coll == "reduce_scatter")
+            type = COLL_REDUCE_SCATTER;
+        else if (coll == "all_gather")
+            type = COLL_ALL_GATHER;
+        else
+            ARGUS_EXIT("Unknown chip collective ", coll, ".\n");
+
+        for (auto &g : j.at("group"))
+            group.push_back(g.is_string() ? GetDefinedParam(g.get<string>())
+                                          : g.get<int>());
+        SetParamFromJson<int>(j, "size", &size);
+        SetParamFromJson<int>(j, "tag", &tag, 0);
+        if (j.contains("datatype"))
+            datatype = ParseDatatype(j["datatype"]);
+    }
+
+    void printSelf(std::string prefix) override{
+        std::cout << prefix << "<Chip_collective>" << std::endl;
+        std::cout << prefix << "\ttype: " << type << ", chips: "
+                  << group.size() << ", size: " << size << std::endl;
+    }
+
+    int taskCoreDefault(TaskChipContext &context) override {
+        if (!context.dma)
+            ARGUS_EXIT("Chip_collective needs a \"link\" section in the config.\n");
+
+        auto it = std::find(group.begin(), group.end(), context.cid);
+        if (it == group.end())
+            ARGUS_EXIT("Chip ", context.cid, " is not in the collective group.\n");
+
+        int p = group.size();
+        int rank = it - group.begin();
+        if (p == 1)
+            return 0;
+
+        u_int64_t bytes = DatatypeBytes(datatype, size);
+        u_int64_t seg = type == COLL_ALL_GATHER ? bytes : bytes / p;
+        bool ring = context.dma->network->config.topology == LINK_RING;
+
+        // 第k步的发送与接收对象：环上固定为相邻芯片，直接交换时为相距k的芯片
+        auto peers = [&](int k, int &to, int &from) {
+            int d = ring ? 1 : k;
+            to = group[(rank + d) % p];
+            from = group[(rank - d + p) % p];
+        };
+
+        // reduce-scatter：每一步收到的一段与本地数据相加
+        if (type != COLL_ALL_GATHER) {
+            for (int k = 1; k < p; k++) {
+                int to, from;
+                peers(k, to, from);
+                context.dma->send(to, tag, seg);
+                context.dma->recv(from, tag);
+                context.dma->access(2 * seg);
+            }
+        }
+
+        // all-gather：环上每一步转发上一步收到的一段，直接交换时每一步发送本地的一段
+        if (type != COLL_REDUCE_SCATTER) {
+            for (int k = 1; k < p; k++) {
+                int to, from;
+                peers(k, to, from);
+                context.dma->send(to, tag, seg);
+                context.dma->recv(from, tag);
+            }
+        }
+
+        return 0;
+    }
+};
@@ -3,6 +3,9 @@
 #include "link/instr/recv_global_mem.h"
 #include "link/instr/print_msg.h"
 #include "link/instr/wait_event.h"
+#include "link/instr/send_chip.h"
+#include "link/instr/recv_chip.h"
+#include "link/instr/chip_collective.h"
 
 chip_instr_base* new_chip_prim(string type){
     chip_instr_base* instr = nullptr;
@@ -15,6 +18,15 @@ chip_instr_base* new_chip_prim(string type){
     else if(type == "Wait_event"){
         instr = new Wait_event();
     }
+    else if(type == "Send_chip"){
+        instr = new Send_chip();
+    }
+    else if(type == "Recv_chip"){
+        instr = new Recv_chip();
+    }
+    else if(type == "Chip_collective"){
+        instr = new Chip_collective();
+    }
     // else if(type == "Send_global_memory"){
 
     // }
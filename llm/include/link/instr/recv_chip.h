@@ -0,0 +1,38 @@
+#pragma once
+#include "chip_instr.h"
+#include "link/chip_dma.h"
+#include "utils/config_utils.h"
+
+// 等待另一个芯片通过 Send_chip 发来的、tag相同的一次数据写入本芯片全局内存
+// {"type": "Recv_chip", "src": 0, "tag": 0}
+class Recv_chip : public chip_instr_base{
+public:
+    int src;
+    int tag;
+
+    Recv_chip() {
+        name = "Recv_chip";
+        instr_type = SEQ_EXEC;
+        id = -1;
+    }
+
+    void parseJson(json j) override {
+        seq = j.contains("seq") && j["seq"].is_number_integer() ? j["seq"].get<int>() : -1;
+        SetParamFromJson<int>(j, "src", &src);
+        SetParamFromJson<int>(j, "tag", &tag, 0);
+    }
+
+    void printSelf(std::string prefix) override{
+        std::cout << prefix << "<Recv_chip>" << std::endl;
+        std::cout << prefix << "\tsrc: " << src << ", tag: " << tag
+                  << std::endl;
+    }
+
+    int taskCoreDefault(TaskChipContext &context) override {
+        if (!context.dma)
+            ARGUS_EXIT("Recv_chip needs a \"link\" section in the config.\n");
+
+        context.dma->recv(src, tag);
+        return 0;
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "chip_instr.h"
+#include "link/chip_dma.h"
+#include "utils/config_utils.h"
+#include "utils/datatype_utils.h"
+
+// 通过片间DMA将size个元素发往另一个芯片
+// {"type": "Send_chip", "dest": 1, "size": "BTC", "tag": 0, "datatype": "fp16"}
+class Send_chip : public chip_instr_base{
+public:
+    int dest;
+    int size;
+    int tag;
+    DATATYPE datatype;
+
+    Send_chip() {
+        name = "Send_chip";
+        instr_type = SEQ_EXEC;
+        id = -1;
+        datatype = INT8;
+    }
+
+    void parseJson(json j) override {
+        seq = j.contains("seq") && j["seq"].is_number_integer() ? j["seq"].get<int>() : -1;
+        SetParamFromJson<int>(j, "dest", &dest);
+        SetParamFromJson<int>(j, "size", &size);
+        SetParamFromJson<int>(j, "tag", &tag, 0);
+        if (j.contains("datatype"))
+            datatype = ParseDatatype(j["datatype"]);
+    }
+
+    void printSelf(std::string prefix) override{
+        std::cout << prefix << "<Send_chip>" << std::endl;
+        std::cout << prefix << "\tdest: " << dest << ", size: " << size
+                  << ", tag: " << tag << std::endl;
+    }
+
+    int taskCoreDefault(TaskChipContext &context) override {
+        if (!context.dma)
+            ARGUS_EXIT("Send_chip needs a \"link\" section in the config.\n");
+
+        context.dma->send(dest, tag, DatatypeBytes(datatype, size));
+        return 0;
+    }
+};
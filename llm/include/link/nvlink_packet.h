@@ -8,7 +8,7 @@
 // namespace nvlink{
 class nvHeaderMsg{
 public:
-    int opcode; // 4位，代表读/写/原子操作等
+    int opcode; // 4位，代表读/写/原子操作等，见NV_OPCODE
     int tag_id;
     int packet_length; //后续flit
 };
@@ -21,34 +21,19 @@ public:
     sc_bv<128> ae; //Address Extension 128b，里面有32b是地址
     sc_bv<128> be; //byte Enable
     std::vector<sc_bv<128>> payload;
+
+    int payload_bytes; // 包中有效的数据字节数，仿真中不携带真实数据
     
     nvMsg();
+    nvMsg(int opcode, int tag_id, u_int64_t addr, int payload_bytes);
     ~nvMsg();
 
+    // 包头与数据一共占用的flit数
+    int flits() const;
 };
 
-// }
+// 将一段数据切分为若干个数据包，除最后一个之外都携带NVLINK_MAX_PAYLOAD_FLITS个flit
+std::vector<nvMsg> NvPacketize(int opcode, int tag_id, u_int64_t addr,
+                               u_int64_t bytes);
 
-// #pragma once
-
-// #include <cstdint>
-// #include <vector>
-// #include <iostream>
-// #include <stdexcept>
-
-// namespace nvlink {
-//     enum class CmdType : uint8_t { READ, WRITE, ACK };
-
-//     struct Packet {
-//         CmdType cmd;
-//         uint64_t addr;
-//         std::vector<uint8_t> payload;
-
-//         // Serialize packet to a byte vector
-//         std::vector<uint8_t> encode() const;
-//         // Deserialize packet from a byte vector
-//         static Packet decode(const std::vector<uint8_t>& data);
-//         // Print packet info for debugging
-//         void print() const;
-//     };
-// } // namespace nvlink
+// }
@@ -0,0 +1,16 @@
+#pragma once
+#include <functional>
+
+using namespace std;
+
+// 按芯片划分的并行仿真。每个芯片是一个分区，在独立的子进程中运行自己的SystemC内核，
+// 工作目录为 partition_<id>/build。父进程以片间链路延迟为窗口（lookahead）
+// 推进所有分区，并在窗口边界转发跨分区的链路数据。
+// 每个分区在一个窗口中的输入只取决于上一个窗口的输出，因此结果与同时运行的
+// 分区数jobs无关。多芯片配置总是按分区仿真，jobs=1 时各分区依次推进。
+// build(chip) 在子进程中创建该芯片的模块，resume() 在每个窗口处理完收到的
+// 片间数据之后、推进之前调用，finish() 在子进程退出前输出统计。
+// 返回0表示所有分区正常结束
+int RunPartitionedChips(int chip_num, int jobs, const function<void(int)> &build,
+                        const function<void()> &resume,
+                        const function<void()> &finish);
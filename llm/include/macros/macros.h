@@ -157,6 +157,12 @@
 #define M_D_ROOFLINE 24
 #define M_D_CONF_END 1
 #define M_D_DATA 128
+#define M_D_MCAST 12
+#define M_D_VC 4
+
+// 虚通道相关：每个虚通道的credit计数在信号中占8位
+#define NOC_MAX_VCS 8
+#define NOC_CREDIT_BITS 8
 
 // 路由消息负载相关
 #define MAX_PACKET_ID 5
@@ -168,10 +174,17 @@
 #endif
 #define PE_GRID_SIZE (PE_GRID_X * PE_GRID_X)
 
-// 绘图相关
+// 绘图相关，NPUSIM_HEADLESS由CMake选项定义，此时不编译任何绘图代码
 #define VERBOSE_TRACE 0
+#ifdef NPUSIM_HEADLESS
+#define HEADLESS_BUILD true
+#define USE_SFML 0
+#define USE_CARIO 0
+#else
+#define HEADLESS_BUILD false
 #define USE_SFML 0
 #define USE_CARIO 1
+#endif
 
 // 默认计算核dram配置文件路径
 #define DEFAULT_DRAM_CONFIG_PATH "../DRAMSys/configs/ddr4-example-df.json"
@@ -191,6 +204,9 @@
 #define KVCACHE_PRIOR_SPILL 0
 #define PERFORMANCE_MODE 1
 
+// 计算代价模型相关
+#define SFU_PIPELINE_DEPTH 4 // sfu 流水线深度，每次调用额外的填充周期
+
 
 // mem_access_unit相关
 #define wait_time 10
@@ -204,6 +220,17 @@
 // 最大输入input数量
 #define MAX_SPLIT_NUM 6
 
+// 集合通信相关
+#define COLL_TAG_BASE 240       // 默认的tag起点，每种算法最多使用16个tag
+#define COLL_CHUNK_BYTES 65536  // 自动分块时，每一块的目标大小
+#define COLL_MAX_CHUNKS 8       // 自动分块时，最多分成多少块做流水
+
+// 片间互联相关
+#define NVLINK_FLIT_BYTES 16        // 一个flit为128bit
+#define NVLINK_HEADER_FLITS 2       // 包头：header/crc一个flit，地址扩展一个flit
+#define NVLINK_MAX_PAYLOAD_FLITS 16 // 每个包最多携带的数据flit数（256B）
+#define CHIP_DMA_CHUNK_BYTES 65536  // DMA每次搬运的块大小，不同的流在链路上按块交错
+
 // PD中的分块策略
 #define MAX_PREFILL_WORKLOAD 384
 // P 占据资源 ： D 占据资源
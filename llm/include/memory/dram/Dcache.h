@@ -12,6 +12,7 @@
 #include "defs/const.h"
 #include "defs/global.h"
 #include "macros/macros.h"
+#include "memory/dramsys_config.h"
 #include "memory/dramsys_wrapper.h"
 #include "trace/Event_engine.h"
 #include "utils/system_utils.h"
@@ -46,7 +47,7 @@ public:
            std::string_view resource_directory)
         : initiatorSocket("initiatorSocket"),
           testConfig(
-              ::DRAMSys::Config::from_path(configuration, resource_directory)) {
+              LoadDramSysConfig(configuration, resource_directory)) {
         dramSysWrapper = new gem5::memory::DRAMSysWrapper("DRAMSysWrapper",
                                                           testConfig, false);
         initiatorSocket.bind(dramSysWrapper->tSocket);
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+#include "../../DRAMSys/src/configuration/DRAMSys/config/DRAMSysConfiguration.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+
+// 由运行参数推导出的DRAMSys子配置（memspec、addressmapping），只保存在内存中，
+// 不再改写 DRAMSys/configs 下的文件。key 为 "<子目录>/<文件名>"，
+// 例如 "memspec/JEDEC_4Gb_DDR4-1866_8bit_DF.json"
+void InitDerivedDramConfigs(string resource_directory, int df_dram_bw,
+                            int gpu_bw);
+
+// 将所有推导出的子配置写入 dump_dir 下，仅用于调试
+void DumpDerivedDramConfigs(string dump_dir);
+
+// 替代 DRAMSys::Config::from_path：顶层配置中引用的子配置文件如果有推导版本，
+// 则直接使用内存中的版本。同一路径的结果会被缓存，所有核共享一次解析
+::DRAMSys::Config::Configuration
+LoadDramSysConfig(std::string_view configuration,
+                  std::string_view resource_directory);
+
+// 推导配置的生成函数
+json BuildDFMemSpec(string base_memspec, int nbr_devices);
+json BuildGPUMemSpec(int nbr_devices);
+json BuildDFAddressMapping(int n);
+json BuildGPUAddressMapping(int n);
@@ -1,6 +1,7 @@
 #pragma once
 #include "macros/macros.h"
 #include "defs/global.h"    
+#include "trace/Stats_registry.h"
 #include <cmath>
 #include <iostream>
 #include <map>
@@ -237,24 +238,17 @@ private:
     // std::vector<CacheBlock> blocks;  // Cache blocks
     int num_blocks;
 
-    // Add file stream for logging
-    std::ofstream logFile;
+    // 命中/缺失计数，下标0为读，1为写
+    Stat_counter *stat_hit[2];
+    Stat_counter *stat_miss[2];
 
-     // Add a method to log cache access
+    // 记录cache访问结果到统计注册表
     void logCacheAccess(bool isHit, string RW, uint64_t address) {
-        std::string logFileName = "gpu_cache/L1Cache_cid_" + std::to_string(cacheId) + ".log";
-
-        logFile.open(logFileName, std::ios::app);
-        if (logFile.is_open()) {
-            logFile << "Core " << cacheId << " Rw " << RW
-                    << " Time: " << sc_core::sc_time_stamp().to_string() 
-                    << " ns Address: 0x" << std::hex << address << std::dec
-                    << " Result: " << (isHit ? "HIT" : "MISS") << std::endl;
-            logFile.close();
-        }else{
-
-            assert(false);
-        }
+        int rw = RW == "WRITE";
+        if (isHit)
+            stat_hit[rw]->inc();
+        else
+            stat_miss[rw]->inc();
     }
 
 
@@ -303,13 +297,11 @@ public:
           payloadEventQueue(this, &L1Cache::peqCallback),
           bus_socket("bus_socket"),
           cpu_socket("cpu_socket") {
-        std::string logFileName = "gpu_cache/L1Cache_cid_" + std::to_string(id) + ".log";
-        logFile.open(logFileName, std::ios::app);
-        
-        if (!logFile.is_open()) {
-            SC_REPORT_ERROR("L1Cache", ("Failed to open log file: " + logFileName).c_str());
-        }
-
+        string prefix = "l1cache" + std::to_string(id) + ".";
+        stat_hit[0] = STATS.counter(prefix + "read_hit");
+        stat_hit[1] = STATS.counter(prefix + "write_hit");
+        stat_miss[0] = STATS.counter(prefix + "read_miss");
+        stat_miss[1] = STATS.counter(prefix + "write_miss");
 
         cpu_socket.register_nb_transport_fw(this, &L1Cache::nb_transport_fw);
         bus_socket.register_nb_transport_bw(this, &L1Cache::nb_transport_bw);
@@ -318,11 +310,7 @@ public:
         SC_THREAD(writebackHandler);    // 注册写回处理线程
         SC_THREAD(processRequestQueue); // 注册统一请求处理线程
     }
-    ~L1Cache() {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
-    }
+    ~L1Cache() {}
 
     // 修改writebackHandler线程，将写回请求转发到统一队列
 
@@ -1397,23 +1385,18 @@ public:
     sc_event end_req_event;
     sc_event mshrevent;
     sc_core::sc_time lastEndRequest = sc_core::sc_max_time();
-    // Add file stream for logging
-    std::ofstream logFile;
+    // 命中/缺失计数，下标0为读，1为写
+    Stat_counter *stat_hit[2] = {STATS.counter("l2cache.read_hit"),
+                                 STATS.counter("l2cache.write_hit")};
+    Stat_counter *stat_miss[2] = {STATS.counter("l2cache.read_miss"),
+                                  STATS.counter("l2cache.write_miss")};
 
     void logCacheAccess(bool isHit, string RW, uint64_t address) {
-        std::string logFileName = "gpu_cache/L2Cache_cid_" + std::to_string(0) + ".log";
-
-        logFile.open(logFileName, std::ios::app);
-        if (logFile.is_open()) {
-            logFile << "Core " << 0 << " Rw " << RW
-                    << " Time: " << sc_core::sc_time_stamp().to_string() 
-                    << " ns Address: 0x" << std::hex << address << std::dec
-                    << " Result: " << (isHit ? "HIT" : "MISS") << std::endl;
-            logFile.close();
-        }else{
-
-            assert(false);
-        }
+        int rw = RW == "WRITE";
+        if (isHit)
+            stat_hit[rw]->inc();
+        else
+            stat_miss[rw]->inc();
     }
 
     SC_HAS_PROCESS(L2Cache);
@@ -1426,13 +1409,6 @@ public:
           payloadEventQueue(this, &L2Cache::peqCallback),
           payloadEventQueue_L2WB(this, &L2Cache::peqCallback_L2WB),
           payloadEventQueue_L2L1WB(this, &L2Cache::peqCallback_L2L1WB) {
-        std::string logFileName = "gpu_cache/L2Cache_cid_" + std::to_string(0) + ".log";
-        logFile.open(logFileName, std::ios::app);
-        
-        if (!logFile.is_open()) {
-            SC_REPORT_ERROR("L2Cache", ("Failed to open log file: " + logFileName).c_str());
-        }
-
         bus_socket.register_nb_transport_fw(this, &L2Cache::nb_transport_fw);
         mem_socket.register_nb_transport_bw(this, &L2Cache::nb_transport_bw);
         SC_THREAD(processMSHRs);
@@ -1440,11 +1416,7 @@ public:
         SC_THREAD(processRequestQueue); // 注册统一请求处理线程
     }
 
-    ~L2Cache() {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
-    }
+    ~L2Cache() {}
     void peqCallback(tlm::tlm_generic_payload &payload,
                      const tlm::tlm_phase &phase) {
 
@@ -0,0 +1,23 @@
+#pragma once
+#include "defs/enums.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 一个可以spill的sram标签
+struct Spill_candidate {
+    string label;
+    int resident; // 仍在sram中的字节数
+    int record;   // LRU访问时间，越大越近
+    int next_use; // 距下一次被原语使用的原语条数，未知时为队列长度
+};
+
+// 按照策略从candidates中选出spill对象，返回其下标。
+// need为还需要腾出的字节数，partial为true时只spill其中need字节（COST使用）
+int ChooseSpillVictim(SPILL_POLICY policy, int cid,
+                      const vector<Spill_candidate> &candidates, int need,
+                      bool partial);
+
+SPILL_POLICY ParseSpillPolicy(const string &name);
@@ -0,0 +1,55 @@
+#pragma once
+#include "systemc.h"
+
+#include "defs/enums.h"
+#include "macros/macros.h"
+#include "trace/Stats_registry.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 一次sram访问的地址模式，地址均为bank字（SRAM_BITWIDTH位）的index，bank为 地址 % SRAM_BANKS。
+// 共rows行，每行width个连续的字，相邻两行起始地址相差stride；
+// 一次multiport访问即 width = SRAM_BANKS、stride = SRAM_BANKS
+struct Sram_access {
+    u_int64_t base;
+    int stride;
+    int rows;
+    int width;
+    bool write;
+};
+
+// 中等精度的sram时序模型：不驱动ArbiterRamBank的SC进程，
+// 只记录每个bank每个读/写端口的占用结束时间，一次调用内算出整个访问的完成时间。
+// 同一访问在一个bank上的字串行完成（占用一个端口），不同bank并行；
+// 同一核上并发原语的访问落在同一bank时占用其他端口，端口用尽时排队
+class SramBankModel {
+public:
+    SramBankModel(const string &name, int read_ports, int write_ports);
+
+    // 在now（ns）发起访问，返回从now到访问完成的时间（ns）。
+    // commit为false时只计算不占用端口（采样快进的原语不推进时间）
+    u_int64_t access(u_int64_t now, const Sram_access &acc,
+                     bool commit = true);
+
+    // 每个bank被访问的字数。行起始bank以 SRAM_BANKS / gcd(stride, SRAM_BANKS)
+    // 为周期重复，只需展开一个周期，与rows无关
+    static void bank_counts(const Sram_access &acc,
+                            array<u_int64_t, SRAM_BANKS> &counts);
+
+private:
+    int read_ports;
+    int write_ports;
+    vector<u_int64_t> read_free;  // [bank * read_ports + port]
+    vector<u_int64_t> write_free; // [bank * write_ports + port]
+
+    Stat_counter *accesses;
+    Stat_counter *words;
+    Stat_counter *conflict_ns;   // 字集中在少数bank上造成的停顿
+    Stat_counter *contention_ns; // 等待其他访问释放端口的停顿
+};
+
+SRAM_MODEL ParseSramModel(const string &name);
@@ -1,8 +1,10 @@
 #pragma once
 #include <queue>
+#include <set>
 
 #include "common/msg.h"
 #include "monitor/config_helper_base.h"
+#include "monitor/placement.h"
 
 using namespace std;
 
@@ -19,11 +21,21 @@ public:
     }
 
     void generate_prims(int i);
+    // 满足多播条件时返回多播组编号，否则返回0
+    int mcast_group(int cid, const CoreJob &work, const vector<Cast> &casts);
     void calculate_address(bool do_loop);
 
     void printSelf();
     void random_core(string font_ttf);
 
+    // 由worklist中的cast与source构建通信图，边权为每轮迭代的字节数
+    vector<Comm_edge> comm_graph();
+    // 按通信量优化核的放置，pinned中的核以及位于host端口router上的source不移动
+    void optimize_placement(const set<int> &pinned, int iters, double balance,
+                            unsigned seed, string font_ttf);
+    // 按照o2r（原id -> 新id）改写所有核的编号、cast与source，并重新绘图
+    void remap_cores(const vector<int> &o2r, string font_ttf);
+
     void parse_ack_msg(Event_engine *event_engine, int flow_id,
                        sc_event *notify_event);
     void parse_done_msg(Event_engine *event_engine, sc_event *notify_event);
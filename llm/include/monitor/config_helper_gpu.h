@@ -1,13 +1,37 @@
 #pragma once
 #include "monitor/config_helper_base.h"
 
+#include <map>
+
+// 单个stream的运行状态。stream内的原语（kernel）依次执行，不同stream之间可以并发
+class GpuStreamState {
+public:
+    int prim_index = 0;  // 正在执行第几个原语
+    int loop = 0;        // 已经完成多少loop了，针对loop字段
+    int issued_ctas = 0; // 当前原语已经下发的CTA数量
+    int issued_sms = 0;  // 当前原语已经分到的SM数量
+    int done_ctas = 0;   // 当前原语已经完成的CTA数量
+    int running_sms = 0; // 当前占用的SM数量
+    bool finished = false;
+    sc_time finish_time;
+};
+
 class config_helper_gpu : public config_helper_base {
 public:
     vector<StreamConfig> streams;
-    int gpu_index; // 正在发放第几个gpu start data，仅在GPU模式下使用
-    int done_loop; // 已经完成多少loop了，针对loop字段
+    vector<GpuStreamState> stream_states;
+    map<string, int> event_records; // 每个事件被记录的次数
     GpuPosLocator *gpu_pos_locator;
 
+    // SM的占用情况：运行的stream编号（-1表示空闲）以及分到的CTA数量
+    vector<int> sm_stream;
+    vector<int> sm_ctas;
+    int rr_stream;   // 轮询下发的起始stream
+    int ack_rounds;  // 启动阶段收到的ack轮数（config、weight）
+    bool started;    // 是否已经发出start数据
+    vector<Msg> temp_config; // 存放所有还没有发出去的config
+    vector<int> config_seq;  // 每个核在temp_config中的包序号
+
     config_helper_gpu(string filename, string font_ttf, int config_chip_id = 0);
     config_helper_gpu *clone() const override {
         return new config_helper_gpu(*this);
@@ -23,4 +47,14 @@ public:
 
     void fill_queue_config(queue<Msg> *q);
     void fill_queue_start(queue<Msg> *q);
-};
\ No newline at end of file
+
+private:
+    // CTA调度
+    bool stream_ready(int s);
+    int stream_sm_limit(int s);
+    void dispatch();
+    void dispatch_ctas(int s, int sm, int first_cta, int cta_num,
+                       int stride = 1);
+    void kernel_done(int s);
+    void report_streams();
+};
@@ -4,6 +4,7 @@
 
 #include "common/pd.h"
 #include "monitor/config_helper_base.h"
+#include "trace/Stats_registry.h"
 
 using namespace std;
 
@@ -19,6 +20,16 @@ public:
     
     vector<vector<double>> token_record; // 记录每一个req的每一个token的处理完毕时间
 
+    // 统计
+    Stat_counter *stat_iters;       // 已完成的iteration数
+    Stat_gauge *stat_decode_queue;  // 等待decode的请求数
+    Stat_gauge *stat_running_reqs;  // 已经开始但尚未完成的请求数
+
+    // 检查点相关
+    int iter_cnt;          // 已经完成的iteration数（prefill与decode合计）
+    bool checkpoint_saved; // 本次模拟是否已经写出检查点
+    double time_offset_ns; // 从检查点恢复时，检查点对应的模拟时间
+
     bool busy_p; // 此次iteration是否已经开始
     bool busy_d;
     bool wait_send_start_prefill;
@@ -71,4 +82,5 @@ public:
     void iter_done(PD_JOB type);
 
     void set_global_vars(int T);
+    void try_checkpoint();
 };
\ No newline at end of file
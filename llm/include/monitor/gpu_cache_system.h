@@ -2,6 +2,7 @@
 #include "systemc.h"
 #include "macros/macros.h"
 
+#include "memory/dramsys_config.h"
 #include "memory/dramsys_wrapper.h"
 #include "memory/gpu/GPU_L1L2_Cache.h"
 #include "defs/global.h"
@@ -23,7 +24,7 @@ public:
                     std::string_view resource_directory)
         : sc_module(name),
           testConfig(
-              ::DRAMSys::Config::from_path(configuration, resource_directory)) {
+              LoadDramSysConfig(configuration, resource_directory)) {
 
         l2Cache = new L2Cache("l2_cache", L2CACHESIZE, L2CACHELINESIZE, 8, 16);
 
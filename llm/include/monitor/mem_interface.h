@@ -4,6 +4,7 @@
 #include "defs/global.h"
 #include "monitor/config_helper_base.h"
 #include "trace/Event_engine.h"
+#include "trace/Stats_registry.h"
 
 enum PRO_PHASE { PRO_CONF, PRO_DATA, PRO_START, PRO_DONE };
 
@@ -48,6 +49,15 @@ public:
     queue<Msg> *write_buffer;
     /* --------------------------------------------------- */
 
+    /* -----------------Host ports------------------------ */
+    // 端口p连接router g_host_ports[p]，write_buffer按端口下标排列
+    int port_num;
+    vector<Stat_counter *> stat_port_packets; // 每个端口注入网络的包数
+    vector<Stat_counter *> stat_port_stalls;  // 有包待发送但端口不可用的周期
+    vector<Stat_counter *> stat_port_recv;    // 每个端口从网络收到的包数
+    Stat_counter *stat_preload_packets;       // 不经过网络直接写入核的CONFIG包
+    /* --------------------------------------------------- */
+
     Event_engine *event_engine;
     int flow_id;
     vector<int> has_global_mem;
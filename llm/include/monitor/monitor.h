@@ -20,6 +20,7 @@ public:
     sc_signal<sc_bv<256>> *rc_channel;
     sc_signal<bool> *channel_avail[DIRECTIONS];
     sc_signal<bool> *data_sent[DIRECTIONS];
+    sc_signal<sc_bv<64>> *credit[DIRECTIONS];
     sc_signal<bool> *rc_data_sent;
 
     sc_signal<bool> *host_channel_avail;
@@ -0,0 +1,92 @@
+#pragma once
+#include "monitor/config_helper_core.h"
+
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class CompBase;
+class Recv_prim;
+class Send_prim;
+
+// 单个计算原语在一个核上的估计耗时，时间单位均为ns
+class Est_prim {
+public:
+    int cid;
+    string name;
+    string label;            // 原语的outdata
+    u_int64_t count = 0;     // 执行次数
+    double compute_ns = 0;   // 计算时间之和
+    double dram_ns = 0;      // 访存时间之和
+    double total_ns = 0;     // max(计算, 访存) 之和
+    u_int64_t dram_bound = 0; // 访存时间大于计算时间的次数
+};
+
+// 单个核的时间线
+class Est_core {
+public:
+    int id;
+    // 与fill_queue_config下发的原语顺序一致，bool为true时RECV_START按RECV_DATA处理
+    vector<pair<PrimBase *, bool>> program;
+    int pc = 0;
+    double now = 0;
+
+    double comp_ns = 0; // 计算原语
+    double send_ns = 0; // 等待接收方握手与发送数据
+    double recv_ns = 0; // 等待数据到达
+
+    // 当前正在执行的recv
+    bool receiving = false;
+    double recv_open = 0;    // 开始等待的时刻
+    int recv_got = 0;        // 已经到达的数据数量
+    double recv_arrive = 0;  // 最后一份数据到达的时刻
+    double inbound_free = 0; // 接收端口空闲的时刻，多发一时的数据依次到达
+
+    list<pair<string, int>> resident; // 驻留在SRAM中的静态数据，LRU顺序
+    int resident_bytes = 0;
+
+    bool finished() const { return pc >= program.size(); }
+};
+
+// 一阶性能估计：不启动SystemC仿真，按照config_helper_core生成的原语序列推算每个核的时间线。
+// 计算时间使用与仿真相同的计算代价模型（COMP_COST），访存时间使用行为级DRAM的带宽折算，
+// 静态数据（权重与bias）在SRAM中按LRU驻留；片上网络按曼哈顿距离的roofline估计，
+// send需要等待接收方到达对应tag的recv（REQ/ACK握手）之后才开始传输
+class Perf_estimator {
+public:
+    Perf_estimator(config_helper_core *config);
+
+    // 返回false表示存在无法推进的核（死锁或config中的收发不匹配）
+    bool run();
+    // 打印各核的时间分解与瓶颈，并写入 <prefix>_cores.csv 与 <prefix>_prims.csv
+    void report(const string &prefix, int top);
+
+    double end_ns = 0; // 端到端延迟
+
+private:
+    config_helper_core *config;
+    vector<Est_core> cores;
+    map<int, int> core_index; // 核id -> cores中的下标
+    map<pair<int, CompBase *>, Est_prim> prims;
+
+    map<int, deque<double>> start_data; // 由host推入的初始数据的到达时刻
+    map<int, double> host_free;         // 每个host端口空闲的时刻
+    set<string> unknown_ops;            // 已报告过没有运算量的原语名
+
+    int hops(int from, int to);
+    double dram_ns(int cid, int bytes);
+    int static_bytes(Est_core &core, const string &label, int bytes);
+    void comp(Est_core &core, CompBase *p);
+    void compute_ops(CompBase *p, int cid, u_int64_t &exu_cycle,
+                     u_int64_t &sfu_cycle);
+
+    bool step(Est_core &core);
+    bool send(Est_core &core, Send_prim *p);
+    bool recv(Est_core &core, Recv_prim *p, bool next_loop);
+    void to_host(Est_core &core, int packets);
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <set>
+#include <vector>
+
+using namespace std;
+
+// 通信图中的一条边：每轮迭代从from发往to的字节数，to或from为GRID_SIZE时表示host
+class Comm_edge {
+public:
+    int from;
+    int to;
+    double bytes;
+
+    Comm_edge(int from, int to, double bytes)
+        : from(from), to(to), bytes(bytes) {}
+};
+
+// 核放置优化：在mesh上为每个核选择位置，最小化 加权跳数 + balance * 最繁忙链路的负载。
+// 链路负载按先X后Y路由累加；host的数据从核对应的host端口进出。
+// 使用模拟退火，每一步交换两个位置上的核（位置可以为空），固定的核不参与交换。
+class Placement_optimizer {
+public:
+    Placement_optimizer(const vector<Comm_edge> &edges, const set<int> &pinned,
+                        double balance);
+
+    // 返回o2r：原位置 -> 新位置，覆盖全部GRID_SIZE个位置
+    vector<int> run(int iters, unsigned seed);
+
+    // 评估一个放置，同时给出加权跳数与最繁忙链路的负载
+    double cost(const vector<int> &o2r, double &weighted_hops,
+                double &max_load);
+
+private:
+    vector<Comm_edge> edges;
+    set<int> pinned;
+    double balance;
+
+    vector<double> link_load; // 位置*4+方向 -> 字节数，最后为每个host端口
+
+    void add_path(int from, int to, double bytes, double &weighted_hops);
+};
@@ -6,6 +6,7 @@
 #include "systemc.h"
 
 #include "nlohmann/json.hpp"
+#include <functional>
 #include <vector>
 
 using json = nlohmann::json;
@@ -18,7 +19,9 @@ public:
     string name;
 
     int sram_addr;
-    DATATYPE datatype = INT8;
+    DATATYPE datatype = INT8;        // 激活值
+    DATATYPE weight_datatype = INT8; // 权重与bias
+    DATATYPE kv_datatype = INT8;     // KV cache
 
     virtual int taskCoreDefault(TaskCoreContext &context) = 0;
     virtual vector<sc_bv<128>> serialize() = 0;
@@ -49,12 +52,25 @@ public:
     // 在initializeDefault()中
     int data_byte;
 
+    // 最近一次执行的性能数据，在taskCoreDefault()中填写，用于原语执行记录
+    u_int64_t last_exu_ops = 0;
+    u_int64_t last_sfu_ops = 0;
+    u_int64_t last_dram_time = 0;
+    u_int64_t last_compute_time = 0;
+    u_int64_t last_exu_time = 0; // last_compute_time 中EXU与SFU各自的部分
+    u_int64_t last_sfu_time = 0;
+
     virtual void initialize() = 0; // 解析之后进行的初始化函数，由用户自定义
     virtual void initializeDefault() = 0; // 默认初始化函数
 
     // 向上暴露的工作函数。不同硬件逻辑不同
     virtual int taskCoreDefault(TaskCoreContext &context) = 0;
 
+    // 原语一次执行的运算量，taskCore与性能估计共用。没有给出运算量的原语返回false
+    virtual bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+        return false;
+    }
+
     // 从配置文件中解析原语的工具函数
     virtual vector<sc_bv<128>> serialize() = 0;
     virtual void deserialize(vector<sc_bv<128>> buffer) = 0;
@@ -63,10 +79,23 @@ public:
     // 打印原语信息
     virtual void printSelf() = 0;
 
+    // 数据类型：json中的datatype/weight_datatype/kv_datatype，
+    // 未给出的权重与KV精度与激活值相同
+    void parseDatatype(json j);
+    // 数据块的字节数，权重与bias按照weight_datatype计算（包括scale开销）
+    int chunkBytes(const string &chunk_name, int elements);
+
     CompBase() { prim_type |= COMP_PRIM; }
 };
 
 
+// 原语在taskCore中通过checkStaticData读入的静态数据（权重、bias等），预取规划使用
+struct Static_chunk {
+    string label;
+    u_int64_t addr; // dram地址
+    int bytes;
+};
+
 class NpuBase : public CompBase {
 public:
     // 地址偏移信息
@@ -78,6 +107,9 @@ public:
     bool skip_input = false;
     bool skip_output = false;
 
+    // 由taskCore按照矩阵形状从计算代价模型中得到的exu周期数，-1表示按exu_ops估算
+    int64_t exu_cycle = -1;
+
     // 数据块信息
     unordered_map<string, int>
         data_chunk_addr; // 可以推算，在initializeDefault()中
@@ -87,6 +119,8 @@ public:
     virtual void taskCore(TaskCoreContext &context, string prim_name,
                           u_int64_t &dram_time, u_int64_t &exu_ops,
                           u_int64_t &sfu_ops) = 0;
+    // 按照矩阵形状从计算代价模型中得到的exu周期数，不是矩阵乘的原语返回-1
+    virtual int64_t gemmCycle(int cid) { return -1; }
 
     // 原语解析函数
     vector<sc_bv<128>> serialize();
@@ -99,13 +133,19 @@ public:
     // perf工具函数
     int sramUtilization(DATATYPE datatype, int cid = 0);
 
-    // 内存存取函数
+    // 内存存取函数。checkStaticData 的 data_size_label 为字节数（data_chunk），
+    // prefReadData 的为元素个数
     void checkStaticData(TaskCoreContext &context, uint64_t &dram_time,
                          uint64_t label_global_addr, int data_size_label,
                          string label_name, bool use_pf = false);
     void prefReadData(TaskCoreContext &context, uint64_t &dram_time,
                       int data_size_label, string label_name);
 
+    // prim_name 为输出标签的前缀，与taskCore的参数相同。默认按照weight、bias、
+    // sincos数据块给出，标签选择依赖运行时状态的原语需要重写
+    virtual void staticData(const string &prim_name,
+                            vector<Static_chunk> &chunks);
+
     NpuBase() { prim_type |= NPU_PRIM; }
 
 private:
@@ -132,8 +172,18 @@ public:
 
     int fetch_index; // 用于记录取权重需要偏移的offset
 
+    // 软件流水线，在compose中给出。tile_k为0时不切分，整体读入之后再与计算重叠
+    int pipe_stages = 2; // 共享内存中的缓冲区数量
+    int tile_k = 0;      // K维每个tile的大小
+
     virtual GpuBase *clone() = 0;
 
+    // 多级流水线：tile i 的读入需要等待其缓冲区被 tile i-stages
+    // 的计算释放，计算在读入完成且上一个tile计算完成之后开始。
+    // 返回时所有tile的计算均已完成
+    void runTilePipeline(TaskCoreContext &context, int tile_num, int cycle,
+                         function<void(int)> load_tile);
+
     // 原语解析函数
     vector<sc_bv<128>> serialize();
     void deserialize(vector<sc_bv<128>> buffer);
@@ -169,4 +219,7 @@ public:
         prim_type |= MOE_PRIM;
         param_name.insert(param_name.end(), {"need_choose"});
     }
+
+    // 专家在运行时选择，不参与预取
+    void staticData(const string &prim_name, vector<Static_chunk> &chunks) {}
 };
\ No newline at end of file
@@ -9,6 +9,7 @@ class Attention_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Attention_f() {
@@ -22,6 +23,7 @@ class Batchnorm_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Batchnorm_f() {
@@ -31,10 +33,26 @@ public:
 };
 
 
+// 集合通信中的一步：拷贝、归约或者拼接，由config中的collective展开生成
+class Collective_f : public NpuBase {
+public:
+    void taskCore(TaskCoreContext &context, string prim_name,
+                 u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    void initialize();
+
+    Collective_f() {
+        name = "Collective_f";
+        param_name.insert(param_name.end(), {"N", "ACC", "K", "op"});
+    }
+};
+
+
 class Conv_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Conv_f() {
@@ -49,6 +67,7 @@ class Dummy_p : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Dummy_p() { name = "Dummy_p"; }
@@ -58,6 +77,7 @@ class gate_forward : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     gate_forward() {
@@ -70,6 +90,7 @@ class Gelu_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Gelu_f() {
@@ -83,6 +104,7 @@ class Layernorm_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Layernorm_f() {
@@ -96,6 +118,8 @@ class Matmul_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    int64_t gemmCycle(int cid);
     void initialize();
     Matmul_f() {
         name = "Matmul_f";
@@ -109,6 +133,7 @@ class switch_data : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     switch_data() {
         name = "switch_data";
@@ -121,6 +146,7 @@ class Max_pool : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     Max_pool() {
         name = "Max_pool";
@@ -147,6 +173,7 @@ class Merge_matmul : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Merge_matmul() {
@@ -160,6 +187,7 @@ class Relu_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     Relu_f() {
         name = "Relu_f";
@@ -172,6 +200,7 @@ class Residual_f : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Residual_f() {
@@ -185,6 +214,7 @@ class rmsnorm_forward : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     rmsnorm_forward() {
         name = "rmsnorm_forward";
@@ -197,6 +227,7 @@ class rope_forward : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     rope_forward() {
@@ -210,6 +241,7 @@ class silu_forward : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     silu_forward() {
         name = "silu_forward";
@@ -236,6 +268,7 @@ class Split_matmul : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     Split_matmul() {
@@ -249,6 +282,7 @@ class swiglu_forward : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     swiglu_forward() {
         name = "swiglu_forward";
@@ -290,6 +324,7 @@ class parse_input : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     parse_input() {
@@ -303,6 +338,7 @@ class parse_output : public NpuBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     parse_output() {
@@ -4,6 +4,8 @@ class matmul_forward_moe : public MoeBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    int64_t gemmCycle(int cid);
     void initialize();
     matmul_forward_moe() {
         name = "matmul_forward_moe";
@@ -17,6 +19,7 @@ class load_expert : public MoeBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     load_expert() {
         name = "load_expert";
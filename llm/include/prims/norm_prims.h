@@ -42,7 +42,9 @@ public:
     void printSelf();
 
     Recv_prim() { name = "Recv_prim"; }
-    Recv_prim(RECV_TYPE type) : type(type) { name = "Recv_prim"; }
+    Recv_prim(RECV_TYPE type) : type(type), tag_id(0), recv_cnt(1) {
+        name = "Recv_prim";
+    }
     Recv_prim(RECV_TYPE type, int tag, int cnt)
         : type(type), tag_id(tag), recv_cnt(cnt) {
         name = "Recv_prim";
@@ -60,6 +62,7 @@ public:
     int end_length;                    // 尾包长度，避免覆盖
 
     int data_packet_id; // 已经发送的包裹数量
+    int mcast_id = 0;   // SEND_DATA的多播组编号，0表示单播
 
     int taskCoreDefault(TaskCoreContext &context);
 
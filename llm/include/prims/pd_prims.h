@@ -4,7 +4,10 @@ class matmul_forward_pd : public PdBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    int64_t gemmCycle(int cid);
     void initialize();
+    void staticData(const string &prim_name, vector<Static_chunk> &chunks);
 
     matmul_forward_pd() {
         name = "matmul_forward_pd";
@@ -18,6 +21,7 @@ class attention_forward_pd : public PdBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
 
     attention_forward_pd() {
@@ -31,6 +35,7 @@ class rope_forward_pd : public PdBase {
 public:
     void taskCore(TaskCoreContext &context, string prim_name,
                  u_int64_t &dram_time, u_int64_t &exu_ops, u_int64_t &sfu_ops);
+    bool computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops);
     void initialize();
     rope_forward_pd() {
         name = "rope_forward_pd";
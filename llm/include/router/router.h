@@ -1,13 +1,16 @@
 #pragma once
 #include "systemc.h"
 #include <iostream>
+#include <map>
 #include <queue>
+#include <tuple>
 
 #include "common/msg.h"
 #include "defs/const.h"
 #include "defs/global.h"
 #include "macros/macros.h"
 #include "trace/Event_engine.h"
+#include "trace/Stats_registry.h"
 #include "utils/memory_utils.h"
 #include "utils/msg_utils.h"
 #include "utils/router_utils.h"
@@ -17,6 +20,24 @@ using namespace std;
 
 class RouterUnit;
 
+// 输出缓存中的包，记录进入缓存的时刻，用于统计在链路前的等待时间
+class Router_flit {
+public:
+    sc_bv<256> data;
+    double enter; // ns
+
+    Router_flit(const sc_bv<256> &data, double enter)
+        : data(data), enter(enter) {}
+};
+
+// 一条数据流（同一source、des、tag的DATA包）在本router选定的输出方向与虚通道。
+// 数据流的第一个包分配，之后的包沿用，保证同一数据流不乱序，且上锁与解锁在同一通道上进行
+class Route_entry {
+public:
+    vector<pair<Directions, int>> outs; // 多播时有多个方向
+    int ref = 0;                        // 经过的尚未结束的数据流数量
+};
+
 class RouterMonitor : public sc_module {
 public:
     RouterUnit **routers;
@@ -39,14 +60,23 @@ public:
     sc_out<sc_bv<256>> channel_o[DIRECTIONS];
     sc_in<sc_bv<256>> channel_i[DIRECTIONS];
 
-    // 输入，输出缓存区
-    queue<sc_bv<256>> buffer_i[DIRECTIONS];
-    queue<sc_bv<256>> buffer_o[DIRECTIONS];
+    // 输入，输出缓存区，按虚通道划分；CENTER方向只有0号虚通道
+    vector<queue<sc_bv<256>>> buffer_i[DIRECTIONS];
+    vector<queue<Router_flit>> buffer_o[DIRECTIONS];
     queue<sc_bv<256>> side_buffer_o[DIRECTIONS];
 
-    // 通道未满的握手信号，只有收到该信号为true，才可向目标发送数据，input信号缺少的一个由core_is_ready担任
+    // 通道未满的握手信号，只对CENTER方向（core）有效
     sc_out<bool> channel_avail_o[DIRECTIONS];
-    sc_in<bool> channel_avail_i[DIRECTIONS - 1];
+
+    // 4个方向基于credit的流控：credit_o返回本router各输入虚通道已经取出的包数（每个虚通道8位的回绕计数），
+    // 上游据此恢复credit；credit[i][vc]为下游对应输入虚通道的剩余空间
+    sc_out<sc_bv<64>> credit_o[DIRECTIONS - 1];
+    sc_in<sc_bv<64>> credit_i[DIRECTIONS - 1];
+    int credit[DIRECTIONS - 1][NOC_MAX_VCS];
+    int credit_seen[DIRECTIONS - 1][NOC_MAX_VCS];
+    int credit_returned[DIRECTIONS - 1][NOC_MAX_VCS];
+    int rr_out[DIRECTIONS];  // 每个输出链路在虚通道之间轮询
+    int rr_in[DIRECTIONS];   // 每个输入端口在虚通道之间轮询
 
     // 通道使能信号，router接收到之后才可查看channel内容
     sc_out<bool> data_sent_o[DIRECTIONS];
@@ -60,10 +90,14 @@ public:
     // 如果为大于0的数，则表示已上锁，数字等于正在连接的通路tag编号。router在发送包的时候，如果该包的tag等于上锁通道的tag，则可以发送，否则不予发送。
     // 在发送当前通路上的end包的时候，当前router上锁的通道自动解除。
     // 现在有一个问题，如果有两个ack返回包在相邻时间返回，其中一个可能会被另一个阻挡，导致部分router会被无意义锁住。
+    // 有多个虚通道时按虚通道上锁，数据流不会占用一个类中最后一个空闲的虚通道，其他包总能绕过被锁的通路。
     int input_lock[5];
     int input_lock_ref[5];
-    int output_lock[5];
-    int output_lock_ref[5];
+    int output_lock[5][NOC_MAX_VCS];
+    int output_lock_ref[5][NOC_MAX_VCS];
+
+    // (source, des, tag) -> 数据流的输出
+    map<tuple<int, int, int>, Route_entry> routes;
 
     vector<Msg>
         req_queue; // 用于存放req。当req需要的信道被上锁时，会被存放在这里。
@@ -85,6 +119,17 @@ public:
     // 触发execute函数的信号
     sc_event need_next_trigger;
 
+    // 统计：经过该router转发的数据包数（4方向 + 本地core）
+    Stat_counter *stat_packets;
+    // 统计：向4方向转发的数据flit数，以及多播额外复制的包数
+    Stat_counter *stat_flits;
+    Stat_counter *stat_mcast_copies;
+    // 统计：4个方向链路上的flit数（用于计算链路利用率）与包在输出缓存中等待链路的时间
+    Stat_counter *stat_link_flits[DIRECTIONS - 1];
+    Stat_histogram *stat_link_wait[DIRECTIONS - 1];
+    // 统计：包因为没有可用的输出虚通道或空间而停顿的周期数
+    Stat_counter *stat_stalls;
+
     Event_engine *event_engine;
 
     SC_HAS_PROCESS(RouterUnit);
@@ -93,6 +138,12 @@ public:
 
     void move_data();
 
+    int vc_num(int dir) { return dir == CENTER ? 1 : noc_vcs; }
+    bool out_open(int out, int tag);
+    int select_vc(int out, int vc_class, int tag, bool stream);
+    bool route_stream(Msg &m, int in, int in_vc, Route_entry &entry);
+    bool forward(int in, int vc);
+
     void router_execute();
     void monitor_core_status();
     void trans_next_trigger();
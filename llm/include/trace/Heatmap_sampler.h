@@ -0,0 +1,38 @@
+#pragma once
+#include "systemc.h"
+
+#include "trace/Stats_registry.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 核阵列热力图的数据流：每隔window_ns的模拟时间写出一行json，包含窗口内每个核
+// 处于计算、等待dram、等待片上网络的时间比例，以及每个router四个方向链路的flit数。
+// 只读取已有的统计量并做差分，由streaming_trace_viewer实时播放
+class Heatmap_sampler : public sc_module {
+public:
+    SC_HAS_PROCESS(Heatmap_sampler);
+    Heatmap_sampler(const sc_module_name &name, int window_ns,
+                    const string &filename);
+    ~Heatmap_sampler();
+
+    void sample_periodically();
+    // 采样因没有其他事件而暂停之后，有了新的事件时继续
+    void resume();
+
+private:
+    int window_ns;
+    ofstream stream;
+    sc_event ev_resume;
+
+    vector<Core_stats *> cores;
+    vector<Stat_counter *> links; // router*4+方向
+    vector<double> last_state;    // 核*3+状态，上一个窗口结束时的累计值
+    vector<u_int64_t> last_flits;
+    double last_ns;
+
+    void write_frame();
+};
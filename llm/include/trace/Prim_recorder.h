@@ -0,0 +1,54 @@
+#pragma once
+#include "systemc.h"
+
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+// 单条原语执行记录，时间单位均为ns
+class Prim_record {
+public:
+    int cid = 0;
+    string kind;          // comp / send / recv
+    string name;          // 原语名，send/recv 为具体类型
+    u_int64_t start = 0;
+    u_int64_t end = 0;
+    u_int64_t exu_ops = 0;
+    u_int64_t sfu_ops = 0;
+    u_int64_t compute_time = 0; // 计算单元理想耗时
+    u_int64_t dram_bytes = 0;   // 读入与写回dram的总字节数
+    u_int64_t dram_time = 0;
+    u_int64_t spill_bytes = 0;
+    u_int64_t recv_wait = 0;    // 等待数据包到达的时间
+    int tag = -1;               // send/recv 的 tag，用于匹配跨核依赖
+    int peer = -1;              // send 的目的核
+    int loop_cnt = 0;
+};
+
+// 原语执行记录器：每条原语执行完毕后写出一行csv，由 scripts/prim_analyzer.py
+// 构建跨核依赖图并分析关键路径
+class Prim_recorder {
+public:
+    static Prim_recorder &instance() {
+        static Prim_recorder recorder;
+        return recorder;
+    }
+
+    void open(const string &filename);
+    void close();
+    inline bool enabled() const { return stream.is_open(); }
+
+    void record(const Prim_record &r);
+
+    static u_int64_t time_ns() {
+        return (u_int64_t)(sc_time_stamp().to_seconds() * 1e9);
+    }
+
+private:
+    Prim_recorder() {}
+
+    ofstream stream;
+};
+
+#define PRIM_RECORDER Prim_recorder::instance()
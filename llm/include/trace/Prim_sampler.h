@@ -0,0 +1,62 @@
+#pragma once
+#include "systemc.h"
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+class CompBase;
+class PrimCoreContext;
+
+// 同一签名的原语在一个核上的采样记录，时间单位均为ns
+class Prim_sample {
+public:
+    u_int64_t count = 0;    // 出现次数
+    u_int64_t detailed = 0; // 详细仿真的次数
+    u_int64_t replayed = 0; // 快进的次数
+    double total_ns = 0;    // 详细仿真的总耗时
+    // 重新验证：快进预测的耗时与详细仿真耗时之差
+    u_int64_t checks = 0;
+    double abs_err_ns = 0;
+    double max_rel_err = 0;
+    u_int64_t since_check = 0; // 上一次验证之后快进的次数
+    bool checking = false;
+    double predicted = 0;
+
+    double mean() const { return detailed ? total_ns / detailed : 0; }
+};
+
+// 重复层的采样仿真：按 (原语, 形状, 输入在SRAM中的状态, SRAM占用) 的签名统计每个核上的
+// 计算原语，前warmup次详细仿真，之后的出现只执行SRAM标签等功能性的更新，访存不推进时间，
+// 并直接等待详细仿真的平均耗时（快进）。每快进revalidate次重新详细仿真一次，
+// 以估计快进带来的误差。只在行为级DRAM（--beha_dram）下可用
+class Prim_sampler {
+public:
+    static Prim_sampler &instance() {
+        static Prim_sampler sampler;
+        return sampler;
+    }
+
+    // 返回false表示参数与dram模型不兼容
+    bool enable(int warmup, int revalidate);
+    inline bool enabled() const { return warmup > 0; }
+
+    string signature(CompBase *p, PrimCoreContext *context);
+    // 返回true表示本次快进，replay_ns为需要等待的时间
+    bool should_replay(int cid, const string &sig, u_int64_t &replay_ns);
+    // 详细仿真结束后登记耗时
+    void record(int cid, const string &sig, u_int64_t duration_ns);
+    void record_replay(int cid, const string &sig);
+
+    void report(const string &filename);
+
+private:
+    Prim_sampler() {}
+
+    int warmup = 0;
+    int revalidate = 0;
+    map<pair<int, string>, Prim_sample> samples;
+};
+
+#define PRIM_SAMPLER Prim_sampler::instance()
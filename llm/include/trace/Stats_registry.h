@@ -0,0 +1,152 @@
+#pragma once
+#include "systemc.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 计数器：只做累加
+class Stat_counter {
+public:
+    u_int64_t value = 0;
+
+    inline void inc(u_int64_t delta = 1) { value += delta; }
+};
+
+// 直方图：固定桶宽，超出范围的样本落在最后一个桶中
+class Stat_histogram {
+public:
+    double bucket_width;
+    vector<u_int64_t> buckets;
+    u_int64_t count = 0;
+    double sum = 0;
+    double min_v = 0;
+    double max_v = 0;
+
+    Stat_histogram(double bucket_width, int bucket_num)
+        : bucket_width(bucket_width), buckets(bucket_num, 0) {}
+
+    inline void sample(double v) {
+        int idx = (int)(v / bucket_width);
+        if (idx < 0)
+            idx = 0;
+        if (idx >= (int)buckets.size())
+            idx = buckets.size() - 1;
+        buckets[idx]++;
+
+        if (count == 0 || v < min_v)
+            min_v = v;
+        if (count == 0 || v > max_v)
+            max_v = v;
+        count++;
+        sum += v;
+    }
+
+    double mean() const { return count ? sum / count : 0; }
+};
+
+// 时间加权量：记录当前值，并按照持续时间累计，用于计算平均利用率等
+class Stat_gauge {
+public:
+    double value = 0;
+    double max_v = 0;
+    double weighted_sum = 0; // value * ns
+    double last_update = 0;  // ns
+
+    inline void set(double v) {
+        double now = sc_time_stamp().to_seconds() * 1e9;
+        weighted_sum += value * (now - last_update);
+        last_update = now;
+        value = v;
+        if (v > max_v)
+            max_v = v;
+    }
+
+    inline void add(double delta) { set(value + delta); }
+
+    // 从0时刻到当前的 value * ns 累计
+    double integral() const {
+        double now = sc_time_stamp().to_seconds() * 1e9;
+        return weighted_sum + value * (now - last_update);
+    }
+
+    double average() const {
+        double now = sc_time_stamp().to_seconds() * 1e9;
+        return now > 0 ? integral() / now : value;
+    }
+};
+
+// 每个核常用的统计量，按cid直接索引，避免在热路径上按名字查找
+class Core_stats {
+public:
+    Stat_counter *prims;            // 执行完毕的原语数
+    Stat_counter *dram_read_bytes;  // 从dram读入sram
+    Stat_counter *dram_write_bytes; // 从sram写回dram
+    Stat_counter *spill_bytes;      // sram spill 到dram的字节数
+    Stat_counter *reload_bytes;     // 被spill的数据重新读入sram的字节数
+    Stat_counter *injected_flits;   // 注入片上网络的数据flit数
+    Stat_gauge *busy;               // 计算单元是否在执行原语
+    Stat_gauge *dram_wait;          // 计算原语等待dram数据
+    Stat_gauge *compute;            // 计算原语在dram之外的计算时间
+    Stat_gauge *noc_wait;           // 执行send/recv原语，等待片上网络
+    Stat_gauge *sram_used;          // sram manager 已使用块的比例
+};
+
+// 全局统计注册表，各个模块在构造时注册，运行中通过返回的指针更新
+class Stats_registry {
+public:
+    static Stats_registry &instance() {
+        static Stats_registry registry;
+        return registry;
+    }
+
+    Stat_counter *counter(const string &name);
+    Stat_histogram *histogram(const string &name, double bucket_width,
+                              int bucket_num);
+    Stat_gauge *gauge(const string &name);
+
+    Core_stats &core(int cid);
+
+    // 周期性采样：每次输出一行，第一次采样时固定列
+    void open_sample_file(const string &filename);
+    void sample();
+    void close_sample_file();
+
+    // 模拟结束时打印并写出汇总
+    void summarize(const string &filename);
+
+private:
+    Stats_registry() {}
+
+    map<string, unique_ptr<Stat_counter>> counters;
+    map<string, unique_ptr<Stat_histogram>> histograms;
+    map<string, unique_ptr<Stat_gauge>> gauges;
+    vector<unique_ptr<Core_stats>> cores;
+
+    ofstream sample_stream;
+    vector<pair<string, Stat_counter *>> sample_counters;
+    vector<pair<string, Stat_gauge *>> sample_gauges;
+};
+
+#define STATS Stats_registry::instance()
+
+// 按照固定的模拟时间间隔进行采样
+class Stats_sampler : public sc_module {
+public:
+    SC_HAS_PROCESS(Stats_sampler);
+    Stats_sampler(const sc_module_name &name, int interval_ns,
+                  const string &filename);
+    ~Stats_sampler();
+
+    void sample_periodically();
+    // 采样因没有其他事件而暂停之后，有了新的事件时继续
+    void resume();
+
+private:
+    int interval_ns;
+    sc_event ev_resume;
+};
@@ -7,9 +7,13 @@
 #include <random>
 #include <optional>
 #include <stdexcept>
+#include <iostream>
 
 class DramKVTable {
 private:
+    // 检查点读写需要访问内部状态
+    friend void SaveDramKVTable(std::ostream &os, const DramKVTable &table);
+    friend void LoadDramKVTable(std::istream &is, DramKVTable &table);
 
 
     // 当前可用的 value 集合
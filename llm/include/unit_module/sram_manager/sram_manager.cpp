@@ -1,4 +1,5 @@
 #include "sram_manager.h"
+#include "trace/Stats_registry.h"
 #include <numeric>   // For std::iota
 #include <iostream>  // For basic output/debugging
 #include <algorithm> // For std::sort, std::remove_if on list (indirectly)
@@ -44,24 +45,9 @@ SramManager::SramManager(int sram_start_address, int cid, int total_sram_size, i
 
 
 void SramManager::log_free_block_ratio() const {
-    // Calculate ratio of free blocks to total blocks
+    // 已使用块的比例，按时间加权记录在统计注册表中
     double ratio = (num_blocks_ > 0) ? static_cast<double>(num_blocks_ - free_block_indices_.size()) / num_blocks_ : 0.0;
-    
-    // Create log filename based on cid
-    std::string filename = "sram_util/sram_manager_cid_" + std::to_string(cid) + ".log";
-    
-    // Open file in append mode
-    std::ofstream log_file(filename, std::ios_base::app);
-    
-    if (log_file.is_open()) {
-        // Write timestamp and ratio to log file
-        log_file << "Time: " << sc_core::sc_time_stamp().to_string() 
-                 << " Free/Total Ratio: " << std::fixed << std::setprecision(4) << ratio 
-                 << " (" << num_blocks_ - free_block_indices_.size() << "/" << num_blocks_ << ")\n";
-        log_file.close();
-    } else {
-        std::cerr << "Error: Could not open log file " << filename << " for writing.\n";
-    }
+    STATS.core(cid).sram_used->set(ratio);
 }
 // Allocate memory
 AllocationID SramManager::allocate(int requested_size) {
@@ -0,0 +1,29 @@
+#pragma once
+#include <iostream>
+#include <string>
+
+#include "common/system.h"
+#include "unit_module/dram_kvtable/dram_kvtable.h"
+
+using namespace std;
+
+class config_helper_pds;
+
+// 检查点文件格式版本，修改序列化内容时需要同步递增
+#define CHECKPOINT_MAGIC 0x54504b43 // "CKPT"
+#define CHECKPOINT_VERSION 1
+
+// 在iteration边界将整个模拟器状态写入二进制文件，包括每个核的
+// PrimCoreContext（sram标签表、SramManager、batch信息）、DramKVTable、
+// config_helper_pds中的请求/核状态，以及全局的统计量
+bool SaveCheckpoint(const string &path, config_helper_pds *helper);
+
+// 从检查点恢复。需要在Monitor构造完毕、sc_start之前调用。
+// helper可以来自不同的config文件（不同的workload尾部），多出来的请求保持初始状态
+bool LoadCheckpoint(const string &path, config_helper_pds *helper);
+
+// 单独的模块状态
+void SavePrimCoreContext(ostream &os, PrimCoreContext *context);
+void LoadPrimCoreContext(istream &is, PrimCoreContext *context);
+void SaveDramKVTable(ostream &os, const DramKVTable &table);
+void LoadDramKVTable(istream &is, DramKVTable &table);
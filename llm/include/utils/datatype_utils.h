@@ -0,0 +1,33 @@
+#pragma once
+#include "systemc.h"
+
+#include "defs/enums.h"
+
+#include <string>
+
+using namespace std;
+
+// 数据类型描述：每个元素的位宽、分组量化的scale开销以及exu吞吐倍率
+class DatatypeDesc {
+public:
+    string name;
+    int bits;        // 每个元素的位宽
+    int group_size;  // 每多少个元素共享一个scale，0表示没有scale
+    int scale_bits;  // 每个scale的位宽
+    double exu_rate; // 相对INT8，每个PE每周期可以完成的乘加数
+
+    // 激活值在SRAM中按字节对齐存放，不足一字节的按一字节计算
+    int byteWidth() const { return (bits + 7) / 8; }
+};
+
+const DatatypeDesc &GetDatatypeDesc(DATATYPE dtype);
+DATATYPE ParseDatatype(const string &name);
+
+// 紧凑存放elements个元素（包括scale）所需的字节数
+u_int64_t DatatypeBytes(DATATYPE dtype, u_int64_t elements);
+
+// 两个操作数精度不同时，按照吞吐较低的一方计算（另一方需要先反量化）
+DATATYPE ComputeDatatype(DATATYPE a, DATATYPE b);
+
+// 将数据类型表写为json，供scripts/map_model.py等工具使用，避免在脚本中重复这张表
+bool DumpDatatypes(const string &path);
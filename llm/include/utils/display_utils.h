@@ -1,6 +1,7 @@
 #pragma once
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <set>
 #include <unordered_map>
 
@@ -8,7 +9,9 @@
 #include "macros/macros.h"
 
 #include "nlohmann/json.hpp"
+#if USE_CARIO == 1
 #include <cairo/cairo.h>
+#endif
 
 using json = nlohmann::json;
 
@@ -18,6 +21,13 @@ json parse_config(const string &filename);
 // 提取核心信息并建立核心数据流图
 unordered_map<int, Display::Core> extract_core_data(const json &config);
 
+// 保存/读取放置之后的数据流图，无界面运行时由npu_render事后绘制
+void save_dataflow(const unordered_map<int, Display::Core> &cores,
+                   const set<int> &source_ids, const string &filename);
+bool load_dataflow(const string &filename,
+                   unordered_map<int, Display::Core> &cores,
+                   set<int> &source_ids);
+
 #if USE_SFML == 1
 // 绘制带描边的箭头
 void draw_arrow(sf::RenderTexture &renderTexture, float start_x, float start_y,
@@ -41,4 +51,8 @@ void visualize_data_flow(cairo_surface_t *surface,
 void plot_dataflow(string filename, string font_ttf);
 void plot_dataflow(unordered_map<int, Display::Core> cores, set<int> source_ids,
                    string font_ttf);
+
+// 核阵列热力图：values为核id -> 数值，颜色按scale归一化，scale为0时使用最大值
+void plot_heatmap(const map<int, double> &values, const string &title,
+                  const string &output, double scale = 0);
 #endif
\ No newline at end of file
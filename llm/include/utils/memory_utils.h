@@ -2,6 +2,9 @@
 #include "common/system.h"
 #include "workercore/workercore.h"
 
+// 访存的等待，原语被采样快进（context.fast_forward）时不推进时间
+void mem_wait(TaskCoreContext &context, u_int64_t ns);
+
 void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
                               u_int64_t global_addr, u_int64_t &dram_time,
                               float *dram_start,
@@ -8,4 +8,6 @@ Msg DeserializeMsg(sc_bv<256> buffer);
 // 给定计算原语的output大小，计算需要发送的包数量
 void CalculatePacketNum(int output_size, int weight, int data_byte,
                         int &packet_num, int &end_length);
-bool IsBlockableMsgType(MSG_TYPE type);
\ No newline at end of file
+bool IsBlockableMsgType(MSG_TYPE type);
+// 一个DATA消息代表的flit数量，行为级NoC下为roofline包数
+int DataFlits(const Msg &msg);
\ No newline at end of file
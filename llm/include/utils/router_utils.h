@@ -1,9 +1,43 @@
 #pragma once
 #include "defs/enums.h"
 
+#include <string>
+#include <vector>
+
+using namespace std;
+
 int GetInputSource(Directions dir, int pos);
 bool IsMarginCore(int id);
 
+// 按mode设置host连接点：west（每行最西侧，默认）、west_east（每行两侧）、
+// edges（四条边上的所有router）或逗号分隔的router编号。每个核使用距离最近的端口，
+// 距离相同时选择已分配核最少的端口。mode不合法时返回false
+bool InitHostPorts(const string &mode);
+bool IsHostPort(int id);
+// host端口数量，未设置时按west初始化
+int HostPortNum();
+// 核id对应的host端口下标
+int HostPortOf(int id);
+// 发往host的包离开网络的router：source有效时为其端口，否则为离pos最近的端口
+int HostExitRouter(int source, int pos);
+
 Directions GetNextHop(int des, int pos);
 Directions GetNextHopReverse(int des, int pos);
-Directions GetOpposeDirection(Directions dir);
\ No newline at end of file
+Directions GetOpposeDirection(Directions dir);
+
+ROUTING_ALGO ParseRouting(const string &name);
+string GetRoutingName(ROUTING_ALGO algo);
+// 从pos发往des时路由算法允许的所有最小路径方向，第一个为确定性路由时的选择。
+// source为-1时表示源未知（如host或配置包），odd-even不再放开源所在列的转向；
+// yx只对O1TURN有效，表示该数据流使用YX路由
+vector<Directions> GetRouteCandidates(int source, int des, int pos, bool yx);
+// 虚通道类：O1TURN下偶数虚通道走XY、奇数虚通道走YX，其余算法只有一个类
+int GetVcClass(int vc);
+bool VcInClass(int vc, int vc_class);
+
+// 多播：相同目标集合复用同一个组编号，组编号用尽时返回0（退化为单播）
+int RegisterMcastGroup(const vector<int> &dests);
+// pos是否在source到des的先X后Y路径上
+bool OnXYPath(int source, int des, int pos);
+// 多播包在pos处需要复制到的方向：经过pos的目标各自的下一跳，构成一棵XY路由树
+vector<Directions> GetMcastNextHops(int group, int source, int pos);
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include "systemc.h"
+
+#include "trace/Stats_registry.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 一条NPU原语交给EXU/SFU的计算阶段，时间单位均为ns。
+// dma_start/dma_end 为原语在taskCoreDefault中读入数据、写回输出的起止时间，
+// 计算可以与本原语的DMA重叠（与原有overlap_time的假设相同），但不早于依赖作业完成
+class Engine_job {
+public:
+    int id = 0;
+    string name;
+    u_int64_t dma_start = 0;
+    u_int64_t dma_end = 0;
+    u_int64_t exu_ns = 0;
+    u_int64_t sfu_ns = 0;
+    u_int64_t exu_end = 0;
+    u_int64_t ready = 0;     // 已完成的依赖中最晚的完成时间
+    vector<int> deps;        // 尚未完成的依赖作业
+    vector<string> inputs;   // 输入的sram标签
+    vector<string> outputs;  // 输出的sram标签
+    function<void()> done;   // 作业完成时调用，用于原语记录与统计
+};
+
+// 核内的DMA、EXU、SFU三个引擎：task_logic作为DMA引擎依次执行原语的读入，
+// 读入完成后原语的计算交给EXU（有矩阵运算时）再交给SFU，核随即可以开始下一条原语的读入。
+// 依赖按sram标签跟踪：原语的DMA要等到写入其输入标签的作业完成（RAW），
+// 并且没有在飞的作业写入（WAW）或读取（WAR）其输出标签之后才开始。
+// 每个引擎取队列中第一个依赖已满足的作业，因此SFU原语可以与前面的EXU原语并行
+class Core_engines : public sc_module {
+public:
+    SC_HAS_PROCESS(Core_engines);
+    Core_engines(const sc_module_name &name, int cid);
+
+    // 在飞的计算作业达到engine_window时等待
+    void wait_slot();
+    // 等待输入输出标签上的在飞作业完成，在dma_begin之前调用
+    void wait_labels(const vector<string> &inputs,
+                     const vector<string> &outputs);
+    void dma_begin();
+    void dma_end();
+    // 按输入标签确定依赖，交给EXU或SFU
+    void issue(Engine_job *job, const vector<string> &inputs);
+    // 等待所有作业完成：send/recv以及非NPU的计算原语之前调用
+    void drain();
+
+    void exu_logic();
+    void sfu_logic();
+
+private:
+    int cid;
+    int next_id = 0;
+    int inflight = 0;
+    bool dma_active = false;
+    bool exu_active = false;
+    bool sfu_active = false;
+    u_int64_t exu_free = 0;
+    u_int64_t sfu_free = 0;
+    u_int64_t dma_start = 0;
+
+    deque<Engine_job *> exu_queue;
+    deque<Engine_job *> sfu_queue;
+    // 标签 -> (写入它的作业，-1表示已完成；完成时间)
+    map<string, pair<int, u_int64_t>> writer;
+    map<string, int> readers; // 标签 -> 读取它的在飞作业数
+    sc_event ev_update; // 有作业入队或完成
+
+    Core_stats *core;
+    Stat_gauge *dma_util;
+    Stat_gauge *exu_util;
+    Stat_gauge *sfu_util;
+    Stat_counter *dma_busy_ns;
+    Stat_counter *exu_busy_ns;
+    Stat_counter *sfu_busy_ns;
+    Stat_counter *dep_stall_ns; // 计算因等待输入标签而推迟的时间
+    Stat_counter *dma_stall_ns; // DMA因等待标签上的在飞作业而推迟的时间
+
+    Engine_job *pick(deque<Engine_job *> &queue);
+    bool label_busy(const vector<string> &inputs,
+                    const vector<string> &outputs);
+    void finish(Engine_job *job);
+    void update_state();
+};
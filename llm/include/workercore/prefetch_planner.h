@@ -0,0 +1,56 @@
+#pragma once
+#include "systemc.h"
+
+#include "trace/Stats_registry.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class PrimBase;
+class NpuBase;
+class TaskCoreContext;
+class SramPosLocator;
+
+// 一次预取：后续某条NPU原语的一块静态数据
+class Prefetch_item {
+public:
+    NpuBase *prim;
+    string label;
+    u_int64_t addr;
+    int bytes;   // 字节数，与checkStaticData的data_size_label相同
+    int reserve; // 读入该数据块需要的sram余量：数据块本身以及到该原语为止的输出
+};
+
+// 核内的权重预取规划：当前原语计算、DMA空闲的时间窗口内，向后查看prim_queue中
+// prefetch_depth条NPU原语，将还不在sram中的静态数据（ETERNAL_PREFIX标签）提前读入。
+// 只有sram余量在扣除这些原语的输出之后仍然足够时才预取，因此预取不会引起spill。
+// 统计：hit为被原语使用时仍在sram中的字节数，late为读入超出计算窗口的字节数，
+// wasted为使用之前已被spill或删除的字节数
+class Prefetch_planner {
+public:
+    Prefetch_planner(int cid);
+
+    // 在window_ns的计算时间内执行预取，返回预取占用的时间
+    u_int64_t run(TaskCoreContext &context, deque<PrimBase *> &queue,
+                  u_int64_t window_ns);
+    // checkStaticData读取静态数据时调用，flag为findPair的返回值
+    void consume(const string &label, int flag);
+
+private:
+    int cid;
+    map<string, int> pending; // 已预取、尚未被使用的标签 -> 字节数
+
+    Stat_counter *issued_bytes;
+    Stat_counter *hit_bytes;
+    Stat_counter *late_bytes;
+    Stat_counter *late_ns;
+    Stat_counter *wasted_bytes;
+
+    void plan(deque<PrimBase *> &queue, vector<Prefetch_item> &items);
+    // sram中尚未被占用的字节数
+    int headroom(SramPosLocator *locator);
+};
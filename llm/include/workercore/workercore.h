@@ -15,6 +15,8 @@
 #include "memory/sram/dynamic_bandwidth_ram_row.h"
 #include "memory/sram_writer.h"
 #include "trace/Event_engine.h"
+#include "workercore/core_engines.h"
+#include "workercore/prefetch_planner.h"
 #include "unit_module/sram_manager/sram_manager.h"
 
 class WorkerCoreExecutor;
@@ -148,6 +150,10 @@ public:
     sc_event *end_global_mem_event;    // global memory访存结束标志
     sc_event *start_sram_event;
     sc_event *end_sram_event;
+    SramBankModel *sram_bank;      // 行为级sram的bank冲突模型
+    SramBankModel *temp_sram_bank;
+    Core_engines *engines; // --core-engines 时原语计算在此执行
+    Prefetch_planner *prefetcher; // 计算期间预取后续原语的权重
     SRAMWriteModule *sram_writer;
 
     SC_HAS_PROCESS(WorkerCoreExecutor);
@@ -165,6 +171,8 @@ public:
     void switch_prim_block();
     void poll_buffer_i(); // 每个时钟周期，将发送进core的数据包统一转移到input
                           // buffer中，实现发送和处理逻辑的解耦
+    // host预加载：不经过router直接放入接收缓冲
+    void preload_msg(const Msg &m);
 
     void send_logic();
     void send_para_logic();
@@ -178,6 +186,8 @@ public:
     bool atomic_helper_lock(sc_time try_time, int status, bool force = false);
 
     PrimBase *parse_prim(vector<sc_bv<128>> buffer);
+    // 按照prim_queue得到各sram标签距下一次使用的计算原语条数，供spill策略使用
+    int reuse_distance(unordered_map<string, int> &next_use);
 
     void end_of_elaboration();
 };
\ No newline at end of file
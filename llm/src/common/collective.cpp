@@ -0,0 +1,630 @@
+#include "common/collective.h"
+#include "defs/enums.h"
+#include "defs/global.h"
+#include "macros/macros.h"
+#include "utils/config_utils.h"
+#include "utils/datatype_utils.h"
+#include "utils/print_utils.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+
+// 核间的send/recv是会合式的：发送方要等到接收方执行到tag相同的recv才会收到ack。
+// 因此环上的偶数位先发后收、奇数位先收后发，树上自底向上再自顶向下，
+// 递归减半/倍增中每一对的较小者先发；收与发拆成不同的job，发送的总是job中最后一个原语的输出。
+
+// 累积结果：依次拼接每一块数据，最后一块写入目标label
+class CollAcc {
+public:
+    string tmp;
+    string cur; // 当前的累积结果（带引用前缀）
+    int n = 0;
+    int gen = 0;
+
+    string next() { return tmp + "_acc" + to_string(gen++ % 2); }
+};
+
+// 环上一个方向的描述
+class CollRingDir {
+public:
+    vector<int> ring;
+    int tag;
+    string tmp;
+    int seg;    // 每一步每个核处理的元素数
+    int chunks; // 每一步拆成多少块做流水
+
+    // 生成第t块的初始发送数据（写入label）
+    function<void(int t, const string &label, vector<json> &prims)> init;
+    // 收到第t块之后的处理，hold为空表示最后一步，不需要再转发
+    function<void(int t, const string &hold, vector<json> &prims)> on_recv;
+};
+
+class CollBuilder {
+public:
+    CollBuilder(const json &spec, int cid);
+    vector<json> build();
+
+private:
+    int cid;
+    COLL_TYPE type;
+    COLL_ALGO algo;
+    vector<int> group;
+    int rank;
+    int size;
+    string src, dst;
+    bool keep;
+    int chunks;
+    int tag;
+    int byte_width;
+    json datatype;
+    json casts;
+
+    vector<json> jobs;
+    vector<string> release_labels;
+
+    int piece(int seg, int c, int j) { return seg / c + (j < seg % c ? 1 : 0); }
+    int autoChunks(int seg);
+    int out_size();
+
+    json prim(COLL_STEP_OP op, int n, int acc, int k, const string &indata,
+              const string &outdata);
+    void job(int recv_cnt, int recv_tag, vector<json> prims,
+             json cast = json::array());
+    void accumulate(CollAcc &acc, const string &piece_ref, int n, bool final,
+                    const string &target, vector<json> &prims);
+    void release(const string &label);
+
+    void ringSchedule(vector<CollRingDir> dirs);
+    CollRingDir ringReduceScatter(const vector<int> &ring, const string &in,
+                                  int n, const string &out, int t,
+                                  const string &tmp);
+    CollRingDir ringAllGather(const vector<int> &ring, const string &in, int n,
+                              const string &out, int t, const string &tmp);
+    void ring(const vector<int> &ring, COLL_TYPE op, const string &in, int n,
+              const string &out, int t, const string &tmp);
+    void biRing(COLL_TYPE op);
+    void mesh2d();
+    void halvingDoubling(COLL_TYPE op, const string &in, int n,
+                         const string &out, int t);
+    void tree();
+};
+
+static COLL_TYPE ParseCollType(const string &name) {
+    if (name == "all_reduce")
+        return COLL_ALL_REDUCE;
+    if (name == "reduce_scatter")
+        return COLL_REDUCE_SCATTER;
+    if (name == "all_gather")
+        return COLL_ALL_GATHER;
+
+    ARGUS_EXIT("Unknown collective ", name,
+               ", use all_reduce/reduce_scatter/all_gather.\n");
+    return COLL_ALL_REDUCE;
+}
+
+static COLL_ALGO ParseCollAlgo(const string &name) {
+    if (name == "ring")
+        return COLL_RING;
+    if (name == "bi_ring")
+        return COLL_BI_RING;
+    if (name == "mesh2d")
+        return COLL_MESH2D;
+    if (name == "halving_doubling")
+        return COLL_HALVING_DOUBLING;
+    if (name == "tree")
+        return COLL_TREE;
+
+    ARGUS_EXIT("Unknown collective algorithm ", name,
+               ", use ring/bi_ring/mesh2d/halving_doubling/tree.\n");
+    return COLL_RING;
+}
+
+CollBuilder::CollBuilder(const json &spec, int cid) : cid(cid) {
+    type = ParseCollType(spec.at("type"));
+    algo = spec.contains("algo") ? ParseCollAlgo(spec["algo"]) : COLL_RING;
+
+    for (auto &g : spec.at("group"))
+        group.push_back(g.is_string() ? GetDefinedParam(g.get<string>())
+                                      : g.get<int>());
+    auto it = find(group.begin(), group.end(), cid);
+    if (it == group.end())
+        ARGUS_EXIT("Core ", cid, " is not in the collective group.\n");
+    rank = it - group.begin();
+
+    SetParamFromJson<int>(spec, "size", &size);
+    SetParamFromJson<int>(spec, "chunks", &chunks, 0);
+    SetParamFromJson<int>(spec, "tag", &tag, COLL_TAG_BASE);
+
+    string indata = spec.at("indata");
+    keep = indata[0] == '_';
+    src = keep ? indata.substr(1) : indata;
+    dst = spec.at("outdata");
+    casts = spec.contains("cast") ? spec["cast"] : json::array();
+
+    byte_width = 1;
+    if (spec.contains("datatype")) {
+        datatype = spec["datatype"];
+        byte_width = GetDatatypeDesc(ParseDatatype(datatype)).byteWidth();
+    }
+}
+
+int CollBuilder::autoChunks(int seg) {
+    if (chunks > 0)
+        return min(chunks, max(seg, 1));
+
+    int c = CeilingDivision(seg * byte_width, COLL_CHUNK_BYTES);
+    return max(1, min(c, COLL_MAX_CHUNKS));
+}
+
+int CollBuilder::out_size() {
+    int p = group.size();
+    switch (type) {
+    case COLL_REDUCE_SCATTER:
+        return size / p;
+    case COLL_ALL_GATHER:
+        return size * p;
+    default:
+        return size;
+    }
+}
+
+json CollBuilder::prim(COLL_STEP_OP op, int n, int acc, int k,
+                       const string &indata, const string &outdata) {
+    json p = {{"type", "Collective_f"},
+              {"N", n},
+              {"ACC", acc},
+              {"K", k},
+              {"op", (int)op}};
+    if (!datatype.is_null())
+        p["datatype"] = datatype;
+    p["sram_address"] = {{"indata", indata}, {"outdata", outdata}};
+    p["dram_address"] = json::object();
+    return p;
+}
+
+void CollBuilder::job(int recv_cnt, int recv_tag, vector<json> prims,
+                      json cast) {
+    jobs.push_back({{"recv_cnt", recv_cnt},
+                    {"recv_tag", recv_cnt ? recv_tag : cid},
+                    {"cast", cast},
+                    {"prims", prims}});
+}
+
+void CollBuilder::accumulate(CollAcc &acc, const string &piece_ref, int n,
+                             bool final, const string &target,
+                             vector<json> &prims) {
+    string out = final ? target : acc.next();
+    if (acc.n == 0)
+        prims.push_back(prim(COLL_COPY, n, 0, 1, piece_ref, out));
+    else
+        prims.push_back(
+            prim(COLL_CONCAT, n, acc.n, 1, acc.cur + " " + piece_ref, out));
+    acc.cur = out;
+    acc.n += n;
+}
+
+void CollBuilder::release(const string &label) {
+    // 多次读取的数据均以 "_" 前缀引用，最后一次读取时去掉前缀以释放
+    for (int i = jobs.size() - 1; i >= 0; i--) {
+        auto &prims = jobs[i]["prims"];
+        for (int j = prims.size() - 1; j >= 0; j--) {
+            string indata = prims[j]["sram_address"]["indata"];
+            istringstream iss(indata);
+            vector<string> words;
+            string w;
+            bool found = false;
+            while (iss >> w) {
+                if (!found && w == "_" + label) {
+                    w = label;
+                    found = true;
+                }
+                words.push_back(w);
+            }
+            if (!found)
+                continue;
+
+            string joined;
+            for (auto &word : words)
+                joined += (joined.empty() ? "" : " ") + word;
+            prims[j]["sram_address"]["indata"] = joined;
+            return;
+        }
+    }
+}
+
+void CollBuilder::ringSchedule(vector<CollRingDir> dirs) {
+    // 以第一个方向上的位置决定奇偶，偶数位：发第t块，再收第t+c块；奇数位相反
+    int p = dirs[0].ring.size();
+    int c = dirs[0].chunks;
+    int pos = find(dirs[0].ring.begin(), dirs[0].ring.end(), cid) -
+              dirs[0].ring.begin();
+    bool even = pos % 2 == 0;
+
+    auto hold = [&](CollRingDir &d, int t) {
+        return d.tmp + "_h" + to_string(t % (2 * c));
+    };
+
+    auto do_send = [&](int t) {
+        for (auto &d : dirs) {
+            int dpos = find(d.ring.begin(), d.ring.end(), cid) - d.ring.begin();
+            int next = d.ring[(dpos + 1) % p];
+            vector<json> prims;
+            string label = d.tmp + "_send";
+            if (t < c)
+                d.init(t, label, prims);
+            else
+                prims.push_back(prim(COLL_COPY, piece(d.seg, c, t % c), 0, 1,
+                                     hold(d, t), label));
+            job(0, cid, prims, json::array({{{"dest", next}, {"tag", d.tag}}}));
+        }
+    };
+
+    auto do_recv = [&](int t) {
+        for (auto &d : dirs) {
+            vector<json> prims;
+            bool last_step = t / c == p - 1;
+            d.on_recv(t, last_step ? "" : hold(d, t), prims);
+            job(1, d.tag, prims);
+        }
+    };
+
+    for (int t = 0; t < (p - 1) * c; t++) {
+        if (even) {
+            do_send(t);
+            do_recv(t + c);
+        } else {
+            do_recv(t + c);
+            do_send(t);
+        }
+    }
+}
+
+CollRingDir CollBuilder::ringReduceScatter(const vector<int> &ring,
+                                           const string &in, int n,
+                                           const string &out, int t,
+                                           const string &tmp) {
+    CollRingDir d;
+    d.ring = ring;
+    d.tag = t;
+    d.tmp = tmp;
+    d.seg = max(1, n / (int)ring.size());
+    d.chunks = autoChunks(d.seg);
+
+    auto acc = make_shared<CollAcc>();
+    acc->tmp = tmp;
+    int c = d.chunks, seg = d.seg;
+
+    d.init = [=](int t, const string &label, vector<json> &prims) {
+        prims.push_back(
+            prim(COLL_COPY, piece(seg, c, t % c), 0, 1, "_" + in, label));
+    };
+    d.on_recv = [=](int t, const string &hold, vector<json> &prims) {
+        int j = t % c, n = piece(seg, c, j);
+        string indata = string(INPUT_LABEL) + " _" + in;
+        if (!hold.empty()) {
+            prims.push_back(prim(COLL_REDUCE, n, 0, 1, indata, hold));
+            return;
+        }
+
+        // 最后一步的归约结果为本核负责的一段
+        if (acc->n == 0) {
+            string target = c == 1 ? out : acc->next();
+            prims.push_back(prim(COLL_REDUCE, n, 0, 1, indata, target));
+            acc->cur = target;
+            acc->n = n;
+            return;
+        }
+        prims.push_back(prim(COLL_REDUCE, n, 0, 1, indata, tmp + "_part"));
+        accumulate(*acc, tmp + "_part", n, j == c - 1, out, prims);
+    };
+    return d;
+}
+
+CollRingDir CollBuilder::ringAllGather(const vector<int> &ring,
+                                       const string &in, int n,
+                                       const string &out, int t,
+                                       const string &tmp) {
+    CollRingDir d;
+    d.ring = ring;
+    d.tag = t;
+    d.tmp = tmp;
+    d.seg = max(1, n);
+    d.chunks = autoChunks(d.seg);
+
+    // 本核的数据作为累积结果的开头
+    auto acc = make_shared<CollAcc>();
+    acc->tmp = tmp;
+    acc->cur = "_" + in;
+    acc->n = d.seg;
+    int p = ring.size(), c = d.chunks, seg = d.seg;
+
+    d.init = [=](int t, const string &label, vector<json> &prims) {
+        prims.push_back(
+            prim(COLL_COPY, piece(seg, c, t % c), 0, 1, "_" + in, label));
+    };
+    d.on_recv = [=](int t, const string &hold, vector<json> &prims) {
+        int j = t % c, n = piece(seg, c, j);
+        bool final = t / c == p - 1 && j == c - 1;
+        string inp = hold.empty() ? INPUT_LABEL : string("_") + INPUT_LABEL;
+        accumulate(*acc, inp, n, final, out, prims);
+        if (!hold.empty())
+            prims.push_back(prim(COLL_COPY, n, 0, 1, INPUT_LABEL, hold));
+    };
+    return d;
+}
+
+void CollBuilder::ring(const vector<int> &ring, COLL_TYPE op, const string &in,
+                       int n, const string &out, int t, const string &tmp) {
+    if (ring.size() == 1) {
+        job(0, cid, {prim(COLL_COPY, n, 0, 1, "_" + in, out)});
+        return;
+    }
+
+    switch (op) {
+    case COLL_REDUCE_SCATTER:
+        ringSchedule({ringReduceScatter(ring, in, n, out, t, tmp)});
+        break;
+    case COLL_ALL_GATHER:
+        ringSchedule({ringAllGather(ring, in, n, out, t, tmp)});
+        break;
+    case COLL_ALL_REDUCE: {
+        int seg = max(1, n / (int)ring.size());
+        ringSchedule({ringReduceScatter(ring, in, n, tmp + "_rs", t, tmp)});
+        ringSchedule({ringAllGather(ring, tmp + "_rs", seg, out, t, tmp)});
+        release_labels.push_back(tmp + "_rs");
+        break;
+    }
+    }
+}
+
+void CollBuilder::biRing(COLL_TYPE op) {
+    // 数据对半，一半顺时针、一半逆时针。奇数个核时相邻的两个偶数位会互相等待，退化为单向环
+    if (group.size() % 2) {
+        cout << "[WARN] Collective: bi_ring needs an even group, using ring.\n";
+        ring(group, op, src, size, dst, tag, dst);
+        return;
+    }
+
+    vector<int> ccw(group.rbegin(), group.rend());
+    int h0 = size / 2, h1 = size - h0;
+    string cw_tmp = dst + "_cw", ccw_tmp = dst + "_ccw";
+    string cw_out = cw_tmp + "_res", ccw_out = ccw_tmp + "_res";
+    int p = group.size();
+
+    switch (op) {
+    case COLL_REDUCE_SCATTER:
+        ringSchedule(
+            {ringReduceScatter(group, src, h0, cw_out, tag, cw_tmp),
+             ringReduceScatter(ccw, src, h1, ccw_out, tag + 1, ccw_tmp)});
+        break;
+    case COLL_ALL_GATHER:
+        ringSchedule({ringAllGather(group, src, h0, cw_out, tag, cw_tmp),
+                      ringAllGather(ccw, src, h1, ccw_out, tag + 1, ccw_tmp)});
+        break;
+    case COLL_ALL_REDUCE:
+        ringSchedule(
+            {ringReduceScatter(group, src, h0, cw_tmp + "_rs", tag, cw_tmp),
+             ringReduceScatter(ccw, src, h1, ccw_tmp + "_rs", tag + 1,
+                               ccw_tmp)});
+        ringSchedule({ringAllGather(group, cw_tmp + "_rs", max(1, h0 / p),
+                                    cw_out, tag, cw_tmp),
+                      ringAllGather(ccw, ccw_tmp + "_rs", max(1, h1 / p),
+                                    ccw_out, tag + 1, ccw_tmp)});
+        release_labels.push_back(cw_tmp + "_rs");
+        release_labels.push_back(ccw_tmp + "_rs");
+        break;
+    }
+
+    // 两个方向的结果拼接为最终结果，奇数位的最后一个job是发送，因此单独成一个job
+    int n0 = type == COLL_ALL_REDUCE     ? h0
+             : type == COLL_ALL_GATHER   ? h0 * p
+                                         : max(1, h0 / p);
+    int n1 = out_size() - n0;
+    job(0, cid, {prim(COLL_CONCAT, n1, n0, 1, cw_out + " " + ccw_out, dst)});
+}
+
+void CollBuilder::mesh2d() {
+    // 将参与的核看作网格中的一个矩形：先行内reduce-scatter，再列内all-reduce，再行内all-gather
+    map<int, vector<int>> rows, cols;
+    for (int g : group) {
+        rows[g / GRID_X].push_back(g);
+        cols[g % GRID_X].push_back(g);
+    }
+    for (auto &r : rows)
+        sort(r.second.begin(), r.second.end());
+    for (auto &c : cols)
+        sort(c.second.begin(), c.second.end());
+
+    if (rows.size() * cols.size() != group.size())
+        ARGUS_EXIT("Collective mesh2d: group is not a rectangle on the grid.\n");
+
+    auto &row = rows[cid / GRID_X];
+    auto &col = cols[cid % GRID_X];
+
+    if (type != COLL_ALL_REDUCE) {
+        // 其余操作按照矩形上的蛇形顺序成环，除首尾之外都是相邻的核
+        vector<int> snake;
+        bool flip = false;
+        for (auto &r : rows) {
+            if (flip)
+                snake.insert(snake.end(), r.second.rbegin(), r.second.rend());
+            else
+                snake.insert(snake.end(), r.second.begin(), r.second.end());
+            flip = !flip;
+        }
+        ring(snake, type, src, size, dst, tag, dst);
+        return;
+    }
+
+    int n1 = max(1, size / (int)row.size());
+    ring(row, COLL_REDUCE_SCATTER, src, size, dst + "_m1", tag, dst + "_row");
+    ring(col, COLL_ALL_REDUCE, dst + "_m1", n1, dst + "_m2", tag + 1,
+         dst + "_col");
+    ring(row, COLL_ALL_GATHER, dst + "_m2", n1, dst, tag + 2, dst + "_ag");
+    release_labels.push_back(dst + "_m1");
+    release_labels.push_back(dst + "_m2");
+}
+
+void CollBuilder::halvingDoubling(COLL_TYPE op, const string &in, int n,
+                                  const string &out, int t) {
+    int p = group.size();
+    int L = 0;
+    while ((1 << L) < p)
+        L++;
+    if ((1 << L) != p)
+        ARGUS_EXIT("Collective halving_doubling needs a power-of-two group, "
+                   "got ",
+                   p, ".\n");
+
+    if (op == COLL_ALL_REDUCE) {
+        halvingDoubling(COLL_REDUCE_SCATTER, in, n, out + "_rs", t);
+        halvingDoubling(COLL_ALL_GATHER, out + "_rs", max(1, n / p), out,
+                        t + L);
+        release_labels.push_back(out + "_rs");
+        return;
+    }
+
+    string cur = in;
+    for (int k = 0; k < L; k++) {
+        int d = op == COLL_REDUCE_SCATTER ? p >> (k + 1) : 1 << k;
+        int partner = group[rank ^ d];
+        bool lower = !(rank & d);
+        string next = k == L - 1 ? out : out + "_hd" + to_string(k);
+
+        // 每一对中较小的一方先发
+        int m = op == COLL_REDUCE_SCATTER ? max(1, n / 2) : n;
+        json send_prim = prim(COLL_COPY, m, 0, 1, "_" + cur, out + "_send");
+        json recv_prim =
+            op == COLL_REDUCE_SCATTER
+                ? prim(COLL_REDUCE, m, 0, 1,
+                       string(INPUT_LABEL) + " _" + cur, next)
+                : prim(COLL_CONCAT, m, n, 1, "_" + cur + " " + INPUT_LABEL,
+                       next);
+        json cast = json::array({{{"dest", partner}, {"tag", t + k}}});
+
+        if (lower) {
+            job(0, cid, {send_prim}, cast);
+            job(1, t + k, {recv_prim});
+        } else {
+            job(1, t + k, {recv_prim});
+            job(0, cid, {send_prim}, cast);
+        }
+
+        if (cur != in)
+            release_labels.push_back(cur);
+        cur = next;
+        n = op == COLL_REDUCE_SCATTER ? m : n * 2;
+    }
+}
+
+void CollBuilder::tree() {
+    // 二叉树：先把每一块归约到根，全部归约完之后根再逐块广播
+    int p = group.size();
+    int parent = rank ? group[(rank - 1) / 2] : -1;
+    vector<int> children;
+    for (int r : {2 * rank + 1, 2 * rank + 2})
+        if (r < p)
+            children.push_back(group[r]);
+
+    int c = autoChunks(size);
+    CollAcc acc;
+    acc.tmp = dst;
+    string send = dst + "_send";
+
+    json up_cast = json::array({{{"dest", parent}, {"tag", tag}}});
+    json down_cast = json::array();
+    for (int ch : children)
+        down_cast.push_back({{"dest", ch}, {"tag", tag + 1}});
+
+    for (int j = 0; j < c; j++) {
+        int n = piece(size, c, j);
+        if (children.empty()) {
+            job(0, cid, {prim(COLL_COPY, n, 0, 1, "_" + src, send)}, up_cast);
+            continue;
+        }
+
+        string red = parent < 0 ? dst + "_r" + to_string(j) : send;
+        json reduce = prim(COLL_REDUCE, n, 0, children.size(),
+                           string(INPUT_LABEL) + " _" + src, red);
+        job(children.size(), tag, {reduce},
+            parent < 0 ? json::array() : up_cast);
+    }
+
+    for (int j = 0; j < c; j++) {
+        int n = piece(size, c, j);
+        bool final = j == c - 1;
+        vector<json> prims;
+        if (parent < 0) {
+            string red = dst + "_r" + to_string(j);
+            accumulate(acc, "_" + red, n, final, dst, prims);
+            prims.push_back(prim(COLL_COPY, n, 0, 1, red, send));
+            job(0, cid, prims, down_cast);
+        } else if (children.empty()) {
+            accumulate(acc, INPUT_LABEL, n, final, dst, prims);
+            job(1, tag + 1, prims);
+        } else {
+            accumulate(acc, string("_") + INPUT_LABEL, n, final, dst, prims);
+            prims.push_back(prim(COLL_COPY, n, 0, 1, INPUT_LABEL, send));
+            job(1, tag + 1, prims, down_cast);
+        }
+    }
+}
+
+vector<json> CollBuilder::build() {
+    if (tag < 0 || tag + 16 > 256)
+        ARGUS_EXIT("Collective tag base ", tag, " leaves no room below 256.\n");
+
+    if (group.size() == 1) {
+        job(0, cid, {prim(COLL_COPY, size, 0, 1, "_" + src, dst)});
+    } else {
+        switch (algo) {
+        case COLL_RING:
+            ring(group, type, src, size, dst, tag, dst);
+            break;
+        case COLL_BI_RING:
+            biRing(type);
+            break;
+        case COLL_MESH2D:
+            mesh2d();
+            break;
+        case COLL_HALVING_DOUBLING:
+            halvingDoubling(type, src, size, dst, tag);
+            break;
+        case COLL_TREE:
+            if (type != COLL_ALL_REDUCE)
+                ARGUS_EXIT("Collective tree only supports all_reduce.\n");
+            tree();
+            break;
+        }
+    }
+
+    for (auto &label : release_labels)
+        release(label);
+    if (!keep)
+        release(src);
+
+    // 最后一个job若已有发送或者输出不是outdata，则追加一个job发送结果
+    if (!casts.empty()) {
+        auto &last = jobs.back();
+        if (last["cast"].empty() &&
+            last["prims"].back()["sram_address"]["outdata"] == dst)
+            last["cast"] = casts;
+        else
+            job(0, cid, {prim(COLL_COPY, out_size(), 0, 1, dst, dst + "_cast")},
+                casts);
+    }
+
+    LOG_VERBOSE(1, cid,
+                "Collective expanded into " << jobs.size() << " jobs");
+    return jobs;
+}
+
+vector<json> ExpandCollective(const json &spec, int cid) {
+    CollBuilder builder(spec, cid);
+    return builder.build();
+}
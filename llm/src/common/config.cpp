@@ -1,3 +1,4 @@
+#include "common/collective.h"
 #include "common/config.h"
 #include "common/msg.h"
 #include "utils/config_utils.h"
@@ -95,6 +96,14 @@ void from_json(const json &j, CoreConfig &c) {
 
     if (j.contains("worklist")) {
         for (int i = 0; i < j["worklist"].size(); i++) {
+            // collective条目在此展开为若干普通job
+            if (j["worklist"][i].contains("collective")) {
+                for (auto &job :
+                     ExpandCollective(j["worklist"][i]["collective"], c.id))
+                    c.worklist.push_back(job.get<CoreJob>());
+                continue;
+            }
+
             CoreJob cjob = j["worklist"][i];
 
             if (!j["worklist"][i].contains("recv_tag")) {
@@ -140,6 +149,24 @@ void from_json(const json &j, LayerConfig &c) {
 void from_json(const json &j, StreamConfig &c) {
     SetParamFromJson<int>(j, "id", &(c.id));
     SetParamFromJson<int>(j, "loop", &(c.loop), 1);
+    SetParamFromJson<int>(j, "sms", &(c.sms), 0);
+
+    if (j.contains("depends")) {
+        for (auto id : j["depends"])
+            c.depends.push_back(id);
+    }
+
+    // 事件格式：{"event": "attn_done", "prim": 2}
+    if (j.contains("record")) {
+        for (auto e : j["record"])
+            c.record_events.push_back(make_pair(
+                e["event"].get<string>(), e["prim"].get<int>()));
+    }
+    if (j.contains("wait")) {
+        for (auto e : j["wait"])
+            c.wait_events.push_back(make_pair(
+                e["event"].get<string>(), e["prim"].get<int>()));
+    }
 
     if (j.contains("prims")) {
         auto prims = j["prims"];
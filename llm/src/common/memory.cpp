@@ -1,4 +1,6 @@
 #include "common/memory.h"
+#include "memory/sram/spill_policy.h"
+#include "trace/Stats_registry.h"
 #include "utils/memory_utils.h"
 #include "utils/system_utils.h"
 
@@ -130,76 +132,69 @@ void SramPosLocator::addPair(std::string &key, AddrPosKey value,
     //      << " Sram fail to allocate enough space! Need to spill & "
     //         "rearrange.\n";
 
-    // 放不下，需要spill，查找里面record最小的成员（除了key）
-    sc_time start_nbdram = sc_time_stamp();
-    while (used > max_sram_size) {
-        std::cout << "\033[1;31m" << ": Core " << cid
-                  << " Sram check: used: " << used
-                  << ", max sram size: " << max_sram_size << "\033[0m" << endl;
-        int min_record = 1e9 + 3;
-        string min_label = "";
-        int min_pos = 0;
-        AllocationID sram_id = 0;
-        for (auto pair : data_map) {
+    // 放不下，需要spill，按照g_spill_policy选择spill对象（除了key）
+    std::unordered_map<std::string, int> next_use;
+    int horizon = 0;
+    if (g_spill_policy != SPILL_LRU && reuse_distance)
+        horizon = reuse_distance(next_use);
+
+    auto collect = [&](bool skip_kvcache,
+                       vector<Spill_candidate> &candidates) {
+        string k_prefix =
+            ETERNAL_PREFIX + string(KVCACHE_PREFIX) + string("k");
+        string v_prefix =
+            ETERNAL_PREFIX + string(KVCACHE_PREFIX) + string("v");
+
+        for (auto &pair : data_map) {
             if (pair.first == key)
                 continue; // 不能spill自己
             if (!pair.second.valid &&
                 pair.second.spill_size == pair.second.size)
                 continue; // 已经全部spill到dram中去了
-
-#if KVCACHE_PRIOR_SPILL == 1
-            string k_prefix =
-                ETERNAL_PREFIX + string(KVCACHE_PREFIX) + string("k");
-            string v_prefix =
-                ETERNAL_PREFIX + string(KVCACHE_PREFIX) + string("v");
-
-            if ((pair.first.length() >= k_prefix.length() &&
-                 pair.first.substr(0, k_prefix.length()) == k_prefix) ||
-                (pair.first.length() >= v_prefix.length() &&
-                 pair.first.substr(0, v_prefix.length()) == v_prefix))
+            if (skip_kvcache &&
+                (pair.first.compare(0, k_prefix.length(), k_prefix) == 0 ||
+                 pair.first.compare(0, v_prefix.length(), v_prefix) == 0))
                 continue; // 简单策略：不spill kvcache
-#endif
 
-            if (pair.second.record < min_record) {
-                min_record = pair.second.record;
-                min_label = pair.first;
-                min_pos = pair.second.pos;
-                sram_id = pair.second.alloc_id;
-            }
+            auto it = next_use.find(pair.first);
+            candidates.push_back(
+                {pair.first,
+                 pair.second.valid
+                     ? pair.second.size
+                     : pair.second.size - pair.second.spill_size,
+                 pair.second.record,
+                 it != next_use.end() ? it->second : horizon});
         }
+    };
 
-        // cout << "[SRAM SPILL] Core " << cid << ": Sram chose to spill label "
-        //      << min_label << ", size " << data_map[min_label].size
-        //      << ", spill_size: " << data_map[min_label].spill_size << endl;
+    sc_time start_nbdram = sc_time_stamp();
+    while (used > max_sram_size) {
+        std::cout << "\033[1;31m" << ": Core " << cid
+                  << " Sram check: used: " << used
+                  << ", max sram size: " << max_sram_size << "\033[0m" << endl;
+        int delta_space = used - max_sram_size;
 
+        vector<Spill_candidate> candidates;
+        collect(KVCACHE_PRIOR_SPILL == 1, candidates);
 #if KVCACHE_PRIOR_SPILL == 1
-        if (min_record == 1e9 + 3) {
+        if (candidates.empty()) {
             cout << "[SRAM] SRAM need to spill kvcache " << max_sram_size << "<"
                  << used << endl;
-
-            for (auto pair : data_map) {
-                if (pair.first == key)
-                    continue; // 不能spill自己
-                if (!pair.second.valid &&
-                    pair.second.spill_size == pair.second.size)
-                    continue; // 已经全部spill到dram中去了
-
-                if (pair.second.record < min_record) {
-                    min_record = pair.second.record;
-                    min_label = pair.first;
-                    min_pos = pair.second.pos;
-                    sram_id = pair.second.alloc_id;
-                }
-            }
+            collect(false, candidates);
         }
 #endif
-        if (min_record == 1e9 + 3) {
+        if (candidates.empty()) {
             cout << "[ERROR] SRAM have no more data to spill " << max_sram_size
                  << "<" << used << endl;
             sc_stop();
             return;
         }
 
+        int victim = ChooseSpillVictim(g_spill_policy, cid, candidates,
+                                       delta_space, spill_partial);
+        string min_label = candidates[victim].label;
+        AllocationID sram_id = data_map[min_label].alloc_id;
+
         // 如果已经spill一部分了，则选择剩余能spill的大小
         int upper_spill_limit;
         if (data_map[min_label].valid) {
@@ -211,11 +206,15 @@ void SramPosLocator::addPair(std::string &key, AddrPosKey value,
 
         data_map[min_label].valid = false;
 
-        int delta_space = used - max_sram_size;
         // 表示已经被放到dram中的数据大小
-        // int spill_size =
-        //     min(double(delta_space) * 1, (double)upper_spill_limit);
         int spill_size = upper_spill_limit;
+#if USE_SRAM_MANAGER == 0
+        // sram manager 按分配整体释放，只有不使用manager时可以部分spill
+        if (spill_partial)
+            spill_size = min(upper_spill_limit,
+                             CeilingDivision(delta_space, SRAM_BLOCK_SIZE) *
+                                 SRAM_BLOCK_SIZE);
+#endif
         used -= spill_size;
         data_map[min_label].spill_size += spill_size;
         // data_map[min_label].size -= spill_size;
@@ -322,6 +321,7 @@ void SramPosLocator::updateKVPair(TaskCoreContext &context, std::string &key,
 
 
     } else if (spill_size > 0) {
+        STATS.core(context.cid).reload_bytes->inc(spill_size);
         sram_first_write_generic(context, spill_size, kv_daddr, dram_time_tmp,
                                  nullptr, key, true, this);
         // KV sram block 之前被建立，但是被放回dram
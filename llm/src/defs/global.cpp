@@ -13,6 +13,12 @@ vector<chip_instr_base*> g_chip_prim_stash;
 AddrLabelTable g_addr_label_table;
 
 DramKVTable** g_dram_kvtable;
+WorkerCoreExecutor** g_core_executor;
+ChipLinkNetwork *g_chip_link = nullptr;
+int g_chip_id = 0;
+
+string g_checkpoint_file = "";
+int g_checkpoint_iter = 0;
 int MAX_SRAM_SIZE;
 sc_event kv_event;
 int dram_aligned;
@@ -60,6 +66,28 @@ string g_config_file;
 int g_default_dram_bw;
 bool beha_dram;
 float beha_dram_util;
+
+bool noc_multicast = false;
+vector<vector<int>> g_mcast_groups(1);
+
+ROUTING_ALGO noc_routing = ROUTE_XY;
+int noc_vcs = 1;
+
+vector<int> g_host_ports;
+vector<int> g_host_port_of;
+bool host_preload = false;
+
+SRAM_MODEL g_sram_model = SRAM_MODEL_ROW;
+
+SPILL_POLICY g_spill_policy = SPILL_LRU;
+bool spill_partial = false;
+
+bool core_engines = false;
+int engine_window = 2;
+
+int prefetch_depth = 0;
+
+bool g_headless = false;
 // int DRAM_BURST_BYTE;
 // int L1CACHELINESIZE;
 // int L2CACHELINESIZE;
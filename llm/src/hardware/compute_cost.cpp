@@ -0,0 +1,199 @@
+#include "hardware/compute_cost.h"
+#include "common/config.h"
+#include "defs/global.h"
+#include "macros/macros.h"
+#include "trace/Stats_registry.h"
+#include "utils/datatype_utils.h"
+#include "utils/print_utils.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+static u_int64_t CeilDiv(u_int64_t a, u_int64_t b) { return (a + b - 1) / b; }
+
+SYSTOLIC_DATAFLOW ParseDataflow(const string &name) {
+    if (name == "ws")
+        return DF_WEIGHT_STATIONARY;
+    if (name == "os")
+        return DF_OUTPUT_STATIONARY;
+    if (name == "is")
+        return DF_INPUT_STATIONARY;
+    if (name == "ideal")
+        return DF_IDEAL;
+
+    ARGUS_EXIT("Unknown systolic dataflow ", name, ", use ws/os/is/ideal.\n");
+    return DF_WEIGHT_STATIONARY;
+}
+
+Comp_cost_model::Comp_cost_model() : dataflow(DF_WEIGHT_STATIONARY) {
+    for (int i = 0; i < COST_OP_NUM; i++)
+        scale[i] = 1;
+
+    stat_hits = STATS.counter("comp_cost.hits");
+    stat_misses = STATS.counter("comp_cost.misses");
+}
+
+void Comp_cost_model::set_dataflow(SYSTOLIC_DATAFLOW df) {
+    dataflow = df;
+    memo.clear();
+}
+
+Comp_cost_key Comp_cost_model::make_key(int op, int cid, u_int64_t m,
+                                        u_int64_t k, u_int64_t n,
+                                        DATATYPE dtype) const {
+    CoreHWConfig *core_config = GetCoreHWConfig(cid);
+
+    Comp_cost_key key;
+    key.op = op;
+    key.m = m;
+    key.k = k;
+    key.n = n;
+    key.dtype = dtype;
+    key.exu_x = core_config->exu->x_dims;
+    key.exu_y = core_config->exu->y_dims;
+    key.sfu_x = core_config->sfu->x_dims;
+    key.dataflow = op == COST_GEMM ? dataflow : DF_IDEAL;
+    return key;
+}
+
+double Comp_cost_model::model_cycles(const Comp_cost_key &key) const {
+    double rate = GetDatatypeDesc(DATATYPE(key.dtype)).exu_rate;
+    u_int64_t R = key.exu_x, C = key.exu_y;
+
+    switch (key.op) {
+    case COST_GEMM: {
+        u_int64_t M = key.m, K = key.k, N = key.n;
+        if (!M || !K || !N)
+            return 0;
+
+        // 每个fold都需要完整的填充与排空，形状不足阵列大小的部分按padding计算
+        double cycles = 0;
+        switch (key.dataflow) {
+        case DF_WEIGHT_STATIONARY:
+            // 权重[K, N]驻留在阵列上，input 的M行流过阵列
+            cycles = CeilDiv(K, R) * CeilDiv(N, C) * (2 * R + C + M - 2);
+            break;
+        case DF_OUTPUT_STATIONARY:
+            // 输出[M, N]驻留在阵列上，沿K维累加
+            cycles = CeilDiv(M, R) * CeilDiv(N, C) * (2 * R + C + K - 2);
+            break;
+        case DF_INPUT_STATIONARY:
+            // input[K, M]驻留在阵列上，权重的N列流过阵列
+            cycles = CeilDiv(K, R) * CeilDiv(M, C) * (2 * R + C + N - 2);
+            break;
+        case DF_IDEAL:
+        default:
+            cycles = (double)M * K * N * 2 / (R * C * 2 * comp_util);
+            break;
+        }
+        return cycles / rate;
+    }
+    case COST_EXU:
+        return key.m / (R * C * 2 * comp_util) / rate;
+    case COST_SFU:
+        if (!key.m)
+            return 0;
+        return (double)CeilDiv(key.m, key.sfu_x) + SFU_PIPELINE_DEPTH;
+    default:
+        return 0;
+    }
+}
+
+u_int64_t Comp_cost_model::lookup(const Comp_cost_key &key) {
+    auto it = memo.find(key);
+    if (it != memo.end()) {
+        stat_hits->inc();
+        return it->second;
+    }
+    stat_misses->inc();
+
+    u_int64_t cycles;
+    Comp_cost_key measured_key = key;
+    measured_key.dataflow = 0;
+    auto m = measured.find(measured_key);
+    if (m != measured.end())
+        cycles = m->second;
+    else
+        cycles = (u_int64_t)(model_cycles(key) * scale[key.op]);
+
+    memo.emplace(key, cycles);
+    return cycles;
+}
+
+u_int64_t Comp_cost_model::gemm(int cid, u_int64_t M, u_int64_t K,
+                                u_int64_t N, DATATYPE dtype) {
+    return lookup(make_key(COST_GEMM, cid, M, K, N, dtype));
+}
+
+u_int64_t Comp_cost_model::exu(int cid, u_int64_t ops, DATATYPE dtype) {
+    return lookup(make_key(COST_EXU, cid, ops, 0, 0, dtype));
+}
+
+u_int64_t Comp_cost_model::sfu(int cid, u_int64_t ops, DATATYPE dtype) {
+    return lookup(make_key(COST_SFU, cid, ops, 0, 0, dtype));
+}
+
+bool Comp_cost_model::load_calibration(const string &filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cout << "[ERROR] Comp cost: cannot open calibration table " << filename
+             << endl;
+        return false;
+    }
+
+    double log_ratio[COST_OP_NUM] = {0};
+    int samples[COST_OP_NUM] = {0};
+
+    string line;
+    getline(file, line); // 表头
+    while (getline(file, line)) {
+        if (line.empty())
+            continue;
+
+        replace(line.begin(), line.end(), ',', ' ');
+        istringstream iss(line);
+        string op;
+        Comp_cost_key key;
+        u_int64_t cycles;
+        if (!(iss >> op >> key.m >> key.k >> key.n >> key.dtype >> key.exu_x >>
+              key.exu_y >> key.sfu_x >> cycles)) {
+            cout << "[ERROR] Comp cost: bad calibration line: " << line << endl;
+            return false;
+        }
+
+        if (op == "gemm")
+            key.op = COST_GEMM;
+        else if (op == "exu")
+            key.op = COST_EXU;
+        else if (op == "sfu")
+            key.op = COST_SFU;
+        else {
+            cout << "[ERROR] Comp cost: unknown op " << op << endl;
+            return false;
+        }
+
+        // 实测值与数据流无关，按照当前数据流计算模型值以得到缩放比例
+        key.dataflow = key.op == COST_GEMM ? dataflow : DF_IDEAL;
+        double model = model_cycles(key);
+        if (model > 0 && cycles > 0) {
+            log_ratio[key.op] += log(cycles / model);
+            samples[key.op]++;
+        }
+
+        key.dataflow = 0;
+        measured[key] = cycles;
+    }
+
+    for (int i = 0; i < COST_OP_NUM; i++) {
+        if (samples[i])
+            scale[i] = exp(log_ratio[i] / samples[i]);
+        cout << "[COMP COST] op " << i << ": " << samples[i]
+             << " calibration samples, scale " << scale[i] << endl;
+    }
+
+    memo.clear();
+    return true;
+}
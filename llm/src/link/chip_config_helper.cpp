@@ -5,6 +5,7 @@
 #include "link/instr/chip_prim_utils.h"
 chip_config_helper::chip_config_helper(string filename, string font_ttf, int cid){
     this->cid = cid;
+    refill = true;
 
     cout << "Loading chip config " << filename << endl;
     json j;
@@ -20,6 +21,8 @@ chip_config_helper::chip_config_helper(string filename, string font_ttf, int cid
     // Parse global_interface prims
     if (j.contains("chips") && j["chips"].is_array() && cid < (int)j["chips"].size()) {
         auto &chip = j["chips"][cid];
+        if (chip.contains("global_interface") && chip["global_interface"].contains("refill"))
+            refill = chip["global_interface"]["refill"];
         if (chip.contains("global_interface") && chip["global_interface"].contains("prims")) {
             auto &prims = chip["global_interface"]["prims"];
             for (const auto &p : prims) {
@@ -54,6 +57,7 @@ chip_config_helper::chip_config_helper(string filename, string font_ttf, int cid
 void chip_config_helper::printSelf(){
     cout << "<ChipConfigHelper>\n";
     cout << "\tchip id: " << cid << endl;
+    cout << "\trefill: " << refill << endl;
     cout << "\t<instr_list>\n";
     for(auto instr : instr_list){
         instr->printSelf("\t\t");
@@ -0,0 +1,302 @@
+#include "link/chip_link.h"
+#include "link/chip_dma.h"
+#include "link/nvlink_packet.h"
+#include "macros/macros.h"
+#include "utils/config_utils.h"
+#include "utils/print_utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+
+void ChipLinkConfig::printSelf() {
+    const char *topo_name[] = {"ring", "full", "switch"};
+    cout << "<ChipLinkConfig>\n";
+    cout << "\tchips: " << chip_num << endl;
+    cout << "\ttopology: " << topo_name[topology] << endl;
+    cout << "\tbandwidth: " << bandwidth << " GB/s, latency: " << latency
+         << " ns\n";
+    cout << "\tdma_bw: " << dma_bw << " GB/s, dma_latency: " << dma_latency
+         << " ns\n";
+    cout << "</ChipLinkConfig>\n";
+}
+
+void from_json(const json &j, ChipLinkConfig &c) {
+    string topo = j.value("topology", "ring");
+    if (topo == "ring")
+        c.topology = LINK_RING;
+    else if (topo == "full")
+        c.topology = LINK_FULL;
+    else if (topo == "switch")
+        c.topology = LINK_SWITCH;
+    else
+        ARGUS_EXIT("Unknown link topology ", topo,
+                   ", use ring/full/switch.\n");
+
+    // 带宽可以是小数，不经过vtable
+    c.bandwidth = j.value("bandwidth", 50.0);
+    c.dma_bw = j.value("dma_bw", 128.0);
+    SetParamFromJson<int>(j, "latency", &(c.latency), 500);
+    SetParamFromJson<int>(j, "switch_latency", &(c.switch_latency), 200);
+    SetParamFromJson<int>(j, "dma_latency", &(c.dma_latency), 100);
+
+    if (c.bandwidth <= 0 || c.dma_bw <= 0)
+        ARGUS_EXIT("Link bandwidth must be positive.\n");
+}
+
+ChipLink::ChipLink(int src, int dst, string name) : src(src), dst(dst) {
+    bytes = STATS.counter(name + ".bytes");
+    packets = STATS.counter(name + ".packets");
+    flits = STATS.counter(name + ".flits");
+}
+
+ChipLinkNetwork::ChipLinkNetwork(const sc_module_name &n,
+                                 const ChipLinkConfig &config)
+    : sc_module(n), config(config) {
+    int num = config.chip_num;
+
+    switch (config.topology) {
+    case LINK_RING:
+        for (int i = 0; i < num && num > 1; i++) {
+            add_link(i, (i + 1) % num);
+            add_link((i + 1) % num, i);
+        }
+        break;
+    case LINK_FULL:
+        for (int i = 0; i < num; i++)
+            for (int j = 0; j < num; j++)
+                if (i != j)
+                    add_link(i, j);
+        break;
+    case LINK_SWITCH:
+        for (int i = 0; i < num; i++) {
+            add_link(i, num);
+            add_link(num, i);
+        }
+        break;
+    }
+
+    this->config.printSelf();
+}
+
+ChipLinkNetwork::~ChipLinkNetwork() {
+    for (auto &l : links)
+        delete l.second;
+}
+
+void ChipLinkNetwork::add_link(int src, int dst) {
+    if (links.count({src, dst}))
+        return;
+
+    auto node_name = [&](int id) {
+        return id == config.chip_num ? string("sw") : to_string(id);
+    };
+    links[{src, dst}] = new ChipLink(
+        src, dst, "link." + node_name(src) + "-" + node_name(dst));
+}
+
+ChipLink *ChipLinkNetwork::get_link(int src, int dst) {
+    auto it = links.find({src, dst});
+    if (it == links.end()) {
+        ARGUS_EXIT("No chip link from ", src, " to ", dst, ".\n");
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+void ChipLinkNetwork::attach(int chip_id, ChipDmaEngine *dma) {
+    dma_engines[chip_id] = dma;
+}
+
+ChipDmaEngine *ChipLinkNetwork::get_dma(int chip_id) {
+    auto it = dma_engines.find(chip_id);
+    if (it == dma_engines.end()) {
+        ARGUS_EXIT("Chip ", chip_id, " has no DMA engine attached.\n");
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+vector<int> ChipLinkNetwork::route(int src, int dst) {
+    int num = config.chip_num;
+    if (src < 0 || src >= num || dst < 0 || dst >= num)
+        ARGUS_EXIT("Chip id out of range: ", src, " -> ", dst, ".\n");
+
+    if (src == dst)
+        return {src};
+
+    switch (config.topology) {
+    case LINK_FULL:
+        return {src, dst};
+    case LINK_SWITCH:
+        return {src, num, dst};
+    default: {
+        // 按最短方向转发，距离相同时顺时针
+        int cw = (dst - src + num) % num;
+        int step = cw <= num - cw ? 1 : -1;
+        vector<int> path = {src};
+        for (int c = src; c != dst;) {
+            c = (c + step + num) % num;
+            path.push_back(c);
+        }
+        return path;
+    }
+    }
+}
+
+double ChipFlow::head() const {
+    return ready.empty() ? 0 : *min_element(ready.begin(), ready.end());
+}
+
+bool ChipFlow::operator<(const ChipFlow &other) const {
+    return make_tuple(head(), src, seq, chunk) <
+           make_tuple(other.head(), other.src, other.seq, other.chunk);
+}
+
+int ChipLinkNetwork::next_hop(int node, int dst) {
+    if (node == config.chip_num)
+        return dst;
+    return route(node, dst)[1];
+}
+
+double ChipLinkNetwork::hop(int from, int to, int tag, u_int64_t bytes,
+                            vector<double> &ready) {
+    ChipLink *l = get_link(from, to);
+    auto pkts = NvPacketize(NV_WRITE, tag, 0, bytes);
+    if (ready.size() != pkts.size())
+        ARGUS_EXIT("Chip flow has ", ready.size(), " packets, expect ",
+                   pkts.size(), ".\n");
+
+    // 包在链路上按顺序串行发送，包头在发送完毕并经过链路延迟之后到达下一个节点
+    double leave = 0;
+    for (int i = 0; i < pkts.size(); i++) {
+        double ser =
+            (double)pkts[i].flits() * NVLINK_FLIT_BYTES / config.bandwidth;
+        double start = max(ready[i], l->free_at);
+        l->free_at = start + ser;
+
+        l->bytes->inc(pkts[i].payload_bytes);
+        l->packets->inc();
+        l->flits->inc(pkts[i].flits());
+
+        leave = start + ser;
+        ready[i] = leave + config.latency;
+        if (to == config.chip_num)
+            ready[i] += config.switch_latency;
+    }
+
+    return leave;
+}
+
+double ChipLinkNetwork::lookahead() {
+    // 任何跨分区的数据至少经过一跳链路
+    if (config.latency <= 0)
+        ARGUS_EXIT("Parallel chip simulation needs a positive link latency.\n");
+    return config.latency;
+}
+
+double ChipLinkNetwork::inject(int src, int dst, int tag, int64_t seq,
+                               int chunk, int chunks, u_int64_t bytes,
+                               u_int64_t msg_bytes, double ready_ns) {
+    ChipFlow flow;
+    flow.src = src;
+    flow.dst = dst;
+    flow.tag = tag;
+    flow.seq = seq;
+    flow.chunk = chunk;
+    flow.chunks = chunks;
+    flow.bytes = bytes;
+    flow.msg_bytes = msg_bytes;
+    flow.ready.assign(NvPacketize(NV_WRITE, tag, 0, bytes).size(), ready_ns);
+
+    flow.node = next_hop(src, dst);
+    double leave = hop(src, flow.node, tag, bytes, flow.ready);
+    forward(flow);
+    return leave;
+}
+
+void ChipLinkNetwork::forward(ChipFlow &flow) {
+    // 交换机的下行链路与最终的接收都归目的芯片
+    if (flow.node == flow.dst || flow.node == config.chip_num)
+        flow.owner = flow.dst;
+    else
+        flow.owner = flow.node;
+
+    if (flow.owner == local_chip)
+        pending.push_back(flow);
+    else
+        outgoing.push_back(flow);
+}
+
+void ChipLinkNetwork::sync(vector<ChipFlow> &incoming) {
+    vector<ChipFlow> flows;
+    flows.swap(pending);
+    flows.insert(flows.end(), incoming.begin(), incoming.end());
+    sort(flows.begin(), flows.end());
+
+    // 每一跳至少经过latency，新产生的流都在下一个窗口之后才到达，留到下一个边界处理
+    for (auto &flow : flows) {
+        if (flow.node == flow.dst) {
+            get_dma(flow.dst)->arrive(flow);
+            continue;
+        }
+
+        int next = next_hop(flow.node, flow.dst);
+        hop(flow.node, next, flow.tag, flow.bytes, flow.ready);
+        flow.node = next;
+        forward(flow);
+    }
+}
+
+void ChipLinkNetwork::report(const string &filename) {
+    double now = sc_time_stamp().to_seconds() * 1e9;
+    ofstream file(filename, ios::trunc);
+    file << "link,bytes,packets,flits,busy_ns,utilization\n";
+
+    PrintBar(48);
+    cout << "| " << std::left << std::setw(44) << "Chip link utilization"
+         << " |\n";
+    PrintBar(48);
+    for (auto &it : links) {
+        ChipLink *l = it.second;
+        // 链路按flit计算忙碌时间，包含包头开销
+        double busy = l->flits->value * NVLINK_FLIT_BYTES / config.bandwidth;
+        double util = now > 0 ? busy / now : 0;
+        string name = (l->src == config.chip_num ? string("sw")
+                                                 : to_string(l->src)) +
+                      "->" +
+                      (l->dst == config.chip_num ? string("sw")
+                                                 : to_string(l->dst));
+
+        file << name << "," << l->bytes->value << "," << l->packets->value
+             << "," << l->flits->value << "," << busy << "," << util << "\n";
+        if (l->bytes->value) {
+            ostringstream percent;
+            percent << std::fixed << std::setprecision(2) << util * 100 << "%";
+            cout << "| " << std::left << std::setw(10) << name << "| "
+                 << std::right << std::setw(18) << l->bytes->value << "B | "
+                 << std::setw(10) << percent.str() << " |\n";
+        }
+    }
+    PrintBar(48);
+
+    file.close();
+    cout << "Chip link statistics written to " << filename << endl;
+}
+
+ChipLinkNetwork *InitChipLink(const char *config_file) {
+    ifstream jfile(config_file);
+    json j;
+    jfile >> j;
+
+    if (!j.contains("link"))
+        return nullptr;
+
+    ChipLinkConfig config = j["link"];
+    config.chip_num = j.contains("chips") ? j["chips"].size() : 1;
+    return new ChipLinkNetwork("chip-link", config);
+}
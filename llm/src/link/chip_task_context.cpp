@@ -5,5 +5,7 @@ TaskChipContext generate_chip_context(GlobalMemInterface *global_mem_interface){
     TaskChipContext context;
     // Pass through the ChipGlobalMemory pointer for TLM transactions
     context.chipGlobalMemory = global_mem_interface->chipGlobalMemory;
+    context.dma = global_mem_interface->dma;
+    context.cid = global_mem_interface->cid;
     return context;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "link/config_top.h"
+#include "link/chip_link.h"
 
 #include "nlohmann/json.hpp"
 #include "utils/system_utils.h"
@@ -68,6 +69,13 @@ TopConfig::TopConfig(std::string filename, std::string font_ttf)
             component_.push_back(chip_ptr);
         }
     }
+
+    // 片间互联放在所有芯片之后，cores_copy按下标引用芯片
+    if (j.contains("link")) {
+        auto link_ptr = new ChipLinkConfig(j["link"].get<ChipLinkConfig>());
+        link_ptr->chip_num = config_chips.size();
+        component_.push_back(link_ptr);
+    }
 }
 
 TopConfig::~TopConfig() {
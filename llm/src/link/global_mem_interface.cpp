@@ -11,9 +11,10 @@
 #include "link/instr/print_msg.h"
 #include "link/instr/wait_event.h"
 
-GlobalMemInterface::GlobalMemInterface(const sc_module_name &n, Event_engine *event_engine,const char *config_name, const char *font_ttf) 
-    : sc_module(n), event_engine(event_engine) {
-    config_helper = new chip_config_helper(config_name, font_ttf, 0);
+GlobalMemInterface::GlobalMemInterface(const sc_module_name &n, Event_engine *event_engine,const char *config_name, const char *font_ttf, int cid) 
+    : sc_module(n), event_engine(event_engine), cid(cid) {
+    config_helper = new chip_config_helper(config_name, font_ttf, cid);
+    chip_prim_refill = config_helper->refill;
     init(); 
     
     // Load any global_interface primitives from the config
@@ -24,13 +25,18 @@ GlobalMemInterface::GlobalMemInterface(const sc_module_name &n, Event_engine *ev
     assert(0);
 }
 
-GlobalMemInterface::GlobalMemInterface() {
+GlobalMemInterface::GlobalMemInterface() : cid(0) {
     init();
 }
 
 void GlobalMemInterface::init() {
 
     chipGlobalMemory = new ChipGlobalMemory(sc_gen_unique_name("chip-global-memory"), "../DRAMSys/configs/ddr4-example-8bit.json", "../DRAMSys/configs");
+    chipGlobalMemory->cid = cid;
+
+    // 配置了片间互联时，为全局内存挂上DMA引擎
+    dma = g_chip_link ? new ChipDmaEngine(cid, chipGlobalMemory, g_chip_link)
+                      : nullptr;
     // // assert(0 && "task_logic's is not impl and sc_env is not implemented");
     SC_THREAD(switch_chip_prim_block);
     sensitive << ev_block;
@@ -142,14 +148,13 @@ void GlobalMemInterface::task_logic() {
 
 void GlobalMemInterface::instr_executor() {
     while(true) {
-        chip_instr_base *p = global_instrs_queue.front();
         // global_instrs_queue.pop_front();
 
         if(global_instrs_queue.size() == 0){
-            //
+            // 不重复执行时，所有原语执行完毕后停在这里
             wait();
         } else{
-            p = global_instrs_queue.front();
+            chip_instr_base *p = global_instrs_queue.front();
             ev_task.notify(CYCLE, SC_NS);
             event_engine->add_event("Chip " + ToHexString(cid), "Comp_prim",
                                     "B", Trace_event_util(p->name));
@@ -1,4 +1,5 @@
 #include "link/monitor_top.h"
+#include "link/chip_link.h"
 #include "link/config_top.h"
 #include "link/monitor_chip.h"
 #include "monitor/monitor.h"
@@ -25,6 +26,15 @@ void TopMonitor::init() {
     // 初始化组件
     assert(config != nullptr && "config is nullptr");
 
+    // 芯片的DMA引擎创建时需要登记到片间网络上，因此先创建网络
+    for (auto config_ptr : config->component_) {
+        if (config_ptr->getType() == BaseConfig::TYPE_LINK) {
+            g_chip_link = new ChipLinkNetwork(
+                "chip_link", *dynamic_cast<ChipLinkConfig *>(config_ptr));
+            components.push_back(g_chip_link);
+        }
+    }
+
     for (auto config_ptr : config->component_) {
         switch (config_ptr->getType()) {
         case BaseConfig::TYPE_CHIP:
@@ -33,6 +43,8 @@ void TopMonitor::init() {
             components.push_back(new ChipMonitor("chip_monitor", event_engine,
                                                  config_ptr, font_ttf));
             break;
+        case BaseConfig::TYPE_LINK:
+            break;
         default:
             assert(0 && "not implemented yet");
             break;
@@ -1,56 +1,47 @@
-// #include "nvlink_packet.h"
-
-
-// // namespace nvlink{
-
-// nvMsg::nvMsg(){
-    
-// }
-
-// nvMsg::~nvMsg(){
-    
-// }
-
-// // }
-
-
-
-// // #include "nvlink_packet.h"
-
-// // namespace nvlink {
-
-// // std::vector<uint8_t> Packet::encode() const {
-// //     std::vector<uint8_t> buf;
-// //     buf.reserve(1 + sizeof(addr) + payload.size());
-// //     buf.push_back(static_cast<uint8_t>(cmd));
-// //     // Serialize address in little endian
-// //     for (size_t i = 0; i < sizeof(addr); ++i) {
-// //         buf.push_back(static_cast<uint8_t>((addr >> (8 * i)) & 0xFF));
-// //     }
-// //     // Append payload
-// //     buf.insert(buf.end(), payload.begin(), payload.end());
-// //     return buf;
-// // }
-
-// // Packet Packet::decode(const std::vector<uint8_t>& data) {
-// //     Packet pkt;
-// //     size_t min_size = 1 + sizeof(pkt.addr);
-// //     if (data.size() < min_size) {
-// //         throw std::runtime_error("Invalid packet size: too small");
-// //     }
-// //     pkt.cmd = static_cast<CmdType>(data[0]);
-// //     pkt.addr = 0;
-// //     for (size_t i = 0; i < sizeof(pkt.addr); ++i) {
-// //         pkt.addr |= static_cast<uint64_t>(data[1 + i]) << (8 * i);
-// //     }
-// //     pkt.payload.assign(data.begin() + 1 + sizeof(pkt.addr), data.end());
-// //     return pkt;
-// // }
-
-// // void Packet::print() const {
-// //     std::cout << "Cmd: " << static_cast<int>(cmd)
-// //               << ", Addr: 0x" << std::hex << addr << std::dec
-// //               << ", Payload size: " << payload.size() << std::endl;
-// // }
-
-// // } // namespace nvlink
+#include "link/nvlink_packet.h"
+#include "macros/macros.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+
+nvMsg::nvMsg() : crc(0), dl_hdr(0), payload_bytes(0) {
+    header.opcode = 0;
+    header.tag_id = 0;
+    header.packet_length = 0;
+}
+
+nvMsg::nvMsg(int opcode, int tag_id, u_int64_t addr, int payload_bytes)
+    : crc(0), dl_hdr(0), payload_bytes(payload_bytes) {
+    header.opcode = opcode;
+    header.tag_id = tag_id;
+    header.packet_length =
+        CeilingDivision(payload_bytes, NVLINK_FLIT_BYTES);
+
+    ae.range(31, 0) = (unsigned)(addr & 0xffffffff);
+    // 最后一个flit中只有部分字节有效
+    int tail = payload_bytes % NVLINK_FLIT_BYTES;
+    be = 0;
+    for (int i = 0; i < (tail ? tail : NVLINK_FLIT_BYTES); i++)
+        be[i] = 1;
+}
+
+nvMsg::~nvMsg() {}
+
+int nvMsg::flits() const { return NVLINK_HEADER_FLITS + header.packet_length; }
+
+std::vector<nvMsg> NvPacketize(int opcode, int tag_id, u_int64_t addr,
+                               u_int64_t bytes) {
+    const u_int64_t max_bytes = NVLINK_MAX_PAYLOAD_FLITS * NVLINK_FLIT_BYTES;
+
+    std::vector<nvMsg> packets;
+    packets.reserve((bytes + max_bytes - 1) / max_bytes);
+    for (u_int64_t offset = 0; offset < bytes; offset += max_bytes) {
+        int len = std::min(max_bytes, bytes - offset);
+        packets.emplace_back(opcode, tag_id, addr + offset, len);
+    }
+    // 没有数据时仍发送一个只有包头的包，接收方据此完成同步
+    if (packets.empty())
+        packets.emplace_back(opcode, tag_id, addr, 0);
+
+    return packets;
+}
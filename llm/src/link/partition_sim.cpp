@@ -0,0 +1,295 @@
+#include "link/partition_sim.h"
+#include "defs/enums.h"
+#include "defs/global.h"
+#include "link/chip_link.h"
+#include "utils/print_utils.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// 父子进程之间通过管道传递的定长消息，后面跟 flows 条 ChipFlow
+struct PartitionCmd {
+    int32_t op;
+    int32_t flows;
+    double window_end;
+};
+
+struct PartitionReport {
+    int32_t status;
+    int32_t flows;
+    int32_t pending;
+    double now;
+    double cpu_seconds;
+};
+
+struct FlowHeader {
+    int32_t src, dst, tag, node, owner, chunk, chunks, packets;
+    int64_t seq;
+    u_int64_t bytes, msg_bytes;
+};
+
+static bool WriteAll(int fd, const void *buf, size_t n) {
+    const char *p = (const char *)buf;
+    while (n > 0) {
+        ssize_t ret = write(fd, p, n);
+        if (ret <= 0)
+            return false;
+        p += ret;
+        n -= ret;
+    }
+    return true;
+}
+
+static bool ReadAll(int fd, void *buf, size_t n) {
+    char *p = (char *)buf;
+    while (n > 0) {
+        ssize_t ret = read(fd, p, n);
+        if (ret <= 0)
+            return false;
+        p += ret;
+        n -= ret;
+    }
+    return true;
+}
+
+static bool WriteFlows(int fd, const vector<ChipFlow> &flows) {
+    for (auto &f : flows) {
+        FlowHeader h = {f.src,   f.dst,    f.tag,  f.node,
+                        f.owner, f.chunk,  f.chunks, (int32_t)f.ready.size(),
+                        f.seq,   f.bytes,  f.msg_bytes};
+        if (!WriteAll(fd, &h, sizeof(h)) ||
+            !WriteAll(fd, f.ready.data(), f.ready.size() * sizeof(double)))
+            return false;
+    }
+    return true;
+}
+
+static bool ReadFlows(int fd, int count, vector<ChipFlow> &flows) {
+    for (int i = 0; i < count; i++) {
+        FlowHeader h;
+        if (!ReadAll(fd, &h, sizeof(h)))
+            return false;
+
+        ChipFlow f;
+        f.src = h.src;
+        f.dst = h.dst;
+        f.tag = h.tag;
+        f.node = h.node;
+        f.owner = h.owner;
+        f.chunk = h.chunk;
+        f.chunks = h.chunks;
+        f.seq = h.seq;
+        f.bytes = h.bytes;
+        f.msg_bytes = h.msg_bytes;
+        f.ready.resize(h.packets);
+        if (!ReadAll(fd, f.ready.data(), h.packets * sizeof(double)))
+            return false;
+        flows.push_back(f);
+    }
+    return true;
+}
+
+// 每个分区有自己的工作目录，DRAMSys与字体通过符号链接共享
+static string PreparePartitionDir(int chip) {
+    namespace fs = std::filesystem;
+    fs::path root = fs::path("partition_" + to_string(chip));
+    fs::create_directories(root / "build");
+    for (string name : {"DRAMSys", "font"}) {
+        fs::path target = fs::absolute(fs::path("..") / name);
+        fs::path link = root / name;
+        if (fs::exists(target) && !fs::exists(fs::symlink_status(link)))
+            fs::create_directory_symlink(target, link);
+    }
+    return (root / "build").string();
+}
+
+static double NowNs() { return sc_time_stamp().to_seconds() * 1e9; }
+
+static void PartitionMain(int chip, const string &dir, int cmd_fd, int rep_fd,
+                          const function<void(int)> &build,
+                          const function<void()> &resume,
+                          const function<void()> &finish) {
+    clock_t start = clock();
+    if (chdir(dir.c_str()) != 0 || !freopen("stdout.log", "w", stdout))
+        _exit(1);
+
+    g_chip_id = chip;
+    g_chip_link->local_chip = chip;
+    build(chip);
+
+    while (true) {
+        PartitionCmd cmd;
+        if (!ReadAll(cmd_fd, &cmd, sizeof(cmd)))
+            _exit(1);
+        if (cmd.op == PART_EXIT)
+            break;
+
+        vector<ChipFlow> incoming;
+        if (!ReadFlows(cmd_fd, cmd.flows, incoming))
+            _exit(1);
+        g_chip_link->sync(incoming);
+
+        if (sc_get_status() != SC_STOPPED && cmd.window_end > NowNs()) {
+            resume();
+            sc_start(sc_time(cmd.window_end - NowNs(), SC_NS));
+        }
+
+        PartitionReport rep;
+        if (sc_get_status() == SC_STOPPED)
+            rep.status = PART_STOPPED;
+        else if (!sc_pending_activity() && g_chip_link->pending.empty())
+            rep.status = PART_IDLE;
+        else
+            rep.status = PART_RUNNING;
+        rep.flows = g_chip_link->outgoing.size();
+        rep.pending = g_chip_link->pending.size();
+        rep.now = NowNs();
+        rep.cpu_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        if (!WriteAll(rep_fd, &rep, sizeof(rep)) ||
+            !WriteFlows(rep_fd, g_chip_link->outgoing))
+            _exit(1);
+        g_chip_link->outgoing.clear();
+    }
+
+    finish();
+    fflush(stdout);
+    _exit(0);
+}
+
+int RunPartitionedChips(int chip_num, int jobs, const function<void(int)> &build,
+                        const function<void()> &resume,
+                        const function<void()> &finish) {
+    double window = g_chip_link->lookahead();
+    if (jobs <= 0 || jobs > chip_num)
+        jobs = chip_num;
+
+    cout << "Parallel chip simulation: " << chip_num << " partitions, " << jobs
+         << " running at a time, window " << window << " ns\n";
+
+    vector<pid_t> pids(chip_num);
+    vector<int> cmd_fds(chip_num), rep_fds(chip_num);
+    for (int k = 0; k < chip_num; k++) {
+        string dir = PreparePartitionDir(k);
+        int cmd_pipe[2], rep_pipe[2];
+        if (pipe(cmd_pipe) != 0 || pipe(rep_pipe) != 0) {
+            cout << "[ERROR] Cannot create pipes for partition " << k << endl;
+            return -1;
+        }
+
+        fflush(stdout);
+        pids[k] = fork();
+        if (pids[k] < 0) {
+            cout << "[ERROR] Cannot fork partition " << k << endl;
+            return -1;
+        }
+        if (pids[k] == 0) {
+            // 子进程只保留自己的管道
+            for (int i = 0; i < k; i++) {
+                close(cmd_fds[i]);
+                close(rep_fds[i]);
+            }
+            close(cmd_pipe[1]);
+            close(rep_pipe[0]);
+            PartitionMain(k, dir, cmd_pipe[0], rep_pipe[1], build, resume,
+                          finish);
+        }
+
+        close(cmd_pipe[0]);
+        close(rep_pipe[1]);
+        cmd_fds[k] = cmd_pipe[1];
+        rep_fds[k] = rep_pipe[0];
+    }
+
+    auto wall_start = chrono::steady_clock::now();
+    vector<vector<ChipFlow>> inbox(chip_num);
+    vector<PartitionReport> reports(chip_num);
+    u_int64_t windows = 0, exchanged = 0;
+    bool failed = false;
+
+    for (double end = window; !failed; end += window) {
+        vector<ChipFlow> sent;
+        // 每次最多jobs个分区同时推进同一个窗口
+        for (int b = 0; b < chip_num && !failed; b += jobs) {
+            int e = min(chip_num, b + jobs);
+            for (int k = b; k < e && !failed; k++) {
+                PartitionCmd cmd = {PART_RUN, (int32_t)inbox[k].size(), end};
+                failed = !WriteAll(cmd_fds[k], &cmd, sizeof(cmd)) ||
+                         !WriteFlows(cmd_fds[k], inbox[k]);
+            }
+            for (int k = b; k < e && !failed; k++)
+                failed = !ReadAll(rep_fds[k], &reports[k], sizeof(reports[k])) ||
+                         !ReadFlows(rep_fds[k], reports[k].flows, sent);
+        }
+        if (failed)
+            break;
+
+        windows++;
+        exchanged += sent.size();
+        for (auto &in : inbox)
+            in.clear();
+        for (auto &f : sent)
+            inbox[f.owner].push_back(f);
+
+        // 所有分区都已停止或空闲，且没有仍在链路上的数据
+        bool quiet = sent.empty();
+        for (auto &r : reports)
+            quiet = quiet && r.status != PART_RUNNING && r.pending == 0;
+        if (quiet)
+            break;
+    }
+
+    for (int k = 0; k < chip_num; k++) {
+        if (!failed) {
+            PartitionCmd cmd = {PART_EXIT, 0, 0};
+            WriteAll(cmd_fds[k], &cmd, sizeof(cmd));
+        }
+        close(cmd_fds[k]);
+        close(rep_fds[k]);
+    }
+
+    int ret = failed ? -1 : 0;
+    for (int k = 0; k < chip_num; k++) {
+        if (failed)
+            kill(pids[k], SIGTERM);
+        int status;
+        waitpid(pids[k], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ret = -1;
+    }
+    if (failed)
+        cout << "[ERROR] A chip partition exited unexpectedly, see "
+                "partition_<id>/build/stdout.log\n";
+
+    double wall = chrono::duration<double>(chrono::steady_clock::now() -
+                                           wall_start)
+                      .count();
+    const char *status_name[] = {"running", "idle", "stopped"};
+    ofstream file("parallel_summary.csv", ios::trunc);
+    file << "chip,status,end_ns,cpu_seconds\n";
+    PrintBar(48);
+    cout << "| " << std::left << std::setw(44) << "Chip partitions" << " |\n";
+    PrintBar(48);
+    for (int k = 0; k < chip_num; k++) {
+        auto &r = reports[k];
+        file << k << "," << status_name[r.status] << "," << r.now << ","
+             << r.cpu_seconds << "\n";
+        cout << "| chip " << std::left << std::setw(5) << k << "| "
+             << std::setw(8) << status_name[r.status] << "| " << std::right
+             << std::setw(16) << (u_int64_t)r.now << "ns | " << std::setw(5)
+             << (int)r.cpu_seconds << "s |\n";
+    }
+    PrintBar(48);
+    file.close();
+
+    cout << "[PARALLEL] windows " << windows << ", exchanged flows "
+         << exchanged << ", wall " << wall << " s\n";
+    return ret;
+}
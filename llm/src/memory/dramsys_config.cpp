@@ -0,0 +1,169 @@
+#include "memory/dramsys_config.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace std;
+
+// 推导出的子配置，key 为 "<子目录>/<文件名>"
+static map<string, json> derived_configs;
+// 已经解析过的顶层配置，避免每个核都重新读取
+static map<string, ::DRAMSys::Config::Configuration> config_cache;
+
+static json ReadJsonFile(const filesystem::path &path) {
+    ifstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open file " + path.string());
+    return json::parse(file, nullptr, true, true);
+}
+
+json BuildDFMemSpec(string base_memspec, int nbr_devices) {
+    json j = ReadJsonFile(base_memspec);
+    j["memspec"]["memarchitecturespec"]["nbrOfDevices"] = nbr_devices;
+    return j;
+}
+
+json BuildGPUMemSpec(int nbr_devices) {
+    json j = {
+        {"memspec",
+         {{"memarchitecturespec",
+           {{"burstLength", 4},
+            {"dataRate", 2},
+            {"nbrOfBankGroups", 4},
+            {"nbrOfBanks", 16},
+            {"nbrOfColumns", 128},
+            {"nbrOfPseudoChannels", 2},
+            {"nbrOfRows", 32768},
+            {"width", 64},
+            {"nbrOfDevices", nbr_devices},
+            {"nbrOfChannels", 1}}},
+          {"memoryId", "https://www.computerbase.de/2019-05/"
+                       "amd-memory-tweak-vram-oc/#bilder"},
+          {"memoryType", "HBM2"},
+          {"memtimingspec",
+           {{"CCDL", 3},   {"CCDS", 2},   {"CKE", 8},     {"DQSCK", 1},
+            {"FAW", 16},   {"PL", 0},     {"RAS", 28},    {"RC", 42},
+            {"RCDRD", 12}, {"RCDWR", 6},  {"REFI", 3900}, {"REFISB", 244},
+            {"RFC", 220},  {"RFCSB", 96}, {"RL", 17},     {"RP", 14},
+            {"RRDL", 6},   {"RRDS", 4},   {"RREFD", 8},   {"RTP", 5},
+            {"RTW", 18},   {"WL", 7},     {"WR", 14},     {"WTRL", 9},
+            {"WTRS", 4},   {"XP", 8},     {"XS", 216},    {"tCK", 1000}}}}}};
+    return j;
+}
+
+static vector<int> BitRange(int start, int count) {
+    vector<int> bits;
+    for (int i = 0; i < count; i++)
+        bits.push_back(start + i);
+    return bits;
+}
+
+// ROW_BIT 占 15 位，最高位必须 <= 34
+json BuildGPUAddressMapping(int n) {
+    json addressmapping;
+    addressmapping["BYTE_BIT"] = BitRange(0, n);
+    addressmapping["COLUMN_BIT"] = BitRange(n, 7);
+    addressmapping["BANK_BIT"] = BitRange(n + 22, 2);
+    addressmapping["BANKGROUP_BIT"] = BitRange(n + 24, 2);
+    addressmapping["PSEUDOCHANNEL_BIT"] = BitRange(n + 26, 1);
+    addressmapping["ROW_BIT"] = BitRange(n + 7, 15);
+
+    json root;
+    root["addressmapping"] = addressmapping;
+    return root;
+}
+
+json BuildDFAddressMapping(int n) {
+    json addressmapping;
+    addressmapping["BYTE_BIT"] = BitRange(0, n);
+    addressmapping["COLUMN_BIT"] = BitRange(n, 10);
+    addressmapping["BANK_BIT"] = BitRange(n + 27, 2);
+    addressmapping["BANKGROUP_BIT"] = BitRange(n + 25, 2);
+    addressmapping["ROW_BIT"] = BitRange(n + 10, 15);
+
+    json root;
+    root["addressmapping"] = addressmapping;
+    return root;
+}
+
+void InitDerivedDramConfigs(string resource_directory, int df_dram_bw,
+                            int gpu_bw) {
+    derived_configs.clear();
+    config_cache.clear();
+
+    filesystem::path base(resource_directory);
+
+    // 数据流模式：dram 带宽由设备数决定
+    derived_configs["memspec/JEDEC_4Gb_DDR4-1866_8bit_DF.json"] =
+        BuildDFMemSpec((base / "memspec" / "JEDEC_4Gb_DDR4-1866_8bit_A.json")
+                           .string(),
+                       df_dram_bw);
+    derived_configs["addressmapping/am_ddr4_8x4Gbx8_df.json"] =
+        BuildDFAddressMapping(static_cast<int>(log2(df_dram_bw)));
+
+    // gpu 模式：每个设备 32 个通道
+    if (gpu_bw == 512 || gpu_bw == 1024 || gpu_bw == 256 || gpu_bw == 128 ||
+        gpu_bw == 64) {
+        derived_configs["memspec/HBM2_GPU.json"] =
+            BuildGPUMemSpec(32 * gpu_bw / 512);
+        derived_configs["addressmapping/am_hbm2_gpu.json"] =
+            BuildGPUAddressMapping(static_cast<int>(log2(gpu_bw)) - 1);
+    }
+}
+
+void DumpDerivedDramConfigs(string dump_dir) {
+    for (auto &pair : derived_configs) {
+        filesystem::path path = filesystem::path(dump_dir) / pair.first;
+        filesystem::create_directories(path.parent_path());
+
+        ofstream file(path);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot write to file " << path << endl;
+            continue;
+        }
+        file << pair.second.dump(4) << endl;
+        cout << "[DRAMSys] Derived config dumped to " << path << endl;
+    }
+}
+
+::DRAMSys::Config::Configuration
+LoadDramSysConfig(std::string_view configuration,
+                  std::string_view resource_directory) {
+    string key = string(configuration) + "|" + string(resource_directory);
+    auto it = config_cache.find(key);
+    if (it != config_cache.end())
+        return it->second;
+
+    using namespace ::DRAMSys::Config;
+    json simulation = ReadJsonFile(string(configuration))
+                          .at(string(Configuration::KEY));
+
+    // 顶层配置中以文件名形式给出的子配置，优先使用推导版本，否则从磁盘读取
+    auto resolve = [&](std::string_view sub_key, std::string_view sub_dir) {
+        if (!simulation.contains(string(sub_key)))
+            return;
+        auto &entry = simulation[string(sub_key)];
+        if (!entry.is_string())
+            return;
+
+        string name = string(sub_dir) + "/" + entry.get<string>();
+        auto derived = derived_configs.find(name);
+        if (derived != derived_configs.end())
+            entry = derived->second.at(string(sub_key));
+        else
+            entry = ReadJsonFile(filesystem::path(resource_directory) / name)
+                        .at(string(sub_key));
+    };
+
+    resolve(MemSpec::KEY, MemSpec::SUB_DIR);
+    resolve(AddressMapping::KEY, AddressMapping::SUB_DIR);
+    resolve(McConfig::KEY, McConfig::SUB_DIR);
+    resolve(SimConfig::KEY, SimConfig::SUB_DIR);
+
+    Configuration config = simulation.get<Configuration>();
+    config_cache.emplace(key, config);
+    return config;
+}
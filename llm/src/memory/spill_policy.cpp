@@ -0,0 +1,58 @@
+#include "memory/sram/spill_policy.h"
+#include "common/config.h"
+#include "utils/print_utils.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+
+// 与行为级dram相同的带宽估计，得到重新读入的时间（ns）
+static double reload_ns(int cid, int bytes) {
+    return (double)bytes / (15.0 * GetCoreHWConfig(cid)->dram_bw / 8);
+}
+
+int ChooseSpillVictim(SPILL_POLICY policy, int cid,
+                      const vector<Spill_candidate> &candidates, int need,
+                      bool partial) {
+    int victim = -1;
+    double best = 0;
+    for (int i = 0; i < candidates.size(); i++) {
+        const Spill_candidate &c = candidates[i];
+
+        // 分数越小越先被spill
+        double score;
+        switch (policy) {
+        case SPILL_BELADY:
+            score = -c.next_use;
+            break;
+        case SPILL_COST: {
+            // 下一次使用越远，重新读入越容易与之前的计算重叠
+            int bytes = partial ? min(c.resident, need) : c.resident;
+            score = reload_ns(cid, bytes) / (c.next_use + 1);
+            break;
+        }
+        default:
+            score = c.record;
+            break;
+        }
+
+        // 分数相同时按LRU
+        if (victim == -1 || score < best ||
+            (score == best && c.record < candidates[victim].record)) {
+            victim = i;
+            best = score;
+        }
+    }
+    return victim;
+}
+
+SPILL_POLICY ParseSpillPolicy(const string &name) {
+    if (name == "lru")
+        return SPILL_LRU;
+    if (name == "belady")
+        return SPILL_BELADY;
+    if (name == "cost")
+        return SPILL_COST;
+
+    ARGUS_EXIT("Unknown spill policy ", name, ", use lru/belady/cost.\n");
+    return SPILL_LRU;
+}
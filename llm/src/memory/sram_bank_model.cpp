@@ -0,0 +1,95 @@
+#include "memory/sram/sram_bank_model.h"
+#include "defs/const.h"
+#include "utils/print_utils.h"
+
+#include <algorithm>
+#include <numeric>
+
+SramBankModel::SramBankModel(const string &name, int read_ports,
+                             int write_ports)
+    : read_ports(read_ports), write_ports(write_ports),
+      read_free(SRAM_BANKS * read_ports, 0),
+      write_free(SRAM_BANKS * write_ports, 0) {
+    accesses = STATS.counter(name + ".accesses");
+    words = STATS.counter(name + ".words");
+    conflict_ns = STATS.counter(name + ".bank_conflict_ns");
+    contention_ns = STATS.counter(name + ".port_contention_ns");
+}
+
+void SramBankModel::bank_counts(const Sram_access &acc,
+                                array<u_int64_t, SRAM_BANKS> &counts) {
+    counts.fill(0);
+    if (acc.rows <= 0 || acc.width <= 0)
+        return;
+
+    // 每行中完整的 SRAM_BANKS 个字恰好覆盖每个bank一次
+    u_int64_t full = acc.width / SRAM_BANKS;
+    for (int b = 0; b < SRAM_BANKS; b++)
+        counts[b] += full * acc.rows;
+
+    int part = acc.width % SRAM_BANKS;
+    if (part == 0)
+        return;
+
+    // 剩余的part个字：第k行从bank (base + k * stride) % SRAM_BANKS 开始
+    int step = ((acc.stride % SRAM_BANKS) + SRAM_BANKS) % SRAM_BANKS;
+    int period = SRAM_BANKS / std::gcd(step, SRAM_BANKS);
+    int first = acc.base % SRAM_BANKS;
+    u_int64_t cycles = acc.rows / period;
+    int tail = acc.rows % period;
+    for (int k = 0; k < period && k < acc.rows; k++) {
+        u_int64_t times = cycles + (k < tail ? 1 : 0);
+        int start = (first + k * step) % SRAM_BANKS;
+        for (int j = 0; j < part; j++)
+            counts[(start + j) % SRAM_BANKS] += times;
+    }
+}
+
+u_int64_t SramBankModel::access(u_int64_t now, const Sram_access &acc,
+                                bool commit) {
+    array<u_int64_t, SRAM_BANKS> counts;
+    bank_counts(acc, counts);
+
+    int ports = acc.write ? write_ports : read_ports;
+    vector<u_int64_t> &free = acc.write ? write_free : read_free;
+    u_int64_t latency = acc.write ? RAM_WRITE_LATENCY : RAM_READ_LATENCY;
+
+    u_int64_t total = 0, busiest = 0, finish = now;
+    for (int b = 0; b < SRAM_BANKS; b++) {
+        if (counts[b] == 0)
+            continue;
+        total += counts[b];
+        busiest = max(busiest, counts[b]);
+
+        // 占用该bank最早空闲的端口
+        u_int64_t *port = &free[b * ports];
+        int p = min_element(port, port + ports) - port;
+        u_int64_t end = max(now, port[p]) + counts[b] * latency;
+        finish = max(finish, end);
+        if (commit)
+            port[p] = end;
+    }
+    if (total == 0)
+        return 0;
+
+    if (commit) {
+        // ideal：字均匀分布在所有bank上；isolated：没有其他访问时的完成时间
+        u_int64_t ideal = (total + SRAM_BANKS - 1) / SRAM_BANKS * latency;
+        u_int64_t isolated = busiest * latency;
+        accesses->inc();
+        words->inc(total);
+        conflict_ns->inc(isolated - ideal);
+        contention_ns->inc(finish - now - isolated);
+    }
+    return finish - now;
+}
+
+SRAM_MODEL ParseSramModel(const string &name) {
+    if (name == "row")
+        return SRAM_MODEL_ROW;
+    if (name == "bank")
+        return SRAM_MODEL_BANK;
+
+    ARGUS_EXIT("Unknown sram model ", name, ", use row/bank.\n");
+    return SRAM_MODEL_ROW;
+}
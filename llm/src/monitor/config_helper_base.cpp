@@ -7,6 +7,7 @@
 #include "common/msg.h"
 #include "defs/global.h"
 #include "monitor/config_helper_base.h"
+#include "utils/router_utils.h"
 
 using json = nlohmann::json;
 
@@ -39,7 +40,7 @@ void config_helper_base::fill_queue_data(queue<Msg> *q) {
     // | output area | input (last core's output) | input (get from host) |
     // 可以复用delta offset这个map
     for (auto config : coreconfigs) {
-        int index = config.id / GRID_X;
+        int index = HostPortOf(config.id);
         int pkg_index = 0;
         int core_prim_cnt = 0;
 
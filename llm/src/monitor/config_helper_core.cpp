@@ -1,5 +1,4 @@
 #include "nlohmann/json.hpp"
-#include <SFML/Graphics.hpp>
 #include <algorithm>
 #include <sstream>
 
@@ -10,6 +9,7 @@
 #include "utils/display_utils.h"
 #include "utils/msg_utils.h"
 #include "utils/prim_utils.h"
+#include "utils/router_utils.h"
 #include "utils/system_utils.h"
 
 using json = nlohmann::json;
@@ -63,11 +63,8 @@ void config_helper_core::printSelf() {
 }
 
 void config_helper_core::random_core(string font_ttf) {
-    int o2r[GRID_SIZE];
-    int r2o[GRID_SIZE];
-    for (int i = 0; i < GRID_SIZE; i++) {
-        o2r[i] = r2o[i] = -1;
-    }
+    vector<int> o2r(GRID_SIZE, -1);
+    vector<int> r2o(GRID_SIZE, -1);
 
     std::srand(std::time(nullptr));
     for (auto config : coreconfigs) {
@@ -81,6 +78,99 @@ void config_helper_core::random_core(string font_ttf) {
         cout << "id " << id << " -> rand " << rand << endl;
     }
 
+    // 其余编号（可能作为tag使用）依次映射到空闲位置，保证o2r是一个排列
+    for (int id = 0, pos = 0; id < GRID_SIZE; id++) {
+        if (o2r[id] != -1)
+            continue;
+        while (r2o[pos] != -1)
+            pos++;
+        o2r[id] = pos;
+        r2o[pos] = id;
+    }
+
+    remap_cores(o2r, font_ttf);
+}
+
+vector<Comm_edge> config_helper_core::comm_graph() {
+    vector<Comm_edge> edges;
+
+    for (auto &config : coreconfigs) {
+        for (int w = 0; w < config.worklist.size(); w++) {
+            auto &work = config.worklist[w];
+
+            // 复制原语的核在展开之前没有原语，使用被复制核的原语
+            vector<PrimBase *> *prims = &work.prims;
+            if (prims->empty() && config.prim_copy != -1) {
+                for (auto &target : coreconfigs)
+                    if (target.id == config.prim_copy &&
+                        w < target.worklist.size())
+                        prims = &target.worklist[w].prims;
+            }
+
+            // 与calculate_address相同，取最后一个计算原语的输出
+            int output_size = 0;
+            for (auto p : *prims)
+                if (p->prim_type & PRIM_TYPE::COMP_PRIM)
+                    output_size = ((CompBase *)p)->out_size;
+
+            for (auto &cast : work.cast) {
+                if (cast.dest < 0 || cast.dest >= GRID_SIZE ||
+                    cast.dest == config.id)
+                    continue;
+
+                int times = cast.loopout == FALSE  ? config.loop - 1
+                            : cast.loopout == TRUE ? 1
+                                                   : config.loop;
+                if (times <= 0)
+                    continue;
+
+                edges.push_back(Comm_edge(config.id, cast.dest,
+                                          (double)output_size /
+                                              max(cast.weight, 1) * times));
+            }
+        }
+    }
+
+    // host推入的初始数据
+    for (auto &source : source_info)
+        edges.push_back(
+            Comm_edge(GRID_SIZE, source.first, source.second * sizeof(float)));
+
+    return edges;
+}
+
+void config_helper_core::optimize_placement(const set<int> &pinned_ids,
+                                            int iters, double balance,
+                                            unsigned seed, string font_ttf) {
+    // 位于host端口router上的source直接接收host的数据，保持不动
+    set<int> pinned = pinned_ids;
+    for (auto &source : source_info)
+        if (IsHostPort(source.first))
+            pinned.insert(source.first);
+
+    Placement_optimizer optimizer(comm_graph(), pinned, balance);
+
+    vector<int> identity(GRID_SIZE);
+    for (int i = 0; i < GRID_SIZE; i++)
+        identity[i] = i;
+
+    double hops_before, load_before, hops_after, load_after;
+    optimizer.cost(identity, hops_before, load_before);
+    vector<int> o2r = optimizer.run(iters, seed);
+    optimizer.cost(o2r, hops_after, load_after);
+
+    cout << "[PLACEMENT] weighted hops " << hops_before << " -> "
+         << hops_after << ", max link load " << load_before << " -> "
+         << load_after << " bytes\n";
+    for (auto &config : coreconfigs)
+        if (o2r[config.id] != config.id)
+            cout << "id " << config.id << " -> " << o2r[config.id] << endl;
+
+    remap_cores(o2r, font_ttf);
+}
+
+void config_helper_core::remap_cores(const vector<int> &o2r,
+                                     string font_ttf) {
     // 改写
     for (auto &config : coreconfigs) {
         int oid = config.id;
@@ -93,7 +183,7 @@ void config_helper_core::random_core(string font_ttf) {
 
         for (auto &work : config.worklist) {
             if (work.recv_tag < GRID_SIZE)
-                work.recv_tag = o2r[oid];
+                work.recv_tag = o2r[work.recv_tag];
             for (auto &cast : work.cast) {
                 if (cast.tag < GRID_SIZE && cast.dest >= 0)
                     cast.tag = o2r[cast.tag];
@@ -142,13 +232,20 @@ void config_helper_core::random_core(string font_ttf) {
         core_id++;
     }
 
-    plot_dataflow(cores, source_ids, font_ttf);
+    save_dataflow(cores, source_ids, "core_data_flow.json");
+#if USE_CARIO == 1
+    if (!g_headless)
+        plot_dataflow(cores, source_ids, font_ttf);
+#endif
 }
 
 config_helper_core::config_helper_core(string filename, string font_ttf,
                                        int config_chip_id) {
     cout << "Loading config file " << filename << endl;
-    plot_dataflow(filename, font_ttf);
+#if USE_CARIO == 1
+    if (!g_headless)
+        plot_dataflow(filename, font_ttf);
+#endif
     ifstream jfile(filename);
     if (!jfile.is_open()) {
         cout << "[ERROR] Cannot open config file " << filename << endl;
@@ -171,7 +268,10 @@ config_helper_core::config_helper_core(string filename, string font_ttf,
     SetParamFromJson(config_vars, "B", &batch_size, 1);
     SetParamFromJson(config_vars, "T", &seq_len, 128);
 
-    auto config_source = j["source"];
+    // 多芯片时每个芯片可以有自己的source，否则使用顶层的source
+    auto config_source = j["chips"][config_chip_id].contains("source")
+                             ? j["chips"][config_chip_id]["source"]
+                             : j["source"];
     end_count_sources = 0;
     for (auto source : config_source) {
         int source_loop = 0;
@@ -194,8 +294,26 @@ config_helper_core::config_helper_core(string filename, string font_ttf,
         coreconfigs.push_back(core);
     }
 
-    if (j.contains("random") && j["random"]) {
+    // 核的放置：random随机打乱，optimize按照通信量优化，默认保持config中的编号
+    string placement = j.contains("placement") ? j["placement"].get<string>()
+                                               : "";
+    if (placement == "random" || (j.contains("random") && j["random"])) {
         random_core(font_ttf);
+    } else if (placement == "optimize") {
+        int iters = 0, seed = 0;
+        SetParamFromJson(j, "placement_iters", &iters, 20000);
+        SetParamFromJson(j, "placement_seed", &seed, 1);
+        double balance = j.value("placement_balance", 1.0);
+
+        set<int> pinned;
+        if (j.contains("pinned"))
+            for (int id : j["pinned"])
+                pinned.insert(id);
+
+        optimize_placement(pinned, iters, balance, seed, font_ttf);
+    } else if (placement != "") {
+        cout << "[ERROR] Unknown placement " << placement
+             << ", use random/optimize.\n";
     }
 
     SetParamFromJson(j, "pipeline", &pipeline, 1);
@@ -244,7 +362,7 @@ config_helper_core::config_helper_core(string filename, string font_ttf,
 
 void config_helper_core::fill_queue_config(queue<Msg> *q) {
     for (auto &config : coreconfigs) {
-        int index = config.id / GRID_X;
+        int index = HostPortOf(config.id);
 
         auto build_msgs = [&](const vector<PrimBase *> &prims,
                               bool adjust_recv = false) {
@@ -348,12 +466,32 @@ void config_helper_core::generate_prims(int i) {
         }
     };
 
-    auto add_sends = [&](vector<PrimBase *> &prims, const vector<Cast> &casts,
+    auto add_sends = [&](vector<PrimBase *> &prims, const CoreJob &work,
                          bool loopout) {
-        for (auto &ca : casts) {
+        vector<Cast> casts;
+        for (auto &ca : work.cast) {
             if ((loopout && ca.loopout == FALSE) ||
                 (!loopout && ca.loopout == TRUE))
                 continue;
+            casts.push_back(ca);
+        }
+
+        // 同一份数据发往多个核时使用多播：逐个握手，收齐ack之后只注入一次数据
+        int group = mcast_group(c->id, work, casts);
+        if (group) {
+            for (auto &ca : casts)
+                prims.push_back(
+                    new Send_prim(SEND_TYPE::SEND_REQ, ca.dest, ca.tag));
+            prims.push_back(
+                new Recv_prim(RECV_TYPE::RECV_ACK, 0, casts.size()));
+            Send_prim *data =
+                new Send_prim(SEND_TYPE::SEND_DATA, casts[0].dest, casts[0].tag);
+            data->mcast_id = group;
+            prims.push_back(data);
+            return;
+        }
+
+        for (auto &ca : casts) {
             prims.push_back(
                 new Send_prim(SEND_TYPE::SEND_REQ, ca.dest, ca.tag));
             prims.push_back(new Recv_prim(RECV_TYPE::RECV_ACK));
@@ -372,7 +510,7 @@ void config_helper_core::generate_prims(int i) {
         add_recv(work.prims_in_loop, (is_source && w == 0), work.recv_tag,
                  work.recv_cnt);
         add_comps(work.prims_in_loop, work.prims);
-        add_sends(work.prims_in_loop, work.cast, false);
+        add_sends(work.prims_in_loop, work, false);
 
         // 最后循环
         add_recv(work.prims_last_loop, (is_source && w == 0 && c->loop == 1),
@@ -386,7 +524,7 @@ void config_helper_core::generate_prims(int i) {
             continue;
         }
 
-        add_sends(work.prims_last_loop, work.cast, true);
+        add_sends(work.prims_last_loop, work, true);
 
         if (w == c->worklist.size() - 1) {
             work.prims_last_loop.push_back(
@@ -395,6 +533,40 @@ void config_helper_core::generate_prims(int i) {
     }
 }
 
+int config_helper_core::mcast_group(int cid, const CoreJob &work,
+                                    const vector<Cast> &casts) {
+    if (!noc_multicast || casts.size() < 2)
+        return 0;
+    // 多播沿XY路由树复制，odd-even路由下XY路径不满足其转向规则
+    if (noc_routing == ROUTE_ODD_EVEN)
+        return 0;
+
+    // 每个cast发送不同标签的数据时不能多播
+    string output_label;
+    for (auto p : work.prims)
+        if (p->prim_type & PRIM_TYPE::COMP_PRIM)
+            output_label = p->prim_context->datapass_label_->outdata;
+    if (output_label.find(' ') != string::npos)
+        return 0;
+
+    // 接收方只接受与recv_tag相同的数据，除非recv_tag等于自身id
+    bool same_tag = true, tag_is_dest = true;
+    vector<int> dests;
+    for (auto &ca : casts) {
+        if (ca.dest < 0 || ca.dest == cid || ca.weight != casts[0].weight ||
+            find(dests.begin(), dests.end(), ca.dest) != dests.end())
+            return 0;
+
+        same_tag &= ca.tag == casts[0].tag;
+        tag_is_dest &= ca.tag == ca.dest;
+        dests.push_back(ca.dest);
+    }
+    if (!same_tag && !tag_is_dest)
+        return 0;
+
+    return RegisterMcastGroup(dests);
+}
+
 void config_helper_core::calculate_address(bool do_loop) {
     // 自动设置 send 和 receive 的地址
     for (int i = 0; i < coreconfigs.size(); i++) {
@@ -444,14 +616,17 @@ void config_helper_core::calculate_address(bool do_loop) {
                     if (temp->type != SEND_DATA)
                         continue;
 
-                    CalculatePacketNum(output_size, work.cast[index].weight,
-                                       (prim->datatype ? 2 : 1),
+                    // out_size 已经按照数据类型换算为字节数
+                    CalculatePacketNum(output_size, work.cast[index].weight, 1,
                                        temp->max_packet, temp->end_length);
 
                     temp->output_label = output_label_split.size() == 1
                                              ? output_label_split[0]
                                              : output_label_split[index];
-                    index++;
+                    // 多播的一个SEND_DATA对应组内所有的cast
+                    index += temp->mcast_id
+                                 ? g_mcast_groups[temp->mcast_id].size()
+                                 : 1;
                 }
             }
         }
@@ -465,7 +640,7 @@ void config_helper_core::fill_queue_start(queue<Msg> *q) {
             cout << "Sending source to " << i << endl;
             int size = source.second;
 
-            int index = i / GRID_X;
+            int index = HostPortOf(i);
             int send_offset = 0;
             for (auto config : coreconfigs) {
                 if (config.id == i)
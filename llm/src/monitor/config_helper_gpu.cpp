@@ -1,9 +1,14 @@
 #include "monitor/config_helper_gpu.h"
 #include "common/config.h"
+#include "prims/norm_prims.h"
 #include "utils/config_utils.h"
 #include "utils/prim_utils.h"
+#include "utils/print_utils.h"
+#include "utils/router_utils.h"
 #include "utils/system_utils.h"
 
+#include <algorithm>
+
 config_helper_gpu::config_helper_gpu(string filename, string font_ttf,
                                      int config_chip_id) {
     cout << "Loading config file " << filename << endl;
@@ -19,14 +24,10 @@ config_helper_gpu::config_helper_gpu(string filename, string font_ttf,
     }
 
     auto config_streams = j["chips"][0]["streams"];
-    if (config_streams.size() != 1) {
-        cout << "[ERROR] more than 1 stream is not supported." << endl;
-        sc_stop();
-    }
-
     for (int i = 0; i < config_streams.size(); i++) {
         StreamConfig stream = config_streams[i];
         streams.push_back(stream);
+        stream_states.push_back(GpuStreamState());
     }
 
     // 将stream的原语放入coreconfigs中
@@ -40,7 +41,7 @@ config_helper_gpu::config_helper_gpu(string filename, string font_ttf,
         coreconfigs.push_back(core);
     }
 
-    // 处理stream的原语
+    // 处理stream的原语，coreconfigs只用于下发权重与打印，实际的CTA在运行时调度
     for (int i = 0; i < streams.size(); i++) {
         auto stream = streams[i];
         auto prims = stream.prims;
@@ -62,107 +63,260 @@ config_helper_gpu::config_helper_gpu(string filename, string font_ttf,
         }
     }
 
-    // 处理收发原语（启动）
-    for (int i = 0; i < coreconfigs.size(); i++) {
-        generate_prims(i);
-    }
-
     end_cores = GRID_SIZE;
     pipeline = 1;
     g_recv_ack_cnt = 0;
     g_recv_done_cnt = 0;
-    gpu_index = 0;
-    done_loop = 0;
+
+    sm_stream.assign(GRID_SIZE, -1);
+    sm_ctas.assign(GRID_SIZE, 0);
+    config_seq.assign(GRID_SIZE, 0);
+    rr_stream = 0;
+    ack_rounds = 0;
+    started = false;
+
+    // 所有核先接收权重，随后第一批CTA等待start数据
+    for (int i = 0; i < GRID_SIZE; i++)
+        generate_prims(i);
+    dispatch();
+
+    // 没有分到CTA的核，只需要接收权重
+    for (auto &m : temp_config) {
+        if (sm_stream[m.des_] == -1) {
+            m.is_end_ = true;
+            m.refill_ = false;
+        }
+    }
 
     printSelf();
 }
 
 void config_helper_gpu::fill_queue_config(queue<Msg> *q) {
-    for (auto config : coreconfigs) {
-        int index = config.id / GRID_X;
-        vector<Msg> single_rep;
+    // 将temp中的所有内容搬运到q中，并清空temp
+    for (auto msg : temp_config) {
+        int index = HostPortOf(msg.des_);
+        q[index].push(msg);
+    }
 
-        auto recv_weight = new Recv_prim(RECV_TYPE::RECV_WEIGHT,
-                                         config.worklist[0].recv_tag, 0);
-        q[index].push(Msg(false, MSG_TYPE::CONFIG, 1, config.id,
-                          recv_weight->serialize()[0]));
+    temp_config.clear();
+    config_seq.assign(GRID_SIZE, 0);
+}
 
-        vector<Stage> batchInfo;
-        for (int i = 0; i < GetDefinedParam("B"); i++)
-            batchInfo.push_back(Stage(i + 1, PREFILL, GetDefinedParam("T")));
+void config_helper_gpu::generate_prims(int i) {
+    auto recv_weight = new Recv_prim(RECV_TYPE::RECV_WEIGHT,
+                                     coreconfigs[i].worklist[0].recv_tag, 0);
+    temp_config.push_back(Msg(false, MSG_TYPE::CONFIG, ++config_seq[i], i,
+                              recv_weight->serialize()[0]));
+}
 
-        PrimBase *set_batch = new Set_batch(batchInfo, true);
-        single_rep.push_back(Msg(false, MSG_TYPE::CONFIG, single_rep.size() + 1,
-                                 config.id, set_batch->serialize()[0]));
+bool config_helper_gpu::stream_ready(int s) {
+    auto &state = stream_states[s];
+    auto &stream = streams[s];
 
-        for (auto work : config.worklist) {
-            for (auto prim : work.prims_last_loop) {
-                auto segments = prim->serialize();
-                for (int seg = 0; seg < segments.size(); seg++)
-                    single_rep.push_back(Msg(false, MSG_TYPE::CONFIG,
-                                             single_rep.size() + 1, config.id,
-                                             seg == segments.size() - 1,
-                                             segments[seg]));
+    if (state.finished)
+        return false;
+
+    GpuBase *prim = (GpuBase *)stream.prims[state.prim_index];
+    if (state.issued_ctas >= prim->req_sm)
+        return false;
+
+    // 刚开始执行时，需要等待依赖的stream全部完成
+    if (state.loop == 0 && state.prim_index == 0) {
+        for (auto id : stream.depends) {
+            for (int d = 0; d < streams.size(); d++) {
+                if (streams[d].id == id && !stream_states[d].finished)
+                    return false;
             }
         }
+    }
 
-        for (int i = 0; i < streams[0].loop; i++) {
-            for (int j = 1; j <= single_rep.size(); j++) {
-                Msg m = single_rep[j - 1];
-                m.seq_id_ = j + single_rep.size() * i + 1;
+    // 第loop轮的原语需要等待事件被记录loop+1次
+    for (auto &e : stream.wait_events) {
+        if (e.second == state.prim_index &&
+            event_records[e.first] < state.loop + 1)
+            return false;
+    }
 
-                if (i == streams[0].loop - 1 && j == single_rep.size()) {
-                    m.is_end_ = true;
-                    m.refill_ = false;
-                }
+    return true;
+}
+
+int config_helper_gpu::stream_sm_limit(int s) {
+    int limit = streams[s].sms;
+    if (limit <= 0 || limit > GRID_SIZE)
+        limit = GRID_SIZE;
+    return limit;
+}
 
-                q[index].push(m);
+void config_helper_gpu::dispatch() {
+    // 轮询所有ready的stream，每次给一个stream分配一个空闲SM，
+    // 使得多个stream交替占用空闲的SM
+    bool progress = true;
+    while (progress) {
+        progress = false;
+
+        for (int k = 0; k < streams.size(); k++) {
+            int s = (rr_stream + k) % streams.size();
+            if (!stream_ready(s))
+                continue;
+
+            auto &state = stream_states[s];
+            int limit = stream_sm_limit(s);
+            if (state.running_sms >= limit)
+                continue;
+
+            int sm = -1;
+            int idle = 0;
+            for (int c = 0; c < GRID_SIZE; c++) {
+                if (sm_stream[c] == -1) {
+                    if (sm == -1)
+                        sm = c;
+                    idle++;
+                }
+            }
+            if (sm == -1)
+                break;
+
+            // 每个SM分到剩余CTA在该stream仍然可用的SM上的平均份额
+            int req = ((GpuBase *)streams[s].prims[state.prim_index])->req_sm;
+            int rest = req - state.issued_ctas;
+            int avail = min(limit - state.running_sms, idle);
+            int ctas = (rest + avail - 1) / avail;
+
+            if (streams.size() == 1) {
+                // 单stream时原语开始执行时SM全部空闲，第k个SM执行CTA
+                // k, k + n, k + 2n ...，与逐原语下发的分配方式相同
+                int n = min(req, limit);
+                dispatch_ctas(s, sm, state.issued_sms, ctas, n);
+            } else {
+                dispatch_ctas(s, sm, state.issued_ctas, ctas);
             }
+            progress = true;
         }
+
+        if (streams.size())
+            rr_stream = (rr_stream + 1) % streams.size();
     }
 }
 
-void config_helper_gpu::generate_prims(int i) {
-    CoreConfig *c = &coreconfigs[i];
-
-    for (auto &work : c->worklist) {
-        // 不向in_loop推入任何原语，只操作last_loop
-        work.prims_last_loop.push_back(
-            new Recv_prim(RECV_TYPE::RECV_START, work.recv_tag, work.recv_cnt));
+void config_helper_gpu::dispatch_ctas(int s, int sm, int first_cta,
+                                      int cta_num, int stride) {
+    auto &state = stream_states[s];
+    GpuBase *prim = (GpuBase *)streams[s].prims[state.prim_index];
+
+    LOG_VERBOSE(1, sm,
+                "[GPU STREAM] stream " << streams[s].id << " prim "
+                                       << state.prim_index << " ctas "
+                                       << first_cta << "-"
+                                       << first_cta + (cta_num - 1) * stride
+                                       << " stride " << stride);
+
+    state.issued_ctas += cta_num;
+    state.issued_sms++;
+    state.running_sms++;
+    sm_stream[sm] = s;
+    sm_ctas[sm] = cta_num;
+
+    // 第一批CTA需要等待权重下发完毕之后的start数据
+    if (!started) {
+        PrimBase *recv_start = new Recv_prim(RECV_TYPE::RECV_START, sm, 1);
+        temp_config.push_back(Msg(false, MSG_TYPE::CONFIG, ++config_seq[sm],
+                                  sm, recv_start->serialize()[0]));
+    }
 
-        for (auto prim : work.prims) {
-            GpuBase *gp = (GpuBase *)prim;
-            int sms = gp->req_sm;
+    // 第一轮为prefill，之后的loop为decode
+    vector<Stage> batchInfo;
+    for (int i = 0; i < GetDefinedParam("B"); i++) {
+        if (state.loop == 0)
+            batchInfo.push_back(Stage(i + 1, PREFILL, GetDefinedParam("T")));
+        else
+            batchInfo.push_back(Stage(i + 1, DECODE, 1));
+    }
+    PrimBase *set_batch = new Set_batch(batchInfo);
+    temp_config.push_back(Msg(false, MSG_TYPE::CONFIG, ++config_seq[sm], sm,
+                              set_batch->serialize()[0]));
+
+    PrimBase *set_addr = PrimFactory::getInstance().createPrim("Set_addr");
+    auto label = set_addr->prim_context->datapass_label_;
+    for (int i = 0; i < MAX_SPLIT_NUM; i++)
+        label->indata[i] = prim->prim_context->datapass_label_->indata[i];
+    label->outdata = prim->prim_context->datapass_label_->outdata;
+
+    for (int i = 0; i < cta_num; i++) {
+        int cta = first_cta + i * stride;
+        // Set_addr 的label 指向其后面的那条原语
+        temp_config.push_back(Msg(false, MSG_TYPE::CONFIG, ++config_seq[sm],
+                                  sm, set_addr->serialize()[0]));
+
+        prim->fetch_index = cta;
+        auto segments = prim->serialize();
+        for (int seg = 0; seg < segments.size(); seg++)
+            temp_config.push_back(Msg(false, MSG_TYPE::CONFIG,
+                                      ++config_seq[sm], sm,
+                                      seg == segments.size() - 1,
+                                      segments[seg]));
+        prim->fetch_index = 0;
+    }
 
-            // 只需要看单个原语重复次数
-            int repeat = sms / GRID_SIZE + (sms % GRID_SIZE > i);
+    // 发送DONE信号
+    PrimBase *send_done = new Send_prim(SEND_TYPE::SEND_DONE);
+    Msg m = Msg(true, MSG_TYPE::CONFIG, ++config_seq[sm], sm,
+                send_done->serialize()[0]);
+    m.refill_ = false;
+    temp_config.push_back(m);
+}
 
-            for (int r = 0; r < repeat; r++) {
-                PrimBase *p = PrimFactory::getInstance().createPrim("Set_addr");
-                auto label = p->prim_context->datapass_label_;
+void config_helper_gpu::kernel_done(int s) {
+    auto &state = stream_states[s];
+    auto &stream = streams[s];
 
-                // Set_addr 的label 指向其后面的那条原语
-                for (int i = 0; i < MAX_SPLIT_NUM; i++) {
-                    label->indata[i] =
-                        gp->prim_context->datapass_label_->indata[i];
-                }
-                label->outdata = gp->prim_context->datapass_label_->outdata;
+    cout << "Config helper GPU: stream " << stream.id << " work done. "
+         << state.prim_index + 1 << " of " << stream.prims.size() << endl;
 
-                // 这里直接推入字符串形式的label，之后会在序列化的时候转化为整形label
-                work.prims_last_loop.push_back(p);
+    for (auto &e : stream.record_events) {
+        if (e.second == state.prim_index)
+            event_records[e.first]++;
+    }
 
-                gp->fetch_index = i + r * GRID_SIZE;
-                work.prims_last_loop.push_back(prim);
-            }
+    state.issued_ctas = 0;
+    state.issued_sms = 0;
+    state.done_ctas = 0;
+
+    if (++state.prim_index == stream.prims.size()) {
+        state.prim_index = 0;
+        state.loop++;
+        cout << "Config helper GPU: stream " << stream.id
+             << " one loop done. " << state.loop << " of " << stream.loop
+             << endl;
+
+        if (state.loop == stream.loop) {
+            state.finished = true;
+            state.finish_time = sc_time_stamp();
+            cout << "[STREAM DONE] Stream " << stream.id << " at "
+                 << sc_time_stamp() << endl;
         }
+    }
+}
 
-        work.prims_last_loop.push_back(new Send_prim(SEND_TYPE::SEND_DONE));
+void config_helper_gpu::report_streams() {
+    cout << "Config helper GPU: all work done.\n";
+    cout << "[CATCH TEST] " << sc_time_stamp() << endl;
+
+    ofstream outfile("simulation_result_gpu.txt", ios::app);
+    if (outfile.is_open()) {
+        outfile << "[CATCH TEST] " << sc_time_stamp() << "L1CACHESIZE "
+                << L1CACHESIZE << " L2CACHESIZE " << L2CACHESIZE
+                << " BANDWIDTH " << gpu_bw << endl;
+        for (int s = 0; s < streams.size(); s++)
+            outfile << "[STREAM] " << streams[s].id << " "
+                    << stream_states[s].finish_time << endl;
+        outfile.close();
+    } else {
+        cout << "Error: Unable to open file for writing timestamp." << endl;
     }
 }
 
 void config_helper_gpu::fill_queue_start(queue<Msg> *q) {
-    cout << "GPU fill start queue, phase " << gpu_index << "\n";
-    int sms = ((GpuBase *)(streams[0].prims[gpu_index]))->req_sm;
+    cout << "GPU fill start queue\n";
 
     for (auto stream : streams) {
         for (auto source : stream.sources) {
@@ -171,20 +325,21 @@ void config_helper_gpu::fill_queue_start(queue<Msg> *q) {
         }
     }
 
-    for (int i = 0; i < min(sms, GRID_SIZE); i++) {
-        auto config = coreconfigs[i];
-        int index = config.id / GRID_X;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        if (sm_stream[i] == -1)
+            continue;
+
+        int index = HostPortOf(i);
         int pkg_index = 0;
 
         // 这里相当于quick start，实际上也只有第一个原语需要初始数据
         sc_bv<128> d(0x1);
-        Msg m = Msg(true, MSG_TYPE::S_DATA, pkg_index + 1, config.id, 0,
-                    config.id, 0, d);
+        Msg m = Msg(true, MSG_TYPE::S_DATA, pkg_index + 1, i, 0, i, 0, d);
         m.source_ = GRID_SIZE;
         q[index].push(m);
     }
 
-    gpu_index++;
+    started = true;
 }
 
 void config_helper_gpu::printSelf() {
@@ -245,6 +400,12 @@ void config_helper_gpu::parse_ack_msg(Event_engine *event_engine, int flow_id,
     event_engine->add_event(this->name(), "Waiting Recv Ack", "E",
                             Trace_event_util());
 
+    // 开始执行之后，运行时下发的config不包含RECV_START，ack无需处理
+    if (started) {
+        g_recv_ack_cnt = 0;
+        return;
+    }
+
     if (g_recv_ack_cnt >= coreconfigs.size()) {
         notify_event->notify(CYCLE, SC_NS);
 
@@ -256,6 +417,7 @@ void config_helper_gpu::parse_ack_msg(Event_engine *event_engine, int flow_id,
         cout << "Config helper GPU: received all ack packets.\n";
 
         g_recv_ack_cnt = 0;
+        ack_rounds++;
     }
 }
 
@@ -266,55 +428,44 @@ void config_helper_gpu::parse_done_msg(Event_engine *event_engine,
 
     for (auto m : g_temp_done_msg) {
         int cid = m.source_;
+        int s = sm_stream[cid];
         cout << sc_time_stamp()
              << ": Config helper GPU: received done packet from " << cid
-             << ", total " << g_recv_done_cnt + 1 << ".\n";
+             << ", stream " << (s == -1 ? -1 : streams[s].id) << ".\n";
+
+        if (s == -1)
+            continue;
+
+        // 释放SM，当前原语的所有CTA完成之后，stream进入下一个原语
+        auto &state = stream_states[s];
+        state.done_ctas += sm_ctas[cid];
+        state.running_sms--;
+        sm_stream[cid] = -1;
+        sm_ctas[cid] = 0;
 
-        g_recv_done_cnt++;
-        // g_done_msg.push_back(m);
+        int req = ((GpuBase *)streams[s].prims[state.prim_index])->req_sm;
+        if (state.done_ctas >= req)
+            kernel_done(s);
     }
     g_temp_done_msg.clear();
     event_engine->add_event(this->name(), "Waiting Core busy", "E",
                             Trace_event_util());
 
-    auto prim = streams[0].prims[gpu_index - 1];
-    auto core_inv = ((GpuBase *)prim)->req_sm;
-
-    if (core_inv >= GRID_SIZE)
-        core_inv = GRID_SIZE;
-    if (g_recv_done_cnt >= core_inv) {
-        cout << "Config helper GPU: one work done. " << gpu_index << " of "
-             << streams[0].prims.size() << endl;
-
-        if (gpu_index == streams[0].prims.size()) {
-            gpu_index = 0;
-            done_loop++;
-            cout << "Config helper GPU: one loop done. " << done_loop << " of "
-                 << streams[0].loop << endl;
-
-            for (auto &pair : vtable) {
-                if (pair.first == "T")
-                    pair.second = 1;
-            }
+    bool all_done = true;
+    for (auto &state : stream_states)
+        all_done &= state.finished;
+    if (all_done) {
+        report_streams();
+        sc_stop();
+        return;
+    }
 
-            if (done_loop == streams[0].loop) {
-                cout << "Config helper GPU: all work done.\n";
-                cout << "[CATCH TEST] " << sc_time_stamp() << endl;
-                ofstream outfile("simulation_result_gpu.txt", ios::app);
-                if (outfile.is_open()) {
-                    outfile << "[CATCH TEST] " << sc_time_stamp()
-                            << "L1CACHESIZE " << L1CACHESIZE << " L2CACHESIZE "
-                            << L2CACHESIZE << " BANDWIDTH " << gpu_bw << endl;
-                    outfile.close();
-                } else {
-                    cout << "Error: Unable to open file for writing timestamp."
-                         << endl;
-                }
-                sc_stop();
-            }
-        }
+    dispatch();
 
-        g_recv_done_cnt = 0;
+    if (temp_config.size())
         notify_event->notify(CYCLE, SC_NS);
-    }
-}
\ No newline at end of file
+    else if (find_if(sm_stream.begin(), sm_stream.end(),
+                     [](int s) { return s != -1; }) == sm_stream.end())
+        ARGUS_EXIT("Config helper GPU: no stream can make progress, check the "
+                   "stream dependencies and events.");
+}
@@ -3,6 +3,7 @@
 #include "prims/norm_prims.h"
 #include "utils/config_utils.h"
 #include "utils/prim_utils.h"
+#include "utils/router_utils.h"
 #include "utils/system_utils.h"
 
 config_helper_gpu_pd::config_helper_gpu_pd(string filename, string font_ttf,
@@ -64,7 +65,7 @@ void config_helper_gpu_pd::fill_queue_config(queue<Msg> *q) {
     // 将temp中的所有内容搬运到q中，并清空temp
     for (auto msg : temp_config) {
         auto des = msg.des_;
-        int index = des / GRID_X;
+        int index = HostPortOf(des);
         q[index].push(msg);
     }
 
@@ -93,7 +94,7 @@ void config_helper_gpu_pd::fill_queue_start(queue<Msg> *q) {
     // 直接获取这一个prim有几个核参加
     int sms = ((GpuBase *)prim_list[prim_index])->req_sm;
     for (int i = 0; i < min(sms, GRID_SIZE); i++) {
-        int index = i / GRID_X;
+        int index = HostPortOf(i);
         int pkg_index = 0;
 
         // 这里相当于quick start，实际上也只有第一个原语需要初始数据
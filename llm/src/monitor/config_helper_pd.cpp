@@ -4,6 +4,7 @@
 #include "prims/norm_prims.h"
 #include "utils/msg_utils.h"
 #include "utils/prim_utils.h"
+#include "utils/router_utils.h"
 #include "utils/system_utils.h"
 
 config_helper_pd::config_helper_pd(string filename, string font_ttf,
@@ -88,7 +89,7 @@ void config_helper_pd::fill_queue_config(queue<Msg> *q) {
     // 将temp中的所有内容搬运到q中，并清空temp
     for (auto msg : temp_config) {
         auto des = msg.des_;
-        int index = des / GRID_X;
+        int index = HostPortOf(des);
         q[index].push(msg);
     }
 
@@ -98,7 +99,7 @@ void config_helper_pd::fill_queue_config(queue<Msg> *q) {
 void config_helper_pd::fill_queue_start(queue<Msg> *q) {
     // 所有tp组的初始核需要发送start_data
     for (auto status : coreStatus) {
-        int index = status.id / GRID_X;
+        int index = HostPortOf(status.id);
         int total_pkg = 0;
 
         for (int i = 0; i < status.batchInfo.size(); i++) {
@@ -399,7 +400,7 @@ void config_helper_pd::generate_prims(int i) {
     // 为每一个核做相同的原语生成
     // 为每一个work生成前后的send和recv原语
     for (int core_id = i; core_id < i + tp_size; core_id++) {
-        int index = core_id / GRID_X;
+        int index = HostPortOf(core_id);
         int prim_seq = 0;
 
         // 每个核生成一个set_batch
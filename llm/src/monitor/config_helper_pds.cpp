@@ -1,9 +1,11 @@
 #include "monitor/config_helper_pds.h"
 #include "prims/norm_prims.h"
 #include "prims/pd_prims.h"
+#include "utils/checkpoint_utils.h"
 #include "utils/config_utils.h"
 #include "utils/msg_utils.h"
 #include "utils/prim_utils.h"
+#include "utils/router_utils.h"
 #include "utils/system_utils.h"
 
 config_helper_pds::config_helper_pds(string filename, string font_ttf,
@@ -14,6 +16,12 @@ config_helper_pds::config_helper_pds(string filename, string font_ttf,
     jfile >> j;
 
     decode_done = 0;
+    iter_cnt = 0;
+    checkpoint_saved = false;
+    stat_iters = STATS.counter("pds.iterations");
+    stat_decode_queue = STATS.gauge("pds.decode_queue");
+    stat_running_reqs = STATS.gauge("pds.running_reqs");
+    time_offset_ns = 0;
 
     // 收集相关参数
     auto config_reqs = j["requests"];
@@ -108,7 +116,7 @@ void config_helper_pds::fill_queue_config(queue<Msg> *q) {
     // 将temp中的所有内容搬运到q中，并清空temp
     for (auto msg : temp_config) {
         auto des = msg.des_;
-        int index = des / GRID_X;
+        int index = HostPortOf(des);
         q[index].push(msg);
     }
 
@@ -124,7 +132,7 @@ void config_helper_pds::fill_queue_start(queue<Msg> *q) {
 
     for (auto status : coreStatus) {
         cout << "status " << status.id << endl;
-        int index = status.id / GRID_X;
+        int index = HostPortOf(status.id);
         int total_pkg = 0;
 
         if (!wait_send_start_prefill && status.id / tp_size < prefill_core)
@@ -205,7 +213,8 @@ void config_helper_pds::iter_done(PD_JOB type) {
                 if (++record.prefill_counter == record.prefill_iters) {
                     stage.type = record.phase = DECODE;
                     token_record[record.id].push_back(
-                        sc_time_stamp().to_double());
+                        (sc_time_stamp() + sc_time(time_offset_ns, SC_NS))
+                            .to_double());
                     stage.token_num = 1;
                     req_decode.push(stage.req_id);
                     if (!busy_d)
@@ -214,7 +223,9 @@ void config_helper_pds::iter_done(PD_JOB type) {
                 break;
             case DECODE:
                 record.decode_counter++;
-                token_record[record.id].push_back(sc_time_stamp().to_double());
+                token_record[record.id].push_back(
+                    (sc_time_stamp() + sc_time(time_offset_ns, SC_NS))
+                        .to_double());
                 if (record.decode_counter >= (2) / (eof_chance)) {
                     stage.type = record.phase = PD_DONE;
 
@@ -258,6 +269,16 @@ void config_helper_pds::iter_done(PD_JOB type) {
         busy_p = false;
     else if (type == JOB_DECODE)
         busy_d = false;
+
+    iter_cnt++;
+    stat_iters->inc();
+    stat_decode_queue->set(req_decode.size());
+
+    int running = 0;
+    for (auto &record : requestRecords)
+        if (record.phase == PREFILL || record.phase == DECODE)
+            running++;
+    stat_running_reqs->set(running);
 }
 
 void config_helper_pds::iter_start(PD_JOB type) {
@@ -507,7 +528,7 @@ void config_helper_pds::generate_prims(int i, vector<Msg> &temp_buffer) {
     // 为每一个核做相同的原语生成
     // 为每一个work生成前后的send和recv原语
     for (int core_id = i; core_id < i + tp_size; core_id++) {
-        int index = core_id / GRID_X;
+        int index = HostPortOf(core_id);
         int prim_seq = 0;
 
         // 每个核生成一个set_batch
@@ -779,6 +800,24 @@ void config_helper_pds::parse_done_msg(Event_engine *event_engine,
         wait_schedule_d = true;
         notify_event->notify(CYCLE, SC_NS);
     }
+
+    try_checkpoint();
+}
+
+void config_helper_pds::try_checkpoint() {
+    if (g_checkpoint_file == "" || checkpoint_saved ||
+        iter_cnt < g_checkpoint_iter)
+        return;
+
+    // 只有prefill和decode都处于iteration边界时，核上才没有正在执行的原语
+    if (busy_p || busy_d) {
+        LOG_VERBOSE(1, 0,
+                    "Checkpoint pending at iter " << iter_cnt
+                                                  << ", waiting for idle.");
+        return;
+    }
+
+    checkpoint_saved = SaveCheckpoint(g_checkpoint_file, this);
 }
 
 void config_helper_pds::set_global_vars(int T) {
@@ -1,4 +1,5 @@
 #include <atomic>
+#include <map>
 #include <vector>
 
 #include "monitor/config_helper_core.h"
@@ -12,6 +13,8 @@
 #include "utils/msg_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/print_utils.h"
+#include "utils/router_utils.h"
+#include "workercore/workercore.h"
 
 MemInterface::MemInterface(const sc_module_name &n, Event_engine *event_engine,
                            const char *config_name, const char *font_ttf)
@@ -20,7 +23,8 @@ MemInterface::MemInterface(const sc_module_name &n, Event_engine *event_engine,
     cout << "SIMULATION MODE: " << SYSTEM_MODE << endl;
 
     if (SYSTEM_MODE == SIM_DATAFLOW)
-        config_helper = new config_helper_core(config_name, font_ttf);
+        config_helper =
+            new config_helper_core(config_name, font_ttf, g_chip_id);
     else if (SYSTEM_MODE == SIM_GPU)
         config_helper = new config_helper_gpu(config_name, font_ttf);
     else if (SYSTEM_MODE == SIM_PD)
@@ -55,15 +59,24 @@ void MemInterface::init() {
             }
         }
     }
-    host_data_sent_i = new sc_in<bool>[GRID_X];
-    host_data_sent_o = new sc_out<bool>[GRID_X];
+    port_num = HostPortNum();
+    host_data_sent_i = new sc_in<bool>[port_num];
+    host_data_sent_o = new sc_out<bool>[port_num];
+
+    host_channel_i = new sc_in<sc_bv<256>>[port_num];
+    host_channel_o = new sc_out<sc_bv<256>>[port_num];
 
-    host_channel_i = new sc_in<sc_bv<256>>[GRID_X];
-    host_channel_o = new sc_out<sc_bv<256>>[GRID_X];
+    host_channel_avail_i = new sc_in<bool>[port_num];
 
-    host_channel_avail_i = new sc_in<bool>[GRID_X];
+    write_buffer = new queue<Msg>[port_num];
 
-    write_buffer = new queue<Msg>[GRID_X];
+    for (int i = 0; i < port_num; i++) {
+        string port = "host.port" + to_string(i);
+        stat_port_packets.push_back(STATS.counter(port + ".packets"));
+        stat_port_stalls.push_back(STATS.counter(port + ".stall_cycles"));
+        stat_port_recv.push_back(STATS.counter(port + ".recv"));
+    }
+    stat_preload_packets = STATS.counter("host.preload.packets");
 
     phase = PRO_CONF;
 
@@ -84,13 +97,13 @@ void MemInterface::init() {
     dont_initialize();
 
     SC_THREAD(catch_host_data_sent_i);
-    for (int i = 0; i < GRID_X; i++) {
+    for (int i = 0; i < port_num; i++) {
         sensitive << host_data_sent_i[i].pos();
     }
     dont_initialize();
 
     SC_THREAD(catch_host_channel_available_i);
-    for (int i = 0; i < GRID_X; i++) {
+    for (int i = 0; i < port_num; i++) {
         sensitive << host_channel_avail_i[i].pos();
     }
     dont_initialize();
@@ -159,7 +172,7 @@ void MemInterface::end_of_simulation() {
 
 void MemInterface::end_of_elaboration() {
     // set signals
-    for (int i = 0; i < GRID_X; i++) {
+    for (int i = 0; i < port_num; i++) {
         host_data_sent_o[i].write(false);
     }
 }
@@ -184,7 +197,7 @@ void MemInterface::distribute_config() {
 
         // 检查write_buffer是否为空，如果为空则直接跳过发送阶段（PD模式）
         bool writable = false;
-        for (int i = 0; i < GRID_X; i++) {
+        for (int i = 0; i < port_num; i++) {
             if (write_buffer[i].size()) {
                 writable = true;
                 break;
@@ -254,10 +267,11 @@ void MemInterface::distribute_start_data() {
 
 void MemInterface::recv_helper() {
     while (true) {
-        for (int i = 0; i < GRID_X; i++) {
+        for (int i = 0; i < port_num; i++) {
             if (host_data_sent_i[i].read()) {
                 sc_bv<256> d = host_channel_i[i].read();
                 Msg m = DeserializeMsg(d);
+                stat_port_recv[i]->inc();
 
                 if (m.msg_type_ == ACK) {
                     cout << "ACK from " << m.source_ << endl;
@@ -308,11 +322,10 @@ void MemInterface::recv_done() {
             notify_event = nullptr;
             break;
         case SIM_GPU:
-            notify_event = &ev_switch_phase;
-            break;
         case SIM_PD:
         case SIM_PDS:
         case SIM_GPU_PD:
+            // gpu模式下，SM空闲之后由config helper下发新的CTA
             notify_event = &ev_dis_config;
             break;
         }
@@ -329,28 +342,53 @@ void MemInterface::write_helper() {
         write_done.write(false);
         cout << "Mem Interface: start to write\n";
 
-        // 立刻将buffer中的内容复制到本地，并清空全局buffer
-        queue<Msg> temp_buffer[GRID_X];
-        for (int i = 0; i < GRID_X; i++) {
+        // 立刻将buffer中的内容复制到本地，并清空全局buffer。
+        // 开启预加载时CONFIG包不进入网络，按核分别排队
+        vector<queue<Msg>> temp_buffer(port_num);
+        map<int, queue<Msg>> preload_buffer;
+        for (int i = 0; i < port_num; i++) {
             while (write_buffer[i].size()) {
                 Msg t = write_buffer[i].front();
-                temp_buffer[i].push(t);
+                if (host_preload && t.msg_type_ == CONFIG && t.des_ >= 0 &&
+                    t.des_ < GRID_SIZE)
+                    preload_buffer[t.des_].push(t);
+                else
+                    temp_buffer[i].push(t);
                 write_buffer[i].pop();
             }
         }
 
+        vector<bool> blocked(port_num);
         while (true) {
             bool stop_flag = true; // 是否已经全部发送完毕
             bool all_block = true; // 是否所有节点都已经被阻塞
-            for (int i = 0; i < GRID_X; i++) {
+
+            // 预加载：每个核每周期写入一个包
+            for (auto it = preload_buffer.begin();
+                 it != preload_buffer.end();) {
+                g_core_executor[it->first]->preload_msg(it->second.front());
+                it->second.pop();
+                stat_preload_packets->inc();
+                stop_flag = all_block = false;
+
+                if (it->second.empty())
+                    it = preload_buffer.erase(it);
+                else
+                    it++;
+            }
+
+            for (int i = 0; i < port_num; i++) {
                 host_data_sent_o[i].write(false);
+                blocked[i] = false;
                 if (!temp_buffer[i].size()) {
                     continue;
                 }
 
                 stop_flag = false;
-                if (host_channel_avail_i[i].read() == false)
+                if (host_channel_avail_i[i].read() == false) {
+                    blocked[i] = true;
                     continue;
+                }
                 all_block = false;
 
                 // send data
@@ -358,6 +396,7 @@ void MemInterface::write_helper() {
                 temp_buffer[i].pop();
                 host_channel_o[i].write(SerializeMsg(t));
                 host_data_sent_o[i].write(true);
+                stat_port_packets[i]->inc();
                 // cout << "SEND DATA to: " << t.des_ << ",seq: " << t.seq_id_
                 //      << ", end ?: " << t.is_end_ << endl;
             }
@@ -365,11 +404,17 @@ void MemInterface::write_helper() {
             if (stop_flag)
                 break;
 
+            sc_time start = sc_time_stamp();
             if (all_block)
                 wait(ev_host_channel_available);
             else {
                 wait(CYCLE, SC_NS);
             }
+
+            u_int64_t cycles = (sc_time_stamp() - start) / sc_time(CYCLE, SC_NS);
+            for (int i = 0; i < port_num; i++)
+                if (blocked[i])
+                    stat_port_stalls[i]->inc(cycles);
         }
 
         cout << "Mem Interface: write done\n";
@@ -466,7 +511,7 @@ void MemInterface::switch_phase() {
 
 
 void MemInterface::clear_write_buffer() {
-    for (int i = 0; i < GRID_X; i++) {
+    for (int i = 0; i < port_num; i++) {
         while (!write_buffer[i].empty())
             write_buffer[i].pop();
     }
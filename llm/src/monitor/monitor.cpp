@@ -2,6 +2,7 @@
 #include "defs/global.h"
 #include "monitor/config_helper_gpu.h"
 #include "monitor/config_helper_gpu_pd.h"
+#include "utils/router_utils.h"
 #include "utils/system_utils.h"
 
 Monitor::Monitor(const sc_module_name &n, Event_engine *event_engine,
@@ -12,8 +13,9 @@ Monitor::Monitor(const sc_module_name &n, Event_engine *event_engine,
       font_ttf(font_ttf) {
     memInterface = new MemInterface("mem-interface", this->event_engine,
                                     config_name, font_ttf);
-    globalMemInterface = new GlobalMemInterface(
-        "global-mem-interface", this->event_engine, config_name, font_ttf);
+    globalMemInterface =
+        new GlobalMemInterface("global-mem-interface", this->event_engine,
+                               config_name, font_ttf, g_chip_id);
 
     init();
 }
@@ -42,6 +44,7 @@ Monitor::~Monitor() {
         delete[] channel[i];
         delete[] channel_avail[i];
         delete[] data_sent[i];
+        delete[] credit[i];
     }
 
     delete[] host_channel_avail;
@@ -59,6 +62,7 @@ void Monitor::init() {
     routerMonitor = new RouterMonitor("router-monitor", this->event_engine);
     workerCores = new WorkerCore *[GRID_SIZE];
     g_dram_kvtable = new DramKVTable *[GRID_SIZE];
+    g_core_executor = new WorkerCoreExecutor *[GRID_SIZE];
 
     // globalMemInterface = new GlobalMemInterface();
 
@@ -144,21 +148,22 @@ void Monitor::init() {
     rc_channel = new sc_signal<sc_bv<256>>[GRID_SIZE];
     rc_data_sent = new sc_signal<bool>[GRID_SIZE];
 
-    host_channel_avail = new sc_signal<bool>[GRID_X];
-    host_data_sent_i = new sc_signal<bool>[GRID_X];
-    host_data_sent_o = new sc_signal<bool>[GRID_X];
-    host_channel_i = new sc_signal<sc_bv<256>>[GRID_X];
-    host_channel_o = new sc_signal<sc_bv<256>>[GRID_X];
+    host_channel_avail = new sc_signal<bool>[HostPortNum()];
+    host_data_sent_i = new sc_signal<bool>[HostPortNum()];
+    host_data_sent_o = new sc_signal<bool>[HostPortNum()];
+    host_channel_i = new sc_signal<sc_bv<256>>[HostPortNum()];
+    host_channel_o = new sc_signal<sc_bv<256>>[HostPortNum()];
 
     for (int i = 0; i < DIRECTIONS; i++) {
         channel[i] = new sc_signal<sc_bv<256>>[GRID_SIZE];
         channel_avail[i] = new sc_signal<bool>[GRID_SIZE];
         data_sent[i] = new sc_signal<bool>[GRID_SIZE];
+        credit[i] = new sc_signal<sc_bv<64>>[GRID_SIZE];
     }
 
     // host & router
-    for (int i = 0; i < GRID_X; i++) {
-        int rid = i * GRID_X; // 边缘core的id
+    for (int i = 0; i < HostPortNum(); i++) {
+        int rid = g_host_ports[i]; // 带host端口的router
         RouterUnit *ru = routerMonitor->routers[rid];
 
         memInterface->host_channel_avail_i[i](host_channel_avail[i]);
@@ -206,7 +211,8 @@ void Monitor::init() {
             pos->channel_i[i](channel[input_dir][input_source]);
 
             pos->channel_avail_o[i](channel_avail[i][j]);
-            pos->channel_avail_i[i](channel_avail[input_dir][input_source]);
+            pos->credit_o[i](credit[i][j]);
+            pos->credit_i[i](credit[input_dir][input_source]);
 
             pos->data_sent_o[i](data_sent[i][j]);
             pos->data_sent_i[i](data_sent[input_dir][input_source]);
@@ -0,0 +1,400 @@
+#include "monitor/perf_estimator.h"
+#include "defs/global.h"
+#include "hardware/compute_cost.h"
+#include "prims/base.h"
+#include "prims/norm_prims.h"
+#include "utils/datatype_utils.h"
+#include "utils/msg_utils.h"
+#include "utils/print_utils.h"
+#include "utils/router_utils.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <typeinfo>
+
+Perf_estimator::Perf_estimator(config_helper_core *config) : config(config) {
+    // 与fill_queue_config相同的展开：pipeline视为一种循环，
+    // 非最后循环中除第一次之外的RECV_START按RECV_DATA处理
+    for (auto &c : config->coreconfigs) {
+        Est_core core;
+        core.id = c.id;
+
+        for (int j = 0; j < config->pipeline; j++) {
+            for (int i = 0; i < c.loop - 1; i++)
+                for (auto &work : c.worklist)
+                    for (auto p : work.prims_in_loop)
+                        core.program.push_back(make_pair(p, i > 0));
+
+            for (auto &work : c.worklist)
+                for (auto p : work.prims_last_loop)
+                    core.program.push_back(make_pair(p, false));
+        }
+
+        core_index[c.id] = cores.size();
+        cores.push_back(core);
+    }
+
+    // host按照fill_queue_start的顺序推入初始数据，每个host端口依次发送
+    for (int pipe = 0; pipe < config->pipeline; pipe++) {
+        for (auto &source : config->source_info) {
+            int packets = 0, end_length = 0;
+            CalculatePacketNum(source.second * sizeof(float), 1, 1, packets,
+                               end_length);
+
+            int port = HostPortOf(source.first);
+            double start = host_free[port];
+            host_free[port] = start + packets * CYCLE;
+            start_data[source.first].push_back(
+                start + (hops(-1, source.first) + packets) * CYCLE);
+        }
+    }
+}
+
+int Perf_estimator::hops(int from, int to) {
+    // host经过核对应的host端口进出，host链路记为一跳
+    int extra = 0;
+    if (from < 0) {
+        from = g_host_ports[HostPortOf(to)];
+        extra = 1;
+    }
+    if (to < 0) {
+        to = g_host_ports[HostPortOf(from)];
+        extra = 1;
+    }
+    return abs(from % GRID_X - to % GRID_X) + abs(from / GRID_X - to / GRID_X) +
+           extra;
+}
+
+double Perf_estimator::dram_ns(int cid, int bytes) {
+    // 与行为级DRAM相同的带宽折算
+    return (double)bytes / beha_dram_util /
+           (15.0 * GetCoreHWConfig(cid)->dram_bw / 8);
+}
+
+int Perf_estimator::static_bytes(Est_core &core, const string &label,
+                                 int bytes) {
+    // 静态数据常驻SRAM（Clear_sram不清除），超出容量时按LRU换出
+    for (auto it = core.resident.begin(); it != core.resident.end(); it++) {
+        if (it->first == label) {
+            core.resident.splice(core.resident.end(), core.resident, it);
+            return 0;
+        }
+    }
+
+    core.resident.push_back(make_pair(label, bytes));
+    core.resident_bytes += bytes;
+    while (core.resident_bytes > MAX_SRAM_SIZE && core.resident.size() > 1) {
+        core.resident_bytes -= core.resident.front().second;
+        core.resident.pop_front();
+    }
+    return bytes;
+}
+
+void Perf_estimator::compute_ops(CompBase *prim, int cid,
+                                 u_int64_t &exu_cycle, u_int64_t &sfu_cycle) {
+    // 运算量由原语自己给出，与taskCore中的一致
+    u_int64_t exu_ops = 0, sfu_ops = 0;
+    exu_cycle = sfu_cycle = 0;
+
+    if (!prim->computeOps(exu_ops, sfu_ops) &&
+        unknown_ops.insert(prim->name).second)
+        cout << "[ERROR] Estimator: prim " << prim->name
+             << " gives no op count, its compute time is counted as 0.\n";
+
+    DATATYPE exu_datatype = ComputeDatatype(
+        prim->datatype,
+        ComputeDatatype(prim->weight_datatype, prim->kv_datatype));
+
+    int64_t gemm_cycle = -1;
+    if (prim->prim_type & PRIM_TYPE::NPU_PRIM)
+        gemm_cycle = ((NpuBase *)prim)->gemmCycle(cid);
+
+    // 与writeOutputData相同：矩阵乘按照脉动阵列的周期，其余按exu_ops估算
+    if (gemm_cycle >= 0)
+        exu_cycle = gemm_cycle;
+    else if (exu_ops)
+        exu_cycle = COMP_COST.exu(cid, exu_ops, exu_datatype);
+    if (sfu_ops)
+        sfu_cycle = COMP_COST.sfu(cid, sfu_ops, prim->datatype);
+}
+
+void Perf_estimator::comp(Est_core &core, CompBase *p) {
+    u_int64_t exu_cycle, sfu_cycle;
+    compute_ops(p, core.id, exu_cycle, sfu_cycle);
+    double compute = (double)(exu_cycle + sfu_cycle) * CYCLE;
+
+    // 从DRAM读入的输入
+    auto label = p->prim_context->datapass_label_;
+    int bytes = 0;
+    for (int i = 0; i < p->data_size_input.size(); i++) {
+        string in = label->indata[i];
+        if (in[0] == '_')
+            in = in.substr(1);
+        if (in.find(DRAM_LABEL) == 0)
+            bytes += p->data_byte * p->data_size_input[i];
+    }
+
+    // 静态数据（data_chunk已经换算为字节数），标签与checkStaticData一致
+    std::size_t pos = label->outdata.find_last_of('_');
+    string prefix = pos != std::string::npos ? label->outdata.substr(0, pos)
+                                             : label->outdata;
+    for (auto &chunk : p->data_chunk) {
+        if (chunk.first.rfind("weight", 0) == 0)
+            bytes += static_bytes(core, ETERNAL_PREFIX + prefix + "_w",
+                                  chunk.second);
+        else if (chunk.first.rfind("bias", 0) == 0)
+            bytes += static_bytes(core, ETERNAL_PREFIX + prefix + "_b",
+                                  chunk.second);
+    }
+
+    double dram = dram_ns(core.id, bytes);
+    double total = max(compute, dram);
+    core.now += total;
+    core.comp_ns += total;
+
+    Est_prim &rec = prims[make_pair(core.id, p)];
+    rec.cid = core.id;
+    rec.name = p->name;
+    rec.label = label->outdata;
+    rec.count++;
+    rec.compute_ns += compute;
+    rec.dram_ns += dram;
+    rec.total_ns += total;
+    if (dram > compute)
+        rec.dram_bound++;
+}
+
+void Perf_estimator::to_host(Est_core &core, int packets) {
+    int port = HostPortOf(core.id);
+    double start = max(core.now, host_free[port]);
+    host_free[port] = start + packets * CYCLE;
+    double done = start + (hops(core.id, -1) + packets) * CYCLE;
+    core.send_ns += done - core.now;
+    core.now = done;
+}
+
+bool Perf_estimator::send(Est_core &core, Send_prim *p) {
+    if (p->type == SEND_DONE) {
+        to_host(core, 1);
+        end_ns = max(end_ns, core.now);
+        return true;
+    }
+
+    // REQ/ACK握手在SEND_DATA时一并计算
+    if (p->type != SEND_DATA)
+        return true;
+
+    if (p->des_id < 0 || !core_index.count(p->des_id)) {
+        to_host(core, p->max_packet);
+        return true;
+    }
+
+    // 接收方需要正在执行对应tag的recv，tag等于核id的recv接收任意tag；
+    // 多播时需要组内所有接收方都到达recv之后才注入一次数据
+    vector<int> dests = p->mcast_id ? g_mcast_groups[p->mcast_id]
+                                    : vector<int>{p->des_id};
+    double open = core.now;
+    int max_hops = 0;
+    for (int id : dests) {
+        if (!core_index.count(id))
+            return false;
+        Est_core &d = cores[core_index[id]];
+        if (!d.receiving)
+            return false;
+        auto r = (Recv_prim *)d.program[d.pc].first;
+        if ((r->tag_id != d.id && r->tag_id != p->tag_id) ||
+            d.recv_got >= r->recv_cnt)
+            return false;
+
+        open = max(open, d.recv_open);
+        max_hops = max(max_hops, hops(core.id, id));
+    }
+
+    double start = open + 2 * max_hops * CYCLE;
+    double done = start;
+    for (int id : dests) {
+        Est_core &d = cores[core_index[id]];
+        double arrive = max(start + hops(core.id, id) * CYCLE, d.inbound_free) +
+                        (double)p->max_packet * CYCLE;
+        d.inbound_free = arrive;
+        d.recv_got++;
+        d.recv_arrive = max(d.recv_arrive, arrive);
+        done = max(done, arrive);
+    }
+
+    core.send_ns += done - core.now;
+    core.now = done;
+    return true;
+}
+
+bool Perf_estimator::recv(Est_core &core, Recv_prim *p, bool next_loop) {
+    if (p->type != RECV_DATA && p->type != RECV_START)
+        return true;
+    if (p->recv_cnt == 0)
+        return true;
+
+    if (p->type == RECV_START && !next_loop) {
+        auto &q = start_data[core.id];
+        if (q.size() < p->recv_cnt)
+            return false;
+
+        double arrive = core.now;
+        for (int i = 0; i < p->recv_cnt; i++) {
+            arrive = max(arrive, q.front());
+            q.pop_front();
+        }
+        core.recv_ns += arrive - core.now;
+        core.now = arrive;
+        return true;
+    }
+
+    if (!core.receiving) {
+        core.receiving = true;
+        core.recv_open = core.now;
+        core.recv_got = 0;
+        core.recv_arrive = core.now;
+    }
+    if (core.recv_got < p->recv_cnt)
+        return false;
+
+    core.receiving = false;
+    core.now = max(core.now, core.recv_arrive);
+    core.recv_ns += core.now - core.recv_open;
+    return true;
+}
+
+bool Perf_estimator::step(Est_core &core) {
+    auto &entry = core.program[core.pc];
+    PrimBase *p = entry.first;
+
+    bool done = true;
+    if (p->prim_type & PRIM_TYPE::COMP_PRIM)
+        comp(core, (CompBase *)p);
+    else if (typeid(*p) == typeid(Send_prim))
+        done = send(core, (Send_prim *)p);
+    else if (typeid(*p) == typeid(Recv_prim))
+        done = recv(core, (Recv_prim *)p, entry.second);
+
+    if (done)
+        core.pc++;
+    return done;
+}
+
+bool Perf_estimator::run() {
+    // 每个核尽可能向前推进，直到所有核都被recv或握手阻塞；
+    // 一个核的推进可能解除其他核的阻塞，因此重复直到没有进展
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (auto &core : cores) {
+            while (!core.finished() && step(core))
+                progress = true;
+        }
+    }
+
+    bool ok = true;
+    for (auto &core : cores) {
+        end_ns = max(end_ns, core.now);
+        if (core.finished())
+            continue;
+
+        ok = false;
+        PrimBase *p = core.program[core.pc].first;
+        cout << "[ERROR] Estimator: core " << core.id << " is blocked at prim "
+             << core.pc << "/" << core.program.size() << " (" << p->name;
+        if (typeid(*p) == typeid(Recv_prim))
+            cout << ", tag " << ((Recv_prim *)p)->tag_id << ", received "
+                 << core.recv_got << "/" << ((Recv_prim *)p)->recv_cnt;
+        else if (typeid(*p) == typeid(Send_prim))
+            cout << ", dest " << ((Send_prim *)p)->des_id << ", tag "
+                 << ((Send_prim *)p)->tag_id;
+        cout << ")\n";
+    }
+    return ok;
+}
+
+void Perf_estimator::report(const string &prefix, int top) {
+    // 各核的计算时间中，访存受限的部分
+    map<int, double> dram_bound_ns;
+    vector<Est_prim *> prim_list;
+    for (auto &it : prims) {
+        auto &rec = it.second;
+        if (rec.dram_ns > rec.compute_ns)
+            dram_bound_ns[rec.cid] += rec.total_ns;
+        prim_list.push_back(&rec);
+    }
+
+    auto bottleneck = [&](Est_core &c) -> string {
+        double dram = dram_bound_ns[c.id];
+        double compute = c.comp_ns - dram;
+        double m = max(max(compute, dram), max(c.send_ns, c.recv_ns));
+        if (m == 0)
+            return "idle";
+        if (m == compute)
+            return "compute";
+        if (m == dram)
+            return "dram";
+        return m == c.send_ns ? "noc-send" : "wait-input";
+    };
+
+    ofstream file(prefix + "_cores.csv", ios::trunc);
+    file << "core,finish_ns,comp_ns,dram_bound_ns,send_ns,recv_ns,"
+            "utilization,bottleneck\n";
+    for (auto &c : cores) {
+        file << c.id << "," << c.now << "," << c.comp_ns << ","
+             << dram_bound_ns[c.id] << "," << c.send_ns << "," << c.recv_ns
+             << "," << (c.now > 0 ? c.comp_ns / c.now : 0) << ","
+             << bottleneck(c) << "\n";
+    }
+    file.close();
+
+    sort(prim_list.begin(), prim_list.end(),
+         [](Est_prim *a, Est_prim *b) { return a->total_ns > b->total_ns; });
+
+    file.open(prefix + "_prims.csv", ios::trunc);
+    file << "core,name,label,count,compute_ns,dram_ns,total_ns,dram_bound\n";
+    for (auto rec : prim_list)
+        file << rec->cid << "," << rec->name << ",\"" << rec->label << "\","
+             << rec->count << "," << rec->compute_ns << "," << rec->dram_ns
+             << "," << rec->total_ns << "," << rec->dram_bound << "\n";
+    file.close();
+
+    PrintBar(86);
+    cout << "| " << std::left << std::setw(6) << "core" << std::right
+         << std::setw(14) << "finish(ns)" << std::setw(14) << "comp(ns)"
+         << std::setw(14) << "send(ns)" << std::setw(14) << "recv(ns)"
+         << std::setw(8) << "util" << std::setw(12) << "bottleneck" << " |\n";
+    PrintBar(86);
+    Est_core *critical = nullptr;
+    for (auto &c : cores) {
+        if (!critical || c.now > critical->now)
+            critical = &c;
+        cout << "| " << std::left << std::setw(6) << c.id << std::right
+             << std::fixed << std::setprecision(0) << std::setw(14) << c.now
+             << std::setw(14) << c.comp_ns << std::setw(14) << c.send_ns
+             << std::setw(14) << c.recv_ns << std::setprecision(2)
+             << std::setw(8) << (c.now > 0 ? c.comp_ns / c.now : 0)
+             << std::setw(12) << bottleneck(c) << " |\n";
+    }
+    PrintBar(86);
+
+    cout << "Top prims by estimated time:\n";
+    for (int i = 0; i < top && i < prim_list.size(); i++) {
+        auto rec = prim_list[i];
+        cout << "  core " << rec->cid << " " << rec->name << " <"
+             << rec->label << "> x" << rec->count << ": " << std::fixed
+             << std::setprecision(0) << rec->total_ns << " ns, "
+             << (rec->dram_ns > rec->compute_ns ? "dram" : "compute")
+             << " bound\n";
+    }
+    cout.unsetf(std::ios::floatfield);
+
+    if (critical)
+        cout << "Critical core " << critical->id << ", bottleneck "
+             << bottleneck(*critical) << endl;
+    cout << "[ESTIMATE] end-to-end " << (u_int64_t)end_ns << " ns" << endl;
+    cout << "Estimator results written to " << prefix << "_cores.csv and "
+         << prefix << "_prims.csv" << endl;
+}
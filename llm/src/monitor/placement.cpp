@@ -0,0 +1,132 @@
+#include "monitor/placement.h"
+#include "defs/global.h"
+#include "utils/router_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+Placement_optimizer::Placement_optimizer(const vector<Comm_edge> &edges,
+                                         const set<int> &pinned,
+                                         double balance)
+    : edges(edges), pinned(pinned), balance(balance) {}
+
+void Placement_optimizer::add_path(int from, int to, double bytes,
+                                   double &weighted_hops) {
+    // host的数据经过核对应的host端口进出，host链路记为一跳
+    if (from == GRID_SIZE || to == GRID_SIZE) {
+        int core = from == GRID_SIZE ? to : from;
+        int port = HostPortOf(core);
+        link_load[GRID_SIZE * 4 + port] += bytes;
+        weighted_hops += bytes;
+
+        if (from == GRID_SIZE)
+            from = g_host_ports[port];
+        else
+            to = g_host_ports[port];
+    }
+
+    int pos = from;
+    while (pos != to) {
+        Directions dir = GetNextHop(to, pos);
+        link_load[pos * 4 + dir] += bytes;
+        weighted_hops += bytes;
+
+        switch (dir) {
+        case WEST:
+            pos -= 1;
+            break;
+        case EAST:
+            pos += 1;
+            break;
+        case NORTH:
+            pos += GRID_X;
+            break;
+        default:
+            pos -= GRID_X;
+            break;
+        }
+    }
+}
+
+double Placement_optimizer::cost(const vector<int> &o2r, double &weighted_hops,
+                                 double &max_load) {
+    link_load.assign(GRID_SIZE * 4 + HostPortNum(), 0);
+    weighted_hops = 0;
+
+    for (auto &e : edges) {
+        int from = e.from == GRID_SIZE ? GRID_SIZE : o2r[e.from];
+        int to = e.to == GRID_SIZE ? GRID_SIZE : o2r[e.to];
+        add_path(from, to, e.bytes, weighted_hops);
+    }
+
+    max_load = *max_element(link_load.begin(), link_load.end());
+    return weighted_hops + balance * max_load;
+}
+
+vector<int> Placement_optimizer::run(int iters, unsigned seed) {
+    vector<int> o2r(GRID_SIZE), r2o(GRID_SIZE);
+    for (int i = 0; i < GRID_SIZE; i++)
+        o2r[i] = r2o[i] = i;
+
+    // 可以交换的位置，包括空位置
+    vector<int> free_pos;
+    for (int i = 0; i < GRID_SIZE; i++)
+        if (!pinned.count(i))
+            free_pos.push_back(i);
+    if (free_pos.size() < 2 || edges.empty())
+        return o2r;
+
+    mt19937 gen(seed);
+    uniform_int_distribution<int> pick(0, free_pos.size() - 1);
+    uniform_real_distribution<double> prob(0, 1);
+
+    auto swap_pos = [&](int a, int b) {
+        int oa = r2o[a], ob = r2o[b];
+        o2r[oa] = b;
+        o2r[ob] = a;
+        r2o[a] = ob;
+        r2o[b] = oa;
+    };
+
+    double hops, load;
+    double cur = cost(o2r, hops, load);
+    double best = cur;
+    vector<int> best_o2r = o2r;
+
+    // 初始温度取随机交换带来的平均代价变化
+    double t0 = 0;
+    int samples = 0;
+    for (int k = 0; k < 100; k++) {
+        int a = free_pos[pick(gen)], b = free_pos[pick(gen)];
+        if (a == b)
+            continue;
+        swap_pos(a, b);
+        t0 += fabs(cost(o2r, hops, load) - cur);
+        swap_pos(a, b);
+        samples++;
+    }
+    t0 = samples && t0 > 0 ? t0 / samples : 1;
+
+    for (int it = 0; it < iters; it++) {
+        // 温度按指数冷却到初始的千分之一
+        double t = t0 * pow(1e-3, (double)it / iters);
+        int a = free_pos[pick(gen)], b = free_pos[pick(gen)];
+        if (a == b)
+            continue;
+
+        swap_pos(a, b);
+        double next = cost(o2r, hops, load);
+        if (next <= cur || prob(gen) < exp((cur - next) / t)) {
+            cur = next;
+            if (cur < best) {
+                best = cur;
+                best_o2r = o2r;
+            }
+        } else {
+            swap_pos(a, b);
+        }
+    }
+
+    return best_o2r;
+}
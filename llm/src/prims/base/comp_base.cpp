@@ -0,0 +1,21 @@
+#include "prims/base.h"
+#include "utils/datatype_utils.h"
+
+void CompBase::parseDatatype(json j) {
+    if (j.contains("datatype"))
+        datatype = ParseDatatype(j["datatype"]);
+
+    weight_datatype = j.contains("weight_datatype")
+                          ? ParseDatatype(j["weight_datatype"])
+                          : datatype;
+    kv_datatype =
+        j.contains("kv_datatype") ? ParseDatatype(j["kv_datatype"]) : datatype;
+}
+
+int CompBase::chunkBytes(const string &chunk_name, int elements) {
+    // load_expert 中的数据块名称为 weight_i_e / bias_i_e
+    if (chunk_name.rfind("weight", 0) == 0 || chunk_name.rfind("bias", 0) == 0)
+        return DatatypeBytes(weight_datatype, elements);
+
+    return elements * data_byte;
+}
@@ -1,5 +1,6 @@
 #include "prims/base.h"
 #include "utils/config_utils.h"
+#include "utils/datatype_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/print_utils.h"
 #include "utils/system_utils.h"
@@ -12,9 +13,13 @@ vector<sc_bv<128>> GpuBase::serialize() {
     // metadata
     sc_bv<128> metadata;
     metadata.range(7, 0) = sc_bv<8>(PrimFactory::getInstance().getPrimId(name));
-    metadata.range(8, 8) = sc_bv<1>(datatype);
     metadata.range(24, 9) = sc_bv<16>(fetch_index);
     metadata.range(56, 41) = sc_bv<16>(req_sm);
+    metadata.range(60, 57) = sc_bv<4>(pipe_stages);
+    metadata.range(76, 61) = sc_bv<16>(tile_k);
+    metadata.range(80, 77) = sc_bv<4>(datatype);
+    metadata.range(84, 81) = sc_bv<4>(weight_datatype);
+    metadata.range(88, 85) = sc_bv<4>(kv_datatype);
     segments.push_back(metadata);
 
     std::vector<std::pair<std::string, int>> vec(param_value.begin(),
@@ -44,9 +49,13 @@ void GpuBase::deserialize(vector<sc_bv<128>> segments) {
 
     // 解析metadata
     auto buffer = segments[0];
-    datatype = DATATYPE(buffer.range(8, 8).to_uint64());
     fetch_index = buffer.range(24, 9).to_uint64();
     req_sm = buffer.range(56, 41).to_uint64();
+    pipe_stages = buffer.range(60, 57).to_uint64();
+    tile_k = buffer.range(76, 61).to_uint64();
+    datatype = DATATYPE(buffer.range(80, 77).to_uint64());
+    weight_datatype = DATATYPE(buffer.range(84, 81).to_uint64());
+    kv_datatype = DATATYPE(buffer.range(88, 85).to_uint64());
 
     vector<string> vec(param_name.begin(), param_name.end());
     sort(vec.begin(), vec.end());
@@ -79,6 +88,47 @@ void GpuBase::deserialize(vector<sc_bv<128>> segments) {
 
 void GpuBase::parseCompose(json j) {
     SetParamFromJson(j, "require_sm", &req_sm);
+    SetParamFromJson(j, "stages", &pipe_stages, 2);
+    SetParamFromJson(j, "tile_k", &tile_k, 0);
+
+    if (pipe_stages < 1 || pipe_stages > 15)
+        ARGUS_EXIT("In ", name, ": pipeline stages should be in [1, 15].\n");
+}
+
+void GpuBase::runTilePipeline(TaskCoreContext &context, int tile_num,
+                              int cycle, function<void(int)> load_tile) {
+    vector<sc_time> compute_end(tile_num);
+    sc_time tile_cycle((double)cycle / tile_num, SC_NS);
+    sc_time last_end = sc_time_stamp();
+    sc_time stall = SC_ZERO_TIME;
+
+    for (int i = 0; i < tile_num; i++) {
+        // 缓冲区仍被占用时，等待对应tile的计算完成
+        if (i >= pipe_stages) {
+            sc_time release = compute_end[i - pipe_stages];
+            if (release > sc_time_stamp()) {
+                stall += release - sc_time_stamp();
+                wait(release - sc_time_stamp());
+            }
+        }
+
+        load_tile(i);
+
+        sc_time start = max(sc_time_stamp(), last_end);
+        last_end = compute_end[i] = start + tile_cycle;
+    }
+
+    sc_time tail = SC_ZERO_TIME;
+    if (last_end > sc_time_stamp()) {
+        tail = last_end - sc_time_stamp();
+        wait(tail);
+    }
+
+    LOG_VERBOSE(1, context.cid,
+                "Prim name:" << name << " tiles: " << tile_num << ", stages: "
+                             << pipe_stages << ", cycle: " << cycle
+                             << ", buffer stall: " << stall
+                             << ", compute tail: " << tail);
 }
 
 void GpuBase::parseAddress(json j) {
@@ -113,6 +163,7 @@ void GpuBase::parseJson(json j) {
     for (auto &param : param_name) {
         SetParamFromJson(j, param, &param_value[param]);
     }
+    parseDatatype(j);
 
     initialize();
     initializeDefault();
@@ -125,10 +176,7 @@ void GpuBase::parseJson(json j) {
 }
 
 void GpuBase::initializeDefault() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     input_size = 0;
     for (auto &input : data_size_input)
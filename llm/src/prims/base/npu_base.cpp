@@ -1,9 +1,13 @@
+#include "hardware/compute_cost.h"
 #include "prims/base.h"
+#include "trace/Stats_registry.h"
 #include "utils/config_utils.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/print_utils.h"
 #include "utils/system_utils.h"
+#include "workercore/prefetch_planner.h"
 
 void NpuBase::parseAddress(json j) {
     SetParamFromJson(j, "input", &inp_offset, 0);
@@ -14,8 +18,9 @@ void NpuBase::parseAddress(json j) {
     for (auto &pair : data_chunk)
         total_data_size += pair.second;
 
+    // data_chunk 在initializeDefault()中已经换算为字节数
     SetParamFromJson(j, "output", &out_offset,
-                     data_offset + total_data_size * data_byte);
+                     data_offset + total_data_size);
 }
 
 void NpuBase::parseSramLabel(json j) {
@@ -51,10 +56,13 @@ vector<sc_bv<128>> NpuBase::serialize() {
 
     sc_bv<128> metadata;
     metadata.range(7, 0) = sc_bv<8>(PrimFactory::getInstance().getPrimId(name));
-    metadata.range(8, 8) = sc_bv<1>(datatype);
-    metadata.range(24, 9) = sc_bv<16>(inp_offset);
-    metadata.range(40, 25) = sc_bv<16>(data_offset);
-    metadata.range(56, 41) = sc_bv<16>(out_offset);
+    // DRAM偏移为字节地址，按32位存放
+    metadata.range(39, 8) = sc_bv<32>(inp_offset);
+    metadata.range(71, 40) = sc_bv<32>(data_offset);
+    metadata.range(103, 72) = sc_bv<32>(out_offset);
+    metadata.range(107, 104) = sc_bv<4>(datatype);
+    metadata.range(111, 108) = sc_bv<4>(weight_datatype);
+    metadata.range(115, 112) = sc_bv<4>(kv_datatype);
     segments.push_back(metadata);
 
     std::vector<std::pair<std::string, int>> vec(param_value.begin(),
@@ -80,10 +88,12 @@ vector<sc_bv<128>> NpuBase::serialize() {
 void NpuBase::deserialize(vector<sc_bv<128>> segments) {
     // 解析metadata
     auto buffer = segments[0];
-    datatype = DATATYPE(buffer.range(8, 8).to_uint64());
-    inp_offset = buffer.range(24, 9).to_uint64();
-    data_offset = buffer.range(40, 25).to_uint64();
-    out_offset = buffer.range(56, 41).to_uint64();
+    inp_offset = buffer.range(39, 8).to_uint64();
+    data_offset = buffer.range(71, 40).to_uint64();
+    out_offset = buffer.range(103, 72).to_uint64();
+    datatype = DATATYPE(buffer.range(107, 104).to_uint64());
+    weight_datatype = DATATYPE(buffer.range(111, 108).to_uint64());
+    kv_datatype = DATATYPE(buffer.range(115, 112).to_uint64());
 
     vector<string> vec(param_name.begin(), param_name.end());
     sort(vec.begin(), vec.end());
@@ -115,6 +125,7 @@ void NpuBase::parseJson(json j) {
     for (auto &param : param_name) {
         SetParamFromJson(j, param, &param_value[param]);
     }
+    parseDatatype(j);
 
     initialize();
     initializeDefault();
@@ -135,11 +146,13 @@ void NpuBase::parseJson(json j) {
 int NpuBase::sramUtilization(DATATYPE datatype, int cid) {
     int total_sram = 0;
 
-    total_sram += CeilingDivision(input_size * data_byte * 8,
-                                  GetCoreHWConfig(cid)->sram_bitwidth);
+    total_sram +=
+        CeilingDivision(DatatypeBytes(datatype, input_size) * 8,
+                        GetCoreHWConfig(cid)->sram_bitwidth);
 
+    // data_chunk 已经按照各自的数据类型换算为字节数
     for (auto &pair : data_chunk) {
-        total_sram += CeilingDivision(pair.second * data_byte * 8,
+        total_sram += CeilingDivision(pair.second * 8,
                                       GetCoreHWConfig(cid)->sram_bitwidth);
     }
 
@@ -148,10 +161,7 @@ int NpuBase::sramUtilization(DATATYPE datatype, int cid) {
 }
 
 void NpuBase::initializeDefault() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     input_size = 0;
     for (auto &input : data_size_input)
@@ -172,7 +182,7 @@ void NpuBase::initializeDefault() {
     int pos = data_offset;
     for (auto &chunk : data_chunk) {
         data_chunk_addr[chunk.first] = pos;
-        chunk.second *= data_byte;
+        chunk.second = chunkBytes(chunk.first, chunk.second);
         pos += chunk.second;
     }
 }
@@ -215,6 +225,7 @@ int NpuBase::taskCoreDefault(TaskCoreContext &context) {
 
     u_int64_t exu_flops = 0;
     u_int64_t sfu_flops = 0;
+    exu_cycle = -1;
 #if USE_SRAM == 1
     {
         // 自定义task
@@ -230,6 +241,13 @@ int NpuBase::taskCoreDefault(TaskCoreContext &context) {
     }
 #endif
 
+    last_exu_ops = exu_flops;
+    last_sfu_ops = sfu_flops;
+    last_dram_time = dram_time;
+    last_compute_time = 0;
+    last_exu_time = 0;
+    last_sfu_time = 0;
+
     // 计算overlap并写回output数据
     if (!skip_output)
         writeOutputData(context, exu_flops, sfu_flops, dram_time, overlap_time,
@@ -309,6 +327,7 @@ void NpuBase::checkInputData(TaskCoreContext &context, uint64_t &dram_time,
                        prim_context->datapass_label_->indata[p].c_str());
                 sc_stop();
             } else if (flag > 0) {
+                STATS.core(context.cid).reload_bytes->inc(flag);
 
 #if USE_SRAM_MANAGER == 1
                 LOG_VERBOSE(
@@ -529,6 +548,20 @@ void NpuBase::prefReadData(TaskCoreContext &context, uint64_t &dram_time,
 
 #endif
 }
+void NpuBase::staticData(const string &prim_name,
+                         vector<Static_chunk> &chunks) {
+    static const vector<pair<string, string>> suffix = {
+        {"weight", "_w"}, {"bias", "_b"}, {"sincos", "_sc"}};
+
+    for (auto &s : suffix) {
+        if (!data_chunk_addr.count(s.first))
+            continue;
+        chunks.push_back({ETERNAL_PREFIX + prim_name + s.second,
+                          (u_int64_t)data_chunk_addr[s.first],
+                          GetFromPairedVector(data_chunk, s.first)});
+    }
+}
+
 void NpuBase::checkStaticData(TaskCoreContext &context, uint64_t &dram_time,
                               uint64_t label_global_addr, int data_size_label,
                               string label_name, bool use_pf) {
@@ -548,23 +581,26 @@ void NpuBase::checkStaticData(TaskCoreContext &context, uint64_t &dram_time,
 
     AddrPosKey sc_key;
     int flag = prim_context->sram_pos_locator_->findPair(label_name, sc_key);
+    if (!use_pf && context.prefetcher)
+        context.prefetcher->consume(label_name, flag);
     if (flag == -1) {
         LOG_VERBOSE(1, context.cid,
                     "Prim name:" << name << " weight data not found");
 
 #if USE_SRAM_MANAGER == 1
         sram_first_write_generic(
-            context, data_byte * data_size_label, label_global_addr, dram_time,
+            context, data_size_label, label_global_addr, dram_time,
             dram_start, label_name, true, prim_context->sram_pos_locator_);
 #else
-        sram_first_write_generic(context, data_byte * data_size_label,
+        sram_first_write_generic(context, data_size_label,
                                  label_global_addr, dram_time, dram_start);
 
-        sc_key = AddrPosKey(*sram_addr, data_byte * data_size_label);
+        sc_key = AddrPosKey(*sram_addr, data_size_label);
         prim_context->sram_pos_locator_->addPair(label_name, sc_key, context,
                                                  dram_time);
 #endif
     } else if (flag > 0) {
+        STATS.core(context.cid).reload_bytes->inc(flag);
         LOG_VERBOSE(1, context.cid,
                     "Prim name:" << name << " weight data has spill");
 #if USE_SRAM_MANAGER == 1
@@ -575,7 +611,7 @@ void NpuBase::checkStaticData(TaskCoreContext &context, uint64_t &dram_time,
 #else
         sram_first_write_generic(context, flag, label_global_addr, dram_time,
                                  dram_start);
-        sc_key.size = data_byte * data_size_label;
+        sc_key.size = data_size_label;
         sc_key.spill_size = 0;
         prim_context->sram_pos_locator_->addPair(label_name, sc_key, context,
                                                  dram_time);
@@ -592,13 +628,13 @@ void NpuBase::checkStaticData(TaskCoreContext &context, uint64_t &dram_time,
     std::cout << label_name << " Key Allocation ID: " << sc_key.alloc_id
               << std::endl;
     if (use_pf == false) {
-        sram_read_generic(context, data_byte * data_size_label, sram_offset,
+        sram_read_generic(context, data_size_label, sram_offset,
                           dram_time, sc_key.alloc_id, true,
                           prim_context->sram_pos_locator_);
     }
 #else
     if (use_pf == false) {
-        sram_read_generic(context, data_byte * data_size_label, sram_offset,
+        sram_read_generic(context, data_size_label, sram_offset,
                           dram_time);
     }
 #endif
@@ -618,17 +654,26 @@ void NpuBase::writeOutputData(TaskCoreContext &context, uint64_t exu_flops,
     cout << exu->x_dims << " " << exu->y_dims << " " << comp_util << endl;
     cout << sfu->x_dims << endl;
 
+    // 操作数精度不同时按照最慢的一方计算
+    DATATYPE exu_datatype = ComputeDatatype(
+        datatype, ComputeDatatype(weight_datatype, kv_datatype));
     if (exu->type == MAC_Array)
         cycle +=
-            exu_flops / (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+            (exu_cycle >= 0 ? exu_cycle
+                            : COMP_COST.exu(cid, exu_flops, exu_datatype)) *
+            CYCLE;
     else
         assert(false && "Unsupported tile type");
+    last_exu_time = cycle;
 
     if (sfu->type == Linear)
-        cycle += sfu_flops / sfu->x_dims * CYCLE;
+        cycle += COMP_COST.sfu(cid, sfu_flops, datatype) * CYCLE;
     else
         assert(false && "Unsupported tile type");
 
+    last_sfu_time = cycle - last_exu_time;
+    last_compute_time = cycle;
+
 #if USE_SRAM == 1
     if (dram_time > cycle) {
         // 因为dram 已经wait 过了，所以额外的 overlap_time = 0
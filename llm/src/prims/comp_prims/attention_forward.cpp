@@ -46,8 +46,13 @@ void Attention_f::taskCore(TaskCoreContext &context, string prim_name,
     sram_read_generic_temp(context, data_byte * GetFromPairedVector(data_chunk, "att"),
                            temp_sram_addr_prior, dram_time);
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Attention_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = (uint64_t)p["B"] * p["NH"] * p["T"] * (p["T"] - 1) / 2 *
               (4 * p["C"] / p["NH"] + 5);
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "systemc.h"
+
+#include "prims/base.h"
+#include "prims/comp_prims.h"
+#include "utils/system_utils.h"
+
+REGISTER_PRIM(Collective_f);
+
+void Collective_f::initialize() {
+    auto &p = param_value;
+    switch (p["op"]) {
+    case COLL_COPY:
+        data_size_input = {p["N"]};
+        data_chunk = {{"output", p["N"]}};
+        break;
+    case COLL_REDUCE:
+        // 第一个输入为收到的K份数据，第二个输入为本地数据
+        data_size_input = {p["N"] * p["K"], p["N"]};
+        data_chunk = {{"output", p["N"]}};
+        break;
+    case COLL_CONCAT:
+        data_size_input = {p["ACC"], p["N"]};
+        data_chunk = {{"output", p["ACC"] + p["N"]}};
+        break;
+    default:
+        ARGUS_EXIT("Collective_f: unknown op ", p["op"], ".\n");
+    }
+}
+
+void Collective_f::taskCore(TaskCoreContext &context, string prim_name,
+                            u_int64_t &dram_time, u_int64_t &exu_ops,
+                            u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Collective_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+    auto &p = param_value;
+    exu_ops = p["op"] == COLL_REDUCE ? (u_int64_t)p["N"] * p["K"] : 0;
+    sfu_ops = 0;
+    return true;
+}
@@ -31,10 +31,15 @@ void Conv_f::taskCore(TaskCoreContext &context, string prim_name,
     checkStaticData(context, dram_time, data_chunk_addr["bias"],
                     GetFromPairedVector(data_chunk, "bias"), label_bias);
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Conv_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     int oH = (p["H"] + 2 * p["pY"] - p["kY"]) / p["sY"] + 1;
     int oW = (p["W"] + 2 * p["pX"] - p["kX"]) / p["sX"] + 1;
     int oC = p["F"];
     exu_ops = (uint64_t)p["B"] * p["C"] * p["kY"] * p["kX"] * 2 * oH * oW * oC;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -12,5 +12,11 @@ void Dummy_p::initialize() { data_size_input = {80}; }
 void Dummy_p::taskCore(TaskCoreContext &context, string prim_name,
                       u_int64_t &dram_time, u_int64_t &exu_ops,
                       u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Dummy_p::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     exu_ops = 10;
+    sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -13,7 +13,12 @@ void gate_forward::initialize() {
 void gate_forward::taskCore(TaskCoreContext &context, string prim_name,
                            u_int64_t &dram_time, u_int64_t &exu_ops,
                            u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool gate_forward::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = (uint64_t)p["B"] * p["T"] * p["C"] * p["E_N"];
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -20,7 +20,12 @@ void Gelu_f::initialize() {
 void Gelu_f::taskCore(TaskCoreContext &context, string prim_name,
                      u_int64_t &dram_time, u_int64_t &exu_ops,
                      u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Gelu_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = 0;
     sfu_ops = (u_int64_t)p["N"];
+    return true;
 }
\ No newline at end of file
@@ -28,7 +28,12 @@ void Layernorm_f::taskCore(TaskCoreContext &context, string prim_name,
     checkStaticData(context, dram_time, data_chunk_addr["bias"],
                     GetFromPairedVector(data_chunk, "bias"), label_bias);
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Layernorm_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = 0;
     sfu_ops = (u_int64_t)p["B"] * p["T"] * (8 * p["C"] + 5);
+    return true;
 }
\ No newline at end of file
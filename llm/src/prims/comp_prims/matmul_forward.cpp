@@ -6,8 +6,10 @@
 #include "common/system.h"
 #include "defs/global.h"
 #include "memory/dram/Dcachecore.h"
+#include "hardware/compute_cost.h"
 #include "prims/base.h"
 #include "prims/comp_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/print_utils.h"
 #include "utils/system_utils.h"
@@ -39,25 +41,16 @@ void Matmul_f::taskCore(TaskCoreContext &context, string prim_name,
     cout << "Core " << prim_context->cid << " Matmul_f\n";
     ARGUS_PRINT(dram_time);
 
-    auto &p = param_value;
 #if PERFORMANCE_MODE == 1
+    auto &p = param_value;
 
     ExuConfig *exu = GetCoreHWConfig(context.cid)->exu;
 
-    uint64_t weight_tile_x = (p["C"] + exu->x_dims - 1) / exu->x_dims;
     uint64_t weight_tile_y = (p["OC"] + exu->y_dims - 1) / exu->y_dims;
 
-    uint64_t padding_input_x =
-        (p["T"] * p["B"]) > exu->x_dims ? p["T"] * p["B"] : exu->x_dims;
-
-    uint64_t performance_cycle = (exu->x_dims + exu->x_dims + padding_input_x) *
-                                 weight_tile_x * weight_tile_y;
-
-    uint64_t performance_comp =
-        performance_cycle * exu->y_dims * exu->x_dims * comp_util;
+    exu_cycle = gemmCycle(context.cid);
     LOG_VERBOSE(1, context.cid,
-                "Prim name:" << name << " performance_cycle "
-                             << performance_cycle);
+                "Prim name:" << name << " performance_cycle " << exu_cycle);
 
     int loop_input_count =
         weight_tile_y - 1; // read loop_input_count Repetitive input
@@ -75,13 +68,20 @@ void Matmul_f::taskCore(TaskCoreContext &context, string prim_name,
             }
         }
     }
+#endif
+    computeOps(exu_ops, sfu_ops);
+}
 
-    exu_ops = performance_cycle;
-    sfu_ops = 0;
-#else
-    // 计算overlap并写回output数据
-    // cout << "matmul output data size: " << data_size_out << endl;
-    exu_ops = (uint64_t)p["B"] * p["OC"] * p["T"] * p["C"] * 2;
+bool Matmul_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+    auto &p = param_value;
+    exu_ops = (u_int64_t)p["B"] * p["T"] * p["C"] * p["OC"] * 2;
     sfu_ops = 0;
-#endif
+    return true;
+}
+
+int64_t Matmul_f::gemmCycle(int cid) {
+    // 按照脉动阵列的数据流得到计算周期，包括填充、排空与padding
+    auto &p = param_value;
+    return COMP_COST.gemm(cid, (u_int64_t)p["B"] * p["T"], p["C"], p["OC"],
+                          ComputeDatatype(datatype, weight_datatype));
 }
\ No newline at end of file
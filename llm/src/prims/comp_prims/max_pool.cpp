@@ -21,10 +21,15 @@ void Max_pool::initialize() {
 void Max_pool::taskCore(TaskCoreContext &context, string prim_name,
                        u_int64_t &dram_time, u_int64_t &exu_ops,
                        u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Max_pool::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     int oH = (p["H"] + 2 * p["pY"] - p["kY"]) / p["sY"] + 1;
     int oW = (p["W"] + 2 * p["pX"] - p["kX"]) / p["sX"] + 1;
     int oC = p["C"];
     exu_ops = 0;
     sfu_ops = (u_int64_t)p["B"] * oC * oH * oW * p["kX"] * p["kY"];
+    return true;
 }
@@ -22,7 +22,12 @@ void Merge_matmul::initialize() {
 void Merge_matmul::taskCore(TaskCoreContext &context, string prim_name,
                             u_int64_t &dram_time, u_int64_t &exu_ops,
                             u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Merge_matmul::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = (u_int64_t)p["B"] * p["T"] * p["C"];
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -21,6 +21,11 @@ void parse_input::taskCore(TaskCoreContext &context, string prim_name,
          << inp_label << " to " << prim_context->datapass_label_->indata[0]
          << endl;
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool parse_input::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     exu_ops = 0;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -12,6 +12,11 @@ void parse_output::initialize() {
 void parse_output::taskCore(TaskCoreContext &context, string prim_name,
                            u_int64_t &dram_time, u_int64_t &exu_ops,
                            u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool parse_output::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     exu_ops = 0;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
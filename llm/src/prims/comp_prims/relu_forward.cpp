@@ -17,7 +17,12 @@ void Relu_f::initialize() {
 void Relu_f::taskCore(TaskCoreContext &context, string prim_name,
                      u_int64_t &dram_time, u_int64_t &exu_ops,
                      u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Relu_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = 0;
     sfu_ops = (u_int64_t)p["N"];
+    return true;
 }
\ No newline at end of file
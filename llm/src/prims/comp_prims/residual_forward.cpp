@@ -17,7 +17,12 @@ void Residual_f::initialize() {
 void Residual_f::taskCore(TaskCoreContext &context, string prim_name,
                          u_int64_t &dram_time, u_int64_t &exu_ops,
                          u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Residual_f::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = (u_int64_t)p["N"];
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -20,7 +20,12 @@ void rmsnorm_forward::taskCore(TaskCoreContext &context, string prim_name,
     checkStaticData(context, dram_time, data_chunk_addr["weight"],
                     GetFromPairedVector(data_chunk, "weight"), label_weight);
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool rmsnorm_forward::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = (u_int64_t)p["B"] * p["T"] * (4 * p["C"] + 3);
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
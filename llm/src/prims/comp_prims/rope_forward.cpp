@@ -20,6 +20,12 @@ void rope_forward::taskCore(TaskCoreContext &context, string prim_name,
     checkStaticData(context, dram_time, data_chunk_addr["sincos"],
                     GetFromPairedVector(data_chunk, "sincos"), label_sincos);
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool rope_forward::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
-    exu_ops = 6 * p["T"] * p["C"];
+    exu_ops = 6 * (u_int64_t)p["T"] * p["C"];
+    sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -14,7 +14,12 @@ void silu_forward::initialize() {
 void silu_forward::taskCore(TaskCoreContext &context, string prim_name,
                            u_int64_t &dram_time, u_int64_t &exu_ops,
                            u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool silu_forward::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = 0;
     sfu_ops = (u_int64_t)p["N"] * 8;
+    return true;
 }
\ No newline at end of file
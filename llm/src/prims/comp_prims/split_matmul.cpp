@@ -17,7 +17,11 @@ void Split_matmul::initialize() {
 void Split_matmul::taskCore(TaskCoreContext &context, string prim_name,
                            u_int64_t &dram_time, u_int64_t &exu_ops,
                            u_int64_t &sfu_ops) {
-    auto &p = param_value;
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool Split_matmul::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     exu_ops = 0;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
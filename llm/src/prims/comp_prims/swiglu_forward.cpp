@@ -14,7 +14,12 @@ void swiglu_forward::initialize() {
 void swiglu_forward::taskCore(TaskCoreContext &context, string prim_name,
                              u_int64_t &dram_time, u_int64_t &exu_ops,
                              u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool swiglu_forward::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     auto &p = param_value;
     exu_ops = (u_int64_t)p["N"] * 12;
     sfu_ops = 0;
+    return true;
 }
@@ -13,6 +13,11 @@ void switch_data::initialize() {
 void switch_data::taskCore(TaskCoreContext &context, string prim_name,
                           u_int64_t &dram_time, u_int64_t &exu_ops,
                           u_int64_t &sfu_ops) {
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool switch_data::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     exu_ops = 0;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "defs/global.h"
+#include "hardware/compute_cost.h"
 #include "prims/gpu_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/system_utils.h"
@@ -7,10 +9,7 @@
 REGISTER_PRIM(Attention_f_gpu);
 
 void Attention_f_gpu::initialize() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     auto &p = param_value;
     input_size = {data_byte * p["B"] * p["T"] * p["C"]};
@@ -56,101 +55,98 @@ int Attention_f_gpu::taskCoreDefault(TaskCoreContext &context) {
          << " at addr " << input_mem_offset << endl;
 
     int overlap_time = 0;
+    int cid = context.cid;
 #if USE_L1L2_CACHE == 1
-    // V
-    gpu_read_generic(
-        context,
-        input_mem_offset + input_size / 3 * 2 +
-            input_size / (3 * p["slice_x"] * p["slice_y"]) * fetch_index,
-        input_size / (3 * p["slice_x"] * p["slice_y"]), mem_time, true);
-    // K
-    gpu_read_generic(
-        context,
-        input_mem_offset + input_size / 3 +
-            input_size / (3 * p["slice_x"] * p["slice_y"]) * fetch_index,
-        input_size / (3 * p["slice_x"] * p["slice_y"]), mem_time, true);
-
-    cout << prim_context->cid << " [Attention_f_gpu] after read1: " << mem_time
-         << endl;
-    cout << prim_context->cid
-         << " [Attention_f_gpu] before write1: " << mem_time << " at addr "
-         << p_key.pos << endl;
-
-    gpu_write_generic(context,
-                      p_key.pos + GetFromPairedVector(data_chunk, "preatt") /
-                                      (p["slice_x"] * p["slice_y"]) *
-                                      fetch_index,
-                      GetFromPairedVector(data_chunk, "preatt") /
-                          (p["slice_x"] * p["slice_y"]),
-                      mem_time);
-    gpu_read_generic(context,
-                     p_key.pos + GetFromPairedVector(data_chunk, "preatt") /
-                                     (p["slice_x"] * p["slice_y"]) *
-                                     fetch_index,
-                     GetFromPairedVector(data_chunk, "preatt") /
-                         (p["slice_x"] * p["slice_y"]),
-                     mem_time);
-
-    gpu_write_generic(
-        context,
-        a_key.pos + GetFromPairedVector(data_chunk, "att") /
-                        (p["slice_x"] * p["slice_y"]) * fetch_index,
-        GetFromPairedVector(data_chunk, "att") / (p["slice_x"] * p["slice_y"]),
-        mem_time);
-    gpu_read_generic(
-        context,
-        a_key.pos + GetFromPairedVector(data_chunk, "att") /
-                        (p["slice_x"] * p["slice_y"]) * fetch_index,
-        GetFromPairedVector(data_chunk, "att") / (p["slice_x"] * p["slice_y"]),
-        mem_time);
-
-    // Q
-    gpu_read_generic(context,
-                     input_mem_offset + input_size /
-                                            (3 * p["slice_x"] * p["slice_y"]) *
-                                            fetch_index,
-                     input_size / (3 * p["slice_x"] * p["slice_y"]), mem_time);
+    int slice_total = p["slice_x"] * p["slice_y"];
+    int qkv_size = input_size / (3 * slice_total);
+    uint64_t q_addr = input_mem_offset + qkv_size * fetch_index;
+    uint64_t k_addr =
+        input_mem_offset + input_size / 3 + qkv_size * fetch_index;
+    uint64_t v_addr =
+        input_mem_offset + input_size / 3 * 2 + qkv_size * fetch_index;
 
-    AddrPosKey out_key;
-    prim_context->gpu_pos_locator_->updatePair(
-        prim_context->datapass_label_->outdata,
-        GetFromPairedVector(data_chunk, "output"));
-    prim_context->gpu_pos_locator_->findPair(
-        prim_context->datapass_label_->outdata, out_key);
-
-    gpu_write_generic(context, out_key.pos,
-                      GetFromPairedVector(data_chunk, "output"), mem_time);
     int cycle = 0;
-    int cid = context.cid;
 
     CoreHWConfig *core_config = GetCoreHWConfig(cid);
     ExuConfig *exu = core_config->exu;
     SfuConfig *sfu = core_config->sfu;
 
     if (exu->type == MAC_Array)
-        cycle += p["B"] * p["NH"] * p["T"] * (p["T"] - 1) / 2 *
-                 (4 * p["C"] / p["NH"] + 5) / (p["slice_x"] * p["slice_y"]) /
-                 (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+        cycle += COMP_COST.exu(cid,
+                               p["B"] * p["NH"] * p["T"] * (p["T"] - 1) / 2 *
+                                   (4 * p["C"] / p["NH"] + 5) / slice_total,
+                               datatype) *
+                 CYCLE;
     else
         assert(false && "Unsupported tile type");
 
     if (sfu->type == Linear)
-        cycle += 0 / (p["slice_x"] * p["slice_y"]) / sfu->x_dims * CYCLE;
+        cycle += COMP_COST.sfu(cid, 0, datatype) * CYCLE;
     else
         assert(false && "Unsupported tile type");
 
+    if (tile_k > 0) {
+        // 沿KV的序列维度切分（flash attention），Q常驻共享内存，
+        // preatt/att 只存在于片上，不再写回
+        gpu_read_generic(context, q_addr, qkv_size, mem_time);
+
+        int tiles = CeilingDivision(p["T"], tile_k);
+        runTilePipeline(context, tiles, cycle, [&](int t) {
+            // K
+            gpu_read_generic(context, k_addr + (uint64_t)qkv_size / tiles * t,
+                             qkv_size / tiles, mem_time, true);
+            // V
+            gpu_read_generic(context, v_addr + (uint64_t)qkv_size / tiles * t,
+                             qkv_size / tiles, mem_time, true);
+        });
+    } else {
+        // V
+        gpu_read_generic(context, v_addr, qkv_size, mem_time, true);
+        // K
+        gpu_read_generic(context, k_addr, qkv_size, mem_time, true);
+
+        cout << prim_context->cid << " [Attention_f_gpu] after read1: "
+             << mem_time << endl;
+        cout << prim_context->cid
+             << " [Attention_f_gpu] before write1: " << mem_time
+             << " at addr " << p_key.pos << endl;
+
+        int preatt_size =
+            GetFromPairedVector(data_chunk, "preatt") / slice_total;
+        int att_size = GetFromPairedVector(data_chunk, "att") / slice_total;
+        gpu_write_generic(context, p_key.pos + preatt_size * fetch_index,
+                          preatt_size, mem_time);
+        gpu_read_generic(context, p_key.pos + preatt_size * fetch_index,
+                         preatt_size, mem_time);
+
+        gpu_write_generic(context, a_key.pos + att_size * fetch_index, att_size,
+                          mem_time);
+        gpu_read_generic(context, a_key.pos + att_size * fetch_index, att_size,
+                         mem_time);
+
+        // Q
+        gpu_read_generic(context, q_addr, qkv_size, mem_time);
+    }
+
+    AddrPosKey out_key;
+    prim_context->gpu_pos_locator_->updatePair(
+        prim_context->datapass_label_->outdata,
+        GetFromPairedVector(data_chunk, "output"));
+    prim_context->gpu_pos_locator_->findPair(
+        prim_context->datapass_label_->outdata, out_key);
 
-    if (mem_time > cycle) {
+    gpu_write_generic(context, out_key.pos,
+                      GetFromPairedVector(data_chunk, "output"), mem_time);
+
+    // 流水线模式下计算已经在tile之间重叠完毕
+    if (tile_k > 0) {
+        overlap_time = 0;
+    } else if (mem_time > cycle) {
         // 因为dram 已经wait 过了，所以额外的 overlap_time = 0
         overlap_time = 0;
         LOG_VERBOSE(1, context.cid,
                     "Prim name:" << name << RED << " cycle: " << cycle
                                  << ", dram_time: " << mem_time << RESET);
-
-        // std::cout << RED << "cycle: " << cycle << ", dram_time: " <<
-        // dram_time
-        //           << RESET << std::endl;
-
     } else {
         overlap_time = cycle - mem_time;
         LOG_VERBOSE(1, context.cid,
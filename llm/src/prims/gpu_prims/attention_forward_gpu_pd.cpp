@@ -1,6 +1,8 @@
 #include "defs/enums.h"
 #include "defs/global.h"
+#include "hardware/compute_cost.h"
 #include "prims/gpu_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/system_utils.h"
@@ -9,10 +11,7 @@
 REGISTER_PRIM(attention_forward_gpu_pd);
 
 void attention_forward_gpu_pd::initialize() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     auto &p = param_value;
     data_size_input = {data_byte * p["B"] * p["T"] * p["C"]};
@@ -144,14 +143,17 @@ int attention_forward_gpu_pd::taskCoreDefault(TaskCoreContext &context) {
     SfuConfig *sfu = core_config->sfu;
 
     if (exu->type == MAC_Array)
-        cycle += p["B"] * p["NH"] * p["T"] * (p["T"] - 1) / 2 *
-                 (4 * p["C"] / p["NH"] + 5) / (p["slice_x"] * p["slice_y"]) /
-                 (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+        cycle += COMP_COST.exu(cid,
+                               p["B"] * p["NH"] * p["T"] * (p["T"] - 1) / 2 *
+                                   (4 * p["C"] / p["NH"] + 5) /
+                                   (p["slice_x"] * p["slice_y"]),
+                               datatype) *
+                 CYCLE;
     else
         assert(false && "Unsupported tile type");
 
     if (sfu->type == Linear)
-        cycle += 0 / (p["slice_x"] * p["slice_y"]) / sfu->x_dims * CYCLE;
+        cycle += COMP_COST.sfu(cid, 0, datatype) * CYCLE;
     else
         assert(false && "Unsupported tile type");
 
@@ -1,4 +1,6 @@
+#include "hardware/compute_cost.h"
 #include "prims/gpu_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/system_utils.h"
@@ -6,10 +8,7 @@
 REGISTER_PRIM(Gelu_f_gpu);
 
 void Gelu_f_gpu::initialize() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     auto &p = param_value;
     input_size = {data_byte * p["N"]};
@@ -61,13 +60,15 @@ int Gelu_f_gpu::taskCoreDefault(TaskCoreContext &context) {
     SfuConfig *sfu = core_config->sfu;
 
     if (exu->type == MAC_Array)
-        cycle += 0 / (p["slice_x"] * p["slice_y"]) /
-                 (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+        cycle += COMP_COST.exu(cid, 0, datatype) * CYCLE;
     else
         assert(false && "Unsupported tile type");
 
     if (sfu->type == Linear)
-        cycle += p["N"] / (p["slice_x"] * p["slice_y"]) / sfu->x_dims * CYCLE;
+        cycle += COMP_COST.sfu(cid,
+                               p["N"] / (p["slice_x"] * p["slice_y"]),
+                               datatype) *
+                 CYCLE;
     else
         assert(false && "Unsupported tile type");
 
@@ -1,4 +1,6 @@
+#include "hardware/compute_cost.h"
 #include "prims/gpu_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/system_utils.h"
@@ -6,15 +8,12 @@
 REGISTER_PRIM(Layernorm_f_gpu);
 
 void Layernorm_f_gpu::initialize() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     auto &p = param_value;
     data_size_input = {data_byte * p["B"] * p["T"] * p["C"]};
-    data_chunk = {{"weight", data_byte * p["C"]},
-                  {"bias", data_byte * p["C"]},
+    data_chunk = {{"weight", chunkBytes("weight", p["C"])},
+                  {"bias", chunkBytes("bias", p["C"])},
                   {"output", data_byte * p["B"] * p["T"] * p["C"] /
                                  (p["slice_x"] * p["slice_y"])}};
 }
@@ -98,13 +97,16 @@ cout << "3\n";
     SfuConfig *sfu = core_config->sfu;
 
     if (exu->type == MAC_Array)
-        cycle += 0 / (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+        cycle += COMP_COST.exu(prim_context->cid, 0, datatype) * CYCLE;
     else
         assert(false && "Unsupported tile type");
 
     if (sfu->type == Linear)
-        cycle += p["B"] * p["T"] * (8 * p["C"] + 5) /
-                 (p["slice_x"] * p["slice_y"]) / sfu->x_dims * CYCLE;
+        cycle += COMP_COST.sfu(prim_context->cid,
+                               p["B"] * p["T"] * (8 * p["C"] + 5) /
+                                   (p["slice_x"] * p["slice_y"]),
+                               datatype) *
+                 CYCLE;
     else
         assert(false && "Unsupported tile type");
 
@@ -1,4 +1,6 @@
+#include "hardware/compute_cost.h"
 #include "prims/gpu_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/system_utils.h"
@@ -6,15 +8,12 @@
 REGISTER_PRIM(Matmul_f_gpu);
 
 void Matmul_f_gpu::initialize() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     auto &p = param_value;
     input_size = {data_byte * p["B"] * p["T"] * p["C"]};
-    data_chunk = {{"weight", data_byte * p["C"] * p["OC"]},
-                  {"bias", data_byte * p["C"]},
+    data_chunk = {{"weight", chunkBytes("weight", p["C"] * p["OC"])},
+                  {"bias", chunkBytes("bias", p["C"])},
                   {"output", data_byte * p["B"] * p["T"] * p["OC"] /
                                  (p["slice_x"] * p["slice_y"])}};
 }
@@ -56,147 +55,105 @@ int Matmul_f_gpu::taskCoreDefault(TaskCoreContext &context) {
 
     int overlap_time = 0;
 #if USE_L1L2_CACHE == 1
+    int slice_total = p["slice_x"] * p["slice_y"];
+
+    // inner：每个SM计算输出的一个分块，需要完整的K维
+    // outer：每个SM负责K维的一段，输出完整的部分和
+    uint64_t in_addr, w_addr, b_addr, out_offset;
+    int in_size, w_size, b_size, out_write_size, k_range;
     if (gpu_inner == true) {
         // 通过fetch_index计算位置
         int row_index = fetch_index / p["slice_x"];
         int col_index = fetch_index % p["slice_x"];
 
-        // input 读入
-        gpu_read_generic(
-            context, input_mem_offset + input_size / p["slice_y"] * row_index,
-            input_size / p["slice_y"], mem_time);
-
-        // weight 读入
-        gpu_read_generic(
-            context, w_key.pos + w_key.size / p["slice_x"] * col_index,
-            GetFromPairedVector(data_chunk, "weight") / p["slice_x"], mem_time);
-
-        // bias 读入
-        gpu_read_generic(
-            context, b_key.pos + b_key.size / p["slice_x"] * col_index,
-            GetFromPairedVector(data_chunk, "bias") / p["slice_x"], mem_time);
-
-        // TODO: 模拟计算cycle数
-        // overlap_time = mem_time;
-        AddrPosKey out_key;
-        prim_context->gpu_pos_locator_->updatePair(
-            prim_context->datapass_label_->outdata,
-            GetFromPairedVector(data_chunk, "output") *
-                (p["slice_x"] * p["slice_y"]));
-        prim_context->gpu_pos_locator_->findPair(
-            prim_context->datapass_label_->outdata, out_key);
-        cout << prim_context->cid
-             << " [Matmul_f_gpu] before write: " << mem_time << " at addr "
-             << out_key.pos << endl;
-        gpu_write_generic(context,
-                          out_key.pos +
-                              GetFromPairedVector(data_chunk, "output") *
-                                  fetch_index,
-                          GetFromPairedVector(data_chunk, "output"), mem_time);
-
-        int cycle = 0;
-
-        CoreHWConfig *core_config = GetCoreHWConfig(prim_context->cid);
-        ExuConfig *exu = core_config->exu;
-        SfuConfig *sfu = core_config->sfu;
-
-        if (exu->type == MAC_Array)
-            cycle += (p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
-                      (p["slice_x"] * p["slice_y"])) /
-                     (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
-        else
-            assert(false && "Unsupported tile type");
-
-        if (sfu->type == Linear)
-            cycle += 0 / sfu->x_dims * CYCLE;
-        else
-            assert(false && "Unsupported tile type");
-
-
-        if (mem_time > cycle) {
-            // 因为dram 已经wait 过了，所以额外的 overlap_time = 0
-            overlap_time = 0;
-            LOG_VERBOSE(1, prim_context->cid,
-                        "Prim name:" << name << RED << " cycle: " << cycle
-                                     << ", dram_time: " << mem_time << RESET);
-
-            // std::cout << RED << "cycle: " << cycle << ", dram_time: " <<
-            // dram_time
-            //           << RESET << std::endl;
-
-        } else {
-            overlap_time = cycle - mem_time;
-            LOG_VERBOSE(1, prim_context->cid,
-                        "Prim name:" << name << GREEN << " cycle: " << cycle
-                                     << ", dram_time: " << mem_time << RESET);
-        }
+        in_addr = input_mem_offset + input_size / p["slice_y"] * row_index;
+        in_size = input_size / p["slice_y"];
+        w_addr = w_key.pos + w_key.size / p["slice_x"] * col_index;
+        w_size = GetFromPairedVector(data_chunk, "weight") / p["slice_x"];
+        b_addr = b_key.pos + b_key.size / p["slice_x"] * col_index;
+        b_size = GetFromPairedVector(data_chunk, "bias") / p["slice_x"];
+        out_offset = GetFromPairedVector(data_chunk, "output") * fetch_index;
+        out_write_size = GetFromPairedVector(data_chunk, "output");
+        k_range = p["C"];
     } else {
+        in_addr = input_mem_offset + input_size / slice_total * fetch_index;
+        in_size = input_size / slice_total;
+        w_addr = w_key.pos + w_key.size / slice_total * fetch_index;
+        w_size = GetFromPairedVector(data_chunk, "weight") / slice_total;
+        b_addr = b_key.pos + b_key.size / slice_total * fetch_index;
+        b_size = GetFromPairedVector(data_chunk, "bias") / slice_total;
+        out_offset = 0;
+        out_write_size =
+            GetFromPairedVector(data_chunk, "output") * slice_total;
+        k_range = max(p["C"] / slice_total, 1);
+    }
 
-        int slice_total = p["slice_x"] * p["slice_y"];
+    int cycle = 0;
+
+    CoreHWConfig *core_config = GetCoreHWConfig(prim_context->cid);
+    ExuConfig *exu = core_config->exu;
+    SfuConfig *sfu = core_config->sfu;
+
+    if (exu->type == MAC_Array)
+        cycle += COMP_COST.exu(prim_context->cid,
+                               p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
+                                   slice_total,
+                               datatype) *
+                 CYCLE;
+    else
+        assert(false && "Unsupported tile type");
+
+    if (sfu->type == Linear)
+        cycle += COMP_COST.sfu(prim_context->cid, 0, datatype) * CYCLE;
+    else
+        assert(false && "Unsupported tile type");
+
+    if (tile_k > 0) {
+        // bias 在流水线开始前读入
+        gpu_read_generic(context, b_addr, b_size, mem_time);
+
+        // 沿K维切分，每个tile读入input与weight的对应部分（按地址区间等分近似）
+        int tiles = CeilingDivision(k_range, tile_k);
+        runTilePipeline(context, tiles, cycle, [&](int t) {
+            gpu_read_generic(context, in_addr + (uint64_t)in_size / tiles * t,
+                             in_size / tiles, mem_time);
+            gpu_read_generic(context, w_addr + (uint64_t)w_size / tiles * t,
+                             w_size / tiles, mem_time);
+        });
+    } else {
         // input 读入
-        gpu_read_generic(
-            context, input_mem_offset + input_size / slice_total * fetch_index,
-            input_size / slice_total, mem_time);
-
+        gpu_read_generic(context, in_addr, in_size, mem_time);
         // weight 读入
-        gpu_read_generic(
-            context, w_key.pos + w_key.size / slice_total * fetch_index,
-            GetFromPairedVector(data_chunk, "weight") / slice_total, mem_time);
-
+        gpu_read_generic(context, w_addr, w_size, mem_time);
         // bias 读入
-        gpu_read_generic(
-            context, b_key.pos + b_key.size / slice_total * fetch_index,
-            GetFromPairedVector(data_chunk, "bias") / slice_total, mem_time);
-
-        AddrPosKey out_key;
-        prim_context->gpu_pos_locator_->updatePair(
-            prim_context->datapass_label_->outdata,
-            GetFromPairedVector(data_chunk, "output") * slice_total);
-        prim_context->gpu_pos_locator_->findPair(
-            prim_context->datapass_label_->outdata, out_key);
-        cout << prim_context->cid
-             << " [Matmul_f_gpu] before write: " << mem_time << " at addr "
-             << out_key.pos << endl;
-        gpu_write_generic(
-            context, out_key.pos,
-            GetFromPairedVector(data_chunk, "output") * slice_total, mem_time);
-
-        int cycle = 0;
-
-        CoreHWConfig *core_config = GetCoreHWConfig(prim_context->cid);
-        ExuConfig *exu = core_config->exu;
-        SfuConfig *sfu = core_config->sfu;
-
-        if (exu->type == MAC_Array)
-            cycle += (p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
-                      (p["slice_x"] * p["slice_y"])) /
-                     (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
-        else
-            assert(false && "Unsupported tile type");
-
-        if (sfu->type == Linear)
-            cycle += 0 / sfu->x_dims * CYCLE;
-        else
-            assert(false && "Unsupported tile type");
-
-
-        if (mem_time > cycle) {
-            // 因为dram 已经wait 过了，所以额外的 overlap_time = 0
-            overlap_time = 0;
-            LOG_VERBOSE(1, prim_context->cid,
-                        "Prim name:" << name << RED << " cycle: " << cycle
-                                     << ", dram_time: " << mem_time << RESET);
-
-            // std::cout << RED << "cycle: " << cycle << ", dram_time: " <<
-            // dram_time
-            //           << RESET << std::endl;
-
-        } else {
-            overlap_time = cycle - mem_time;
-            LOG_VERBOSE(1, prim_context->cid,
-                        "Prim name:" << name << GREEN << " cycle: " << cycle
-                                     << ", dram_time: " << mem_time << RESET);
-        }
+        gpu_read_generic(context, b_addr, b_size, mem_time);
+    }
+
+    AddrPosKey out_key;
+    prim_context->gpu_pos_locator_->updatePair(
+        prim_context->datapass_label_->outdata,
+        GetFromPairedVector(data_chunk, "output") * slice_total);
+    prim_context->gpu_pos_locator_->findPair(
+        prim_context->datapass_label_->outdata, out_key);
+    cout << prim_context->cid << " [Matmul_f_gpu] before write: " << mem_time
+         << " at addr " << out_key.pos << endl;
+    gpu_write_generic(context, out_key.pos + out_offset, out_write_size,
+                      mem_time);
+
+    // 流水线模式下计算已经在tile之间重叠完毕
+    if (tile_k > 0) {
+        overlap_time = 0;
+    } else if (mem_time > cycle) {
+        // 因为dram 已经wait 过了，所以额外的 overlap_time = 0
+        overlap_time = 0;
+        LOG_VERBOSE(1, prim_context->cid,
+                    "Prim name:" << name << RED << " cycle: " << cycle
+                                 << ", dram_time: " << mem_time << RESET);
+    } else {
+        overlap_time = cycle - mem_time;
+        LOG_VERBOSE(1, prim_context->cid,
+                    "Prim name:" << name << GREEN << " cycle: " << cycle
+                                 << ", dram_time: " << mem_time << RESET);
     }
 #endif
 
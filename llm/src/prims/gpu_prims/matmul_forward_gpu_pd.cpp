@@ -1,4 +1,6 @@
+#include "hardware/compute_cost.h"
 #include "prims/gpu_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/system_utils.h"
@@ -6,15 +8,12 @@
 REGISTER_PRIM(matmul_forward_gpu_pd);
 
 void matmul_forward_gpu_pd::initialize() {
-    if (datatype == INT8)
-        data_byte = 1;
-    else if (datatype == FP16)
-        data_byte = 2;
+    data_byte = GetDatatypeDesc(datatype).byteWidth();
 
     auto &p = param_value;
     input_size = {data_byte * p["B"] * p["T"] * p["C"]};
-    data_chunk = {{"weight", data_byte * p["C"] * p["OC"]},
-                  {"bias", data_byte * p["C"]},
+    data_chunk = {{"weight", chunkBytes("weight", p["C"] * p["OC"])},
+                  {"bias", chunkBytes("bias", p["C"])},
                   {"output", data_byte * p["B"] * p["T"] * p["oC"] /
                                  (3 * p["slice_x"] * p["slice_y"])}};
 }
@@ -93,12 +92,15 @@ int matmul_forward_gpu_pd::taskCoreDefault(TaskCoreContext &context) {
             switch (p["job_type"]) {
             case JOB_PREFILL:
             case JOB_BOTH:
-                size = data_byte * p["B"] * p["OC"] * stage.token_num /
-                       (p["slice_y"] * p["slice_x"]) / 3;
+                size = DatatypeBytes(kv_datatype,
+                                     (u_int64_t)p["B"] * p["OC"] *
+                                         stage.token_num /
+                                         (p["slice_y"] * p["slice_x"]) / 3);
                 break;
             case JOB_DECODE:
-                size = data_byte * p["B"] * p["OC"] * 1 /
-                       (p["slice_y"] * p["slice_x"]) / 3;
+                size = DatatypeBytes(kv_datatype,
+                                     (u_int64_t)p["B"] * p["OC"] * 1 /
+                                         (p["slice_y"] * p["slice_x"]) / 3);
                 break;
             default:
                 assert(false && "Unsupported job type");
@@ -151,14 +153,16 @@ int matmul_forward_gpu_pd::taskCoreDefault(TaskCoreContext &context) {
         SfuConfig *sfu = core_config->sfu;
 
         if (exu->type == MAC_Array)
-            cycle += (p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
-                      (p["slice_x"] * p["slice_y"])) /
-                     (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+            cycle += COMP_COST.exu(prim_context->cid,
+                                   p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
+                                       (p["slice_x"] * p["slice_y"]),
+                                   datatype) *
+                     CYCLE;
         else
             assert(false && "Unsupported tile type");
 
         if (sfu->type == Linear)
-            cycle += 0 / sfu->x_dims * CYCLE;
+            cycle += COMP_COST.sfu(prim_context->cid, 0, datatype) * CYCLE;
         else
             assert(false && "Unsupported tile type");
 
@@ -212,12 +216,15 @@ int matmul_forward_gpu_pd::taskCoreDefault(TaskCoreContext &context) {
             switch (p["job_type"]) {
             case JOB_PREFILL:
             case JOB_BOTH:
-                size = data_byte * p["B"] * p["OC"] * stage.token_num /
-                       (p["slice_y"] * p["slice_x"]) / 3;
+                size = DatatypeBytes(kv_datatype,
+                                     (u_int64_t)p["B"] * p["OC"] *
+                                         stage.token_num /
+                                         (p["slice_y"] * p["slice_x"]) / 3);
                 break;
             case JOB_DECODE:
-                size = data_byte * p["B"] * p["OC"] * 1 /
-                       (p["slice_y"] * p["slice_x"]) / 3;
+                size = DatatypeBytes(kv_datatype,
+                                     (u_int64_t)p["B"] * p["OC"] * 1 /
+                                         (p["slice_y"] * p["slice_x"]) / 3);
                 break;
             default:
                 assert(false && "Unsupported job type");
@@ -273,14 +280,16 @@ int matmul_forward_gpu_pd::taskCoreDefault(TaskCoreContext &context) {
         SfuConfig *sfu = core_config->sfu;
 
         if (exu->type == MAC_Array)
-            cycle += (p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
-                      (p["slice_x"] * p["slice_y"])) /
-                     (exu->x_dims * exu->y_dims * 2 * comp_util) * CYCLE;
+            cycle += COMP_COST.exu(prim_context->cid,
+                                   p["B"] * p["T"] * p["C"] * p["OC"] * 2 /
+                                       (p["slice_x"] * p["slice_y"]),
+                                   datatype) *
+                     CYCLE;
         else
             assert(false && "Unsupported tile type");
 
         if (sfu->type == Linear)
-            cycle += 0 / sfu->x_dims * CYCLE;
+            cycle += COMP_COST.sfu(prim_context->cid, 0, datatype) * CYCLE;
         else
             assert(false && "Unsupported tile type");
 
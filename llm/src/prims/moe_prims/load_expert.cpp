@@ -70,6 +70,11 @@ void load_expert::taskCore(TaskCoreContext &context, string prim_name,
 
     cout << "[load_expert] Prefetch expert: " << exp_1 << endl;
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool load_expert::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
     exu_ops = 0;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "prims/moe_prims.h"
+#include "hardware/compute_cost.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/print_utils.h"
 #include "utils/system_utils.h"
@@ -131,31 +133,17 @@ void matmul_forward_moe::taskCore(TaskCoreContext &context, string prim_name,
     ARGUS_PRINT(dram_time);
 
 
-    if (p["is_merge"])
-        exu_ops = (u_int64_t)p["B"] * p["T"] * p["C"] * p["OC"] * p["K"] * 2 +
-                  (u_int64_t)p["B"] * p["T"] * p["OC"] * p["K"];
-    else
-        exu_ops = (uint64_t)p["B"] * p["T"] * p["C"] * p["OC"] * p["K"] * 2;
+    computeOps(exu_ops, sfu_ops);
 
 #if PERFORMANCE_MODE == 1
 
     ExuConfig *exu = GetCoreHWConfig(context.cid)->exu;
 
-    uint64_t weight_tile_x = (p["C"] + exu->x_dims - 1) / exu->x_dims;
     uint64_t weight_tile_y = (p["OC"] + exu->y_dims - 1) / exu->y_dims;
 
-    uint64_t padding_input_x = (p["T"] * p["B"] * p["K"]) > exu->x_dims
-                                   ? p["T"] * p["B"] * p["K"]
-                                   : exu->x_dims;
-
-    uint64_t performance_cycle = (exu->x_dims + exu->x_dims + padding_input_x) *
-                                 weight_tile_x * weight_tile_y;
-
-    uint64_t performance_comp =
-        performance_cycle * exu->y_dims * exu->x_dims * comp_util;
+    exu_cycle = gemmCycle(context.cid);
     LOG_VERBOSE(1, context.cid,
-                "Prim name:" << name << " performance_cycle "
-                             << performance_cycle);
+                "Prim name:" << name << " performance_cycle " << exu_cycle);
 
     int loop_input_count =
         weight_tile_y - 1; // read loop_input_count Repetitive input
@@ -170,7 +158,23 @@ void matmul_forward_moe::taskCore(TaskCoreContext &context, string prim_name,
             }
         }
     }
-
-    exu_ops = performance_comp;
 #endif
+}
+
+bool matmul_forward_moe::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+    auto &p = param_value;
+    if (p["is_merge"])
+        exu_ops = (u_int64_t)p["B"] * p["T"] * p["C"] * p["OC"] * p["K"] * 2 +
+                  (u_int64_t)p["B"] * p["T"] * p["OC"] * p["K"];
+    else
+        exu_ops = (uint64_t)p["B"] * p["T"] * p["C"] * p["OC"] * p["K"] * 2;
+    sfu_ops = 0;
+    return true;
+}
+
+int64_t matmul_forward_moe::gemmCycle(int cid) {
+    // 按照脉动阵列的数据流得到计算周期，包括填充、排空与padding
+    auto &p = param_value;
+    return COMP_COST.gemm(cid, (u_int64_t)p["B"] * p["T"] * p["K"], p["C"],
+                          p["OC"], ComputeDatatype(datatype, weight_datatype));
 }
\ No newline at end of file
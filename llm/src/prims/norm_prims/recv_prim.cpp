@@ -22,7 +22,7 @@ void Recv_prim::deserialize(vector<sc_bv<128>> segments) {
     type = RECV_TYPE(buffer.range(11, 8).to_uint64());
     tag_id = buffer.range(19, 12).to_uint64();
     recv_cnt = buffer.range(27, 20).to_uint64();
-    datatype = DATATYPE(buffer.range(29, 28).to_uint64());
+    datatype = DATATYPE(buffer.range(31, 28).to_uint64());
 }
 
 vector<sc_bv<128>> Recv_prim::serialize() {
@@ -33,7 +33,7 @@ vector<sc_bv<128>> Recv_prim::serialize() {
     d.range(11, 8) = sc_bv<4>(type);
     d.range(19, 12) = sc_bv<8>(tag_id);
     d.range(27, 20) = sc_bv<8>(recv_cnt);
-    d.range(29, 28) = sc_bv<2>(datatype);
+    d.range(31, 28) = sc_bv<4>(datatype);
     segments.push_back(d);
 
     return segments;
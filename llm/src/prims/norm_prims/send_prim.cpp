@@ -13,6 +13,8 @@ void Send_prim::printSelf() {
 
 
     cout << "\t[" << GetEnumSendType(type) << "] > send to " << des_id << endl;
+    if (mcast_id)
+        cout << "\tmulticast group " << mcast_id << endl;
     cout << "\tmax_packet: " << max_packet << ", tag_id: " << tag_id
          << ", end_length: " << end_length << endl;
 
@@ -34,7 +36,8 @@ void Send_prim::deserialize(vector<sc_bv<128>> segments) {
     max_packet = buffer.range(91, 60).to_uint64();
     tag_id = buffer.range(99, 92).to_uint64();
     end_length = buffer.range(107, 100).to_uint64();
-    datatype = DATATYPE(buffer.range(109, 108).to_uint64());
+    datatype = DATATYPE(buffer.range(111, 108).to_uint64());
+    mcast_id = buffer.range(127, 112).to_uint64();
 }
 
 vector<sc_bv<128>> Send_prim::serialize() {
@@ -56,7 +59,8 @@ vector<sc_bv<128>> Send_prim::serialize() {
     d.range(91, 60) = sc_bv<32>(max_packet);
     d.range(99, 92) = sc_bv<8>(tag_id);
     d.range(107, 100) = sc_bv<8>(end_length);
-    d.range(109, 108) = sc_bv<2>(datatype);
+    d.range(111, 108) = sc_bv<4>(datatype);
+    d.range(127, 112) = sc_bv<16>(mcast_id);
     segments.push_back(d);
 
     return segments;
@@ -18,9 +18,9 @@ void Set_addr::deserialize(vector<sc_bv<128>> segments) {
     auto buffer = segments[0];
 
     sram_addr = buffer.range(31, 8).to_uint64();
-    datatype = (DATATYPE)buffer.range(33, 32).to_uint64();
+    datatype = (DATATYPE)buffer.range(35, 32).to_uint64();
 
-    int offset = 34;
+    int offset = 36;
     for (int i = 0; i < MAX_SPLIT_NUM; i++) {
         datapass_label.indata[i] = g_addr_label_table.findRecord(
             buffer.range(offset + 11, offset).to_uint64());
@@ -36,9 +36,9 @@ vector<sc_bv<128>> Set_addr::serialize() {
     sc_bv<128> d;
     d.range(7, 0) = sc_bv<8>(PrimFactory::getInstance().getPrimId(name));
     d.range(31, 8) = sc_bv<24>(sram_addr);
-    d.range(33, 32) = sc_bv<2>(datatype);
+    d.range(35, 32) = sc_bv<4>(datatype);
 
-    int offset = 34;
+    int offset = 36;
     for (int i = 0; i < MAX_SPLIT_NUM; i++) {
         d.range(offset + 11, offset) = sc_bv<12>(g_addr_label_table.addRecord(
             prim_context->datapass_label_->indata[i]));
@@ -14,7 +14,7 @@ void Store_prim::deserialize(vector<sc_bv<128>> segments) {
     dram_addr = buffer.range(23, 8).to_uint64();
     sram_addr = buffer.range(39, 24).to_uint64();
     size = buffer.range(55, 40).to_uint64();
-    datatype = (DATATYPE)buffer.range(57, 56).to_uint64();
+    datatype = (DATATYPE)buffer.range(59, 56).to_uint64();
 }
 
 vector<sc_bv<128>> Store_prim::serialize() {
@@ -25,7 +25,7 @@ vector<sc_bv<128>> Store_prim::serialize() {
     d.range(23, 8) = sc_bv<16>(dram_addr);
     d.range(39, 24) = sc_bv<16>(sram_addr);
     d.range(55, 40) = sc_bv<16>(size);
-    d.range(57, 56) = sc_bv<2>(datatype);
+    d.range(59, 56) = sc_bv<4>(datatype);
     segments.push_back(d);
 
     return segments;
@@ -1,4 +1,5 @@
 #include "prims/pd_prims.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 
@@ -113,7 +114,8 @@ void attention_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
         sram_read_generic(context, vcache.size, vcache.pos, dram_time);
 #endif
 
-        cur_tokens = kcache.size / (p["B"] * p["C"] * data_byte);
+        cur_tokens =
+            kcache.size / DatatypeBytes(kv_datatype, p["B"] * p["C"]);
     }
 
     // 写入preatt中间结果
@@ -141,7 +143,13 @@ void attention_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
     sram_read_generic_temp(context, data_byte * data_chunk_addr["att"],
                            temp_sram_addr_prior, dram_time);
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool attention_forward_pd::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+    auto &p = param_value;
     exu_ops = (u_int64_t)p["B"] * p["NH"] * p["T"] * (p["T"] - 1) / 2 *
               (4 * p["C"] / p["NH"] + 5);
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
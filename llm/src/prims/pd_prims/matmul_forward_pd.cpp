@@ -1,5 +1,7 @@
 #include "common/pd.h"
 #include "prims/pd_prims.h"
+#include "hardware/compute_cost.h"
+#include "utils/datatype_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/prim_utils.h"
 #include "utils/print_utils.h"
@@ -15,6 +17,30 @@ void matmul_forward_pd::initialize() {
                   {"output", p["B"] * p["T"] * p["OC"] / 3}};
 }
 
+void matmul_forward_pd::staticData(const string &prim_name,
+                                   vector<Static_chunk> &chunks) {
+    auto &p = param_value;
+    if (p["T"] == 0)
+        return;
+
+    // 与taskCore相同：没有decode阶段时只读入1/chunk的权重
+    bool need_multiply = false;
+    for (auto stage : prim_context->batch_info_) {
+        if (stage.type == DECODE) {
+            need_multiply = true;
+            break;
+        }
+    }
+
+    int chunk_ratio = need_multiply ? 1 : p["chunk"];
+    chunks.push_back({ETERNAL_PREFIX + prim_name + "_w",
+                      (u_int64_t)data_chunk_addr["weight"],
+                      GetFromPairedVector(data_chunk, "weight") / chunk_ratio});
+    chunks.push_back({ETERNAL_PREFIX + prim_name + "_b",
+                      (u_int64_t)data_chunk_addr["bias"],
+                      GetFromPairedVector(data_chunk, "bias") / chunk_ratio});
+}
+
 void matmul_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
                                  u_int64_t &dram_time, u_int64_t &exu_ops,
                                  u_int64_t &sfu_ops) {
@@ -57,10 +83,12 @@ void matmul_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
         switch (p["job_type"]) {
         case JOB_PREFILL:
         case JOB_BOTH:
-            size = data_byte * p["B"] * p["OC"] * stage.token_num / 3;
+            size = DatatypeBytes(kv_datatype, (u_int64_t)p["B"] * p["OC"] *
+                                                  stage.token_num / 3);
             break;
         case JOB_DECODE:
-            size = data_byte * p["B"] * p["OC"] / 3 * p["chunk"];
+            size = DatatypeBytes(kv_datatype,
+                                 (u_int64_t)p["B"] * p["OC"] / 3 * p["chunk"]);
             break;
         default:
             assert(false && "Unsupported job type");
@@ -118,20 +146,11 @@ void matmul_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
 
     ExuConfig *exu = GetCoreHWConfig(context.cid)->exu;
 
-    uint64_t weight_tile_x = (p["C"] + exu->x_dims - 1) / exu->x_dims;
     uint64_t weight_tile_y = (p["OC"] + exu->y_dims - 1) / exu->y_dims;
 
-    uint64_t padding_input_x =
-        (p["B"] * p["T"]) > exu->x_dims ? p["B"] * p["T"] : exu->x_dims;
-
-    uint64_t performance_cycle = (exu->x_dims + exu->x_dims + padding_input_x) *
-                                 weight_tile_x * weight_tile_y;
-
-    uint64_t performance_comp =
-        performance_cycle * exu->y_dims * exu->x_dims * comp_util;
+    exu_cycle = gemmCycle(context.cid);
     LOG_VERBOSE(1, context.cid,
-                "Prim name:" << name << " performance_cycle "
-                             << performance_cycle);
+                "Prim name:" << name << " performance_cycle " << exu_cycle);
 
     int loop_input_count =
         weight_tile_y - 1; // read loop_input_count Repetitive input
@@ -147,9 +166,21 @@ void matmul_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
         }
     }
 
-    exu_ops = performance_comp;
     ARGUS_PRINT(dram_time);
-#else
-    exu_ops = (u_int64_t)p["B"] * p["T"] * p["C"] * p["OC"] * 2;
 #endif
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool matmul_forward_pd::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+    auto &p = param_value;
+    exu_ops = (u_int64_t)p["B"] * p["T"] * p["C"] * p["OC"] * 2;
+    sfu_ops = 0;
+    return true;
+}
+
+int64_t matmul_forward_pd::gemmCycle(int cid) {
+    // 按照脉动阵列的数据流得到计算周期，包括填充、排空与padding
+    auto &p = param_value;
+    return COMP_COST.gemm(cid, (u_int64_t)p["B"] * p["T"], p["C"], p["OC"],
+                          ComputeDatatype(datatype, weight_datatype));
 }
@@ -31,8 +31,6 @@ void rope_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
                     label_sincos);
 
     // 在这里写回kvcache
-    int total_tokens = 0;
-
     for (auto stage : prim_context->batch_info_) {
         int size = 0;
         switch (p["job_type"]) {
@@ -47,8 +45,6 @@ void rope_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
             assert(false && "Unsupported job type");
         }
 
-        total_tokens += stage.token_num;
-
         char format_label_k[100];
         sprintf(format_label_k, "%s%sk#%d", ETERNAL_PREFIX, KVCACHE_PREFIX,
                 stage.req_id);
@@ -86,6 +82,17 @@ void rope_forward_pd::taskCore(TaskCoreContext &context, string prim_name,
 #endif
     }
 
+    computeOps(exu_ops, sfu_ops);
+}
+
+bool rope_forward_pd::computeOps(u_int64_t &exu_ops, u_int64_t &sfu_ops) {
+    // 运算量与本轮batch中所有阶段的token数之和成正比
+    auto &p = param_value;
+    u_int64_t total_tokens = 0;
+    for (auto stage : prim_context->batch_info_)
+        total_tokens += stage.token_num;
+
     exu_ops = (u_int64_t)p["C"] * total_tokens * 6;
     sfu_ops = 0;
+    return true;
 }
\ No newline at end of file
@@ -34,11 +34,39 @@ RouterUnit::RouterUnit(const sc_module_name &n, int rid,
     for (int i = 0; i < DIRECTIONS; i++) {
         input_lock[i] = 0;
         input_lock_ref[i] = 0;
-        output_lock[i] = -1;
-        output_lock_ref[i] = 0;
+        for (int v = 0; v < NOC_MAX_VCS; v++) {
+            output_lock[i][v] = -1;
+            output_lock_ref[i][v] = 0;
+        }
+
+        buffer_i[i].resize(vc_num(i));
+        buffer_o[i].resize(vc_num(i));
+        rr_in[i] = 0;
+        rr_out[i] = 0;
+    }
+
+    // 下游每个输入虚通道的缓存初始均为空
+    const char *link_names[DIRECTIONS - 1] = {"west", "east", "north",
+                                              "south"};
+    for (int i = 0; i < DIRECTIONS - 1; i++) {
+        for (int v = 0; v < NOC_MAX_VCS; v++) {
+            credit[i][v] = MAX_BUFFER_PACKET_SIZE;
+            credit_seen[i][v] = 0;
+            credit_returned[i][v] = 0;
+        }
+
+        string link = "router" + to_string(rid) + ".link_" + link_names[i];
+        stat_link_flits[i] = STATS.counter(link + ".flits");
+        stat_link_wait[i] = STATS.histogram(link + ".wait", CYCLE, 32);
     }
 
-    if (IsMarginCore(rid)) {
+    stat_packets = STATS.counter("router" + to_string(rid) + ".packets");
+    stat_flits = STATS.counter("router" + to_string(rid) + ".flits");
+    stat_mcast_copies =
+        STATS.counter("router" + to_string(rid) + ".mcast_copies");
+    stat_stalls = STATS.counter("router" + to_string(rid) + ".stalls");
+
+    if (IsHostPort(rid)) {
         host_buffer_i = new queue<sc_bv<256>>;
         host_buffer_o = new queue<sc_bv<256>>;
         host_channel_i = new sc_in<sc_bv<256>>;
@@ -52,10 +80,10 @@ RouterUnit::RouterUnit(const sc_module_name &n, int rid,
     sensitive << data_sent_i[WEST].pos() << data_sent_i[EAST].pos()
               << data_sent_i[CENTER].pos() << data_sent_i[SOUTH].pos()
               << data_sent_i[NORTH].pos();
-    if (IsMarginCore(rid))
+    if (IsHostPort(rid))
         sensitive << host_data_sent_i->pos();
-    sensitive << channel_avail_i[WEST].pos() << channel_avail_i[EAST].pos()
-              << channel_avail_i[SOUTH].pos() << channel_avail_i[NORTH].pos();
+    sensitive << credit_i[WEST] << credit_i[EAST] << credit_i[SOUTH]
+              << credit_i[NORTH];
     sensitive << core_busy_i.neg();
     dont_initialize();
 
@@ -70,16 +98,207 @@ void RouterUnit::end_of_elaboration() {
         channel_avail_o[i].write(true);
         data_sent_o[i].write(false);
     }
+    for (int i = 0; i < DIRECTIONS - 1; i++)
+        credit_o[i].write(sc_bv<64>(0));
 
-    if (IsMarginCore(rid)) {
+    if (IsHostPort(rid)) {
         host_channel_avail_o->write(true);
         host_data_sent_o->write(false);
     }
 }
 
+bool RouterUnit::out_open(int out, int tag) {
+    for (int v = 0; v < vc_num(out); v++)
+        if (output_lock[out][v] == -1 || output_lock[out][v] == tag)
+            return true;
+    return false;
+}
+
+int RouterUnit::select_vc(int out, int vc_class, int tag, bool stream) {
+    // 优先与同一tag的数据流共享虚通道，否则使用未上锁的虚通道
+    int free_vc = -1, free_num = 0, class_num = 0;
+    for (int v = 0; v < vc_num(out); v++) {
+        if (out != CENTER && !VcInClass(v, vc_class))
+            continue;
+
+        class_num++;
+        if (output_lock[out][v] == -1)
+            free_num++;
+        if (buffer_o[out][v].size() >= MAX_BUFFER_PACKET_SIZE)
+            continue;
+
+        if (output_lock[out][v] == tag)
+            return v;
+        if (output_lock[out][v] == -1 && free_vc < 0)
+            free_vc = v;
+    }
+
+    // 数据流不能锁住一个类中最后一个空闲的虚通道，留给ack等其他包
+    if (free_vc >= 0 && stream && class_num > 1 && free_num <= 1)
+        return -1;
+    return free_vc;
+}
+
+bool RouterUnit::route_stream(Msg &m, int in, int in_vc, Route_entry &entry) {
+    // 虚通道类在数据流进入网络时确定，之后保持不变
+    int vc_class = 0;
+    if (in != CENTER)
+        vc_class = GetVcClass(in_vc);
+    else if (noc_routing == ROUTE_O1TURN && m.mcast_ == 0)
+        vc_class = (m.source_ + m.des_ + m.tag_id_) % 2;
+
+    // 多播包沿XY路由树复制，所有方向都可用时才分配
+    if (m.mcast_ > 0) {
+        for (auto out : GetMcastNextHops(m.mcast_, m.source_, rid)) {
+            int v = select_vc(out, vc_class, m.tag_id_, true);
+            if (v < 0)
+                return false;
+            entry.outs.push_back(make_pair(out, v));
+        }
+        return true;
+    }
+
+    // 自适应：在路由算法允许的方向中选择下游剩余credit与本地空间最多的
+    int best_score = -1;
+    for (auto out :
+         GetRouteCandidates(m.source_, m.des_, rid, vc_class == 1)) {
+        int v = select_vc(out, vc_class, m.tag_id_, true);
+        if (v < 0)
+            continue;
+
+        int score = MAX_BUFFER_PACKET_SIZE - buffer_o[out][v].size();
+        if (out != CENTER)
+            score += credit[out][v];
+        if (score > best_score) {
+            best_score = score;
+            entry.outs.assign(1, make_pair(out, v));
+        }
+    }
+
+    return best_score >= 0;
+}
+
+bool RouterUnit::forward(int in, int vc) {
+    sc_bv<256> temp = buffer_i[in][vc].front();
+    Msg m = DeserializeMsg(temp);
+    double now = sc_time_stamp().to_seconds() * 1e9;
+
+    // 注意：REQUEST包若终点为本core，则会优先进入req_buffer；否则按照正常数据流转
+    if (m.msg_type_ == REQUEST && m.des_ == rid) {
+        buffer_i[in][vc].pop();
+        req_queue.push_back(m);
+
+        cout << "[REQUEST] Router " << rid << " received REQ from "
+             << m.source_ << ", put into req_queue, size " << req_queue.size()
+             << "\n";
+        return true;
+    }
+
+    // [DATA] core之间的数据流（包括多播）：第一个包分配输出方向与虚通道并上锁，最后一个包解锁
+    // 排除了host发出的Config DATA 包
+    if (m.msg_type_ == DATA && m.source_ != GRID_SIZE && m.des_ != GRID_SIZE) {
+        auto key = make_tuple(m.source_, m.des_, m.tag_id_);
+        auto it = routes.find(key);
+
+        Route_entry entry;
+        if (it != routes.end())
+            entry = it->second;
+        else if (!route_stream(m, in, vc, entry))
+            return false;
+
+        for (auto &o : entry.outs)
+            if (buffer_o[o.first][o.second].size() >= MAX_BUFFER_PACKET_SIZE)
+                return false;
+
+        // Two Ack 多发一 DATA 包 乱序 接受核的接受地址由 Send 包中地址决定，同一tag共享锁并增加refcnt
+        if (m.seq_id_ == 1 || it == routes.end()) {
+            for (auto &o : entry.outs) {
+                output_lock[o.first][o.second] = m.tag_id_;
+                output_lock_ref[o.first][o.second]++;
+                cout << sc_time_stamp() << " " << ": Router " << rid
+                     << " lock: " << o.first << " vc " << o.second << " "
+                     << m.tag_id_ << " " << output_lock_ref[o.first][o.second]
+                     << endl;
+            }
+            entry.ref++;
+        }
+
+        // 最后一个数据包，需要减少refcnt，如果refcnt为0,则解锁
+        if (m.is_end_) {
+            for (auto &o : entry.outs) {
+                int &ref = output_lock_ref[o.first][o.second];
+                ref--;
+
+                cout << sc_time_stamp() << " " << ": Router " << rid
+                     << " unlock: " << o.first << " vc " << o.second << " "
+                     << output_lock[o.first][o.second] << " " << ref << endl;
+
+                if (ref < 0) {
+                    cout << sc_time_stamp() << ": Router " << rid
+                         << " output ref below zero.\n";
+                    sc_stop();
+                } else if (ref == 0) {
+                    output_lock[o.first][o.second] = -1;
+                }
+            }
+            entry.ref--;
+        }
+
+        for (auto &o : entry.outs)
+            buffer_o[o.first][o.second].emplace(temp, now);
+        if (entry.outs.size() > 1)
+            stat_mcast_copies->inc(entry.outs.size() - 1);
+
+        if (entry.ref > 0)
+            routes[key] = entry;
+        else if (it != routes.end())
+            routes.erase(it);
+
+        buffer_i[in][vc].pop();
+        return true;
+    }
+
+    // 其他包按照路由算法的确定性选择转发，保持同一源和目标之间的顺序
+    int vc_class = in == CENTER ? 0 : GetVcClass(vc);
+    Directions out;
+    int out_vc = -1;
+    if (m.des_ == GRID_SIZE) {
+        // 经过任意带host端口的router都可以离开网络，否则先X后Y发往源核对应的端口
+        if (host_buffer_o) {
+            if (host_buffer_o->size() >= MAX_BUFFER_PACKET_SIZE)
+                return false;
+
+            buffer_i[in][vc].pop();
+            host_buffer_o->emplace(temp);
+            return true;
+        }
+        out = GetNextHop(HostExitRouter(m.source_, rid), rid);
+
+        // 发往host的包不受锁的限制
+        for (int v = 0; v < vc_num(out); v++)
+            if (VcInClass(v, vc_class) &&
+                buffer_o[out][v].size() < MAX_BUFFER_PACKET_SIZE) {
+                out_vc = v;
+                break;
+            }
+    } else {
+        out = GetRouteCandidates(-1, m.des_, rid, vc_class == 1)[0];
+        // 目标通道上锁，且上锁tag不等同于自己的tag时不能通过
+        out_vc = select_vc(out, vc_class, m.tag_id_, false);
+    }
+
+    if (out_vc < 0)
+        return false;
+
+    buffer_i[in][vc].pop();
+    buffer_o[out][out_vc].emplace(temp, now);
+    return true;
+}
+
 void RouterUnit::router_execute() {
     while (true) {
         bool flag_trigger = false;
+        double now = sc_time_stamp().to_seconds() * 1e9;
 
         // 将输出信号都设置为初始值false
         for (int i = 0; i < DIRECTIONS; i++) {
@@ -87,17 +306,32 @@ void RouterUnit::router_execute() {
             data_sent_o[i].write(false);
         }
 
+        // [credit] 下游取出包之后返回的credit
+        for (int i = 0; i < DIRECTIONS - 1; i++) {
+            sc_bv<64> returned = credit_i[i].read();
+            for (int v = 0; v < noc_vcs; v++) {
+                int cnt = returned
+                              .range((v + 1) * NOC_CREDIT_BITS - 1,
+                                     v * NOC_CREDIT_BITS)
+                              .to_uint();
+                credit[i][v] += (cnt - credit_seen[i][v] +
+                                 (1 << NOC_CREDIT_BITS)) %
+                                (1 << NOC_CREDIT_BITS);
+                credit_seen[i][v] = cnt;
+            }
+        }
+
         // [input] 4方向+cores
         for (int i = 0; i < DIRECTIONS; i++) {
             if (data_sent_i[i].read()) {
-                // move the data into the buffer
+                // move the data into the buffer，按照包头中的虚通道放入对应的缓存
                 sc_bv<256> temp = channel_i[i].read();
                 Msg tt = DeserializeMsg(temp);
                 // cout << sc_time_stamp() << ": Router " << rid
                 //      << ": get des seqid " << tt.des_ << " " << tt.seq_id_
                 //      << " from " << i << "." << endl;
 
-                buffer_i[i].emplace(temp);
+                buffer_i[i][i == CENTER ? 0 : tt.vc_].emplace(temp);
 
                 // need trigger again
                 flag_trigger = true;
@@ -105,7 +339,7 @@ void RouterUnit::router_execute() {
         }
 
         // [input] host
-        // if IsMarginCore
+        // if IsHostPort
         if (host_buffer_i) {
             // host send data to core
             if (host_data_sent_i->read()) {
@@ -124,35 +358,45 @@ void RouterUnit::router_execute() {
             }
         }
 
-        // [output] 4方向
+        // [output] 4方向，每个周期在有credit的虚通道之间轮询发送一个包
         for (int i = 0; i < DIRECTIONS - 1; i++) {
             // global update once
             data_sent_o[i].write(false);
-            // 输出方向的buffer是否为满
-            if (channel_avail_i[i].read() == false)
-                continue;
 
-            // shall not check when output buffer is empty
-            // 对应输出的buffer非空
-            if (!buffer_o[i].size())
-                continue;
+            for (int k = 0; k < noc_vcs; k++) {
+                int v = (rr_out[i] + k) % noc_vcs;
+                // 对应输出的buffer非空，且下游的虚通道未满
+                if (!buffer_o[i][v].size() || credit[i][v] <= 0)
+                    continue;
 
-            sc_bv<256> temp = buffer_o[i].front();
-            buffer_o[i].pop();
+                Router_flit flit = buffer_o[i][v].front();
+                buffer_o[i][v].pop();
 
-            Msg tt = DeserializeMsg(temp);
-            // cout << sc_time_stamp() << ": " << rid << ": output " << i <<
-            // "\n";
+                Msg tt = DeserializeMsg(flit.data);
+                tt.vc_ = v;
+                // cout << sc_time_stamp() << ": " << rid << ": output " << i
+                // << "\n";
 
-            channel_o[i].write(temp);
-            data_sent_o[i].write(true);
+                channel_o[i].write(SerializeMsg(tt));
+                data_sent_o[i].write(true);
+                credit[i][v]--;
+                rr_out[i] = (v + 1) % noc_vcs;
 
-            // need trigger again
-            flag_trigger = true;
+                stat_packets->inc();
+                stat_link_flits[i]->inc(tt.msg_type_ == DATA ? DataFlits(tt)
+                                                             : 1);
+                stat_link_wait[i]->sample(now - flit.enter);
+                if (tt.msg_type_ == DATA)
+                    stat_flits->inc(DataFlits(tt));
+
+                // need trigger again
+                flag_trigger = true;
+                break;
+            }
         }
 
         // [output] host
-        // if IsMarginCore
+        // if IsHostPort
         if (host_channel_i) {
             host_data_sent_o->write(false);
             // 输出到host方向上的buffer非空
@@ -172,18 +416,19 @@ void RouterUnit::router_execute() {
         // 输出到本地core内部的
         data_sent_o[CENTER].write(false);
         // 输出到本地core内的buffer非空
-        if (buffer_o[CENTER].size()) {
+        if (buffer_o[CENTER][0].size()) {
             // core内部的接受队列是否满
             if (!core_busy_i.read()) {
                 // move the data out of the buffer
-                sc_bv<256> temp = buffer_o[CENTER].front();
+                sc_bv<256> temp = buffer_o[CENTER][0].front().data;
 
-                buffer_o[CENTER].pop();
+                buffer_o[CENTER][0].pop();
 
                 Msg tt = DeserializeMsg(temp);
 
                 channel_o[CENTER].write(temp);
                 data_sent_o[CENTER].write(true);
+                stat_packets->inc();
                 // cout << sc_time_stamp() << ": Router " << rid << ": send "
                 //      << tt.seq_id_ << " to core.\n";
             }
@@ -197,13 +442,13 @@ void RouterUnit::router_execute() {
         if (host_channel_i && host_buffer_i->size()) {
             sc_bv<256> temp = host_buffer_i->front();
             int d = DeserializeMsg(temp).des_;
-            // 先x后y的路由
-            Directions next = GetNextHop(d, rid);
+            Directions next = GetRouteCandidates(-1, d, rid, false)[0];
+            // tag为-1：只使用未上锁的虚通道
+            int v = select_vc(next, 0, -1, false);
 
-            if (buffer_o[next].size() < MAX_BUFFER_PACKET_SIZE &&
-                output_lock[next] == -1) {
+            if (v >= 0) {
                 host_buffer_i->pop();
-                buffer_o[next].emplace(temp);
+                buffer_o[next][v].emplace(temp, now);
 
                 flag_trigger = true;
             }
@@ -217,14 +462,14 @@ void RouterUnit::router_execute() {
             int source = req.source_;
             Directions next = GetNextHop(des, source);
 
-            if (output_lock[next] == -1 || output_lock[next] == req.tag_id_) {
+            if (out_open(next, req.tag_id_)) {
                 cout << "[INFO] Router " << rid << ", checking req from "
                      << source << endl;
-                if (buffer_o[CENTER].size() < MAX_BUFFER_PACKET_SIZE) {
+                if (buffer_o[CENTER][0].size() < MAX_BUFFER_PACKET_SIZE) {
                     cout << "[INFO] Router " << rid
                          << ", push req into core.\n";
                     it = req_queue.erase(it);
-                    buffer_o[CENTER].emplace(SerializeMsg(req));
+                    buffer_o[CENTER][0].emplace(SerializeMsg(req), now);
                     flag_trigger = true;
                     continue;
                 }
@@ -233,123 +478,48 @@ void RouterUnit::router_execute() {
             ++it;
         }
 
-        // FIX input -> output 的仲裁
         // [input -> output] 4方向+core
+        // 每个输入端口每周期转发一个包，在虚通道之间轮询，队头被阻塞的虚通道不影响其他虚通道
         for (int i = 0; i < DIRECTIONS; i++) {
-            if (!buffer_i[i].size())
-                continue;
-
-            // cout << "router " << rid << " input " << i << " size "
-            //      << buffer_i[i].size() << endl;
-
-            sc_bv<256> temp = buffer_i[i].front();
-            Msg m = DeserializeMsg(temp);
-            Directions out = GetNextHop(m.des_, rid);
-
-            // 是否能发送 不能发送的情况是上锁了以后，并且tag一样
-            // 注意：REQUEST包若终点为本core，则会优先进入req_buffer；否则按照正常数据流转
-            if (m.msg_type_ == REQUEST && m.des_ == rid) {
-                buffer_i[i].pop();
-                req_queue.push_back(m);
-
-                cout << "[REQUEST] Router " << rid << " received REQ from "
-                     << m.source_ << ", put into req_queue, size "
-                     << req_queue.size() << "\n";
-                continue;
-            }
+            int n = vc_num(i);
+            bool waiting = false, moved = false;
 
-            if (m.des_ != GRID_SIZE && output_lock[out] != -1 &&
-                output_lock[out] !=
-                    m.tag_id_) // 如果不发往host，且目标通道上锁，且目标上锁tag不等同于自己的tag：continue
-                continue;
-            if (out == HOST &&
-                host_buffer_o->size() >=
-                    MAX_BUFFER_PACKET_SIZE) // 如果发往host，但通道已满：continue
-                continue;
-            else if (
-                out != HOST &&
-                buffer_o[out].size() >=
-                    MAX_BUFFER_PACKET_SIZE) // 如果不发往host，但通道已满：continue
-                continue;
-
-            // cout << sc_time_stamp() << ": Router " << rid << ": "
-            //      << " put into " << out << " id " << m.seq_id_ << endl;
-
-            // [ACK] 非发往host的ACK包，需要上锁或者增加refcnt
-            // FIX 上锁应该在第一个DATA 包
-            if (m.msg_type_ == DATA && m.seq_id_ == 1 && m.des_ != GRID_SIZE &&
-                m.source_ != GRID_SIZE) {
-                // i 是 ACK 的进入方向，需要计算 ACK 的输出方向
-                if (output_lock[out] == -1) {
-                    // 上锁
-                    output_lock[out] = m.tag_id_;
-                    output_lock_ref[out]++;
-                    cout << sc_time_stamp() << " " << ": Router " << rid
-                         << " lock: " << out << " " << output_lock[out] << " "
-                         << output_lock_ref[out] << endl;
-                } else if (output_lock[out] == m.tag_id_) {
-                    // 添加refcnt
-                    // Two Ack 多发一 DATA 包 乱序 接受核的接受地址由 Send
-                    // 包中地址决定
-                    output_lock_ref[out]++;
-                    // cout << sc_time_stamp() << " " << ": Router " << rid
-                    //      << " addlock: " << out << " " << output_lock[out]
-                    //      << " " << output_lock_ref[out] << endl;
-                } else {
-                    // 并非对应tag，不予通过
+            for (int k = 0; k < n && !moved; k++) {
+                int v = (rr_in[i] + k) % n;
+                if (!buffer_i[i][v].size())
                     continue;
-                }
-            }
-
-            // [DATA] 最后一个数据包，需要减少refcnt，如果refcnt为0,则解锁
-            // DTODO
-            // 排除了Config DATA 包，不会减少 lock
-            // START DATA 包也不会上锁？
-            if (m.msg_type_ == DATA && m.is_end_ && m.source_ != GRID_SIZE &&
-                m.des_ != GRID_SIZE) {
-                // i 是 data 的进入方向，需要计算 data 的输出方向
-                out = GetNextHop(m.des_, rid);
-
-                output_lock_ref[out]--;
-
-                cout << sc_time_stamp() << " " << ": Router " << rid
-                     << " unlock: " << out << " " << output_lock[out] << " "
-                     << output_lock_ref[out] << endl;
 
-                if (output_lock_ref[out] < 0) {
-                    cout << sc_time_stamp() << ": Router " << rid
-                         << " output ref below zero.\n";
-                    sc_stop();
-                } else if (output_lock_ref[out] == 0) {
-                    output_lock[out] = -1;
+                waiting = true;
+                if (forward(i, v)) {
+                    moved = true;
+                    rr_in[i] = (v + 1) % n;
+                    if (i != CENTER)
+                        credit_returned[i][v] = (credit_returned[i][v] + 1) %
+                                                (1 << NOC_CREDIT_BITS);
+                    flag_trigger = true;
                 }
             }
 
-            // 发送
-            if (out == HOST) {
-                buffer_i[i].pop();
-                host_buffer_o->emplace(temp);
-
-                flag_trigger = true;
-            } else {
-                buffer_i[i].pop();
-                buffer_o[out].emplace(temp);
-
-                flag_trigger = true;
-            }
+            if (waiting && !moved)
+                stat_stalls->inc();
         }
 
         // 检查是否有剩余的req，需要重复触发
         if (req_queue.size())
             flag_trigger = true;
 
-        // [SIGNALS] 4方向
-        for (int i = 0; i < DIRECTIONS; i++) {
-            if (buffer_i[i].size() < MAX_BUFFER_PACKET_SIZE) {
-                channel_avail_o[i].write(true);
-            } else {
-                channel_avail_o[i].write(false);
-            }
+        // [SIGNALS] core
+        channel_avail_o[CENTER].write(buffer_i[CENTER][0].size() <
+                                      MAX_BUFFER_PACKET_SIZE);
+
+        // [SIGNALS] 4方向，返回credit
+        for (int i = 0; i < DIRECTIONS - 1; i++) {
+            sc_bv<64> returned(0);
+            for (int v = 0; v < noc_vcs; v++)
+                returned.range((v + 1) * NOC_CREDIT_BITS - 1,
+                               v * NOC_CREDIT_BITS) =
+                    sc_bv<NOC_CREDIT_BITS>(credit_returned[i][v]);
+            credit_o[i].write(returned);
         }
 
         // [SIGNALS] host
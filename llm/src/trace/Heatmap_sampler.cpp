@@ -0,0 +1,82 @@
+#include "trace/Heatmap_sampler.h"
+#include "defs/global.h"
+
+Heatmap_sampler::Heatmap_sampler(const sc_module_name &name, int window_ns,
+                                 const string &filename)
+    : sc_module(name), window_ns(window_ns), last_ns(0) {
+    stream.open(filename, ios::trunc);
+    if (!stream.is_open())
+        cout << "[ERROR] Heatmap: cannot open " << filename << endl;
+
+    const char *link_names[DIRECTIONS - 1] = {"west", "east", "north",
+                                              "south"};
+    for (int i = 0; i < GRID_SIZE; i++) {
+        cores.push_back(&STATS.core(i));
+        for (int d = 0; d < DIRECTIONS - 1; d++)
+            links.push_back(STATS.counter("router" + to_string(i) + ".link_" +
+                                          link_names[d] + ".flits"));
+    }
+    last_state.assign(GRID_SIZE * 3, 0);
+    last_flits.assign(links.size(), 0);
+
+    // 第一行描述网格，之后每行一个窗口
+    stream << "{\"grid_x\": " << GRID_X << ", \"grid_size\": " << GRID_SIZE
+           << ", \"window_ns\": " << window_ns << ", \"cycle_ns\": " << CYCLE
+           << "}" << endl;
+
+    SC_THREAD(sample_periodically);
+}
+
+Heatmap_sampler::~Heatmap_sampler() {
+    // 最后一个不完整的窗口
+    if (stream.is_open() && sc_time_stamp().to_seconds() * 1e9 > last_ns)
+        write_frame();
+    stream.close();
+}
+
+void Heatmap_sampler::write_frame() {
+    double now = sc_time_stamp().to_seconds() * 1e9;
+    double span = now - last_ns;
+    if (span <= 0)
+        return;
+
+    stream << "{\"t\": " << (u_int64_t)now << ", \"span\": " << span
+           << ", \"cores\": [";
+    for (int i = 0; i < GRID_SIZE; i++) {
+        Stat_gauge *states[3] = {cores[i]->compute, cores[i]->dram_wait,
+                                 cores[i]->noc_wait};
+        stream << (i ? ", [" : "[");
+        for (int s = 0; s < 3; s++) {
+            double v = states[s]->integral();
+            char text[16];
+            snprintf(text, sizeof(text), "%.3f",
+                     (v - last_state[i * 3 + s]) / span);
+            stream << (s ? ", " : "") << text;
+            last_state[i * 3 + s] = v;
+        }
+        stream << "]";
+    }
+
+    stream << "], \"links\": [";
+    for (int i = 0; i < links.size(); i++) {
+        stream << (i ? ", " : "") << links[i]->value - last_flits[i];
+        last_flits[i] = links[i]->value;
+    }
+    stream << "]}" << endl;
+
+    last_ns = now;
+}
+
+void Heatmap_sampler::sample_periodically() {
+    while (true) {
+        wait(sc_time(window_ns, SC_NS));
+        write_frame();
+
+        // 除了采样本身之外没有其他事件时暂停，避免让模拟无法结束；
+        // 分区仿真中芯片在窗口边界收到片间数据之后由resume()唤醒
+        while (!sc_pending_activity())
+            wait(ev_resume);
+    }
+}
+
+void Heatmap_sampler::resume() { ev_resume.notify(SC_ZERO_TIME); }
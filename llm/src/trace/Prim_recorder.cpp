@@ -0,0 +1,29 @@
+#include "trace/Prim_recorder.h"
+
+void Prim_recorder::open(const string &filename) {
+    stream.open(filename, ios::trunc);
+    if (!stream.is_open()) {
+        cout << "[ERROR] Prim recorder: cannot open " << filename << endl;
+        return;
+    }
+
+    stream << "core,kind,name,start_ns,end_ns,exu_ops,sfu_ops,compute_ns,"
+              "dram_bytes,dram_time_ns,spill_bytes,recv_wait_ns,tag,peer,"
+              "loop_cnt\n";
+}
+
+void Prim_recorder::close() {
+    if (stream.is_open())
+        stream.close();
+}
+
+void Prim_recorder::record(const Prim_record &r) {
+    if (!stream.is_open())
+        return;
+
+    stream << r.cid << "," << r.kind << "," << r.name << "," << r.start << ","
+           << r.end << "," << r.exu_ops << "," << r.sfu_ops << ","
+           << r.compute_time << "," << r.dram_bytes << "," << r.dram_time
+           << "," << r.spill_bytes << "," << r.recv_wait << "," << r.tag << ","
+           << r.peer << "," << r.loop_cnt << "\n";
+}
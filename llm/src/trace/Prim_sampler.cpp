@@ -0,0 +1,150 @@
+#include "trace/Prim_sampler.h"
+#include "common/memory.h"
+#include "defs/global.h"
+#include "prims/base.h"
+#include "utils/print_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+bool Prim_sampler::enable(int warmup, int revalidate) {
+    if (warmup > 0 && !beha_dram) {
+        cout << "[ERROR] Prim sampling needs the behavioral dram model "
+                "(--beha_dram true).\n";
+        return false;
+    }
+
+    this->warmup = max(warmup, 0);
+    this->revalidate = max(revalidate, 0);
+    return true;
+}
+
+string Prim_sampler::signature(CompBase *p, PrimCoreContext *context) {
+    ostringstream sig;
+    sig << p->name << "|" << p->datatype << "," << p->weight_datatype << ","
+        << p->kv_datatype << "|";
+
+    // 形状参数按名字排序
+    map<string, int> params(p->param_value.begin(), p->param_value.end());
+    for (auto &it : params)
+        sig << it.first << "=" << it.second << ",";
+
+    // 每个输入：r 在SRAM中，s 部分被spill，m 不在SRAM中（从DRAM读入）。
+    // 直接查表，不经过findPair以免改变LRU记录
+    auto &data_map = context->sram_pos_locator_->data_map;
+    sig << "|";
+    for (int i = 0; i < MAX_SPLIT_NUM; i++) {
+        string label = context->datapass_label_->indata[i];
+        if (label == UNSET_LABEL)
+            continue;
+        if (label[0] == '_')
+            label = label.substr(1);
+
+        auto it = data_map.find(label);
+        if (it == data_map.end())
+            sig << "m";
+        else
+            sig << (it->second.spill_size > 0 ? "s" : "r");
+    }
+
+    // SRAM占用按1/8分档
+    int64_t used = 0;
+    for (auto &it : data_map)
+        used += it.second.valid ? it.second.size
+                                : it.second.size - it.second.spill_size;
+    int max_size = max(context->sram_pos_locator_->max_sram_size, 1);
+    sig << "|" << min<int64_t>(used * 8 / max_size, 8);
+
+    return sig.str();
+}
+
+bool Prim_sampler::should_replay(int cid, const string &sig,
+                                 u_int64_t &replay_ns) {
+    Prim_sample &s = samples[{cid, sig}];
+    s.count++;
+
+    if (s.detailed < warmup)
+        return false;
+
+    // 重新验证：以当前的平均耗时作为预测，与这一次的详细仿真对比
+    if (revalidate > 0 && s.since_check >= revalidate) {
+        s.checking = true;
+        s.predicted = s.mean();
+        return false;
+    }
+
+    replay_ns = (u_int64_t)llround(s.mean());
+    return true;
+}
+
+void Prim_sampler::record(int cid, const string &sig, u_int64_t duration_ns) {
+    Prim_sample &s = samples[{cid, sig}];
+
+    if (s.checking) {
+        double err = fabs((double)duration_ns - s.predicted);
+        s.checks++;
+        s.abs_err_ns += err;
+        if (duration_ns > 0)
+            s.max_rel_err = max(s.max_rel_err, err / duration_ns);
+        s.checking = false;
+        s.since_check = 0;
+    }
+
+    s.detailed++;
+    s.total_ns += duration_ns;
+}
+
+void Prim_sampler::record_replay(int cid, const string &sig) {
+    Prim_sample &s = samples[{cid, sig}];
+    s.replayed++;
+    s.since_check++;
+}
+
+void Prim_sampler::report(const string &filename) {
+    if (!enabled())
+        return;
+
+    ofstream file(filename, ios::trunc);
+    file << "core,signature,count,detailed,replayed,mean_ns,checks,"
+            "mean_abs_err_ns,max_rel_err\n";
+
+    u_int64_t total = 0, replayed = 0;
+    double replayed_ns = 0, err_ns = 0, max_rel = 0;
+    for (auto &it : samples) {
+        auto &s = it.second;
+        double mean_err = s.checks ? s.abs_err_ns / s.checks : 0;
+        file << it.first.first << ",\"" << it.first.second << "\"," << s.count
+             << "," << s.detailed << "," << s.replayed << "," << s.mean()
+             << "," << s.checks << "," << mean_err << "," << s.max_rel_err
+             << "\n";
+
+        total += s.count;
+        replayed += s.replayed;
+        replayed_ns += s.replayed * s.mean();
+        // 没有重新验证过的签名不计入误差估计
+        err_ns += s.replayed * mean_err;
+        max_rel = max(max_rel, s.max_rel_err);
+    }
+    file.close();
+
+    ostringstream ratio, err;
+    ratio << std::fixed << std::setprecision(2)
+          << (total ? 100.0 * replayed / total : 0) << "%";
+    err << std::fixed << std::setprecision(2)
+        << (replayed_ns > 0 ? 100.0 * err_ns / replayed_ns : 0) << "%";
+
+    PrintBar(48);
+    cout << "| " << std::left << std::setw(44) << "Prim sampling" << " |\n";
+    PrintBar(48);
+    cout << "| " << std::left << std::setw(28) << "comp prims" << std::right
+         << std::setw(16) << total << " |\n";
+    cout << "| " << std::left << std::setw(28) << "fast-forwarded" << std::right
+         << std::setw(16) << ratio.str() << " |\n";
+    cout << "| " << std::left << std::setw(28) << "est. error of replayed"
+         << std::right << std::setw(16) << err.str() << " |\n";
+    PrintBar(48);
+    cout << "Prim sampling statistics written to " << filename << endl;
+}
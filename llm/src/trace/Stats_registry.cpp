@@ -0,0 +1,140 @@
+#include "trace/Stats_registry.h"
+#include "utils/print_utils.h"
+
+#include <iomanip>
+
+Stat_counter *Stats_registry::counter(const string &name) {
+    auto &c = counters[name];
+    if (!c)
+        c.reset(new Stat_counter());
+    return c.get();
+}
+
+Stat_histogram *Stats_registry::histogram(const string &name,
+                                          double bucket_width, int bucket_num) {
+    auto &h = histograms[name];
+    if (!h)
+        h.reset(new Stat_histogram(bucket_width, bucket_num));
+    return h.get();
+}
+
+Stat_gauge *Stats_registry::gauge(const string &name) {
+    auto &g = gauges[name];
+    if (!g)
+        g.reset(new Stat_gauge());
+    return g.get();
+}
+
+Core_stats &Stats_registry::core(int cid) {
+    while (cores.size() <= cid) {
+        int id = cores.size();
+        string prefix = "core" + to_string(id) + ".";
+
+        Core_stats *s = new Core_stats();
+        s->prims = counter(prefix + "prims");
+        s->dram_read_bytes = counter(prefix + "dram_read_bytes");
+        s->dram_write_bytes = counter(prefix + "dram_write_bytes");
+        s->spill_bytes = counter(prefix + "spill_bytes");
+        s->reload_bytes = counter(prefix + "reload_bytes");
+        s->injected_flits = counter(prefix + "injected_flits");
+        s->busy = gauge(prefix + "busy");
+        s->dram_wait = gauge(prefix + "state.dram");
+        s->compute = gauge(prefix + "state.compute");
+        s->noc_wait = gauge(prefix + "state.noc");
+        s->sram_used = gauge(prefix + "sram.used_ratio");
+        cores.emplace_back(s);
+    }
+
+    return *cores[cid];
+}
+
+void Stats_registry::open_sample_file(const string &filename) {
+    sample_stream.open(filename, ios::trunc);
+    if (!sample_stream.is_open())
+        cout << "[ERROR] Stats: cannot open " << filename << endl;
+}
+
+void Stats_registry::sample() {
+    if (!sample_stream.is_open())
+        return;
+
+    // 第一次采样时固定列，之后注册的统计量只出现在汇总中
+    if (sample_counters.empty() && sample_gauges.empty()) {
+        sample_stream << "time_ns";
+        for (auto &c : counters) {
+            sample_counters.push_back(make_pair(c.first, c.second.get()));
+            sample_stream << "," << c.first;
+        }
+        for (auto &g : gauges) {
+            sample_gauges.push_back(make_pair(g.first, g.second.get()));
+            sample_stream << "," << g.first;
+        }
+        sample_stream << "\n";
+    }
+
+    sample_stream << (u_int64_t)(sc_time_stamp().to_seconds() * 1e9);
+    for (auto &c : sample_counters)
+        sample_stream << "," << c.second->value;
+    for (auto &g : sample_gauges)
+        sample_stream << "," << g.second->value;
+    sample_stream << "\n";
+}
+
+void Stats_registry::close_sample_file() {
+    if (sample_stream.is_open())
+        sample_stream.close();
+}
+
+void Stats_registry::summarize(const string &filename) {
+    ofstream file(filename, ios::trunc);
+    file << "name,type,value,mean,min,max\n";
+
+    PrintBar(48);
+    cout << "| " << std::left << std::setw(44) << "Statistics summary"
+         << " |\n";
+    PrintBar(48);
+
+    for (auto &c : counters) {
+        file << c.first << ",counter," << c.second->value << ",,,\n";
+        if (c.second->value)
+            cout << "| " << std::left << std::setw(26) << c.first << "| "
+                 << std::right << std::setw(15) << c.second->value << " |\n";
+    }
+    for (auto &g : gauges) {
+        file << g.first << ",gauge," << g.second->value << ","
+             << g.second->average() << ",," << g.second->max_v << "\n";
+    }
+    for (auto &h : histograms) {
+        file << h.first << ",histogram," << h.second->count << ","
+             << h.second->mean() << "," << h.second->min_v << ","
+             << h.second->max_v << "\n";
+    }
+    PrintBar(48);
+
+    file.close();
+    cout << "Statistics summary written to " << filename << endl;
+}
+
+Stats_sampler::Stats_sampler(const sc_module_name &name, int interval_ns,
+                             const string &filename)
+    : sc_module(name), interval_ns(interval_ns) {
+    STATS.open_sample_file(filename);
+    SC_THREAD(sample_periodically);
+}
+
+Stats_sampler::~Stats_sampler() { STATS.close_sample_file(); }
+
+void Stats_sampler::sample_periodically() {
+    while (true) {
+        STATS.sample();
+
+        // 除了采样本身之外没有其他事件时暂停，避免让模拟无法结束；
+        // 分区仿真中芯片在窗口边界收到片间数据之后由resume()唤醒
+        while (!sc_pending_activity())
+            wait(ev_resume);
+
+        wait(sc_time(interval_ns, SC_NS));
+    }
+}
+
+void Stats_sampler::resume() { ev_resume.notify(SC_ZERO_TIME); }
@@ -0,0 +1,410 @@
+#include "utils/checkpoint_utils.h"
+#include "monitor/config_helper_pds.h"
+#include "workercore/workercore.h"
+
+#include <fstream>
+
+using namespace std;
+
+// 以下为基础类型的读写工具
+template <typename T> static void WritePod(ostream &os, const T &v) {
+    os.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T> static void ReadPod(istream &is, T &v) {
+    is.read(reinterpret_cast<char *>(&v), sizeof(T));
+}
+
+static void WriteString(ostream &os, const string &s) {
+    WritePod(os, (u_int32_t)s.size());
+    os.write(s.data(), s.size());
+}
+
+static void ReadString(istream &is, string &s) {
+    u_int32_t size;
+    ReadPod(is, size);
+    s.resize(size);
+    is.read(&s[0], size);
+}
+
+template <typename T>
+static void WritePodVector(ostream &os, const vector<T> &v) {
+    WritePod(os, (u_int32_t)v.size());
+    for (const auto &e : v)
+        WritePod(os, e);
+}
+
+template <typename T> static void ReadPodVector(istream &is, vector<T> &v) {
+    u_int32_t size;
+    ReadPod(is, size);
+    v.resize(size);
+    for (auto &e : v)
+        ReadPod(is, e);
+}
+
+static void WriteStages(ostream &os, const vector<Stage> &stages) {
+    WritePod(os, (u_int32_t)stages.size());
+    for (const auto &s : stages) {
+        WritePod(os, s.req_id);
+        WritePod(os, (int)s.type);
+        WritePod(os, s.token_num);
+        WritePod(os, s.total_iter);
+    }
+}
+
+static void ReadStages(istream &is, vector<Stage> &stages) {
+    u_int32_t size;
+    ReadPod(is, size);
+    stages.resize(size);
+    for (auto &s : stages) {
+        int type;
+        ReadPod(is, s.req_id);
+        ReadPod(is, type);
+        ReadPod(is, s.token_num);
+        ReadPod(is, s.total_iter);
+        s.type = (PD_PHASE)type;
+    }
+}
+
+// 以下为各模块状态
+static void SaveSramManager(ostream &os, SramManager *manager) {
+    vector<char> status(manager->block_status_.begin(),
+                        manager->block_status_.end());
+    WritePodVector(os, status);
+
+    WritePod(os, (u_int32_t)manager->allocations_.size());
+    for (const auto &alloc : manager->allocations_) {
+        WritePod(os, alloc.first);
+        WritePodVector(os, alloc.second);
+    }
+
+    vector<int> free_blocks(manager->free_block_indices_.begin(),
+                            manager->free_block_indices_.end());
+    WritePodVector(os, free_blocks);
+    WritePod(os, manager->next_allocation_id_);
+}
+
+static void LoadSramManager(istream &is, SramManager *manager) {
+    vector<char> status;
+    ReadPodVector(is, status);
+    manager->block_status_.assign(status.begin(), status.end());
+
+    u_int32_t alloc_cnt;
+    ReadPod(is, alloc_cnt);
+    manager->allocations_.clear();
+    for (u_int32_t i = 0; i < alloc_cnt; i++) {
+        AllocationID id;
+        vector<int> blocks;
+        ReadPod(is, id);
+        ReadPodVector(is, blocks);
+        manager->allocations_[id] = blocks;
+    }
+
+    vector<int> free_blocks;
+    ReadPodVector(is, free_blocks);
+    manager->free_block_indices_.assign(free_blocks.begin(), free_blocks.end());
+    ReadPod(is, manager->next_allocation_id_);
+}
+
+static void SaveSramPosLocator(ostream &os, SramPosLocator *locator) {
+    WritePod(os, locator->visit);
+    WritePod(os, (u_int32_t)locator->data_map.size());
+    for (const auto &pair : locator->data_map) {
+        WriteString(os, pair.first);
+        WritePod(os, pair.second.pos);
+        WritePod(os, pair.second.left_byte);
+        WritePod(os, pair.second.alloc_id);
+        WritePod(os, pair.second.size);
+        WritePod(os, pair.second.dram_addr);
+        WritePod(os, pair.second.valid);
+        WritePod(os, pair.second.spill_size);
+        WritePod(os, pair.second.record);
+    }
+}
+
+static void LoadSramPosLocator(istream &is, SramPosLocator *locator) {
+    u_int32_t size;
+    ReadPod(is, locator->visit);
+    ReadPod(is, size);
+    locator->data_map.clear();
+    for (u_int32_t i = 0; i < size; i++) {
+        string key;
+        AddrPosKey value;
+        ReadString(is, key);
+        ReadPod(is, value.pos);
+        ReadPod(is, value.left_byte);
+        ReadPod(is, value.alloc_id);
+        ReadPod(is, value.size);
+        ReadPod(is, value.dram_addr);
+        ReadPod(is, value.valid);
+        ReadPod(is, value.spill_size);
+        ReadPod(is, value.record);
+        locator->data_map[key] = value;
+    }
+}
+
+void SavePrimCoreContext(ostream &os, PrimCoreContext *context) {
+    WritePod(os, context->loop_cnt);
+    WritePod(os, context->auto_pd_);
+    WriteStages(os, context->batch_info_);
+
+    vector<char> decode_done(context->decode_done_.begin(),
+                             context->decode_done_.end());
+    WritePodVector(os, decode_done);
+
+    for (int i = 0; i < MAX_SPLIT_NUM; i++)
+        WriteString(os, context->datapass_label_->indata[i]);
+    WriteString(os, context->datapass_label_->outdata);
+
+    WritePodVector(os, context->selected_experts_);
+    WritePodVector(os, context->selected_freq_);
+    WritePodVector(os, context->prefetched_experts_);
+
+    SaveSramManager(os, context->sram_manager_);
+    SaveSramPosLocator(os, context->sram_pos_locator_);
+}
+
+void LoadPrimCoreContext(istream &is, PrimCoreContext *context) {
+    ReadPod(is, context->loop_cnt);
+    ReadPod(is, context->auto_pd_);
+    ReadStages(is, context->batch_info_);
+
+    vector<char> decode_done;
+    ReadPodVector(is, decode_done);
+    context->decode_done_.assign(decode_done.begin(), decode_done.end());
+
+    for (int i = 0; i < MAX_SPLIT_NUM; i++)
+        ReadString(is, context->datapass_label_->indata[i]);
+    ReadString(is, context->datapass_label_->outdata);
+
+    ReadPodVector(is, context->selected_experts_);
+    ReadPodVector(is, context->selected_freq_);
+    ReadPodVector(is, context->prefetched_experts_);
+
+    LoadSramManager(is, context->sram_manager_);
+    LoadSramPosLocator(is, context->sram_pos_locator_);
+}
+
+void SaveDramKVTable(ostream &os, const DramKVTable &table) {
+    WritePodVector(os, table.free_values);
+    WritePod(os, (u_int32_t)table.map.size());
+    for (const auto &pair : table.map) {
+        WriteString(os, pair.first);
+        WritePod(os, pair.second);
+    }
+}
+
+void LoadDramKVTable(istream &is, DramKVTable &table) {
+    u_int32_t size;
+    ReadPodVector(is, table.free_values);
+    ReadPod(is, size);
+    table.map.clear();
+    for (u_int32_t i = 0; i < size; i++) {
+        string key;
+        uint64_t value;
+        ReadString(is, key);
+        ReadPod(is, value);
+        table.map[key] = value;
+    }
+}
+
+static void SavePdsHelper(ostream &os, config_helper_pds *helper) {
+    WritePod(os, helper->decode_done);
+    WritePod(os, helper->iter_cnt);
+
+    WritePod(os, (u_int32_t)helper->coreStatus.size());
+    for (const auto &status : helper->coreStatus) {
+        WritePod(os, status.id);
+        WritePod(os, (int)status.job_type);
+        WriteStages(os, status.batchInfo);
+        WritePod(os, status.available);
+        WritePod(os, status.data_sent);
+    }
+
+    WritePod(os, (u_int32_t)helper->requestRecords.size());
+    for (int i = 0; i < helper->requestRecords.size(); i++) {
+        const auto &record = helper->requestRecords[i];
+        WritePod(os, record.seq_len);
+        WritePod(os, record.prefill_iters);
+        WritePod(os, record.arrival_time);
+        WritePod(os, (int)record.phase);
+        WritePod(os, record.prefill_distribute);
+        WritePod(os, record.prefill_counter);
+        WritePod(os, record.decode_counter);
+        WritePodVector(os, helper->token_record[i]);
+    }
+
+    // 等待decode的请求队列
+    vector<int> req_decode;
+    for (auto q = helper->req_decode; !q.empty(); q.pop())
+        req_decode.push_back(q.front());
+    WritePodVector(os, req_decode);
+
+    WritePod(os, (u_int32_t)helper->idle_decode.size());
+    for (auto q : helper->idle_decode) {
+        vector<int> idle;
+        for (; !q.empty(); q.pop())
+            idle.push_back(q.front());
+        WritePodVector(os, idle);
+    }
+}
+
+static bool LoadPdsHelper(istream &is, config_helper_pds *helper,
+                          double time_offset_ns) {
+    ReadPod(is, helper->decode_done);
+    ReadPod(is, helper->iter_cnt);
+
+    u_int32_t core_cnt;
+    ReadPod(is, core_cnt);
+    if (core_cnt != helper->coreStatus.size()) {
+        cout << "[ERROR] Checkpoint: core layout mismatch, checkpoint has "
+             << core_cnt << " cores, config has " << helper->coreStatus.size()
+             << ".\n";
+        return false;
+    }
+    for (auto &status : helper->coreStatus) {
+        int job_type;
+        ReadPod(is, status.id);
+        ReadPod(is, job_type);
+        ReadStages(is, status.batchInfo);
+        ReadPod(is, status.available);
+        ReadPod(is, status.data_sent);
+        status.job_type = (PD_JOB)job_type;
+    }
+
+    // 新config中的请求数可以与检查点不同：重叠部分恢复，多出部分保持初始状态
+    u_int32_t req_cnt;
+    ReadPod(is, req_cnt);
+    if (req_cnt > helper->requestRecords.size()) {
+        cout << "[ERROR] Checkpoint: config has fewer requests ("
+             << helper->requestRecords.size() << ") than checkpoint ("
+             << req_cnt << ").\n";
+        return false;
+    }
+    for (int i = 0; i < req_cnt; i++) {
+        auto &record = helper->requestRecords[i];
+        int phase;
+        ReadPod(is, record.seq_len);
+        ReadPod(is, record.prefill_iters);
+        ReadPod(is, record.arrival_time);
+        ReadPod(is, phase);
+        ReadPod(is, record.prefill_distribute);
+        ReadPod(is, record.prefill_counter);
+        ReadPod(is, record.decode_counter);
+        ReadPodVector(is, helper->token_record[i]);
+        record.phase = (PD_PHASE)phase;
+    }
+
+    // 恢复后的模拟时间从0开始，将所有到达时间平移到新的时间轴上
+    for (int i = 0; i < helper->requestRecords.size(); i++) {
+        int shifted = max(0, (int)(helper->arrival_time[i] - time_offset_ns));
+        helper->arrival_time[i] = shifted;
+        helper->requestRecords[i].arrival_time = shifted;
+    }
+    helper->time_offset_ns = time_offset_ns;
+
+    vector<int> req_decode;
+    ReadPodVector(is, req_decode);
+    helper->req_decode = queue<int>();
+    for (auto id : req_decode)
+        helper->req_decode.push(id);
+
+    u_int32_t idle_cnt;
+    ReadPod(is, idle_cnt);
+    for (int i = 0; i < idle_cnt; i++) {
+        vector<int> idle;
+        ReadPodVector(is, idle);
+        if (i >= helper->idle_decode.size())
+            continue;
+        helper->idle_decode[i] = queue<int>();
+        for (auto id : idle)
+            helper->idle_decode[i].push(id);
+    }
+
+    return true;
+}
+
+bool SaveCheckpoint(const string &path, config_helper_pds *helper) {
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cout << "[ERROR] Checkpoint: cannot open " << path << " for writing.\n";
+        return false;
+    }
+
+    double now_ns = sc_time_stamp().to_seconds() * 1e9 + helper->time_offset_ns;
+
+    WritePod(file, (u_int32_t)CHECKPOINT_MAGIC);
+    WritePod(file, (u_int32_t)CHECKPOINT_VERSION);
+    WritePod(file, GRID_SIZE);
+    WritePod(file, MAX_SRAM_SIZE);
+    WritePod(file, now_ns);
+
+    // 统计量
+    WritePod(file, dcache_hits);
+    WritePod(file, dcache_misses);
+    WritePod(file, dcache_evictions);
+
+    for (int i = 0; i < GRID_SIZE; i++) {
+        WritePod(file, *(g_core_executor[i]->sram_addr));
+        SavePrimCoreContext(file, g_core_executor[i]->core_context);
+        SaveDramKVTable(file, *g_dram_kvtable[i]);
+    }
+
+    SavePdsHelper(file, helper);
+    file.close();
+
+    cout << "[CHECKPOINT] Saved simulation state at " << now_ns << " ns to "
+         << path << endl;
+    return true;
+}
+
+bool LoadCheckpoint(const string &path, config_helper_pds *helper) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        cout << "[ERROR] Checkpoint: cannot open " << path << ".\n";
+        return false;
+    }
+
+    u_int32_t magic, version;
+    int grid_size, sram_size;
+    double time_ns;
+    ReadPod(file, magic);
+    ReadPod(file, version);
+    if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) {
+        cout << "[ERROR] Checkpoint: " << path
+             << " is not a valid checkpoint of version " << CHECKPOINT_VERSION
+             << ".\n";
+        return false;
+    }
+
+    ReadPod(file, grid_size);
+    ReadPod(file, sram_size);
+    if (grid_size != GRID_SIZE || sram_size != MAX_SRAM_SIZE) {
+        cout << "[ERROR] Checkpoint: hardware mismatch (grid " << grid_size
+             << ", sram " << sram_size << ").\n";
+        return false;
+    }
+    ReadPod(file, time_ns);
+
+    ReadPod(file, dcache_hits);
+    ReadPod(file, dcache_misses);
+    ReadPod(file, dcache_evictions);
+
+    for (int i = 0; i < GRID_SIZE; i++) {
+        ReadPod(file, *(g_core_executor[i]->sram_addr));
+        LoadPrimCoreContext(file, g_core_executor[i]->core_context);
+        LoadDramKVTable(file, *g_dram_kvtable[i]);
+    }
+
+    if (!LoadPdsHelper(file, helper, time_ns))
+        return false;
+
+    if (!file) {
+        cout << "[ERROR] Checkpoint: " << path << " is truncated.\n";
+        return false;
+    }
+
+    cout << "[CHECKPOINT] Restored simulation state of " << time_ns
+         << " ns from " << path << endl;
+    return true;
+}
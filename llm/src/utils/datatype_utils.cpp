@@ -0,0 +1,65 @@
+#include "utils/datatype_utils.h"
+#include "utils/print_utils.h"
+
+#include <fstream>
+
+// 与DATATYPE的顺序一致
+static const DatatypeDesc datatype_table[DATATYPE_NUM] = {
+    {"int8", 8, 0, 0, 1},
+    {"fp16", 16, 0, 0, 1},
+    {"bf16", 16, 0, 0, 1},
+    {"fp8", 8, 0, 0, 1},
+    {"int4", 4, 128, 16, 2},
+};
+
+const DatatypeDesc &GetDatatypeDesc(DATATYPE dtype) {
+    if (dtype < 0 || dtype >= DATATYPE_NUM)
+        ARGUS_EXIT("Unknown datatype ", (int)dtype, ".\n");
+
+    return datatype_table[dtype];
+}
+
+DATATYPE ParseDatatype(const string &name) {
+    for (int i = 0; i < DATATYPE_NUM; i++) {
+        if (datatype_table[i].name == name)
+            return DATATYPE(i);
+    }
+
+    ARGUS_EXIT("Unknown datatype ", name, ", use int8/fp16/bf16/fp8/int4.\n");
+    return INT8;
+}
+
+u_int64_t DatatypeBytes(DATATYPE dtype, u_int64_t elements) {
+    const DatatypeDesc &desc = GetDatatypeDesc(dtype);
+
+    u_int64_t bits = elements * desc.bits;
+    if (desc.group_size)
+        bits += (elements + desc.group_size - 1) / desc.group_size *
+                desc.scale_bits;
+
+    return (bits + 7) / 8;
+}
+
+DATATYPE ComputeDatatype(DATATYPE a, DATATYPE b) {
+    return GetDatatypeDesc(b).exu_rate < GetDatatypeDesc(a).exu_rate ? b : a;
+}
+
+bool DumpDatatypes(const string &path) {
+    ofstream file(path, ios::trunc);
+    if (!file.is_open()) {
+        cout << "[ERROR] Cannot write datatype table to " << path << ".\n";
+        return false;
+    }
+
+    file << "{\n";
+    for (int i = 0; i < DATATYPE_NUM; i++) {
+        const DatatypeDesc &d = datatype_table[i];
+        file << "    \"" << d.name << "\": {\"bits\": " << d.bits
+             << ", \"group_size\": " << d.group_size
+             << ", \"scale_bits\": " << d.scale_bits
+             << ", \"exu_rate\": " << d.exu_rate << "}"
+             << (i + 1 < DATATYPE_NUM ? ",\n" : "\n");
+    }
+    file << "}\n";
+    return true;
+}
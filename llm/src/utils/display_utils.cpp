@@ -8,7 +8,9 @@
 #include "utils/display_utils.h"
 
 #include "nlohmann/json.hpp"
+#if USE_CARIO == 1
 #include <cairo/cairo.h>
+#endif
 
 using json = nlohmann::json;
 
@@ -55,6 +57,16 @@ unordered_map<int, Display::Core> extract_core_data(const json &config) {
         } else {
             for (const auto &work : core_json["worklist"]) {
                 vector<int> temp_cast;
+                // collective条目只画出与组内其他核之间的通信
+                if (work.contains("collective")) {
+                    for (const auto &g : work["collective"]["group"]) {
+                        if (g.is_number_integer() && g != core.id)
+                            temp_cast.push_back(g);
+                    }
+                    core.dests.push_back(temp_cast);
+                    continue;
+                }
+
                 for (const auto &cast : work["cast"]) {
                     if (cast.contains("critical") && cast["critical"]) {
                         int d = cast["dest"];
@@ -74,6 +86,54 @@ unordered_map<int, Display::Core> extract_core_data(const json &config) {
     return cores;
 }
 
+void save_dataflow(const unordered_map<int, Display::Core> &cores,
+                   const set<int> &source_ids, const string &filename) {
+    json j;
+    j["grid_x"] = GRID_X;
+    j["grid_size"] = GRID_SIZE;
+    j["sources"] = source_ids;
+    j["cores"] = json::array();
+    for (auto &pair : cores) {
+        json c;
+        c["id"] = pair.second.id;
+        c["dests"] = pair.second.dests;
+        j["cores"].push_back(c);
+    }
+
+    ofstream file(filename);
+    file << j.dump(2);
+}
+
+bool load_dataflow(const string &filename,
+                   unordered_map<int, Display::Core> &cores,
+                   set<int> &source_ids) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cout << "[ERROR] Cannot open dataflow file " << filename << endl;
+        return false;
+    }
+
+    json j;
+    file >> j;
+    if (j["grid_x"] != GRID_X || j["grid_size"] != GRID_SIZE) {
+        cout << "[ERROR] Dataflow file " << filename
+             << " does not match the core config grid.\n";
+        return false;
+    }
+
+    for (int id : j["sources"])
+        source_ids.emplace(id);
+    for (auto &c : j["cores"]) {
+        Display::Core core;
+        core.id = c["id"];
+        core.x = core.id % GRID_X;
+        core.y = core.id / GRID_X;
+        core.dests = c["dests"].get<vector<vector<int>>>();
+        cores[core.id] = core;
+    }
+    return true;
+}
+
 #if USE_SFML == 1
 // 绘制带描边的箭头
 void draw_arrow(sf::RenderTexture &renderTexture, float start_x, float start_y,
@@ -758,4 +818,66 @@ void plot_dataflow(unordered_map<int, Display::Core> cores, set<int> source_ids,
 
     cout << "图像已保存为 'core_data_flow.png'" << endl;
 }
-#endif
\ No newline at end of file
+
+void plot_heatmap(const map<int, double> &values, const string &title,
+                  const string &output, double scale) {
+    int rows = GRID_SIZE / GRID_X;
+    double cell = 80, margin = 40, title_height = 60;
+    int width = margin * 2 + cell * GRID_X;
+    int height = margin * 2 + title_height + cell * rows;
+
+    cairo_surface_t *surface =
+        cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t *cr = cairo_create(surface);
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+
+    double max_value = scale;
+    if (max_value <= 0)
+        for (auto &pair : values)
+            max_value = max(max_value, pair.second);
+
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 24);
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_move_to(cr, margin, margin + 24);
+    cairo_show_text(cr, title.c_str());
+
+    // 与数据流图相同，y坐标向上增长；数值越大颜色越红，没有数据的核为灰色
+    cairo_set_font_size(cr, 14);
+    for (int i = 0; i < GRID_SIZE; i++) {
+        double x = margin + i % GRID_X * cell;
+        double y = margin + title_height + (rows - 1 - i / GRID_X) * cell;
+
+        auto it = values.find(i);
+        if (it == values.end())
+            cairo_set_source_rgb(cr, 0.85, 0.85, 0.85);
+        else {
+            double t = max_value > 0 ? min(1.0, it->second / max_value) : 0;
+            cairo_set_source_rgb(cr, 1.0, 1.0 - 0.8 * t, 1.0 - 0.9 * t);
+        }
+        cairo_rectangle(cr, x, y, cell, cell);
+        cairo_fill_preserve(cr);
+        cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
+        cairo_set_line_width(cr, 1);
+        cairo_stroke(cr);
+
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_move_to(cr, x + 6, y + 20);
+        cairo_show_text(cr, to_string(i).c_str());
+        if (it != values.end()) {
+            char text[32];
+            snprintf(text, sizeof(text), "%.3g", it->second);
+            cairo_move_to(cr, x + 6, y + cell - 10);
+            cairo_show_text(cr, text);
+        }
+    }
+
+    cairo_surface_write_to_png(surface, output.c_str());
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    cout << "图像已保存为 '" << output << "'" << endl;
+}
+#endif
@@ -4,6 +4,7 @@
 #include "defs/global.h"
 #include "macros/macros.h"
 #include "memory/gpu/GPU_L1L2_Cache.h"
+#include "trace/Stats_registry.h"
 #include "utils/print_utils.h"
 #include "utils/system_utils.h"
 
@@ -15,6 +16,25 @@
 #include <tlm_utils/simple_target_socket.h>
 
 
+void mem_wait(TaskCoreContext &context, u_int64_t ns) {
+    if (!context.fast_forward)
+        wait(ns, SC_NS);
+}
+
+// 行为级sram从start（ns）开始的访问时间。--sram-model row：每行计一次row_latency；
+// bank：由核上的bank模型按地址模式计算bank冲突与端口竞争
+static u_int64_t beha_sram_time(TaskCoreContext &context, SramBankModel *bank,
+                                u_int64_t start, const Sram_access &acc,
+                                int row_latency) {
+    if (acc.rows <= 0 || acc.width <= 0)
+        return 0;
+    if (g_sram_model == SRAM_MODEL_ROW || bank == nullptr)
+        return (u_int64_t)acc.rows * row_latency;
+    return bank->access(start, acc, !context.fast_forward);
+}
+
+static u_int64_t now_ns() { return sc_time_stamp().to_seconds() * 1e9; }
+
 void sram_write(TaskCoreContext &context, int dma_read_count,
                 int sram_addr_temp, AllocationID alloc_id, bool use_manager) {
     //     auto hmau = context.hmau;
@@ -53,6 +73,7 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
                               bool use_manager,
                               SramPosLocator *sram_pos_locator,
                               bool dummy_alloc, bool add_dram_addr) {
+    STATS.core(context.cid).dram_read_bytes->inc(data_size_in_byte);
 
     int sram_bitw = GetCoreHWConfig(context.cid)->sram_bitwidth;
 
@@ -242,7 +263,7 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
             float need_NS = (float)require_byte / beha_dram_util /
                             (15.0 * GetCoreHWConfig(context.cid)->dram_bw / 8);
             int need_cycles = need_NS;
-            wait(need_cycles, SC_NS);
+            mem_wait(context, need_cycles);
         }
         context.event_engine->add_event("Core " + ToHexString(context.cid),
                                         "R_Dram", "E",
@@ -265,6 +286,8 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
 
 #endif
 #if USE_BEHA_SRAM == 1
+        // sram写入与dram读取重叠，从dram访问开始时占用bank
+        u_int64_t sram_base = sram_addr_temp;
         for (int i = 0; i < dma_read_count; i++) {
             if (i != 0) {
 #if USE_SRAM_MANAGER == 1
@@ -281,11 +304,14 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
                 sram_addr_temp = sram_addr_temp + SRAM_BANKS;
 #endif
             }
-
-            sram_time += RAM_WRITE_LATENCY;
         }
+        sram_time = beha_sram_time(
+            context, context.sram_bank,
+            start_nbdram.to_seconds() * 1e9,
+            {sram_base, SRAM_BANKS, dma_read_count, SRAM_BANKS, true},
+            RAM_WRITE_LATENCY);
         if (nbdram_time < sram_time) {
-            wait(sram_time - nbdram_time, SC_NS);
+            mem_wait(context, sram_time - nbdram_time);
         }
 
 #endif
@@ -322,9 +348,9 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
             sram_addr_temp = sram_addr_temp + SRAM_BANKS;
         }
 
-        wait(nbdram_time, SC_NS);
+        mem_wait(context, nbdram_time);
         if (nbdram_time < sram_time) {
-            wait(sram_time - nbdram_time, SC_NS);
+            mem_wait(context, sram_time - nbdram_time);
         }
 
 #endif
@@ -356,10 +382,10 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
             // cout << "end padding nbdram: " << sc_time_stamp().to_string()
             //      << endl;
             nbdram_time = (end_nbdram - start_nbdram).to_seconds() * 1e9;
-            sram_time = 0;
             sc_bv<SRAM_BITWIDTH> data_tmp2;
             data_tmp2 = 0;
             sc_time elapsed_time;
+            u_int64_t single_base = sram_addr_temp;
             for (int i = 0; i < single_read_count; i++) {
                 if (i != 0) {
 #if USE_SRAM_MANAGER == 1
@@ -376,11 +402,14 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
                     sram_addr_temp = sram_addr_temp + 1;
 #endif
                 }
-                sram_time += RAM_WRITE_LATENCY;
             }
+            sram_time = beha_sram_time(
+                context, context.sram_bank, start_nbdram.to_seconds() * 1e9,
+                {single_base, 1, single_read_count, 1, true},
+                RAM_WRITE_LATENCY);
 
             if (nbdram_time < sram_time) {
-                wait(sram_time - nbdram_time, SC_NS);
+                mem_wait(context, sram_time - nbdram_time);
             }
 #endif
         }
@@ -424,9 +453,9 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
                 sram_time += RAM_WRITE_LATENCY;
                 sram_addr_temp = sram_addr_temp + 1;
             }
-            wait(nbdram_time, SC_NS);
+            mem_wait(context, nbdram_time);
             if (nbdram_time < sram_time) {
-                wait(sram_time - nbdram_time, SC_NS);
+                mem_wait(context, sram_time - nbdram_time);
             }
         }
 #endif
@@ -455,6 +484,10 @@ void sram_first_write_generic(TaskCoreContext &context, int data_size_in_byte,
 
 void sram_spill_back_generic(TaskCoreContext &context, int data_size_in_byte,
                              u_int64_t global_addr, u_int64_t &dram_time) {
+    Core_stats &stats = STATS.core(context.cid);
+    stats.spill_bytes->inc(data_size_in_byte);
+    stats.dram_write_bytes->inc(data_size_in_byte);
+
     int sram_bitw = GetCoreHWConfig(context.cid)->sram_bitwidth;
     // assert(false);
     int dma_read_count = data_size_in_byte * 8 / (int)(sram_bitw * SRAM_BANKS);
@@ -551,7 +584,7 @@ void sram_spill_back_generic(TaskCoreContext &context, int data_size_in_byte,
         float need_NS = (float)require_byte / beha_dram_util /
                         (15.0 * GetCoreHWConfig(context.cid)->dram_bw / 8);
         int need_cycles = need_NS;
-        wait(need_cycles, SC_NS);
+        mem_wait(context, need_cycles);
     }
     context.event_engine->add_event("Core " + ToHexString(context.cid),
                                     "W_Dram", "E", Trace_event_util("W_Dram"));
@@ -563,18 +596,18 @@ void sram_spill_back_generic(TaskCoreContext &context, int data_size_in_byte,
 #endif
     u_int64_t nbdram_time = (end_nbdram - start_nbdram).to_seconds() * 1e9;
 
-    for (int i = 0; i < dma_read_count; i++) {
-        // sc_time elapsed_time;
-        // hmau->mem_read_port->multiport_read(sram_addr_temp, data_tmp,
-        //                                     elapsed_time);
-        // u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
-        // sram_time += sram_timer;
-        sram_time += RAM_READ_LATENCY;
-        sram_addr_temp = sram_addr_temp + SRAM_BANKS;
-    }
+    // sc_time elapsed_time;
+    // hmau->mem_read_port->multiport_read(sram_addr_temp, data_tmp,
+    //                                     elapsed_time);
+    sram_time = beha_sram_time(
+        context, context.sram_bank, start_nbdram.to_seconds() * 1e9,
+        {(u_int64_t)sram_addr_temp, SRAM_BANKS, dma_read_count, SRAM_BANKS,
+         false},
+        RAM_READ_LATENCY);
+    sram_addr_temp = sram_addr_temp + dma_read_count * SRAM_BANKS;
 
     if (nbdram_time < sram_time) {
-        wait(sram_time - nbdram_time, SC_NS);
+        mem_wait(context, sram_time - nbdram_time);
     }
 
 #else
@@ -604,9 +637,9 @@ void sram_spill_back_generic(TaskCoreContext &context, int data_size_in_byte,
         sram_time = sram_time += RAM_READ_LATENCY;
         sram_addr_temp = sram_addr_temp + SRAM_BANKS;
     }
-    wait(nbdram_time, SC_NS);
+    mem_wait(context, nbdram_time);
     if (nbdram_time < sram_time) {
-        wait(sram_time - nbdram_time, SC_NS);
+        mem_wait(context, sram_time - nbdram_time);
     }
 #endif
 
@@ -632,21 +665,15 @@ void sram_spill_back_generic(TaskCoreContext &context, int data_size_in_byte,
         // cout << "Core " << context.cid << " end padding nbdram: " <<
         // sc_time_stamp().to_string() << endl;
         nbdram_time = (end_nbdram - start_nbdram).to_seconds() * 1e9;
-        sram_time = 0;
-        // sc_bv<SRAM_BITWIDTH> data_tmp2;
-        // data_tmp2 = 0;
-        // sc_time elapsed_time;
-        for (int i = 0; i < single_read_count; i++) {
-            // mau->mem_read_port->read(sram_addr_temp, data_tmp2,
-            // elapsed_time); u_int64_t sram_timer = elapsed_time.to_seconds() *
-            // 1e9; sram_time += sram_timer;
-            sram_addr_temp = sram_addr_temp + 1;
-
-            sram_time += RAM_READ_LATENCY;
-        }
+        // mau->mem_read_port->read(sram_addr_temp, data_tmp2, elapsed_time);
+        sram_time = beha_sram_time(
+            context, context.sram_bank, start_nbdram.to_seconds() * 1e9,
+            {(u_int64_t)sram_addr_temp + 1, 1, single_read_count, 1, false},
+            RAM_READ_LATENCY);
+        sram_addr_temp = sram_addr_temp + single_read_count;
 
         if (nbdram_time < sram_time) {
-            wait(sram_time - nbdram_time, SC_NS);
+            mem_wait(context, sram_time - nbdram_time);
         }
 #endif
 #else
@@ -683,9 +710,9 @@ void sram_spill_back_generic(TaskCoreContext &context, int data_size_in_byte,
             sram_time += RAM_READ_LATENCY;
             sram_addr_temp = sram_addr_temp + 1;
         }
-        wait(nbdram_time, SC_NS);
+        mem_wait(context, nbdram_time);
         if (nbdram_time < sram_time) {
-            wait(sram_time - nbdram_time, SC_NS);
+            mem_wait(context, sram_time - nbdram_time);
         }
 #endif
     }
@@ -757,6 +784,7 @@ void sram_read_generic(TaskCoreContext &context, int data_size_in_byte,
 #endif
 
     int sram_time = 0;
+    int sram_base = sram_addr_offset;
     for (int i = 0; i < dma_read_count; i++) {
         if (i != 0) {
 #if USE_SRAM_MANAGER == 1
@@ -783,15 +811,15 @@ void sram_read_generic(TaskCoreContext &context, int data_size_in_byte,
         u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
         dram_time += sram_timer;
 
-#else
-        sram_time += RAM_READ_LATENCY;
-        dram_time += RAM_READ_LATENCY;
-
-
 #endif
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(
+        context, context.sram_bank, now_ns(),
+        {(u_int64_t)sram_base, SRAM_BANKS, dma_read_count, SRAM_BANKS, false},
+        RAM_READ_LATENCY);
+    dram_time += sram_time;
+    mem_wait(context, sram_time);
 
 #endif
 
@@ -800,7 +828,7 @@ void sram_read_generic(TaskCoreContext &context, int data_size_in_byte,
     data_tmp2 = 0;
 
     sc_time elapsed_time;
-    sram_time = 0;
+    sram_base = sram_addr_offset;
     for (int i = 0; i < single_read_count; i++) {
         if (i != 0) {
 #if USE_SRAM_MANAGER == 1
@@ -822,13 +850,15 @@ void sram_read_generic(TaskCoreContext &context, int data_size_in_byte,
 
         u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
         dram_time += sram_timer;
-#else
-        sram_time += RAM_READ_LATENCY;
-        dram_time += RAM_READ_LATENCY;
 #endif
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(context, context.sram_bank, now_ns(),
+                               {(u_int64_t)sram_base, 1, single_read_count, 1,
+                                false},
+                               RAM_READ_LATENCY);
+    dram_time += sram_time;
+    mem_wait(context, sram_time);
 
 #endif
 }
@@ -860,6 +890,7 @@ void sram_read_generic_temp(TaskCoreContext &context, int data_size_in_byte,
         data_tmp[i] = 0;
     }
     int sram_time = 0;
+    int sram_base = sram_addr_offset;
     for (int i = 0; i < dma_read_count; i++) {
 #if USE_BEHA_SRAM == 0
         sc_time elapsed_time;
@@ -867,16 +898,16 @@ void sram_read_generic_temp(TaskCoreContext &context, int data_size_in_byte,
                                             elapsed_time);
         u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
         dram_time += sram_timer;
-#else
-        sram_time += RAM_READ_LATENCY;
-        dram_time += RAM_READ_LATENCY;
-
-
 #endif
         sram_addr_offset = sram_addr_offset + SRAM_BANKS;
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(
+        context, context.temp_sram_bank, now_ns(),
+        {(u_int64_t)sram_base, SRAM_BANKS, dma_read_count, SRAM_BANKS, false},
+        RAM_READ_LATENCY);
+    dram_time += sram_time;
+    mem_wait(context, sram_time);
 
 #endif
 
@@ -885,7 +916,7 @@ void sram_read_generic_temp(TaskCoreContext &context, int data_size_in_byte,
     data_tmp2 = 0;
 
     sc_time elapsed_time;
-    sram_time = 0;
+    sram_base = sram_addr_offset + 1;
     for (int i = 0; i < single_read_count; i++) {
         sram_addr_offset = sram_addr_offset + 1;
 #if USE_BEHA_SRAM == 0
@@ -893,14 +924,16 @@ void sram_read_generic_temp(TaskCoreContext &context, int data_size_in_byte,
 
         u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
         dram_time += sram_timer;
-#else
-        sram_time += RAM_READ_LATENCY;
-        dram_time += RAM_READ_LATENCY;
 #endif
     }
 
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(context, context.temp_sram_bank, now_ns(),
+                               {(u_int64_t)sram_base, 1, single_read_count, 1,
+                                false},
+                               RAM_READ_LATENCY);
+    dram_time += sram_time;
+    mem_wait(context, sram_time);
 
 #endif
 }
@@ -1031,6 +1064,7 @@ void sram_write_append_generic(TaskCoreContext &context, int data_size_in_byte,
         data_tmp[i] = 0;
     }
     int sram_time = 0;
+    int sram_base = sram_addr_temp;
 
     for (int i = 0; i < dma_read_count; i++) {
         sc_time elapsed_time;
@@ -1052,15 +1086,18 @@ void sram_write_append_generic(TaskCoreContext &context, int data_size_in_byte,
         hmau->mem_read_port->multiport_write(sram_addr_temp, data_tmp,
                                              elapsed_time);
         // u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
-#else
-        sram_time += 0; // RAM_WRITE_LATENCY;
 #endif
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    // row模式下写回与计算重叠，不计时间
+    sram_time = beha_sram_time(
+        context, context.sram_bank, now_ns(),
+        {(u_int64_t)sram_base, SRAM_BANKS, dma_read_count, SRAM_BANKS, true},
+        0);
+    mem_wait(context, sram_time);
 
 #endif
-    sram_time = 0;
+    sram_base = sram_addr_temp;
 
     sc_bv<SRAM_BITWIDTH> data_tmp2;
     data_tmp2 = 0;
@@ -1084,14 +1121,16 @@ void sram_write_append_generic(TaskCoreContext &context, int data_size_in_byte,
 #if USE_BEHA_SRAM == 0
         mau->mem_write_port->write(sram_addr_temp, data_tmp2, elapsed_time);
 
-#else
-        sram_time += 0; // RAM_WRITE_LATENCY;
 #endif
         // u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
         // dram_time += sram_timer;
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(context, context.sram_bank, now_ns(),
+                               {(u_int64_t)sram_base, 1, single_read_count, 1,
+                                true},
+                               0);
+    mem_wait(context, sram_time);
 
 #endif
 
@@ -1133,6 +1172,7 @@ void sram_write_back_temp(TaskCoreContext &context, int data_size_in_byte,
         data_tmp[i] = 0;
     }
     int sram_time = 0;
+    int sram_base = temp_sram_addr;
 
     for (int i = 0; i < dma_read_count; i++) {
 #if USE_BEHA_SRAM == 0
@@ -1140,33 +1180,37 @@ void sram_write_back_temp(TaskCoreContext &context, int data_size_in_byte,
         hmau->mem_read_port->multiport_write(temp_sram_addr, data_tmp,
                                              elapsed_time);
         u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
-#else
-        sram_time += 0; // RAM_WRITE_LATENCY;
 #endif
         // dram_time += sram_timer;
         temp_sram_addr = temp_sram_addr + SRAM_BANKS;
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(
+        context, context.temp_sram_bank, now_ns(),
+        {(u_int64_t)sram_base, SRAM_BANKS, dma_read_count, SRAM_BANKS, true},
+        0);
+    mem_wait(context, sram_time);
 #endif
 
     sc_bv<SRAM_BITWIDTH> data_tmp2;
     data_tmp2 = 0;
 
     sc_time elapsed_time;
-    sram_time = 0;
+    sram_base = temp_sram_addr;
     for (int i = 0; i < single_read_count; i++) {
 #if USE_BEHA_SRAM == 0
         mau->mem_write_port->write(temp_sram_addr, data_tmp2, elapsed_time);
-#else
-        sram_time += 0; // RAM_WRITE_LATENCY;
 #endif
         temp_sram_addr = temp_sram_addr + 1;
         // u_int64_t sram_timer = elapsed_time.to_seconds() * 1e9;
         // dram_time += sram_timer;
     }
 #if USE_BEHA_SRAM == 1
-    wait(sram_time, SC_NS);
+    sram_time = beha_sram_time(context, context.temp_sram_bank, now_ns(),
+                               {(u_int64_t)sram_base, 1, single_read_count, 1,
+                                true},
+                               0);
+    mem_wait(context, sram_time);
 #endif
 }
 
@@ -1412,6 +1456,7 @@ void sram_write_back_temp(TaskCoreContext &context, int data_size_in_byte,
 #if USE_L1L2_CACHE == 1
 void gpu_read_generic(TaskCoreContext &context, uint64_t global_addr,
                       int data_size_in_byte, int &mem_time, bool cache_read) {
+    STATS.core(context.cid).dram_read_bytes->inc(data_size_in_byte);
 
     uint64_t inp_global_addr =
         (global_addr / dram_aligned) *
@@ -1469,9 +1514,9 @@ void gpu_read_generic(TaskCoreContext &context, uint64_t global_addr,
             (float)require_byte / beha_dram_util / (gpu_bw)*GRID_SIZE;
         int need_cycles = need_NS;
         if (cache_read == true) {
-            wait(need_cycles / 5, SC_NS);
+            mem_wait(context, need_cycles / 5);
         } else {
-            wait(need_cycles, SC_NS);
+            mem_wait(context, need_cycles);
         }
         // LOG_VERBOSE(1, context.cid," beha gpu: " << "require_byte " <<
         // require_byte << gpunb_dcache_if->id);
@@ -1506,6 +1551,7 @@ void gpu_read_generic(TaskCoreContext &context, uint64_t global_addr,
 
 void gpu_write_generic(TaskCoreContext &context, uint64_t global_addr,
                        int data_size_in_byte, int &mem_time, bool cache_write) {
+    STATS.core(context.cid).dram_write_bytes->inc(data_size_in_byte);
 
     uint64_t inp_global_addr =
         (global_addr / dram_aligned) *
@@ -1552,9 +1598,9 @@ void gpu_write_generic(TaskCoreContext &context, uint64_t global_addr,
             (float)require_byte / beha_dram_util / (gpu_bw)*GRID_SIZE;
         int need_cycles = need_NS;
         if (cache_write == true) {
-            wait(0, SC_NS);
+            mem_wait(context, 0);
         } else {
-            wait(need_cycles, SC_NS);
+            mem_wait(context, need_cycles);
         }
     }
     context.event_engine->add_event("Core " + ToHexString(context.cid),
@@ -1624,6 +1670,10 @@ TaskCoreContext generate_context(WorkerCoreExecutor *workercore) {
     context.event_engine = workercore->event_engine;
     context.s_sram = workercore->start_sram_event;
     context.e_sram = workercore->end_sram_event;
+    context.sram_bank = workercore->sram_bank;
+    context.temp_sram_bank = workercore->temp_sram_bank;
+    if (prefetch_depth > 0)
+        context.prefetcher = workercore->prefetcher;
 #if USE_BEHA_SRAM == 0
     context.sram_writer = sram_writer;
 #endif
@@ -39,7 +39,13 @@ sc_bv<256> SerializeMsg(Msg msg) {
     pos += M_D_CONF_END;
     serialized_msg.range(pos + M_D_DATA - 1, pos) = msg.data_;
     pos += M_D_DATA;
-    serialized_msg.range(255, pos) = sc_bv<32>(0);
+    serialized_msg.range(pos + M_D_MCAST - 1, pos) =
+        sc_bv<M_D_MCAST>(msg.mcast_);
+    pos += M_D_MCAST;
+    serialized_msg.range(pos + M_D_VC - 1, pos) = sc_bv<M_D_VC>(msg.vc_);
+    pos += M_D_VC;
+    if (pos < 256)
+        serialized_msg.range(255, pos) = sc_bv<32>(0);
 
     return serialized_msg;
 }
@@ -72,6 +78,10 @@ Msg DeserializeMsg(sc_bv<256> buffer) {
     msg.config_end_ = buffer.range(pos + M_D_CONF_END - 1, pos).to_uint64(),
     pos += M_D_CONF_END;
     msg.data_ = buffer.range(pos + M_D_DATA - 1, pos);
+    pos += M_D_DATA;
+    msg.mcast_ = buffer.range(pos + M_D_MCAST - 1, pos).to_uint64();
+    pos += M_D_MCAST;
+    msg.vc_ = buffer.range(pos + M_D_VC - 1, pos).to_uint64();
 
     return msg;
 }
@@ -99,4 +109,12 @@ bool IsBlockableMsgType(MSG_TYPE type) {
     default:
         return false;
     }
-}
\ No newline at end of file
+}
+
+int DataFlits(const Msg &msg) {
+#if USE_BEHA_NOC == 1
+    return msg.roofline_packets_;
+#else
+    return 1;
+#endif
+}
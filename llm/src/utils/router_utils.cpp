@@ -1,8 +1,11 @@
 #include "utils/router_utils.h"
 #include "defs/global.h"
 #include "macros/macros.h"
+#include "utils/print_utils.h"
+#include <algorithm>
 #include <queue>
 #include <fstream>
+#include <sstream>
 
 int GetInputSource(Directions dir, int pos) {
     int x = pos % GRID_X;
@@ -30,12 +33,102 @@ int GetInputSource(Directions dir, int pos) {
 
 bool IsMarginCore(int id) { return id % GRID_X == 0; }
 
+static int HostDistance(int a, int b) {
+    return abs(a % GRID_X - b % GRID_X) + abs(a / GRID_X - b / GRID_X);
+}
+
+bool InitHostPorts(const string &mode) {
+    int rows = GRID_SIZE / GRID_X;
+    vector<int> ports;
+
+    if (mode == "west" || mode == "west_east") {
+        for (int y = 0; y < rows; y++)
+            ports.push_back(y * GRID_X);
+        if (mode == "west_east" && GRID_X > 1)
+            for (int y = 0; y < rows; y++)
+                ports.push_back(y * GRID_X + GRID_X - 1);
+    } else if (mode == "edges") {
+        for (int i = 0; i < GRID_SIZE; i++) {
+            int x = i % GRID_X, y = i / GRID_X;
+            if (x == 0 || x == GRID_X - 1 || y == 0 || y == rows - 1)
+                ports.push_back(i);
+        }
+    } else {
+        stringstream ss(mode);
+        string item;
+        while (getline(ss, item, ',')) {
+            int id;
+            try {
+                id = stoi(item);
+            } catch (...) {
+                return false;
+            }
+            if (id < 0 || id >= GRID_SIZE ||
+                find(ports.begin(), ports.end(), id) != ports.end())
+                return false;
+            ports.push_back(id);
+        }
+    }
+
+    if (ports.empty())
+        return false;
+
+    // 按核编号顺序静态分配，同一个核的数据始终经过同一个端口，保证到达顺序
+    vector<int> load(ports.size(), 0);
+    g_host_port_of.assign(GRID_SIZE, 0);
+    for (int i = 0; i < GRID_SIZE; i++) {
+        int best = 0;
+        for (int p = 1; p < ports.size(); p++) {
+            int d = HostDistance(ports[p], i), bd = HostDistance(ports[best], i);
+            if (d < bd || (d == bd && load[p] < load[best]))
+                best = p;
+        }
+        g_host_port_of[i] = best;
+        load[best]++;
+    }
+
+    g_host_ports = ports;
+    return true;
+}
+
+int HostPortNum() {
+    if (g_host_ports.empty())
+        InitHostPorts("west");
+    return g_host_ports.size();
+}
+
+bool IsHostPort(int id) {
+    HostPortNum();
+    return find(g_host_ports.begin(), g_host_ports.end(), id) !=
+           g_host_ports.end();
+}
+
+int HostPortOf(int id) {
+    HostPortNum();
+    if (id < 0 || id >= GRID_SIZE)
+        return 0;
+    return g_host_port_of[id];
+}
+
+int HostExitRouter(int source, int pos) {
+    if (source >= 0 && source < GRID_SIZE)
+        return g_host_ports[HostPortOf(source)];
+
+    HostPortNum();
+    int best = g_host_ports[0];
+    for (auto p : g_host_ports)
+        if (HostDistance(p, pos) < HostDistance(best, pos))
+            best = p;
+    return best;
+}
+
 Directions GetNextHop(int des, int pos) {
     // 从pos发往des的下一个方向, 先X后Y
-    if (IsMarginCore(pos) && des == GRID_SIZE)
-        return HOST;
-    if (des == GRID_SIZE)
-        return WEST; // CTODO: fix this
+    if (des == GRID_SIZE) {
+        if (IsHostPort(pos))
+            return HOST;
+        des = HostExitRouter(-1, pos);
+    }
 
     int dx = des % GRID_X;
     int dy = des / GRID_X;
@@ -62,10 +155,11 @@ Directions GetNextHop(int des, int pos) {
 
 Directions GetNextHopReverse(int des, int pos) {
     // 从pos发往des的下一个方向, 先Y后X
-    if (IsMarginCore(pos) && des == GRID_SIZE)
-        return HOST;
-    if (des == GRID_SIZE)
-        return WEST; // CTODO: fix this
+    if (des == GRID_SIZE) {
+        if (IsHostPort(pos))
+            return HOST;
+        des = HostExitRouter(-1, pos);
+    }
 
     int dx = des % GRID_X;
     int dy = des / GRID_X;
@@ -103,4 +197,126 @@ Directions GetOpposeDirection(Directions dir) {
     default:
         return CENTER;
     }
-}
\ No newline at end of file
+}
+
+ROUTING_ALGO ParseRouting(const string &name) {
+    if (name == "xy")
+        return ROUTE_XY;
+    if (name == "west_first")
+        return ROUTE_WEST_FIRST;
+    if (name == "odd_even")
+        return ROUTE_ODD_EVEN;
+    if (name == "o1turn")
+        return ROUTE_O1TURN;
+
+    ARGUS_EXIT("Unknown routing algorithm ", name,
+               ", use xy/west_first/odd_even/o1turn.\n");
+    return ROUTE_XY;
+}
+
+string GetRoutingName(ROUTING_ALGO algo) {
+    switch (algo) {
+    case ROUTE_WEST_FIRST:
+        return "west_first";
+    case ROUTE_ODD_EVEN:
+        return "odd_even";
+    case ROUTE_O1TURN:
+        return "o1turn";
+    default:
+        return "xy";
+    }
+}
+
+vector<Directions> GetRouteCandidates(int source, int des, int pos, bool yx) {
+    // host方向与本地core不存在选择
+    if (des == GRID_SIZE || des == pos)
+        return {GetNextHop(des, pos)};
+
+    int ex = des % GRID_X - pos % GRID_X;
+    int ey = des / GRID_X - pos / GRID_X;
+    Directions dir_x = ex > 0 ? EAST : WEST;
+    Directions dir_y = ey > 0 ? NORTH : SOUTH;
+
+    vector<Directions> dirs;
+    switch (noc_routing) {
+    case ROUTE_WEST_FIRST:
+        // 需要向西时必须先走完西向，之后在东、南、北之间自适应
+        if (ex < 0 || ey == 0)
+            return {GetNextHop(des, pos)};
+        if (ex > 0)
+            dirs.push_back(EAST);
+        dirs.push_back(dir_y);
+        return dirs;
+
+    case ROUTE_ODD_EVEN: {
+        // Chiu的odd-even转向模型：偶数列禁止东->南北的转向，奇数列禁止南北->西的转向
+        int cx = pos % GRID_X, dx = des % GRID_X;
+        if (ex == 0)
+            return {dir_y};
+        if (ex > 0) {
+            if (ey == 0)
+                return {EAST};
+            if (dx % 2 == 1 || ex != 1)
+                dirs.push_back(EAST);
+            if (cx % 2 == 1 || (source >= 0 && source < GRID_SIZE &&
+                                cx == source % GRID_X))
+                dirs.push_back(dir_y);
+            return dirs;
+        }
+        dirs.push_back(WEST);
+        if (ey != 0 && cx % 2 == 0)
+            dirs.push_back(dir_y);
+        return dirs;
+    }
+
+    case ROUTE_O1TURN:
+        return {yx ? GetNextHopReverse(des, pos) : GetNextHop(des, pos)};
+
+    default:
+        return {GetNextHop(des, pos)};
+    }
+}
+
+int GetVcClass(int vc) { return noc_routing == ROUTE_O1TURN ? vc % 2 : 0; }
+
+bool VcInClass(int vc, int vc_class) { return GetVcClass(vc) == vc_class; }
+
+int RegisterMcastGroup(const vector<int> &dests) {
+    vector<int> sorted = dests;
+    sort(sorted.begin(), sorted.end());
+
+    for (int i = 1; i < g_mcast_groups.size(); i++)
+        if (g_mcast_groups[i] == sorted)
+            return i;
+
+    if (g_mcast_groups.size() >= (1 << M_D_MCAST))
+        return 0;
+
+    g_mcast_groups.push_back(sorted);
+    return g_mcast_groups.size() - 1;
+}
+
+bool OnXYPath(int source, int des, int pos) {
+    int sx = source % GRID_X, sy = source / GRID_X;
+    int dx = des % GRID_X, dy = des / GRID_X;
+    int px = pos % GRID_X, py = pos / GRID_X;
+
+    // X段：与source同一行；Y段：与des同一列
+    if (py == sy && px >= min(sx, dx) && px <= max(sx, dx))
+        return true;
+    return px == dx && py >= min(sy, dy) && py <= max(sy, dy);
+}
+
+vector<Directions> GetMcastNextHops(int group, int source, int pos) {
+    vector<Directions> outs;
+    for (int des : g_mcast_groups[group]) {
+        if (!OnXYPath(source, des, pos))
+            continue;
+
+        Directions next = GetNextHop(des, pos);
+        if (find(outs.begin(), outs.end(), next) == outs.end())
+            outs.push_back(next);
+    }
+
+    return outs;
+}
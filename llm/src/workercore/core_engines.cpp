@@ -0,0 +1,210 @@
+#include "workercore/core_engines.h"
+#include "defs/global.h"
+#include "trace/Prim_recorder.h"
+
+#include <algorithm>
+
+Core_engines::Core_engines(const sc_module_name &name, int cid)
+    : sc_module(name), cid(cid) {
+    string prefix = "core" + to_string(cid) + ".engine.";
+    core = &STATS.core(cid);
+    dma_util = STATS.gauge(prefix + "dma");
+    exu_util = STATS.gauge(prefix + "exu");
+    sfu_util = STATS.gauge(prefix + "sfu");
+    dma_busy_ns = STATS.counter(prefix + "dma.busy_ns");
+    exu_busy_ns = STATS.counter(prefix + "exu.busy_ns");
+    sfu_busy_ns = STATS.counter(prefix + "sfu.busy_ns");
+    dep_stall_ns = STATS.counter(prefix + "dep_stall_ns");
+    dma_stall_ns = STATS.counter(prefix + "dma_stall_ns");
+
+    SC_THREAD(exu_logic);
+    SC_THREAD(sfu_logic);
+}
+
+void Core_engines::wait_slot() {
+    while (inflight >= engine_window)
+        wait(ev_update);
+}
+
+bool Core_engines::label_busy(const vector<string> &inputs,
+                              const vector<string> &outputs) {
+    for (auto &label : inputs) {
+        auto it = writer.find(label);
+        if (it != writer.end() && it->second.first >= 0)
+            return true;
+    }
+    for (auto &label : outputs) {
+        auto it = writer.find(label);
+        if (it != writer.end() && it->second.first >= 0)
+            return true;
+        if (readers.count(label))
+            return true;
+    }
+    return false;
+}
+
+void Core_engines::wait_labels(const vector<string> &inputs,
+                               const vector<string> &outputs) {
+    u_int64_t start = Prim_recorder::time_ns();
+    while (label_busy(inputs, outputs))
+        wait(ev_update);
+    dma_stall_ns->inc(Prim_recorder::time_ns() - start);
+}
+
+void Core_engines::dma_begin() {
+    dma_active = true;
+    dma_start = Prim_recorder::time_ns();
+    dma_util->set(1);
+    core->dram_wait->set(1);
+    update_state();
+}
+
+void Core_engines::dma_end() {
+    dma_active = false;
+    dma_busy_ns->inc(Prim_recorder::time_ns() - dma_start);
+    dma_util->set(0);
+    core->dram_wait->set(0);
+    update_state();
+}
+
+void Core_engines::issue(Engine_job *job, const vector<string> &inputs) {
+    job->id = next_id++;
+    job->inputs = inputs;
+    for (auto &label : inputs) {
+        auto it = writer.find(label);
+        if (it == writer.end())
+            continue;
+        if (it->second.first >= 0)
+            job->deps.push_back(it->second.first);
+        else
+            job->ready = max(job->ready, it->second.second);
+    }
+    for (auto &label : job->outputs)
+        writer[label] = {job->id, 0};
+    for (auto &label : inputs)
+        readers[label]++;
+
+    inflight++;
+    if (job->exu_ns > 0)
+        exu_queue.push_back(job);
+    else
+        sfu_queue.push_back(job);
+    ev_update.notify(SC_ZERO_TIME);
+}
+
+void Core_engines::drain() {
+    while (inflight > 0)
+        wait(ev_update);
+}
+
+Engine_job *Core_engines::pick(deque<Engine_job *> &queue) {
+    for (auto it = queue.begin(); it != queue.end(); it++) {
+        if ((*it)->deps.empty()) {
+            Engine_job *job = *it;
+            queue.erase(it);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void Core_engines::exu_logic() {
+    while (true) {
+        Engine_job *job = pick(exu_queue);
+        if (job == nullptr) {
+            wait(ev_update);
+            continue;
+        }
+
+        // 引擎空闲时计算可以追溯到本原语DMA开始，与其重叠
+        u_int64_t now = Prim_recorder::time_ns();
+        u_int64_t earliest = max(exu_free, job->dma_start);
+        u_int64_t start = max(earliest, job->ready);
+        dep_stall_ns->inc(start - earliest);
+        job->exu_end = start + job->exu_ns;
+        exu_free = job->exu_end;
+        exu_busy_ns->inc(job->exu_ns);
+
+        if (job->exu_end > now) {
+            exu_active = true;
+            exu_util->set(1);
+            update_state();
+            wait(job->exu_end - now, SC_NS);
+            exu_active = false;
+            exu_util->set(0);
+            update_state();
+        }
+
+        sfu_queue.push_back(job);
+        ev_update.notify(SC_ZERO_TIME);
+    }
+}
+
+void Core_engines::sfu_logic() {
+    while (true) {
+        Engine_job *job = pick(sfu_queue);
+        if (job == nullptr) {
+            wait(ev_update);
+            continue;
+        }
+
+        u_int64_t now = Prim_recorder::time_ns();
+        u_int64_t earliest = max({sfu_free, job->dma_start, job->exu_end});
+        u_int64_t start = max(earliest, job->ready);
+        if (job->exu_ns == 0)
+            dep_stall_ns->inc(start - earliest);
+        sfu_free = start + job->sfu_ns;
+        sfu_busy_ns->inc(job->sfu_ns);
+
+        // 原语在输出写回（dma_end）之前不算完成
+        u_int64_t end = max(sfu_free, job->dma_end);
+        if (end > now) {
+            sfu_active = true;
+            sfu_util->set(1);
+            update_state();
+            wait(end - now, SC_NS);
+            sfu_active = false;
+            sfu_util->set(0);
+            update_state();
+        }
+
+        finish(job);
+    }
+}
+
+void Core_engines::finish(Engine_job *job) {
+    u_int64_t now = Prim_recorder::time_ns();
+    for (auto &label : job->outputs) {
+        auto it = writer.find(label);
+        if (it != writer.end() && it->second.first == job->id)
+            it->second = {-1, now};
+    }
+    for (auto &label : job->inputs) {
+        auto it = readers.find(label);
+        if (it != readers.end() && --it->second == 0)
+            readers.erase(it);
+    }
+
+    for (auto *queue : {&exu_queue, &sfu_queue}) {
+        for (auto *other : *queue) {
+            auto it = find(other->deps.begin(), other->deps.end(), job->id);
+            if (it != other->deps.end()) {
+                other->deps.erase(it);
+                other->ready = max(other->ready, now);
+            }
+        }
+    }
+
+    if (job->done)
+        job->done();
+    delete job;
+
+    inflight--;
+    update_state();
+    ev_update.notify(SC_ZERO_TIME);
+}
+
+void Core_engines::update_state() {
+    core->compute->set(exu_active || sfu_active);
+    core->busy->set(dma_active || inflight > 0);
+}
@@ -2,6 +2,7 @@
 #include <deque>
 #include <iostream>
 #include <queue>
+#include <sstream>
 #include <string>
 #include <typeinfo>
 
@@ -17,6 +18,9 @@
 #include "prims/norm_prims.h"
 #include "prims/pd_prims.h"
 #include "trace/Event_engine.h"
+#include "trace/Prim_recorder.h"
+#include "trace/Prim_sampler.h"
+#include "trace/Stats_registry.h"
 #include "utils/memory_utils.h"
 #include "utils/msg_utils.h"
 #include "utils/pe_utils.h"
@@ -32,6 +36,8 @@ void WorkerCoreExecutor::send_logic() {
 
         prim->data_packet_id = 0;
         bool job_done = false; // 结束内圈循环的标志
+        u_int64_t record_start = Prim_recorder::time_ns();
+        STATS.core(cid).noc_wait->set(1);
 
         cout << "[SEND START] Core " << cid << ": running send "
              << GetEnumSendType(prim->type) << ", destination " << prim->des_id
@@ -76,7 +82,10 @@ void WorkerCoreExecutor::send_logic() {
                                        prim->data_packet_id, prim->des_id, 0,
                                        prim->tag_id, length, sc_bv<128>(0x1));
                     temp_msg.roofline_packets_ = roofline_packets;
+                    temp_msg.source_ = cid;
+                    temp_msg.mcast_ = prim->mcast_id;
                     send_buffer = temp_msg;
+                    STATS.core(cid).injected_flits->inc(DataFlits(temp_msg));
 
                     // send_helper_write = 3;
                     atomic_helper_lock(sc_time_stamp(), 3);
@@ -156,6 +165,20 @@ void WorkerCoreExecutor::send_logic() {
                 cout << "[SEND DONE] Core " << cid << ": running send "
                      << GetEnumSendType(prim->type) << " done at "
                      << sc_time_stamp() << "\n";
+                STATS.core(cid).noc_wait->set(0);
+
+                if (PRIM_RECORDER.enabled()) {
+                    Prim_record record;
+                    record.cid = cid;
+                    record.kind = "send";
+                    record.name = GetEnumSendType(prim->type);
+                    record.start = record_start;
+                    record.end = Prim_recorder::time_ns();
+                    record.tag = prim->tag_id;
+                    record.peer = prim->des_id;
+                    record.loop_cnt = core_context->loop_cnt;
+                    PRIM_RECORDER.record(record);
+                }
                 break;
             }
         }
@@ -191,6 +214,7 @@ void WorkerCoreExecutor::send_para_logic() {
             }
 
             bool job_done = false; // 结束内圈循环的标志
+            int ack_cnt = 0;       // 已经收到的ack数量
 
             while (true) {
 #if ROUTER_PIPE == 0
@@ -260,6 +284,9 @@ void WorkerCoreExecutor::send_para_logic() {
                                 s_prim->des_id, 0, s_prim->tag_id, length,
                                 sc_bv<128>(0x1));
 #endif
+                            send_buffer.source_ = cid;
+                            send_buffer.mcast_ = s_prim->mcast_id;
+                            STATS.core(cid).injected_flits->inc(1);
                             int delay = 0;
                             TaskCoreContext context = generate_context(this);
                             delay = prim->taskCoreDefault(context);
@@ -343,7 +370,8 @@ void WorkerCoreExecutor::send_para_logic() {
                         Msg m = msg_buffer_[MSG_TYPE::ACK].front();
                         msg_buffer_[MSG_TYPE::ACK].pop();
 
-                        if (m.msg_type_ == ACK) {
+                        if (m.msg_type_ == ACK &&
+                            ++ack_cnt >= ((Recv_prim *)prim)->recv_cnt) {
                             job_done = true;
 
                             cout << sc_time_stamp() << ": Worker " << cid
@@ -398,6 +426,8 @@ void WorkerCoreExecutor::recv_logic() {
         bool wait_send = false;
         bool job_done = false;
         vector<sc_bv<128>> segments; // 单个原语配置的所有数据包
+        u_int64_t record_start = Prim_recorder::time_ns();
+        STATS.core(cid).noc_wait->set(1);
 
         cout << "[RECV] Core " << cid << ": running recv "
              << GetEnumRecvType(prim->type) << ", recv_cnt " << prim->recv_cnt
@@ -416,11 +446,11 @@ void WorkerCoreExecutor::recv_logic() {
                 while (!msg_buffer_[MSG_TYPE::ACK].size())
                     wait(ev_recv_msg_type_[MSG_TYPE::ACK]);
 
-                // 接收到数据包
+                // 接收到数据包，多播时需要收到所有目标的ack
                 Msg m = msg_buffer_[MSG_TYPE::ACK].front();
                 msg_buffer_[MSG_TYPE::ACK].pop();
 
-                if (m.msg_type_ == ACK) {
+                if (m.msg_type_ == ACK && ++recv_cnt >= prim->recv_cnt) {
                     job_done = true;
 
                     cout << sc_time_stamp() << ": Worker " << cid
@@ -617,6 +647,21 @@ void WorkerCoreExecutor::recv_logic() {
             if (job_done)
                 break;
         }
+        STATS.core(cid).noc_wait->set(0);
+
+        if (PRIM_RECORDER.enabled()) {
+            // recv原语的全部时间都视为等待上游数据
+            Prim_record record;
+            record.cid = cid;
+            record.kind = "recv";
+            record.name = GetEnumRecvType(prim->type);
+            record.start = record_start;
+            record.end = Prim_recorder::time_ns();
+            record.recv_wait = record.end - record.start;
+            record.tag = prim->tag_id;
+            record.loop_cnt = core_context->loop_cnt;
+            PRIM_RECORDER.record(record);
+        }
 
         ev_block.notify(CYCLE, SC_NS);
         wait();
@@ -633,8 +678,156 @@ void WorkerCoreExecutor::task_logic() {
         cout << "[PRIM] Core <\033[38;5;214m" << cid
              << "\033[0m>: PRIM NAME -----------------------: " << p->name
              << endl;
-        delay = p->taskCoreDefault(context);
-        wait(sc_time(delay, SC_NS));
+        Core_stats &stats = STATS.core(cid);
+        Prim_record record;
+        record.start = Prim_recorder::time_ns();
+        u_int64_t dram_bytes_before =
+            stats.dram_read_bytes->value + stats.dram_write_bytes->value;
+        u_int64_t spill_bytes_before = stats.spill_bytes->value;
+
+        // 采样仿真：重复出现的计算原语只做功能性的更新，时间按之前详细仿真的平均耗时
+        string sample_sig;
+        u_int64_t replay_ns = 0;
+        bool replay = false;
+        if (PRIM_SAMPLER.enabled() && (p->prim_type & NPU_PRIM)) {
+            sample_sig = PRIM_SAMPLER.signature((CompBase *)p, core_context);
+            replay = PRIM_SAMPLER.should_replay(cid, sample_sig, replay_ns);
+        }
+
+        // 核内引擎并行：这里只完成原语的读入与写回（DMA），计算交给EXU/SFU，
+        // 核随即执行下一条原语
+        if (core_engines && (p->prim_type & NPU_PRIM) && !replay) {
+            // 与taskCoreDefault相同地去掉输入标签的 '_' 与 DRAM_LABEL 前缀
+            AddrDatapassLabel *label = core_context->datapass_label_;
+            vector<string> inputs, outputs;
+            for (int i = 0; i < MAX_SPLIT_NUM; i++) {
+                string in = label->indata[i];
+                if (in == UNSET_LABEL)
+                    continue;
+                if (in[0] == '_')
+                    in = in.substr(1);
+                size_t space_pos = in.find(' ');
+                if (in.find(DRAM_LABEL) == 0 && space_pos != string::npos)
+                    in = in.substr(space_pos + 1);
+                inputs.push_back(in);
+            }
+            istringstream iss(label->outdata);
+            string out;
+            while (iss >> out)
+                outputs.push_back(out);
+
+            // 读入输入之前等待其生产者完成，写回输出之前等待其读者与写者完成
+            engines->wait_slot();
+            engines->wait_labels(inputs, outputs);
+            record.start = Prim_recorder::time_ns();
+            engines->dma_begin();
+            p->taskCoreDefault(context);
+            engines->dma_end();
+
+            CompBase *comp = (CompBase *)p;
+            Engine_job *job = new Engine_job();
+            job->name = p->name;
+            job->dma_start = record.start;
+            job->dma_end = Prim_recorder::time_ns();
+            job->exu_ns = comp->last_exu_time;
+            job->sfu_ns = comp->last_sfu_time;
+            job->outputs = outputs;
+
+            record.cid = cid;
+            record.kind = "comp";
+            record.name = p->name;
+            record.dram_bytes = stats.dram_read_bytes->value +
+                                stats.dram_write_bytes->value -
+                                dram_bytes_before;
+            record.spill_bytes = stats.spill_bytes->value - spill_bytes_before;
+            record.loop_cnt = core_context->loop_cnt;
+            record.exu_ops = comp->last_exu_ops;
+            record.sfu_ops = comp->last_sfu_ops;
+            record.compute_time = comp->last_compute_time;
+            record.dram_time = comp->last_dram_time;
+            job->done = [this, record, sample_sig]() mutable {
+                record.end = Prim_recorder::time_ns();
+                STATS.core(cid).prims->inc();
+                if (sample_sig != "")
+                    PRIM_SAMPLER.record(cid, sample_sig,
+                                        record.end - record.start);
+                if (PRIM_RECORDER.enabled())
+                    PRIM_RECORDER.record(record);
+                cout << "Core " << cid << ": task " << record.name
+                     << " done.\n";
+            };
+            // 本原语计算结束之前（按引擎空闲估计）DMA空闲，预取后续原语的权重
+            u_int64_t compute_end = job->dma_start + job->exu_ns + job->sfu_ns;
+            engines->issue(job, inputs);
+
+            u_int64_t now = Prim_recorder::time_ns();
+            if (context.prefetcher && compute_end > now) {
+                engines->dma_begin();
+                context.prefetcher->run(context, prim_queue, compute_end - now);
+                engines->dma_end();
+            }
+
+            ev_block.notify(CYCLE, SC_NS);
+            wait();
+            continue;
+        }
+
+        // 其他计算原语以及采样快进的原语独占核，先等待引擎上的计算完成
+        if (core_engines && (p->prim_type & COMP_PRIM)) {
+            engines->drain();
+            record.start = Prim_recorder::time_ns();
+        }
+
+        // taskCoreDefault内部等待dram，返回之后剩余的时间为不能与dram重叠的计算
+        stats.busy->set(1);
+        stats.dram_wait->set(1);
+        if (replay) {
+            context.fast_forward = true;
+            p->taskCoreDefault(context);
+            stats.dram_wait->set(0);
+            stats.compute->set(1);
+            u_int64_t elapsed = Prim_recorder::time_ns() - record.start;
+            if (replay_ns > elapsed)
+                wait(sc_time(replay_ns - elapsed, SC_NS));
+            PRIM_SAMPLER.record_replay(cid, sample_sig);
+        } else {
+            delay = p->taskCoreDefault(context);
+            stats.dram_wait->set(0);
+            stats.compute->set(1);
+            // 计算期间DMA空闲，预取后续原语的权重
+            u_int64_t prefetch_ns = 0;
+            if (context.prefetcher && (p->prim_type & NPU_PRIM))
+                prefetch_ns =
+                    context.prefetcher->run(context, prim_queue, delay);
+            if ((u_int64_t)delay > prefetch_ns)
+                wait(sc_time(delay - prefetch_ns, SC_NS));
+            if (sample_sig != "")
+                PRIM_SAMPLER.record(cid, sample_sig,
+                                    Prim_recorder::time_ns() - record.start);
+        }
+        stats.compute->set(0);
+        stats.busy->set(0);
+        stats.prims->inc();
+
+        if (PRIM_RECORDER.enabled()) {
+            record.cid = cid;
+            record.kind = "comp";
+            record.name = p->name;
+            record.end = Prim_recorder::time_ns();
+            record.dram_bytes = stats.dram_read_bytes->value +
+                                stats.dram_write_bytes->value -
+                                dram_bytes_before;
+            record.spill_bytes = stats.spill_bytes->value - spill_bytes_before;
+            record.loop_cnt = core_context->loop_cnt;
+            if (p->prim_type & COMP_PRIM) {
+                CompBase *comp = (CompBase *)p;
+                record.exu_ops = comp->last_exu_ops;
+                record.sfu_ops = comp->last_sfu_ops;
+                record.compute_time = comp->last_compute_time;
+                record.dram_time = comp->last_dram_time;
+            }
+            PRIM_RECORDER.record(record);
+        }
 
         cout << "Core " << cid << ": task " << p->name << " done.\n";
 
@@ -0,0 +1,130 @@
+#include "workercore/prefetch_planner.h"
+#include "defs/global.h"
+#include "prims/base.h"
+#include "prims/norm_prims.h"
+#include "trace/Prim_recorder.h"
+#include "utils/system_utils.h"
+
+#include <set>
+
+Prefetch_planner::Prefetch_planner(int cid) : cid(cid) {
+    string prefix = "core" + to_string(cid) + ".prefetch.";
+    issued_bytes = STATS.counter(prefix + "issued_bytes");
+    hit_bytes = STATS.counter(prefix + "hit_bytes");
+    late_bytes = STATS.counter(prefix + "late_bytes");
+    late_ns = STATS.counter(prefix + "late_ns");
+    wasted_bytes = STATS.counter(prefix + "wasted_bytes");
+}
+
+int Prefetch_planner::headroom(SramPosLocator *locator) {
+    int used = 0;
+    // 部分spill的标签valid为false，但剩余部分仍占用sram，与addPair相同地统计
+    for (auto &pair : locator->data_map)
+        used += pair.second.size - pair.second.spill_size;
+    return locator->max_sram_size - used;
+}
+
+void Prefetch_planner::plan(deque<PrimBase *> &queue,
+                            vector<Prefetch_item> &items) {
+    SramPosLocator *locator = queue.front()->prim_context->sram_pos_locator_;
+
+    // 预取之后在使用之前已经不在sram中的数据
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (!locator->data_map.count(it->first)) {
+            wasted_bytes->inc(it->second);
+            it = pending.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    // 按照Set_addr得到每条后续原语的输出标签，与taskCoreDefault中相同地取前缀
+    string outdata = queue.front()->prim_context->datapass_label_->outdata;
+    int reserve = 0;
+    int found = 0;
+    set<string> planned;
+    for (int i = 1; i < queue.size() && found < prefetch_depth; i++) {
+        PrimBase *q = queue[i];
+        if (typeid(*q) == typeid(Set_addr)) {
+            outdata = ((Set_addr *)q)->datapass_label.outdata;
+            continue;
+        }
+        if (!(q->prim_type & NPU_PRIM))
+            continue;
+
+        NpuBase *npu = (NpuBase *)q;
+        found++;
+        reserve += CeilingDivision(npu->out_size, SRAM_BLOCK_SIZE) *
+                   SRAM_BLOCK_SIZE;
+
+        size_t pos = outdata.find_last_of('_');
+        string prefix =
+            pos != string::npos ? outdata.substr(0, pos) : outdata;
+
+        vector<Static_chunk> chunks;
+        npu->staticData(prefix, chunks);
+        for (auto &chunk : chunks) {
+            if (chunk.bytes <= 0 || locator->data_map.count(chunk.label) ||
+                planned.count(chunk.label))
+                continue;
+            planned.insert(chunk.label);
+            int bytes =
+                CeilingDivision(chunk.bytes, SRAM_BLOCK_SIZE) * SRAM_BLOCK_SIZE;
+            // 已经预取的数据块在headroom中扣除，这里只加上本数据块
+            items.push_back({npu, chunk.label, chunk.addr, chunk.bytes,
+                             reserve + bytes});
+        }
+    }
+}
+
+u_int64_t Prefetch_planner::run(TaskCoreContext &context,
+                                deque<PrimBase *> &queue,
+                                u_int64_t window_ns) {
+    if (prefetch_depth <= 0 || context.fast_forward || queue.empty())
+        return 0;
+
+    vector<Prefetch_item> items;
+    plan(queue, items);
+    if (items.empty())
+        return 0;
+
+    SramPosLocator *locator = queue.front()->prim_context->sram_pos_locator_;
+    u_int64_t start = Prim_recorder::time_ns();
+    u_int64_t deadline = start + window_ns;
+    for (auto &item : items) {
+        // DMA空闲的窗口已经用完，剩余的数据由原语自己读入
+        if (Prim_recorder::time_ns() >= deadline)
+            break;
+        if (item.reserve > headroom(locator))
+            break;
+
+        u_int64_t dram_time = 0;
+        item.prim->checkStaticData(context, dram_time, item.addr, item.bytes,
+                                   item.label, true);
+        pending[item.label] = item.bytes;
+        issued_bytes->inc(item.bytes);
+
+        u_int64_t now = Prim_recorder::time_ns();
+        if (now > deadline) {
+            late_bytes->inc(item.bytes);
+            late_ns->inc(now - deadline);
+        }
+    }
+
+    return Prim_recorder::time_ns() - start;
+}
+
+void Prefetch_planner::consume(const string &label, int flag) {
+    auto it = pending.find(label);
+    if (it == pending.end())
+        return;
+
+    if (flag == -1) {
+        wasted_bytes->inc(it->second);
+    } else {
+        int spilled = min(flag, it->second);
+        hit_bytes->inc(it->second - spilled);
+        wasted_bytes->inc(spilled);
+    }
+    pending.erase(it);
+}
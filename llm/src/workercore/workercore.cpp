@@ -68,6 +68,7 @@ WorkerCore::WorkerCore(const sc_module_name &n, int s_cid,
            dcache->dramSysWrapper->dramsys->getMemSpec().memorySizeBytes);
     g_dram_kvtable[cid] =
         new DramKVTable(executor->MaxDramAddr, (uint64_t)50 * 1024 * 1024, 20);
+    g_core_executor[cid] = executor;
 #if USE_NB_DRAMSYS == 1
     executor->nb_dcache_socket->socket.bind(dcache->socket);
 #else
@@ -151,6 +152,16 @@ WorkerCoreExecutor::WorkerCoreExecutor(const sc_module_name &n, int s_cid,
     start_nb_gpu_dram_event = new sc_event();
     start_sram_event = new sc_event();
     end_sram_event = new sc_event();
+    sram_bank = new SramBankModel("core" + to_string(cid) + ".sram",
+                                  SIMU_READ_PORT, SIMU_WRITE_PORT);
+    temp_sram_bank = new SramBankModel("core" + to_string(cid) + ".temp_sram",
+                                       SIMU_READ_PORT, SIMU_WRITE_PORT);
+    engines = new Core_engines(sc_gen_unique_name("engines"), cid);
+    prefetcher = new Prefetch_planner(cid);
+    core_context->sram_pos_locator_->reuse_distance =
+        [this](unordered_map<string, int> &next_use) {
+            return reuse_distance(next_use);
+        };
 
     end_nb_dram_event = new sc_event();
     end_nb_gpu_dram_event = new sc_event();
@@ -211,6 +222,11 @@ void WorkerCoreExecutor::worker_core_execute() {
         // switch_prim_block 收到 ev_block 触发 ev_block 在 send_logic 和
         // recv_logic 中触发
 
+        // 通信原语需要等待核内引擎上的计算全部完成
+        if (core_engines && (typeid(*p) == typeid(Send_prim) ||
+                             typeid(*p) == typeid(Recv_prim)))
+            engines->drain();
+
         if (typeid(*p) == typeid(Send_prim)) {
             // 触发 send_logic
 #if SR_PARA == 0
@@ -318,6 +334,47 @@ void WorkerCoreExecutor::switch_prim_block() {
     }
 }
 
+// 当前原语的标签距离为0。prim_queue在循环执行时首尾相接，
+// 因此遍历一遍即覆盖一次迭代，未出现的标签按队列长度计
+int WorkerCoreExecutor::reuse_distance(unordered_map<string, int> &next_use) {
+    AddrDatapassLabel label = *core_context->datapass_label_;
+    int distance = 0;
+
+    auto use = [&](string name) {
+        if (name == UNSET_LABEL)
+            return;
+        if (name[0] == '_')
+            name = name.substr(1);
+        next_use.emplace(name, distance);
+    };
+
+    for (int i = 0; i < prim_queue.size(); i++) {
+        PrimBase *p = prim_queue[i];
+        if (typeid(*p) == typeid(Set_addr)) {
+            label = ((Set_addr *)p)->datapass_label;
+            continue;
+        }
+        if (!(p->prim_type & COMP_PRIM))
+            continue;
+
+        for (int j = 0; j < MAX_SPLIT_NUM; j++)
+            use(label.indata[j]);
+
+        if (p->prim_type & NPU_PRIM) {
+            size_t pos = label.outdata.find_last_of('_');
+            string prefix = pos != string::npos ? label.outdata.substr(0, pos)
+                                                : label.outdata;
+            vector<Static_chunk> chunks;
+            ((NpuBase *)p)->staticData(prefix, chunks);
+            for (auto &chunk : chunks)
+                use(chunk.label);
+        }
+        distance++;
+    }
+
+    return prim_queue.size();
+}
+
 // 指令被 RECV_CONF发送过来后，会在本地核实例化对应的指令类
 PrimBase *WorkerCoreExecutor::parse_prim(vector<sc_bv<128>> segments) {
     int type = segments[0].range(7, 0).to_uint64();
@@ -363,6 +420,11 @@ void WorkerCoreExecutor::poll_buffer_i() {
     }
 }
 
+void WorkerCoreExecutor::preload_msg(const Msg &m) {
+    msg_buffer_[m.msg_type_].push(m);
+    ev_recv_msg_type_[m.msg_type_].notify(0, SC_NS);
+}
+
 /*
  在workercore executor中添加了一把锁，用于lock住write helper，
  因为同时运行send和recv原语会在同一个时钟周期内access write helper函数
@@ -526,6 +588,10 @@ WorkerCoreExecutor::~WorkerCoreExecutor() {
     delete end_nb_dram_event;
     delete start_sram_event;
     delete end_sram_event;
+    delete sram_bank;
+    delete temp_sram_bank;
+    delete engines;
+    delete prefetcher;
     delete start_global_mem_event;
     delete end_global_mem_event;
     delete sram_writer;
@@ -0,0 +1,109 @@
+#include "defs/global.h"
+#include "hardware/compute_cost.h"
+#include "monitor/config_helper_core.h"
+#include "monitor/perf_estimator.h"
+#include "systemc.h"
+#include "utils/datatype_utils.h"
+#include "utils/router_utils.h"
+#include "utils/simple_flags.h"
+#include "utils/system_utils.h"
+#include <ctime>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// 一阶性能估计：与npusim使用相同的config与原语类，但不启动SystemC仿真（不调用sc_start），
+// 用于在长时间仿真之前快速检查config并筛选设计点
+Define_bool_opt("--help", g_flag_help, false, "show these help information");
+Define_string_opt("--config-file", g_flag_config_file,
+                  "../llm/test/chores/dataflow_tp.json", "config file");
+Define_string_opt("--core-config-file", g_flag_core_config_file,
+                  "../llm/test/core_configs/core_4x4.json", "core config file");
+Define_string_opt("--ttf-file", g_flag_ttf, "../font/NotoSansDisplay-Bold.ttf",
+                  "font ttf file");
+Define_int64_opt("--sram-max", g_flag_max_sram, 8388608, "Max SRAM size");
+Define_int64_opt("--df_dram_bw", g_dram_bw, 8, "Dataflow per core bandwidth");
+Define_float_opt("--beha_dram_util", g_beha_dram_util, 0.7,
+                 "dram bandwidth utilization in beha dram");
+Define_string_opt("--dataflow", g_flag_dataflow, "ws",
+                  "systolic dataflow used for matmul timing: ws/os/is/ideal");
+Define_string_opt("--comp-calib", g_flag_comp_calib, "",
+                  "csv table of measured compute cycles used to calibrate "
+                  "the compute cost model");
+Define_bool_opt("--noc-multicast", g_flag_noc_multicast, false,
+                "send the same data cast to several cores as one multicast "
+                "packet replicated along the XY routing tree");
+Define_string_opt("--host-ports", g_flag_host_ports, "west",
+                  "host attachment routers: west/west_east/edges or a comma "
+                  "separated list of router ids, each core uses the nearest");
+Define_bool_opt("--headless", g_flag_headless, HEADLESS_BUILD,
+                "skip dataflow plotting, the dataflow can be drawn afterwards "
+                "with npu_render");
+Define_int64_opt("--chip-id", g_flag_chip_id, 0, "chip to estimate");
+Define_string_opt("--estimate-prefix", g_flag_estimate_prefix, "estimate",
+                  "write <prefix>_cores.csv and <prefix>_prims.csv");
+Define_int64_opt("--estimate-top", g_flag_estimate_top, 10,
+                 "number of most expensive prims to print");
+Define_string_opt("--dump-datatypes", g_flag_dump_datatypes, "",
+                  "write the datatype table as json to this file and exit");
+
+int sc_main(int argc, char *argv[]) {
+    clock_t start = clock();
+    std::cout.setf(std::ios::unitbuf);
+
+    simple_flags::parse_args(argc, argv);
+    if (!simple_flags::get_unknown_flags().empty()) {
+        string content;
+        for (auto it : simple_flags::get_unknown_flags()) {
+            content += "'" + it + "', ";
+        }
+        content.resize(content.size() - 2); // remove last ', '
+        content.append(".");
+        cout << "unknown option(s): " << content.c_str() << endl;
+        return -1;
+    }
+
+    if (g_flag_help) {
+        simple_flags::print_args_info();
+        return 0;
+    }
+
+    if (g_flag_dump_datatypes != "")
+        return DumpDatatypes(g_flag_dump_datatypes) ? 0 : -1;
+
+    use_node = false;
+    use_DramSys = false;
+    beha_dram = true;
+    beha_dram_util = g_beha_dram_util;
+    noc_multicast = g_flag_noc_multicast;
+    g_headless = g_flag_headless;
+    MAX_SRAM_SIZE = g_flag_max_sram;
+    g_default_dram_bw = g_dram_bw;
+    COMP_COST.set_dataflow(ParseDataflow(g_flag_dataflow));
+    if (g_flag_comp_calib != "" &&
+        !COMP_COST.load_calibration(g_flag_comp_calib))
+        return -1;
+
+    g_config_file = g_flag_config_file;
+    InitGrid(g_flag_config_file.c_str(), g_flag_core_config_file.c_str());
+    InitGlobalMembers();
+    if (!InitHostPorts(g_flag_host_ports)) {
+        cout << "[ERROR] Invalid --host-ports " << g_flag_host_ports << ".\n";
+        return -1;
+    }
+
+    if (SYSTEM_MODE != SIM_DATAFLOW) {
+        cout << "[ERROR] The estimator only supports dataflow configs.\n";
+        return -1;
+    }
+
+    config_helper_core config(g_flag_config_file, g_flag_ttf, g_flag_chip_id);
+    Perf_estimator estimator(&config);
+    bool ok = estimator.run();
+    estimator.report(g_flag_estimate_prefix, g_flag_estimate_top);
+
+    clock_t end = clock();
+    cout << "花费了" << (double)(end - start) / CLOCKS_PER_SEC << "秒" << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include "defs/global.h"
+#include "systemc.h"
+#include "utils/display_utils.h"
+#include "utils/simple_flags.h"
+#include "utils/system_utils.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// 事后绘图：npusim以--headless运行时不绘制任何图像，之后用本程序从保存的结果中绘制。
+// 不指定--stats-file时绘制数据流图（--dataflow为运行时保存的core_data_flow.json，包含放置优化的结果），
+// 否则从stats_summary.csv中取出每个核（或router）的统计量绘制热力图；
+// 指定--heatmap-stream时把热力图数据流的每个窗口绘制为一帧
+Define_bool_opt("--help", g_flag_help, false, "show these help information");
+Define_string_opt("--config-file", g_flag_config_file,
+                  "../llm/test/chores/dataflow_tp.json", "config file");
+Define_string_opt("--core-config-file", g_flag_core_config_file,
+                  "../llm/test/core_configs/core_4x4.json", "core config file");
+Define_string_opt("--ttf-file", g_flag_ttf, "../font/NotoSansDisplay-Bold.ttf",
+                  "font ttf file");
+Define_string_opt("--dataflow", g_flag_dataflow, "",
+                  "core_data_flow.json saved by a run, empty to draw the "
+                  "dataflow of --config-file");
+Define_string_opt("--stats-file", g_flag_stats_file, "",
+                  "stats_summary.csv of a run, draws a heat map of --stat");
+Define_string_opt("--stat", g_flag_stat, "core.busy",
+                  "per core statistic to draw, e.g. core.busy, "
+                  "core.dram_read_bytes, router.flits");
+Define_string_opt("--stat-column", g_flag_stat_column, "mean",
+                  "column of stats_summary.csv: value/mean/min/max");
+Define_string_opt("--output", g_flag_output, "",
+                  "output png, defaults to <stat>.png for heat maps");
+Define_string_opt("--heatmap-stream", g_flag_heatmap_stream, "",
+                  "heatmap_stream.jsonl of a run (--heatmap-window), draws "
+                  "one png per window into --frames-dir");
+Define_string_opt("--frame-state", g_flag_frame_state, "compute",
+                  "state drawn in the heat map frames: compute/dram/noc");
+Define_string_opt("--frames-dir", g_flag_frames_dir, "heatmap_frames",
+                  "output directory of the heat map frames");
+
+int sc_main(int argc, char *argv[]) {
+    simple_flags::parse_args(argc, argv);
+    if (!simple_flags::get_unknown_flags().empty()) {
+        string content;
+        for (auto it : simple_flags::get_unknown_flags()) {
+            content += "'" + it + "', ";
+        }
+        content.resize(content.size() - 2); // remove last ', '
+        content.append(".");
+        cout << "unknown option(s): " << content.c_str() << endl;
+        return -1;
+    }
+
+    if (g_flag_help) {
+        simple_flags::print_args_info();
+        return 0;
+    }
+
+    InitGrid(g_flag_config_file.c_str(), g_flag_core_config_file.c_str());
+
+    if (g_flag_heatmap_stream != "") {
+        vector<string> states = {"compute", "dram", "noc"};
+        int state = find(states.begin(), states.end(), g_flag_frame_state) -
+                    states.begin();
+        if (state >= states.size()) {
+            cout << "[ERROR] Invalid --frame-state " << g_flag_frame_state
+                 << ".\n";
+            return -1;
+        }
+
+        ifstream stream(g_flag_heatmap_stream);
+        if (!stream.is_open()) {
+            cout << "[ERROR] Cannot open heat map stream "
+                 << g_flag_heatmap_stream << endl;
+            return -1;
+        }
+        std::filesystem::create_directories(g_flag_frames_dir);
+
+        // 第一行为网格信息，之后每行一个窗口
+        string line;
+        getline(stream, line);
+        if (json::parse(line)["grid_size"] != GRID_SIZE) {
+            cout << "[ERROR] Heat map stream does not match the core config "
+                    "grid.\n";
+            return -1;
+        }
+
+        int frame = 0;
+        while (getline(stream, line)) {
+            json j = json::parse(line);
+            map<int, double> values;
+            for (int i = 0; i < j["cores"].size(); i++)
+                values[i] = j["cores"][i][state];
+
+            char name[32];
+            snprintf(name, sizeof(name), "/frame_%05d.png", frame++);
+            plot_heatmap(values,
+                         g_flag_frame_state + " @ " +
+                             to_string(j["t"].get<u_int64_t>()) + " ns",
+                         g_flag_frames_dir + name, 1.0);
+        }
+        return 0;
+    }
+
+    if (g_flag_stats_file == "") {
+        if (g_flag_dataflow == "") {
+            plot_dataflow(g_flag_config_file, g_flag_ttf);
+            return 0;
+        }
+
+        unordered_map<int, Display::Core> cores;
+        set<int> source_ids;
+        if (!load_dataflow(g_flag_dataflow, cores, source_ids))
+            return -1;
+        plot_dataflow(cores, source_ids, g_flag_ttf);
+        return 0;
+    }
+
+    // --stat形如 core.busy，对应统计量 core<id>.busy
+    size_t dot = g_flag_stat.find('.');
+    if (dot == string::npos) {
+        cout << "[ERROR] --stat should look like core.busy.\n";
+        return -1;
+    }
+    regex pattern("^" + g_flag_stat.substr(0, dot) + "(\\d+)\\." +
+                  g_flag_stat.substr(dot + 1) + "$");
+
+    ifstream file(g_flag_stats_file);
+    if (!file.is_open()) {
+        cout << "[ERROR] Cannot open stats file " << g_flag_stats_file << endl;
+        return -1;
+    }
+
+    // 列：name,type,value,mean,min,max
+    vector<string> columns = {"name", "type", "value", "mean", "min", "max"};
+    int column = find(columns.begin(), columns.end(), g_flag_stat_column) -
+                 columns.begin();
+    if (column < 2 || column >= columns.size()) {
+        cout << "[ERROR] Invalid --stat-column " << g_flag_stat_column << ".\n";
+        return -1;
+    }
+
+    map<int, double> values;
+    string line;
+    getline(file, line);
+    while (getline(file, line)) {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, ','))
+            fields.push_back(field);
+
+        smatch m;
+        if (fields.size() <= column || fields[column] == "" ||
+            !regex_match(fields[0], m, pattern))
+            continue;
+        int id = stoi(m[1]);
+        if (id < GRID_SIZE)
+            values[id] = stod(fields[column]);
+    }
+
+    if (values.empty()) {
+        cout << "[ERROR] No statistic matches " << g_flag_stat << " in "
+             << g_flag_stats_file << ".\n";
+        return -1;
+    }
+
+    string output =
+        g_flag_output != "" ? g_flag_output : g_flag_stat + ".png";
+    plot_heatmap(values, g_flag_stat + " (" + g_flag_stat_column + ")",
+                 output);
+    return 0;
+}
@@ -1,9 +1,23 @@
 #include "assert.h"
 #include "defs/global.h"
+#include "hardware/compute_cost.h"
+#include "link/chip_link.h"
+#include "link/global_mem_interface.h"
+#include "link/partition_sim.h"
+#include "monitor/config_helper_pds.h"
+#include "memory/dramsys_config.h"
+#include "memory/sram/sram_bank_model.h"
+#include "memory/sram/spill_policy.h"
 #include "monitor/monitor.h"
 #include "systemc.h"
 #include "trace/Event_engine.h"
+#include "trace/Heatmap_sampler.h"
+#include "trace/Prim_recorder.h"
+#include "trace/Prim_sampler.h"
+#include "trace/Stats_registry.h"
+#include "utils/checkpoint_utils.h"
 #include "utils/print_utils.h"
+#include "utils/router_utils.h"
 #include "utils/simple_flags.h"
 #include "utils/system_utils.h"
 #include <ctime>
@@ -15,7 +29,6 @@
 #include <nlohmann/json.hpp> 
 #include <string>
 
-#include <SFML/Graphics.hpp>
 using namespace std;
 
 #define CHECK_C cout << total_cycle << endl;
@@ -37,7 +50,7 @@ Define_int64_opt("--trace-window", g_flag_trace_window, 2, "Trace window size");
 Define_int64_opt("--sram-max", g_flag_max_sram, 8388608,
                  "Max SRAM size"); // 3145728
 Define_bool_opt("--gpu_cachelog", g_gpu_clog, false,
-                    "whether log gpu cache"); // 3145728
+                    "whether count gpu cache hit/miss in stats"); // 3145728
 Define_int64_opt("--gpu_dram_bw", g_gpu_bw, 512,
                         "GPU bandwidth"); // 3145728
 Define_int64_opt("--df_dram_bw", g_dram_bw, 8,
@@ -61,6 +74,84 @@ Define_int64_opt("--gpu_B", g_gpu_B, 1,
 
 Define_int64_opt("--verbose-level", g_verbose_level, 1,
                  "verbose-level"); // 3145728
+Define_int64_opt("--stats-interval", g_flag_stats_interval, 0,
+                 "sample statistics every N ns of simulated time, 0 to disable");
+Define_string_opt("--stats-file", g_flag_stats_file, "stats.csv",
+                  "output file of the periodic statistics samples");
+Define_int64_opt("--heatmap-window", g_flag_heatmap_window, 0,
+                 "write per-core state and per-link flit heat map frames "
+                 "every N ns of simulated time, 0 to disable");
+Define_string_opt("--heatmap-file", g_flag_heatmap_file,
+                  "heatmap_stream.jsonl",
+                  "output file of the heat map frames, played by "
+                  "streaming_trace_viewer");
+Define_string_opt("--prim-records", g_flag_prim_records, "",
+                  "write one record per executed prim to this csv file, "
+                  "see scripts/prim_analyzer.py");
+Define_string_opt("--checkpoint-file", g_flag_checkpoint_file, "",
+                  "write a checkpoint to this file (pds mode only)");
+Define_int64_opt("--checkpoint-iter", g_flag_checkpoint_iter, 0,
+                 "write the checkpoint at the first idle boundary after this "
+                 "many iterations");
+Define_bool_opt("--dump-derived-configs", g_flag_dump_derived_configs, false,
+                "dump the derived DRAMSys memspec/addressmapping into "
+                "./derived_configs for debugging");
+Define_string_opt("--restore-file", g_flag_restore_file, "",
+                  "resume simulation from this checkpoint (pds mode only)");
+Define_string_opt("--dataflow", g_flag_dataflow, "ws",
+                  "systolic dataflow used for matmul timing: ws/os/is/ideal");
+Define_string_opt("--comp-calib", g_flag_comp_calib, "",
+                  "csv table of measured compute cycles used to calibrate "
+                  "the compute cost model");
+Define_bool_opt("--parallel-chips", g_flag_parallel_chips, false,
+                "advance the chips of a multi-chip config (one process "
+                "each, synchronized at windows of one link latency) at the "
+                "same time instead of one after another");
+Define_int64_opt("--parallel-jobs", g_flag_parallel_jobs, 0,
+                 "with --parallel-chips, number of chip partitions advancing "
+                 "at the same time, 0 for all");
+Define_int64_opt("--sample-warmup", g_flag_sample_warmup, 0,
+                 "simulate the first N occurrences of each comp prim signature "
+                 "per core in detail and fast-forward the rest, 0 to disable");
+Define_int64_opt("--sample-revalidate", g_flag_sample_revalidate, 16,
+                 "re-simulate a fast-forwarded prim in detail after this many "
+                 "replays to estimate the sampling error, 0 to never");
+Define_string_opt("--sample-report", g_flag_sample_report, "sample_report.csv",
+                  "output file of the per-signature sampling statistics");
+Define_bool_opt("--noc-multicast", g_flag_noc_multicast, false,
+                "send the same data cast to several cores as one multicast "
+                "packet replicated along the XY routing tree");
+Define_string_opt("--noc-routing", g_flag_noc_routing, "xy",
+                  "NoC routing algorithm: xy/west_first/odd_even/o1turn");
+Define_int64_opt("--noc-vcs", g_flag_noc_vcs, 1,
+                 "virtual channels per router port (o1turn needs at least 2)");
+Define_string_opt("--host-ports", g_flag_host_ports, "west",
+                  "host attachment routers: west/west_east/edges or a comma "
+                  "separated list of router ids, each core uses the nearest");
+Define_bool_opt("--host-preload", g_flag_host_preload, false,
+                "write CONFIG packets directly into the cores without "
+                "occupying the host ports and the NoC");
+Define_string_opt("--sram-model", g_flag_sram_model, "row",
+                  "behavioral sram timing: row charges a fixed latency per "
+                  "row, bank models bank conflicts and port contention");
+Define_string_opt("--spill-policy", g_flag_spill_policy, "lru",
+                  "sram spill victim selection: lru, belady (farthest next "
+                  "use in the prim queue) or cost (reload time over reuse "
+                  "distance)");
+Define_bool_opt("--spill-partial", g_flag_spill_partial, false,
+                "spill only the bytes needed to fit new data instead of the "
+                "whole victim label");
+Define_bool_opt("--core-engines", g_flag_core_engines, false,
+                "run the DMA, EXU and SFU of a core as separate engines so "
+                "the next prim loads while the current one computes");
+Define_int64_opt("--engine-window", g_flag_engine_window, 2,
+                 "max NPU prims in flight on the EXU/SFU engines of a core");
+Define_int64_opt("--prefetch-depth", g_flag_prefetch_depth, 0,
+                 "number of upcoming NPU prims whose weights are prefetched "
+                 "into sram while the current prim computes, 0 disables");
+Define_bool_opt("--headless", g_flag_headless, HEADLESS_BUILD,
+                "skip dataflow plotting and the VCD trace file, the dataflow "
+                "can be drawn afterwards with npu_render");
 // ----------------------------------------------------------------------------
 // all the individual layers' forward and backward passes
 // B = batch_size, T = sequence_length, C = channels, V = vocab_size
@@ -88,313 +179,6 @@ void delete_core_log_files() {
 }
 
 
-/**
- * 修改JSON文件中的nbrOfDevices值
- * @param inputPath 原JSON文件路径
- * @param outputPath 新JSON文件路径
- * @param x 要设置的nbrOfDevices值
- * @return 成功返回true，失败返回false
- */
-bool modifyNbrOfDevices(const std::string& inputPath, const std::string& outputPath, int x) {
-    // 读取原始 JSON 文件
-    std::ifstream infile(inputPath);
-    if (!infile.is_open()) {
-        std::cerr << "无法打开输入文件: " << inputPath << std::endl;
-        return false;
-    }
-
-    json j;
-    try {
-        infile >> j;
-    } catch (json::parse_error& e) {
-        std::cerr << "JSON 解析错误: " << e.what() << std::endl;
-        return false;
-    }
-    infile.close();
-
-    // 修改 nbrOfDevices 的值
-    j["memspec"]["memarchitecturespec"]["nbrOfDevices"] = x;
-
-    // 写入新文件
-    std::ofstream outfile(outputPath);
-    if (!outfile.is_open()) {
-        std::cerr << "无法创建输出文件: " << outputPath << std::endl;
-        return false;
-    }
-
-    try {
-        outfile << j.dump(4); // 格式化输出，缩进4个空格
-    } catch (const std::exception& e) {
-        std::cerr << "写入文件时发生错误: " << e.what() << std::endl;
-        return false;
-    }
-    
-    outfile.close();
-    return true;
-}
-
-
-
-void generateAddressMapping(int n, const std::string& outputFilename) {
-    // ROW_BIT 占 15 位，从 n+12 开始，最高位是 n+26，必须 <= 34
-    json addressmapping;
-
-    int byte_start = 0;
-    int column_start = n;
-    int bank_start = n + 22;
-    int bankgroup_start = n + 24;
-    int pseudo_start = n + 26;
-    int row_start = n + 7;
-
-    // BYTE_BIT
-    std::vector<int> byte_bits;
-    for (int i = 0; i < n; ++i) byte_bits.push_back(i);
-    addressmapping["BYTE_BIT"] = byte_bits;
-
-    // COLUMN_BIT (7 bits)
-    std::vector<int> column_bits;
-    for (int i = 0; i < 7; ++i) column_bits.push_back(column_start + i);
-    addressmapping["COLUMN_BIT"] = column_bits;
-
-    // BANK_BIT (2 bits)
-    std::vector<int> bank_bits = {bank_start, bank_start + 1};
-    addressmapping["BANK_BIT"] = bank_bits;
-
-    // BANKGROUP_BIT (2 bits)
-    std::vector<int> bankgroup_bits = {bankgroup_start, bankgroup_start + 1};
-    addressmapping["BANKGROUP_BIT"] = bankgroup_bits;
-
-    // PSEUDOCHANNEL_BIT (1 bit)
-    addressmapping["PSEUDOCHANNEL_BIT"] = std::vector<int>{pseudo_start};
-
-    // ROW_BIT (15 bits)
-    std::vector<int> row_bits;
-    for (int i = 0; i < 15; ++i) {
-        int bit = row_start + i;
-        row_bits.push_back(bit);
-    }
-    addressmapping["ROW_BIT"] = row_bits;
-
-    // 写入文件
-    json root;
-    root["addressmapping"] = addressmapping;
-
-    std::ofstream outFile(outputFilename);
-    if (!outFile.is_open()) {
-        std::cerr << "Error: Cannot write to file " << outputFilename << std::endl;
-        return;
-    }
-    outFile << std::setw(4) << root << std::endl;
-    outFile.close();
-
-    std::cout << "Address mapping with n=" << n << " saved to " << outputFilename << std::endl;
-}
-
-
-void generateDFAddressMapping(int n, const std::string& outputFilename) {
-    // ROW_BIT 占 15 位，从 n+12 开始，最高位是 n+26，必须 <= 34
-    json addressmapping;
-
-    int byte_start = 0;
-    int column_start = n;
-    int bank_start = n + 27;
-    int bankgroup_start = n + 25;
-    int row_start = n + 10;
-
-    // BYTE_BIT
-    std::vector<int> byte_bits;
-    for (int i = 0; i < n; ++i) byte_bits.push_back(i);
-    addressmapping["BYTE_BIT"] = byte_bits;
-
-    // COLUMN_BIT (10 bits)
-    std::vector<int> column_bits;
-    for (int i = 0; i < 10; ++i) column_bits.push_back(column_start + i);
-    addressmapping["COLUMN_BIT"] = column_bits;
-
-    // BANK_BIT (2 bits)
-    std::vector<int> bank_bits = {bank_start, bank_start + 1};
-    addressmapping["BANK_BIT"] = bank_bits;
-
-    // BANKGROUP_BIT (2 bits)
-    std::vector<int> bankgroup_bits = {bankgroup_start, bankgroup_start + 1};
-    addressmapping["BANKGROUP_BIT"] = bankgroup_bits;
-
-    // ROW_BIT (15 bits)
-    std::vector<int> row_bits;
-    for (int i = 0; i < 15; ++i) {
-        int bit = row_start + i;
-        row_bits.push_back(bit);
-    }
-    addressmapping["ROW_BIT"] = row_bits;
-
-    // 写入文件
-    json root;
-    root["addressmapping"] = addressmapping;
-
-    std::ofstream outFile(outputFilename);
-    if (!outFile.is_open()) {
-        std::cerr << "Error: Cannot write to file " << outputFilename << std::endl;
-        return;
-    }
-    outFile << std::setw(4) << root << std::endl;
-    outFile.close();
-
-    std::cout << "Address mapping with n=" << n << " saved to " << outputFilename << std::endl;
-}
-
-
-/**
- * @brief 根据给定的 nbrOfDevices 值生成一个 JSON 文件。
- *
- * @param A 要写入 nbrOfDevices 字段的整数值。
- * @param filename 要生成的 JSON 文件的名称（可选，默认为 "output.json"）。
- * @return bool 如果文件成功生成则返回 true，否则返回 false。
- */
-bool generateGPUCacheJsonFile(int numDevices, const std::string& filename = "output.json") {
-    try {
-        // 1. 创建 JSON 对象结构并填充初始数据
-        json j = {
-            {"memspec", {
-                {"memarchitecturespec", {
-                    {"burstLength", 4},
-                    {"dataRate", 2},
-                    {"nbrOfBankGroups", 4},
-                    {"nbrOfBanks", 16},
-                    {"nbrOfColumns", 128},
-                    {"nbrOfPseudoChannels", 2},
-                    {"nbrOfRows", 32768},
-                    {"width", 64},
-                    // 注意：这里初始化为 32，但会被参数 A 覆盖
-                    {"nbrOfDevices", 32}, 
-                    {"nbrOfChannels", 1}
-                    
-                }},
-                {"memoryId", "https://www.computerbase.de/2019-05/amd-memory-tweak-vram-oc/#bilder"},
-                {"memoryType", "HBM2"},
-                {"memtimingspec", {
-                    {"CCDL", 3},
-                    {"CCDS", 2},
-                    {"CKE", 8},
-                    {"DQSCK", 1},
-                    {"FAW", 16},
-                    {"PL", 0},
-                    {"RAS", 28},
-                    {"RC", 42},
-                    {"RCDRD", 12},
-                    {"RCDWR", 6},
-                    {"REFI", 3900},
-                    {"REFISB", 244},
-                    {"RFC", 220},
-                    {"RFCSB", 96},
-                    {"RL", 17},
-                    {"RP", 14},
-                    {"RRDL", 6},
-                    {"RRDS", 4},
-                    {"RREFD", 8},
-                    {"RTP", 5},
-                    {"RTW", 18},
-                    {"WL", 7},
-                    {"WR", 14},
-                    {"WTRL", 9},
-                    {"WTRS", 4},
-                    {"XP", 8},
-                    {"XS", 216},
-                    {"tCK", 1000}
-                }}
-            }}
-        };
-
-        // 2. 使用传入的参数 A 替换 nbrOfDevices 的值
-        j["memspec"]["memarchitecturespec"]["nbrOfDevices"] = numDevices;
-
-        // 3. 打开文件流用于写入
-        std::ofstream outFile(filename);
-        if (!outFile.is_open()) {
-            std::cerr << "错误：无法打开文件 " << filename << " 进行写入。" << std::endl;
-            return false;
-        }
-
-        // 4. 将 JSON 对象序列化为格式化的字符串并写入文件
-        // setw(4) 用于美化输出，使其具有缩进
-        outFile << j.dump(4); 
-        outFile.close();
-
-        std::cout << "JSON 文件已成功生成: " << filename << std::endl;
-        return true;
-
-    } catch (const std::exception& e) {
-        std::cerr << "生成 JSON 文件时发生异常: " << e.what() << std::endl;
-        return false;
-    }
-}
-
-void remove_all_l1cache_log_files() {
-    try {
-        // Define the log directory path
-        std::filesystem::path log_dir("gpu_cache");
-        
-        // Check if directory exists
-        if (!std::filesystem::exists(log_dir)) {
-            std::filesystem::create_directory(log_dir);
-            // If directory doesn't exist, nothing to remove
-            return;
-        }
-        
-        // Define the regex pattern to match sram_manager_cid_*.log files
-        std::regex log_pattern("L1Cache_cid_\\d+\\.log");
-        
-        // Iterate through all files in the sram_util directory
-        for (const auto& entry : std::filesystem::directory_iterator(log_dir)) {
-            // Check if entry is a regular file
-            if (entry.is_regular_file()) {
-                // Get the filename as a string
-                std::string filename = entry.path().filename().string();
-                
-                // Check if filename matches our pattern
-                if (std::regex_match(filename, log_pattern)) {
-                    // Remove the file
-                    std::filesystem::remove(entry.path());
-                }
-            }
-        }
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "Warning: Could not remove log files from sram_util folder. Reason: " << e.what() << std::endl;
-    }
-}
-
-void remove_all_sram_log_files() {
-    try {
-        // Define the log directory path
-        std::filesystem::path log_dir("sram_util");
-        
-        // Check if directory exists
-        if (!std::filesystem::exists(log_dir)) {
-            std::filesystem::create_directory(log_dir);
-            // If directory doesn't exist, nothing to remove
-            return;
-        }
-        
-        // Define the regex pattern to match sram_manager_cid_*.log files
-        std::regex log_pattern("sram_manager_cid_\\d+\\.log");
-        
-        // Iterate through all files in the sram_util directory
-        for (const auto& entry : std::filesystem::directory_iterator(log_dir)) {
-            // Check if entry is a regular file
-            if (entry.is_regular_file()) {
-                // Get the filename as a string
-                std::string filename = entry.path().filename().string();
-                
-                // Check if filename matches our pattern
-                if (std::regex_match(filename, log_pattern)) {
-                    // Remove the file
-                    std::filesystem::remove(entry.path());
-                }
-            }
-        }
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "Warning: Could not remove log files from sram_util folder. Reason: " << e.what() << std::endl;
-    }
-}
 int sc_main(int argc, char *argv[]) {
     clock_t start = clock();
 
@@ -434,6 +218,10 @@ int sc_main(int argc, char *argv[]) {
     
 
     comp_util = g_flag_comp_util;
+    COMP_COST.set_dataflow(ParseDataflow(g_flag_dataflow));
+    if (g_flag_comp_calib != "" &&
+        !COMP_COST.load_calibration(g_flag_comp_calib))
+        return -1;
     MAX_SRAM_SIZE = g_flag_max_sram;
     verbose_level = g_verbose_level;
     dram_aligned = g_dram_aligned;
@@ -448,42 +236,172 @@ int sc_main(int argc, char *argv[]) {
     use_gpu = g_use_gpu;
     beha_dram_util = g_beha_dram_util;
     beha_dram = g_beha_dram;
+    noc_multicast = g_flag_noc_multicast;
+    noc_routing = ParseRouting(g_flag_noc_routing);
+    noc_vcs = g_flag_noc_vcs;
+    host_preload = g_flag_host_preload;
+    g_headless = g_flag_headless;
+    g_sram_model = ParseSramModel(g_flag_sram_model);
+    g_spill_policy = ParseSpillPolicy(g_flag_spill_policy);
+    spill_partial = g_flag_spill_partial;
+    core_engines = g_flag_core_engines;
+    engine_window = g_flag_engine_window;
+    if (engine_window < 1) {
+        cout << "[ERROR] Invalid --engine-window " << engine_window
+             << ", use at least 1.\n";
+        return -1;
+    }
+    prefetch_depth = g_flag_prefetch_depth;
+    if (prefetch_depth < 0) {
+        cout << "[ERROR] Invalid --prefetch-depth " << prefetch_depth
+             << ", use 0 or more.\n";
+        return -1;
+    }
+    if (noc_vcs < 1 || noc_vcs > NOC_MAX_VCS ||
+        (noc_routing == ROUTE_O1TURN && noc_vcs < 2)) {
+        cout << "[ERROR] Invalid --noc-vcs " << noc_vcs << " for routing "
+             << GetRoutingName(noc_routing) << ", use 1~" << NOC_MAX_VCS
+             << " (o1turn needs at least 2).\n";
+        return -1;
+    }
     gpu_B = g_gpu_B;
+    g_checkpoint_file = g_flag_checkpoint_file;
+    g_checkpoint_iter = g_flag_checkpoint_iter;
+    if (!PRIM_SAMPLER.enable(g_flag_sample_warmup, g_flag_sample_revalidate))
+        return -1;
 
-    modifyNbrOfDevices("../DRAMSys/configs/memspec/JEDEC_4Gb_DDR4-1866_8bit_A.json", "../DRAMSys/configs/memspec/JEDEC_4Gb_DDR4-1866_8bit_DF.json", g_default_dram_bw);
-    int bytecount_df = static_cast<int>(log2(g_dram_bw));
-    generateDFAddressMapping(bytecount_df, "../DRAMSys/configs/addressmapping/am_ddr4_8x4Gbx8_df.json");
+    // 由带宽参数推导出的DRAMSys配置只保存在内存中，不再改写 DRAMSys/configs
+    InitDerivedDramConfigs("../DRAMSys/configs", g_default_dram_bw, g_gpu_bw);
+    if (g_flag_dump_derived_configs)
+        DumpDerivedDramConfigs("derived_configs");
 
     if (g_gpu_bw == 512 || g_gpu_bw == 1024 || g_gpu_bw == 256 || g_gpu_bw == 128 || g_gpu_bw == 64 ){
-        int numDevices = 32 * g_gpu_bw / 512; // 每个设备 32 个通道
-        int bytecount = static_cast<int>(log2(g_gpu_bw)) - 1;
-        // DRAM_BURST_BYTE = DRAM_BURST_BYTE * g_gpu_bw / 512;
-        // L1CACHELINESIZE = DRAM_BURST_BYTE;
-        // L2CACHELINESIZE = DRAM_BURST_BYTE;
         cout << "GPU BW: " << DRAM_BURST_BYTE << " GB/s" << endl;
-        generateGPUCacheJsonFile(numDevices,"../DRAMSys/configs/memspec/HBM2_GPU.json");
-        generateAddressMapping(bytecount, "../DRAMSys/configs/addressmapping/am_hbm2_gpu.json");
         gpu_dram_config = "../DRAMSys/configs/gpu_hbm2.json";
     }else if (beha_dram != true)
     {
         assert(false && "gpu bandwidth must be 512 1024 256");
     }
     delete_core_log_files();
-    remove_all_sram_log_files();
-    remove_all_l1cache_log_files();
 
     g_config_file = g_flag_config_file;
     InitGrid(g_flag_config_file.c_str(), g_flag_core_config_file.c_str());
     InitGlobalMembers();
+    if (!InitHostPorts(g_flag_host_ports)) {
+        cout << "[ERROR] Invalid --host-ports " << g_flag_host_ports << ".\n";
+        return -1;
+    }
 
     // init_dram_areas();
     // initialize_cache_structures();
 
     Event_engine *event_engine =
         new Event_engine("event-engine", g_flag_trace_window);
+    // 片间互联需要在各芯片的全局内存接口之前创建
+    g_chip_link = InitChipLink(g_flag_config_file.c_str());
+    if (g_flag_parallel_chips && !g_chip_link) {
+        cout << "[ERROR] --parallel-chips needs a link section in the "
+                "config.\n";
+        return -1;
+    }
+    // 多芯片配置中每个芯片在自己的进程中仿真全部的核，片间链路逐跳预约；
+    // 不指定 --parallel-chips 时各分区依次推进同一个窗口
+    if (g_chip_link && g_chip_link->config.chip_num > 1) {
+        if (g_flag_restore_file != "" || g_checkpoint_file != "") {
+            cout << "[ERROR] Checkpoint is not supported with multiple "
+                    "chips.\n";
+            return -1;
+        }
+
+        // 子进程切换到各自的工作目录，输入文件使用绝对路径
+        string config_file =
+            std::filesystem::absolute(g_flag_config_file).string();
+        string ttf_file = std::filesystem::absolute(g_flag_ttf).string();
+        ifstream jfile(config_file);
+        json j;
+        jfile >> j;
+
+        // 采样结果写在各分区的工作目录中
+        Stats_sampler *stats_sampler = nullptr;
+        Heatmap_sampler *heatmap_sampler = nullptr;
+        int ret = RunPartitionedChips(
+            g_chip_link->config.chip_num,
+            g_flag_parallel_chips ? g_flag_parallel_jobs : 1,
+            [&](int chip) {
+                // 没有核阵列的芯片只执行global_interface中的片级原语
+                if (j["chips"][chip].contains("cores"))
+                    new Monitor("monitor", event_engine, config_file.c_str(),
+                                ttf_file.c_str());
+                else
+                    new GlobalMemInterface("global-mem-interface",
+                                           event_engine, config_file.c_str(),
+                                           ttf_file.c_str(), chip);
+                if (g_flag_prim_records != "")
+                    PRIM_RECORDER.open(g_flag_prim_records);
+                if (g_flag_stats_interval > 0)
+                    stats_sampler =
+                        new Stats_sampler("stats-sampler", g_flag_stats_interval,
+                                          g_flag_stats_file);
+                if (g_flag_heatmap_window > 0)
+                    heatmap_sampler =
+                        new Heatmap_sampler("heatmap-sampler",
+                                            g_flag_heatmap_window,
+                                            g_flag_heatmap_file);
+            },
+            [&]() {
+                // 收到片间数据之后继续已经暂停的采样
+                if (stats_sampler)
+                    stats_sampler->resume();
+                if (heatmap_sampler)
+                    heatmap_sampler->resume();
+            },
+            [&]() {
+                STATS.sample();
+                STATS.counter("dcache.hits")->inc(dcache_hits);
+                STATS.counter("dcache.misses")->inc(dcache_misses);
+                STATS.summarize("stats_summary.csv");
+                g_chip_link->report("link_stats.csv");
+                PRIM_SAMPLER.report(g_flag_sample_report);
+                if (stats_sampler)
+                    delete stats_sampler;
+                if (heatmap_sampler)
+                    delete heatmap_sampler;
+                PRIM_RECORDER.close();
+                close_log_files();
+            });
+
+        clock_t end = clock();
+        cout << "花费了" << (double)(end - start) / CLOCKS_PER_SEC << "秒"
+             << endl;
+        return ret;
+    }
+
     Monitor monitor("monitor", event_engine, g_flag_config_file.c_str(),
                     g_flag_ttf.c_str());
-    sc_trace_file *tf = sc_create_vcd_trace_file("Cchip_1");
+
+    if (g_flag_restore_file != "" || g_checkpoint_file != "") {
+        if (SYSTEM_MODE != SIM_PDS) {
+            cout << "[ERROR] Checkpoint is only supported in pds mode.\n";
+            return -1;
+        }
+    }
+    if (g_flag_restore_file != "" &&
+        !LoadCheckpoint(g_flag_restore_file,
+                        (config_helper_pds *)monitor.memInterface->config_helper))
+        return -1;
+    if (g_flag_prim_records != "")
+        PRIM_RECORDER.open(g_flag_prim_records);
+    Stats_sampler *stats_sampler = nullptr;
+    if (g_flag_stats_interval > 0)
+        stats_sampler = new Stats_sampler("stats-sampler", g_flag_stats_interval,
+                                          g_flag_stats_file);
+    Heatmap_sampler *heatmap_sampler = nullptr;
+    if (g_flag_heatmap_window > 0)
+        heatmap_sampler = new Heatmap_sampler(
+            "heatmap-sampler", g_flag_heatmap_window, g_flag_heatmap_file);
+    sc_trace_file *tf = nullptr;
+    if (!g_headless)
+        tf = sc_create_vcd_trace_file("Cchip_1");
     sc_clock clk("clk", CYCLE, SC_NS);
     // sc_trace(tf, clk, "clk");
     // sc_trace(tf, monitor.memInterface->host_data_sent_i[0],
@@ -499,7 +417,21 @@ int sc_main(int argc, char *argv[]) {
     // destroy_dram_areas();
     // destroy_cache_structures();
     // event_engine->dump_traced_file();
-    sc_close_vcd_trace_file(tf);
+    if (tf)
+        sc_close_vcd_trace_file(tf);
+
+    STATS.sample();
+    STATS.counter("dcache.hits")->inc(dcache_hits);
+    STATS.counter("dcache.misses")->inc(dcache_misses);
+    STATS.summarize("stats_summary.csv");
+    if (g_chip_link)
+        g_chip_link->report("link_stats.csv");
+    PRIM_SAMPLER.report(g_flag_sample_report);
+    if (stats_sampler)
+        delete stats_sampler;
+    if (heatmap_sampler)
+        delete heatmap_sampler;
+    PRIM_RECORDER.close();
 
     SystemCleanup();
     close_log_files();
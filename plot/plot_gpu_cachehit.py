@@ -1,61 +1,53 @@
+import csv
 import os
 import re
-import glob
 import matplotlib.pyplot as plt
 from matplotlib.backends.backend_pdf import PdfPages
 
-# 正则匹配日志行
-log_pattern = re.compile(
-    r"Core \d+ Rw (READ|WRITE) Time: (\d+) ns.*Address: (0x[0-9a-fA-F]+) Result: (HIT|MISS)"
-)
-
-def parse_log_file(filepath: str):
-    """解析日志文件，返回 (时间, 累计HIT率) 列表"""
-    data = []
-    hit_count = 0
-    total_count = 0
+def parse_stats_file(filepath: str):
+    """解析 npusim --stats-interval 输出的统计文件，返回 {cid: [(时间, 累计HIT率)]}"""
+    data = {}
 
     with open(filepath, 'r') as f:
-        for line in f:
-            match = log_pattern.search(line)
-            if not match:
-                continue
-
-            time_ns = int(match.group(2))
-            result = match.group(4)
-
-            total_count += 1
-            if result == "HIT":
-                hit_count += 1
-
-            hit_rate = hit_count / total_count
-            data.append((time_ns, hit_rate))
-
-    return data
+        reader = csv.reader(f)
+        header = next(reader)
+        columns = {}
+        for idx, name in enumerate(header):
+            match = re.match(r"l1cache(\d+)\.(read|write)_(hit|miss)", name)
+            if match:
+                cid = int(match.group(1))
+                columns.setdefault(cid, {"hit": [], "miss": []})[match.group(3)].append(idx)
+
+        for row in reader:
+            time_ns = int(row[0])
+            for cid, cols in columns.items():
+                hit_count = sum(int(row[i]) for i in cols["hit"])
+                total_count = hit_count + sum(int(row[i]) for i in cols["miss"])
+                if total_count == 0:
+                    continue
+                data.setdefault(cid, []).append((time_ns, hit_count / total_count))
+
+    return dict(sorted(data.items()))
 
 
 def plot_all_cores_to_single_pdf(
-    input_dir="../build/gpu_cache",
+    stats_file="../build/stats.csv",
     output_pdf="l1cache_hit_rate_all_in_one.pdf",
     plots_per_row=4
 ):
-    # 匹配所有 L1Cache_cid_*.log 文件，并按 cid 数字排序
-    pattern = os.path.join(input_dir, "L1Cache_cid_*.log")
-    log_files = glob.glob(pattern)
-
-    # 按 cid 的数字排序：cid_0, cid_1, ..., cid_10
-    log_files.sort(key=lambda x: int(re.search(r"cid_(\d+)", os.path.basename(x)).group(1)))
+    if not os.path.exists(stats_file):
+        print(f"❌ 未找到统计文件 '{stats_file}'，请使用 --stats-interval 运行 npusim。")
+        return
 
-    if not log_files:
-        print(f"❌ 在 '{input_dir}' 目录下未找到 L1Cache_cid_*.log 文件。")
+    core_data = parse_stats_file(stats_file)
+    if not core_data:
+        print(f"❌ '{stats_file}' 中没有 L1 cache 的访问记录。")
         return
 
-    print(f"✅ 找到 {len(log_files)} 个日志文件：")
-    for f in log_files:
-        print(f"    {os.path.basename(f)}")
+    print(f"✅ 找到 {len(core_data)} 个核的 L1 cache 统计。")
 
     # 计算子图布局：每行 4 个
-    n_files = len(log_files)
+    n_files = len(core_data)
     n_cols = plots_per_row
     n_rows = (n_files + n_cols - 1) // n_cols  # 向上取整计算行数
 
@@ -66,15 +58,8 @@ def plot_all_cores_to_single_pdf(
     axes = axes.flatten() if n_files > 1 else [axes]
 
     # 解析并绘图
-    for idx, log_file in enumerate(log_files):
-        data = parse_log_file(log_file)
-        if not data:
-            print(f"⚠️  {os.path.basename(log_file)} 没有有效数据，跳过。")
-            axes[idx].set_visible(False)
-            continue
-
+    for idx, (core_id, data) in enumerate(core_data.items()):
         times, hit_rates = zip(*data)
-        core_id = re.search(r"cid_(\d+)", log_file).group(1)
 
         ax = axes[idx]
         ax.plot(times, hit_rates, linewidth=1.8)
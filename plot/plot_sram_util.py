@@ -1,51 +1,55 @@
+import csv
 import os
 import re
 import matplotlib.pyplot as plt
 import numpy as np
 import math
 
-def parse_log_file(filepath):
+def parse_stats_file(filepath):
     """
-    Parse a log file and extract time and ratio data
+    Parse the periodic statistics csv and extract time and ratio data per core
     """
-    times = []
-    ratios = []
-    
-    # Regular expression to match log entries
-    pattern = r"Time:\s*([\d.]+)\s*ns\s+Free/Total Ratio:\s*([\d.]+)"
-    
+    data = {}
+
     with open(filepath, 'r') as file:
-        for line in file:
-            match = re.search(pattern, line)
+        reader = csv.reader(file)
+        header = next(reader)
+        columns = {}
+        for idx, name in enumerate(header):
+            match = re.match(r"core(\d+)\.sram\.used_ratio", name)
             if match:
-                time = float(match.group(1))
-                ratio = float(match.group(2))
-                times.append(time)
-                ratios.append(ratio)
-    
-    return times, ratios
+                columns[int(match.group(1))] = idx
+                data[int(match.group(1))] = ([], [])
+
+        for row in reader:
+            time = float(row[0])
+            for cid, idx in columns.items():
+                data[cid][0].append(time)
+                data[cid][1].append(float(row[idx]))
+
+    # 只保留使用过sram manager的核
+    return {cid: v for cid, v in sorted(data.items()) if any(v[1])}
 
 def plot_sram_utilization():
     """
     Plot SRAM utilization ratios from all log files in subplots and save as PDF
     """
-    # Directory containing log files
-    log_dir = "../build/sram_util/"
+    # Statistics file sampled by npusim --stats-interval
+    stats_file = "../build/stats.csv"
     
-    # Check if directory exists
-    if not os.path.exists(log_dir):
-        print(f"Directory {log_dir} does not exist")
+    # Check if file exists
+    if not os.path.exists(stats_file):
+        print(f"File {stats_file} does not exist, run npusim with --stats-interval")
         return
     
-    # Find all log files matching the pattern
-    log_files = [f for f in os.listdir(log_dir) if re.match(r'sram_manager_cid_\d+\.log', f)]
+    core_data = parse_stats_file(stats_file)
     
-    if not log_files:
-        print("No log files found matching the pattern 'sram_manager_cid_*.log'")
+    if not core_data:
+        print("No core.sram.used_ratio samples found in " + stats_file)
         return
     
     # Calculate subplot layout
-    n_files = len(log_files)
+    n_files = len(core_data)
     n_cols = min(3, n_files)  # Maximum 3 columns
     n_rows = math.ceil(n_files / n_cols)
     
@@ -60,22 +64,13 @@ def plot_sram_utilization():
     else:
         axes = axes.flatten()
     
-    # Process each log file
-    for i, log_file in enumerate(log_files):
-        filepath = os.path.join(log_dir, log_file)
-        
-        # Parse the log file
-        times, ratios = parse_log_file(filepath)
-        
-        # Extract CID from filename
-        cid_match = re.search(r'sram_manager_cid_(\d+)\.log', log_file)
-        cid = cid_match.group(1) if cid_match else "Unknown"
-        
+    # Process each core
+    for i, (cid, (times, ratios)) in enumerate(core_data.items()):
         # Plot the data in the corresponding subplot
         axes[i].plot(times, ratios, marker='o', linewidth=2, markersize=4, color=f'C{i}')
         axes[i].set_title(f'CID {cid}', fontsize=12)
         axes[i].set_xlabel('Time (ns)', fontsize=10)
-        axes[i].set_ylabel('Free/Total Ratio', fontsize=10)
+        axes[i].set_ylabel('Used/Total Ratio', fontsize=10)
         axes[i].grid(True, alpha=0.3)
         
         # Set y-axis limits to 0-1 for all subplots
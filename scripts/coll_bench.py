@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# 集合通信基准：对每一种 (消息大小, 算法) 生成一个 dataflow 配置并调用 npusim 仿真，
+# 输出 nccl-tests 风格的 algbw / busbw
+# 1. 组内每个核都是一个 source，先接收 size 个元素并拷贝为 coll_in
+# 2. 之后执行 worklist 中的 collective 条目（见 llm/include/common/collective.h），
+#    结果发送给 host（dest -1）
+# 3. 同时仿真一个不做 collective、直接把 coll_in 发回 host 的基线，
+#    algbw = 消息字节数 / (总时间 - 基线时间)，busbw = algbw * 系数
+#    （all_reduce 为 2(p-1)/p，reduce_scatter 与 all_gather 为 (p-1)/p）
+#
+# 用法：
+#   python3 coll_bench.py --core-config ../llm/test/core_configs/core_4x4.json \
+#       --npusim ../build/npusim --type all_reduce --algos ring,bi_ring,tree \
+#       --sizes 4096,65536,1048576 -o coll_out
+
+import argparse
+import csv
+import json
+import os
+from concurrent.futures import ProcessPoolExecutor, as_completed
+
+import sweep
+
+ALGOS = ["ring", "bi_ring", "mesh2d", "halving_doubling", "tree"]
+TYPES = ["all_reduce", "reduce_scatter", "all_gather"]
+BYTE_WIDTH = {"int8": 1, "fp8": 1, "fp16": 2, "bf16": 2}
+
+
+def copy_prim(n, indata, outdata, dtype):
+    return {"type": "Collective_f", "N": n, "ACC": 0, "K": 1, "op": 0,
+            "datatype": dtype,
+            "sram_address": {"indata": indata, "outdata": outdata},
+            "dram_address": {}}
+
+
+def make_config(group, size, coll_type, algo, opts):
+    """algo 为 None 时生成基线配置"""
+    cores = []
+    for cid in group:
+        worklist = [{"recv_cnt": 1,
+                     "cast": [],
+                     "prims": [copy_prim(size, "input_label", "coll_in",
+                                         opts.datatype)]}]
+        if algo is None:
+            worklist[0]["cast"] = [{"dest": -1}]
+        else:
+            worklist.append({"collective": {
+                "type": coll_type, "algo": algo, "group": group,
+                "size": size, "indata": "coll_in", "outdata": "coll_out",
+                "chunks": opts.chunks, "datatype": opts.datatype,
+                "cast": [{"dest": -1}]}})
+        cores.append({"id": cid, "worklist": worklist})
+
+    return {
+        "random": False,
+        "vars": {},
+        "pipeline": 1,
+        "source": [{"dest": cid, "size": size} for cid in group],
+        "chips": [{"cores": cores}],
+    }
+
+
+def bus_factor(coll_type, p):
+    if coll_type == "all_reduce":
+        return 2.0 * (p - 1) / p
+    return (p - 1.0) / p
+
+
+def main():
+    parser = argparse.ArgumentParser(description="collective benchmark on npusim")
+    parser.add_argument("--core-config", required=True,
+                        help="core config json (test/core_configs/*.json)")
+    parser.add_argument("--npusim", required=True)
+    parser.add_argument("--type", choices=TYPES, default="all_reduce")
+    parser.add_argument("--algos", default="ring,bi_ring",
+                        help="comma separated, from " + ",".join(ALGOS))
+    parser.add_argument("--sizes", default="4096,65536,1048576",
+                        help="comma separated per-core element counts")
+    parser.add_argument("--group", help="comma separated core ids, default all")
+    parser.add_argument("--chunks", type=int, default=0)
+    parser.add_argument("--datatype", choices=sorted(BYTE_WIDTH), default="int8")
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-o", "--out-dir", default="coll_out")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=int, default=None)
+    opts = parser.parse_args()
+
+    with open(opts.core_config) as f:
+        x = json.load(f).get("x", 4)
+    group = ([int(g) for g in opts.group.split(",")] if opts.group
+             else list(range(x * x)))
+    algos = opts.algos.split(",")
+    for a in algos:
+        if a not in ALGOS:
+            parser.error("unknown algorithm " + a)
+    sizes = [int(s) for s in opts.sizes.split(",")]
+
+    args = {}
+    for a in opts.sim_arg or []:
+        name, _, value = a.partition("=")
+        args[name] = value
+
+    out_dir = os.path.abspath(opts.out_dir)
+    cfg_dir = os.path.join(out_dir, "configs")
+    os.makedirs(cfg_dir, exist_ok=True)
+
+    runs = []
+    for size in sizes:
+        for algo in [None] + algos:
+            path = os.path.join(cfg_dir, "%s_%d.json" % (algo or "base", size))
+            with open(path, "w") as f:
+                json.dump(make_config(group, size, opts.type, algo, opts), f,
+                          indent=2)
+            runs.append({"size": size, "algo": algo or "base",
+                         "config_file": path})
+
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = {}
+        for i, r in enumerate(runs):
+            spec = {"npusim": os.path.abspath(opts.npusim),
+                    "config_file": r["config_file"],
+                    "core_config_file": os.path.abspath(opts.core_config),
+                    "args": args, "timeout": opts.timeout}
+            futures[pool.submit(sweep.run_one, i, {}, spec, out_dir)] = r
+        for fut in as_completed(futures):
+            r = futures[fut]
+            try:
+                res = fut.result()
+                r["returncode"] = res["returncode"]
+                r["sim_time_ns"] = res.get("sim_time_ns")
+            except Exception as e:
+                r["returncode"] = -1
+                r["error"] = str(e)
+
+    # 减去基线（接收输入、发回 host）的时间
+    base = {r["size"]: r.get("sim_time_ns") for r in runs if r["algo"] == "base"}
+    p = len(group)
+    results = []
+    print("%10s %18s %12s %10s %10s" % ("bytes", "algo", "time(ns)",
+                                         "algbw", "busbw"))
+    for r in runs:
+        if r["algo"] == "base":
+            continue
+        nbytes = r["size"] * BYTE_WIDTH[opts.datatype]
+        t, t0 = r.get("sim_time_ns"), base.get(r["size"])
+        r["bytes"] = nbytes
+        if t is not None and t0 is not None and t > t0:
+            r["coll_ns"] = t - t0
+            r["algbw_GBps"] = round(nbytes / r["coll_ns"], 4)
+            r["busbw_GBps"] = round(r["algbw_GBps"] * bus_factor(opts.type, p), 4)
+        results.append(r)
+        print("%10d %18s %12s %10s %10s" % (nbytes, r["algo"], r.get("coll_ns"),
+                                             r.get("algbw_GBps"),
+                                             r.get("busbw_GBps")))
+
+    with open(os.path.join(out_dir, "coll_results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    fields = ["size", "bytes", "algo", "coll_ns", "algbw_GBps", "busbw_GBps",
+              "sim_time_ns", "returncode", "config_file"]
+    with open(os.path.join(out_dir, "coll_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+    print("Results written to " + out_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# host连接点与配置预加载的对比：同一组配置分别以不同的 --host-ports / --host-preload 运行 npusim，
+# 从 stats_summary.csv 中汇总每个host端口注入与接收的包数、阻塞周期，
+# 输出最忙端口的占用率、端口总阻塞周期、预加载的包数与仿真时间
+#
+# 用法：
+#   python3 host_bench.py --core-config ../llm/test/core_configs/core_4x4.json \
+#       --npusim ../build/npusim --host-ports "west;edges;0,3,12,15" \
+#       -o host_out ../llm/test/gpt2_small/tp_8.json
+
+import argparse
+import csv
+import json
+import os
+import re
+from concurrent.futures import ProcessPoolExecutor
+
+import sweep
+
+PORT_RE = re.compile(r"host\.port(\d+)\.(packets|stall_cycles|recv)$")
+
+
+def read_ports(run_dir):
+    """读取每个host端口的统计，以及预加载的包数"""
+    ports = {}
+    preload = 0
+    path = os.path.join(run_dir, "build", "stats_summary.csv")
+    if not os.path.exists(path):
+        return ports, preload
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            name = row["name"]
+            if name == "host.preload.packets":
+                preload = int(float(row["value"]))
+                continue
+            m = PORT_RE.match(name)
+            if m:
+                ports.setdefault(int(m.group(1)), {})[m.group(2)] = int(
+                    float(row["value"]))
+    return ports, preload
+
+
+def summarize(result, cycle_ns):
+    ports, preload = read_ports(result["run_dir"])
+    result["host_ports"] = len(ports)
+    result["preload_packets"] = preload
+    if not ports:
+        return result
+
+    busy = {p: v.get("packets", 0) + v.get("recv", 0) for p, v in ports.items()}
+    hottest = max(busy, key=busy.get)
+    result["host_packets"] = sum(v.get("packets", 0) for v in ports.values())
+    result["host_stall_cycles"] = sum(
+        v.get("stall_cycles", 0) for v in ports.values())
+    result["hottest_port"] = hottest
+    sim_time = result.get("sim_time_ns")
+    if sim_time:
+        result["max_port_util"] = round(busy[hottest] * cycle_ns / sim_time, 4)
+        result["mean_port_util"] = round(
+            sum(busy.values()) * cycle_ns / sim_time / len(busy), 4)
+    return result
+
+
+def run_config(index, config, combo, opts, args, out_dir):
+    spec = {"npusim": os.path.abspath(opts.npusim),
+            "config_file": os.path.abspath(config),
+            "core_config_file": os.path.abspath(opts.core_config),
+            "args": args, "timeout": opts.timeout}
+    result = sweep.run_one(index, combo, spec, out_dir)
+    result["config"] = config
+    return summarize(result, opts.cycle_ns)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="host port / preload comparison")
+    parser.add_argument("configs", nargs="+", help="config files")
+    parser.add_argument("--core-config", required=True)
+    parser.add_argument("--npusim", required=True)
+    parser.add_argument("--host-ports", default="west;west_east;edges",
+                        help="semicolon separated --host-ports values "
+                             "(a router list itself uses commas)")
+    parser.add_argument("--no-preload", action="store_true",
+                        help="do not run the --host-preload variants")
+    parser.add_argument("--cycle-ns", type=float, default=2,
+                        help="router cycle (CYCLE in macros.h)")
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-o", "--out-dir", default="host_out")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=int, default=None)
+    opts = parser.parse_args()
+
+    args = {}
+    for a in opts.sim_arg or []:
+        name, _, value = a.partition("=")
+        args[name] = value
+
+    # 显式的router列表本身含逗号，模式之间用分号分隔
+    modes = opts.host_ports.split(";")
+    preloads = [False] if opts.no_preload else [False, True]
+    combos = [{"--host-ports": m, "--host-preload": p}
+              for m in modes for p in preloads]
+
+    out_dir = os.path.abspath(opts.out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+    jobs = [(c, combo) for c in opts.configs for combo in combos]
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = [pool.submit(run_config, i, c, combo, opts, args, out_dir)
+                   for i, (c, combo) in enumerate(jobs)]
+        results = [f.result() for f in futures]
+
+    # 以 west + 不预加载（原有的host连接方式）为基准
+    print("%-24s %-12s %7s %14s %8s %9s %12s %8s" % (
+        "config", "host_ports", "preload", "sim_time(ns)", "speedup",
+        "max_util", "stall_cycles", "preload"))
+    for r in results:
+        base = next((b for b in results if b["config"] == r["config"] and
+                     b["--host-ports"] == "west" and
+                     not b["--host-preload"]), None)
+        if base and base.get("sim_time_ns") and r.get("sim_time_ns"):
+            r["speedup"] = round(base["sim_time_ns"] / r["sim_time_ns"], 4)
+        print("%-24s %-12s %7s %14s %8s %9s %12s %8s" % (
+            os.path.basename(r["config"]), r["--host-ports"],
+            str(r["--host-preload"]), r.get("sim_time_ns"), r.get("speedup"),
+            r.get("max_port_util"), r.get("host_stall_cycles"),
+            r.get("preload_packets")))
+
+    with open(os.path.join(out_dir, "host_results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    fields = ["config", "--host-ports", "--host-preload", "sim_time_ns",
+              "speedup", "host_ports", "hottest_port", "max_port_util",
+              "mean_port_util", "host_packets", "host_stall_cycles",
+              "preload_packets", "wall_seconds", "returncode", "run_dir"]
+    with open(os.path.join(out_dir, "host_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+    print("Results written to " + out_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,815 @@
+#!/usr/bin/env python3
+# 模型到核的映射编译器：根据模型描述、核配置与并行方案生成完整的 dataflow 配置文件
+# 1. 按照 PP 将各层均匀切分为流水级，每一级由 TP 个核组成（第一个核为 leader），
+#    DP 个副本各自拥有独立的 source
+# 2. 按照放置策略（row / snake）为每一个 (副本, 流水级, TP rank) 分配核
+# 3. TP 组内：leader 做 norm + Split_matmul 并广播给其他核，各核计算自己的切片，
+#    再以独立的 tag 发回 leader，leader 做 Merge_matmul + Residual；
+#    同一个核上的多层使用带层号前缀的 SRAM label，权重不会互相覆盖
+# 4. 每个核的 DRAM 地址按照原语的 input / data / output 大小顺序分配，互不重叠
+# 5. 搜索模式：枚举所有放得下的 (tp, pp, dp, placement)，为每个方案生成配置并用
+#    npu_estimate 估计总时间（与 npusim 相同的原语与计算代价模型），
+#    对估计最快的 top-k 个方案调用 npusim 仿真（复用 sweep.py）
+#
+# 数据类型表（位宽与scale开销）与时间估计都取自 npu_estimate，脚本中不重复C++中的模型
+#
+# 模型描述文件示例（见 scripts/map_example_model.json）：
+# {
+#     "layers": 28, "hidden": 1024, "heads": 16, "kv_heads": 8, "ffn": 3072,
+#     "norm": "rmsnorm", "act": "swiglu", "rope": true, "batch": 1, "seq": 128,
+#     "moe": {"experts": 8, "topk": 2}
+# }
+#
+# 用法：
+#   python3 map_model.py model.json --core-config core_4x4.json \
+#       --estimator ../build/npu_estimate --tp 2 --pp 4 -o out.json
+#   python3 map_model.py model.json --core-config core_4x4.json --search --top-k 4 \
+#       --estimator ../build/npu_estimate --npusim ../build/npusim -o map_out
+
+import argparse
+import csv
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ProcessPoolExecutor, as_completed
+
+import sweep
+
+TAG_NUM = 256           # send / recv 的 tag 字段为8位
+DRAM_ALIGN = 64
+PLACEMENTS = ["row", "snake"]
+
+# 名称 -> {bits, group_size, scale_bits, exu_rate}，由 load_datatypes 从 npu_estimate 读入
+DATATYPES = {}
+
+
+def load_datatypes(estimator):
+    """npu_estimate --dump-datatypes 导出 datatype_utils.cpp 中的数据类型表"""
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "datatypes.json")
+        proc = subprocess.run([estimator, "--dump-datatypes", path],
+                              stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                              text=True)
+        if proc.returncode != 0 or not os.path.exists(path):
+            sys.exit("[ERROR] Cannot get the datatype table from %s:\n%s" %
+                     (estimator, proc.stdout))
+        with open(path) as f:
+            DATATYPES.update(json.load(f))
+
+
+def datatype_bytes(dtype, elements):
+    d = DATATYPES[dtype]
+    total = elements * d["bits"]
+    if d["group_size"]:
+        total += (elements + d["group_size"] - 1) // d["group_size"] * \
+            d["scale_bits"]
+    return (total + 7) // 8
+
+
+def byte_width(dtype):
+    return (DATATYPES[dtype]["bits"] + 7) // 8
+
+
+def ceil_div(a, b):
+    return (a + b - 1) // b
+
+
+class Model:
+    def __init__(self, j):
+        self.name = j.get("name", "model")
+        self.layers = j["layers"]
+        self.hidden = j["hidden"]
+        self.heads = j["heads"]
+        self.kv_heads = j.get("kv_heads", self.heads)
+        self.ffn = j.get("ffn", 4 * self.hidden)
+        self.norm = j.get("norm", "rmsnorm")
+        self.act = j.get("act", "swiglu")
+        self.rope = j.get("rope", True)
+        self.batch = j.get("batch", 1)
+        self.seq = j.get("seq", 128)
+        self.moe = j.get("moe")
+        self.datatype = j.get("datatype", "int8")
+        self.weight_datatype = j.get("weight_datatype", self.datatype)
+
+        if self.heads % self.kv_heads:
+            sys.exit("[ERROR] heads must be a multiple of kv_heads.")
+        if self.norm not in ("rmsnorm", "layernorm"):
+            sys.exit("[ERROR] Unknown norm " + self.norm + ", use rmsnorm/layernorm.")
+        if self.act not in ("swiglu", "gelu"):
+            sys.exit("[ERROR] Unknown act " + self.act + ", use swiglu/gelu.")
+        for d in (self.datatype, self.weight_datatype):
+            if d not in DATATYPES:
+                sys.exit("[ERROR] Unknown datatype " + d + ".")
+
+        # Attention_f 中 R = heads / kv_heads，QKV 的总宽度为 C * (1 + 2 / R)
+        self.R = self.heads // self.kv_heads
+        self.qkv = self.hidden + 2 * self.hidden // self.R
+
+    def tp_ok(self, tp):
+        if self.heads % tp or self.hidden % tp or self.ffn % tp or self.qkv % tp:
+            return False
+        if self.moe and self.moe["experts"] % tp:
+            return False
+        return True
+
+
+class Hardware:
+    def __init__(self, j, opts):
+        self.x = j.get("x", 4)
+        self.size = self.x * self.x
+        self.sram_size = j.get("sram_size", opts.sram_size)
+
+    def order(self, placement):
+        """按照放置策略给出核的排列，相邻的 (流水级, rank) 放在相邻的核上"""
+        if placement == "row":
+            return list(range(self.size))
+        if placement == "snake":
+            ids = []
+            for y in range(self.x):
+                row = [y * self.x + x for x in range(self.x)]
+                ids += row if y % 2 == 0 else row[::-1]
+            return ids
+        sys.exit("[ERROR] Unknown placement " + placement + ", use row/snake.")
+
+
+class Vars:
+    """config 中的 vars 表，原语参数统一以变量名引用"""
+
+    def __init__(self):
+        self.table = {}
+
+    def __call__(self, name, value):
+        value = int(value)
+        if self.table.get(name, value) != value:
+            sys.exit("[ERROR] Var %s redefined: %d vs %d." %
+                     (name, self.table[name], value))
+        self.table[name] = value
+        return name
+
+
+class Prim:
+    def __init__(self, type, params, inputs, chunks, extra=None):
+        self.type = type
+        self.params = params    # json字段 -> 变量名
+        self.inputs = inputs    # 每个输入的元素数，与 data_size_input 一致
+        self.chunks = chunks    # [(名称, 元素数)]，与 data_chunk 一致
+        self.extra = extra or {}
+        self.indata = ""
+        self.outdata = ""
+        self.dram = None
+
+    def weight_elements(self):
+        return sum(n for name, n in self.chunks
+                   if name.startswith("weight") or name.startswith("bias"))
+
+    def output_elements(self):
+        return dict(self.chunks)["output"]
+
+    def to_json(self, model):
+        j = {"type": self.type}
+        j.update(self.params)
+        j.update(self.extra)
+        if model.datatype != "int8":
+            j["datatype"] = model.datatype
+        if model.weight_datatype != model.datatype and self.weight_elements():
+            j["weight_datatype"] = model.weight_datatype
+        j["sram_address"] = {"indata": self.indata, "outdata": self.outdata}
+        if self.dram is not None:
+            j["dram_address"] = self.dram
+        return j
+
+
+class Job:
+    def __init__(self, recv_cnt, prims, recv_tag=None):
+        self.recv_cnt = recv_cnt
+        self.recv_tag = recv_tag
+        self.cast = []
+        self.prims = prims
+
+    def to_json(self, model):
+        j = {"recv_cnt": self.recv_cnt}
+        if self.recv_tag is not None:
+            j["recv_tag"] = self.recv_tag
+        j["cast"] = self.cast
+        j["prims"] = [p.to_json(model) for p in self.prims]
+        return j
+
+
+class Builder:
+    """按照 comp_prims 中各原语 initialize() 的形状构造原语"""
+
+    def __init__(self, model, tp):
+        self.m = model
+        self.tp = tp
+        self.v = Vars()
+        m, v = model, self.v
+        self.B = v("B", m.batch)
+        self.T = v("T", m.seq)
+        self.C = v("C", m.hidden)
+        self.BTC = v("BTC", m.batch * m.seq * m.hidden)
+        self.BT = m.batch * m.seq
+
+    def part(self, name, value):
+        """按照 TP 切分后的变量"""
+        if self.tp == 1:
+            return self.v(name, value)
+        return self.v("%s/%d" % (name, self.tp), value // self.tp)
+
+    def local(self, name, value):
+        """每个核上的局部值，与全局值不同时单独命名"""
+        if self.tp == 1:
+            return self.v(name, value)
+        return self.v(name + "_local", value)
+
+    def norm(self):
+        m = self.m
+        n = self.BT * m.hidden
+        params = {"B": self.B, "T": self.T, "C": self.C}
+        if m.norm == "rmsnorm":
+            return Prim("rmsnorm_forward", params, [n],
+                        [("weight", m.hidden), ("output", n)])
+        return Prim("Layernorm_f", params, [n],
+                    [("weight", m.hidden), ("bias", m.hidden), ("output", n)])
+
+    def matmul(self, C, OC, c, oc):
+        return Prim("Matmul_f", {"B": self.B, "T": self.T, "C": C, "OC": OC},
+                    [self.BT * c], [("weight", c * oc), ("bias", oc),
+                                    ("output", self.BT * oc)])
+
+    def rope(self, C, c, NH, nh):
+        return Prim("rope_forward",
+                    {"B": self.B, "T": self.T, "C": C, "NH": NH},
+                    [self.BT * c],
+                    [("sincos", self.m.batch * (c // nh) * 2 * self.m.seq),
+                     ("output", self.BT * c)])
+
+    def attention(self, C, c, NH, nh):
+        m = self.m
+        T = m.seq
+        # 与 Attention_f::initialize() 相同，2 / R 为整数除法
+        out = self.BT * c // (1 + 2 // m.R)
+        return Prim("Attention_f",
+                    {"B": self.B, "T": self.T, "C": C, "NH": NH,
+                     "R": self.v("R", m.R)},
+                    [self.BT * c],
+                    [("preatt", m.batch * nh * T * T),
+                     ("att", m.batch * nh * T * T), ("output", out)])
+
+    def residual(self):
+        n = self.BT * self.m.hidden
+        return Prim("Residual_f", {"N": self.BTC}, [n, n], [("output", n)])
+
+    def act(self, N, n):
+        if self.m.act == "swiglu":
+            return Prim("swiglu_forward", {"N": N}, [n, n], [("output", n)])
+        return Prim("Gelu_f", {"N": N}, [n], [("output", n)])
+
+    def switch(self):
+        n = self.BT * self.m.hidden
+        return Prim("switch_data", {"IN": self.BTC, "OUT": self.BTC}, [n],
+                    [("output", n)])
+
+    def split(self):
+        n = self.BT * self.m.hidden
+        return Prim("Split_matmul",
+                    {"B": self.B, "T": self.T, "C": self.C},
+                    [n], [("output", n)], {"dim": 2, "slice": self.tp})
+
+    def merge(self):
+        # 行切分的 matmul 输出为部分和，按 dim 1 归约为 [B, T, C]
+        n = self.BT * self.m.hidden
+        return Prim("Merge_matmul",
+                    {"B": self.B, "T": self.T, "C": self.C},
+                    [n] * self.tp, [("output", n)],
+                    {"dim": 1, "slice": self.tp})
+
+    def gate(self):
+        m = self.m
+        e = m.moe["experts"]
+        return Prim("gate_forward",
+                    {"B": self.B, "T": self.T, "C": self.C,
+                     "K": self.v("K", m.moe["topk"]), "E_N": self.v("E_N", e)},
+                    [self.BT * m.hidden], [("output", self.BT * m.moe["topk"])])
+
+    def moe_matmul(self, C, OC, c, oc, first=False, merge=False):
+        m = self.m
+        # 专家按照 TP 均分，每个核只选择自己的专家
+        e = m.moe["experts"] // self.tp
+        k = min(m.moe["topk"], e)
+        extra = {}
+        if first:
+            extra["choose"] = True
+        if merge:
+            extra["is_merge"] = True
+            inputs, out = [self.BT * c * k], self.BT * oc
+        else:
+            inputs, out = [self.BT * c], self.BT * oc * k
+        return Prim("matmul_forward_moe",
+                    {"B": self.B, "T": self.T, "C": C, "OC": OC,
+                     "K": self.local("K", k), "E_N": self.local("E_N", e)},
+                    inputs, [("weight", c * oc), ("bias", oc), ("output", out)],
+                    extra)
+
+    # ---------------- 层内的切片 ----------------
+
+    def attention_slice(self, pre, indata, keep_input):
+        m, tp = self.m, self.tp
+        qkv, nh = m.qkv // tp, m.heads // tp
+        QKV = self.part("QKV", m.qkv)
+        NH = self.part("NH", m.heads)
+        prims = [self.matmul(self.C, QKV, m.hidden, qkv)]
+        if m.rope:
+            prims.append(self.rope(QKV, qkv, NH, nh))
+        prims.append(self.attention(QKV, qkv, NH, nh))
+        prims.append(self.matmul(self.part("C", m.hidden), self.C,
+                                 m.hidden // tp, m.hidden))
+
+        names = ["matmul1"] + (["rope1"] if m.rope else []) + \
+            ["attention1", "matmul2"]
+        self.chain(pre, prims, names, ("_" if keep_input else "") + indata)
+        return prims
+
+    def ffn_slice(self, pre, indata):
+        m, tp = self.m, self.tp
+        prims = []
+        if m.moe:
+            e_ffn = self.part("FFN", m.ffn)
+            up = self.moe_matmul(self.C, e_ffn, m.hidden, m.ffn // tp,
+                                 first=True)
+            up.indata, up.outdata = "_" + indata, pre + "matmul_moe1_out"
+            prims.append(up)
+            last = up.outdata
+            if m.act == "swiglu":
+                gate = self.moe_matmul(self.C, e_ffn, m.hidden, m.ffn // tp)
+                gate.indata, gate.outdata = indata, pre + "matmul_moe2_out"
+                prims.append(gate)
+            else:
+                prims[0].indata = indata
+            k = min(m.moe["topk"], m.moe["experts"] // tp)
+            n = self.BT * m.ffn // tp * k
+            act = self.act(self.v("BT*FFN*K/%d" % tp, n), n)
+            act.indata = last + (" " + pre + "matmul_moe2_out"
+                                 if m.act == "swiglu" else "")
+            act.outdata = pre + "act1_out"
+            down = self.moe_matmul(e_ffn, self.C, m.ffn // tp, m.hidden,
+                                   merge=True)
+            down.indata, down.outdata = act.outdata, pre + "matmul_moe3_out"
+            return prims + [act, down]
+
+        FFN = self.part("FFN", m.ffn)
+        f = m.ffn // tp
+        up = self.matmul(self.C, FFN, m.hidden, f)
+        prims.append(up)
+        if m.act == "swiglu":
+            gate = self.matmul(self.C, FFN, m.hidden, f)
+            prims.append(gate)
+            up.indata, up.outdata = "_" + indata, pre + "matmul3_out"
+            gate.indata, gate.outdata = indata, pre + "matmul4_out"
+        else:
+            up.indata, up.outdata = indata, pre + "matmul3_out"
+        n = self.BT * f
+        act = self.act(self.part("BT*FFN", self.BT * m.ffn), n)
+        act.indata = pre + "matmul3_out" + \
+            (" " + pre + "matmul4_out" if m.act == "swiglu" else "")
+        act.outdata = pre + "act1_out"
+        down = self.matmul(FFN, self.C, f, m.hidden)
+        down.indata, down.outdata = act.outdata, pre + "matmul5_out"
+        return prims + [act, down]
+
+    def chain(self, pre, prims, names, indata):
+        for p, name in zip(prims, names):
+            p.indata = indata
+            p.outdata = pre + name + "_out"
+            indata = p.outdata
+
+
+def split_layers(layers, pp):
+    base, rem = divmod(layers, pp)
+    out, start = [], 0
+    for s in range(pp):
+        n = base + (1 if s < rem else 0)
+        out.append(list(range(start, start + n)))
+        start += n
+    return out
+
+
+def pick_tags(leader, grid_size):
+    """TP 组内发回 leader 的两个 tag，不能与 leader 的 id 相同（默认 tag 为目的核）"""
+    tags = [t for t in list(range(grid_size, TAG_NUM)) + list(range(grid_size))
+            if t != leader]
+    return tags[0], tags[1]
+
+
+class Plan:
+    def __init__(self, tp, pp, dp, placement):
+        self.tp, self.pp, self.dp, self.placement = tp, pp, dp, placement
+
+    def name(self):
+        return "tp%d_pp%d_dp%d_%s" % (self.tp, self.pp, self.dp, self.placement)
+
+
+def map_model(model, hw, plan, iters):
+    """生成 dataflow 配置，返回 (config, 方案信息)"""
+    tp, pp, dp = plan.tp, plan.pp, plan.dp
+    if tp * pp * dp > hw.size:
+        sys.exit("[ERROR] Plan %s needs %d cores, grid has %d." %
+                 (plan.name(), tp * pp * dp, hw.size))
+    if not model.tp_ok(tp):
+        sys.exit("[ERROR] TP %d does not divide heads/hidden/ffn/experts." % tp)
+    if pp > model.layers:
+        sys.exit("[ERROR] PP %d exceeds the number of layers." % pp)
+
+    b = Builder(model, tp)
+    order = hw.order(plan.placement)
+    stages = split_layers(model.layers, pp)
+    cores = {}   # cid -> [Job]
+    groups = []  # [[(leader, followers, layers)]] 按副本
+
+    for d in range(dp):
+        replica = []
+        for s in range(pp):
+            base = (d * pp + s) * tp
+            ids = order[base:base + tp]
+            replica.append((ids[0], ids[1:], stages[s]))
+        groups.append(replica)
+
+    for replica in groups:
+        for s, (leader, followers, layers) in enumerate(replica):
+            if s + 1 < len(replica):
+                out_cast = {"dest": replica[s + 1][0], "critical": True}
+            else:
+                out_cast = {"dest": -1, "critical": True}
+            t1, t2 = pick_tags(leader, hw.size)
+            cores[leader] = []
+            for f in followers:
+                cores[f] = []
+
+            cur = "input_label"
+            for i, l in enumerate(layers):
+                pre = "l%d_" % l
+                first = i == 0
+                last = i == len(layers) - 1
+                if tp == 1:
+                    job = Job(1 if first else 0,
+                              map_layer_single(b, pre, cur))
+                else:
+                    jobs = map_layer_tp(b, pre, cur, followers, leader,
+                                        first, t1, t2)
+                    for f, fjobs in zip(followers, jobs["followers"]):
+                        cores[f] += fjobs
+                    cores[leader] += jobs["leader"][:-1]
+                    job = jobs["leader"][-1]
+                if last:
+                    job.cast = [out_cast]
+                cores[leader].append(job)
+                cur = job.prims[-1].outdata
+
+    for cid, jobs in cores.items():
+        allocate_dram(model, jobs)
+
+    config = {
+        "random": False,
+        "vars": b.v.table,
+        "pipeline": ceil_div(iters, dp),
+        "source": [{"dest": replica[0][0], "size": b.BTC}
+                   for replica in groups],
+        "chips": [{"cores": [
+            {"id": cid, "worklist": [j.to_json(model) for j in cores[cid]]}
+            for cid in sorted(cores)]}],
+    }
+    return config, plan_info(model, hw, plan, cores)
+
+
+def map_layer_single(b, pre, cur):
+    """TP = 1：一层全部在一个核上"""
+    m = b.m
+    norm1 = b.norm()
+    norm1.indata, norm1.outdata = "_" + cur, pre + "norm1_out"
+    attn = b.attention_slice(pre, norm1.outdata, False)
+    res1 = b.residual()
+    res1.indata = cur + " " + attn[-1].outdata
+    res1.outdata = pre + "residual1_out"
+    norm2 = b.norm()
+    norm2.indata, norm2.outdata = "_" + res1.outdata, pre + "norm2_out"
+    prims = [norm1] + attn + [res1, norm2]
+    if m.moe:
+        gate = b.gate()
+        gate.indata, gate.outdata = "_" + norm2.outdata, pre + "gate_out"
+        prims.append(gate)
+    ffn = b.ffn_slice(pre, norm2.outdata)
+    res2 = b.residual()
+    res2.indata = res1.outdata + " " + ffn[-1].outdata
+    res2.outdata = pre + "residual2_out"
+    return prims + ffn + [res2]
+
+
+def map_layer_tp(b, pre, cur, followers, leader, first, t1, t2):
+    """TP > 1：leader 广播、各核计算切片、leader 归约，与 qwen3_0.6B/tp_*.json 相同"""
+    m = b.m
+    lead_a = []
+    if cur == "input_label":
+        # 之后接收到的数据同样标记为 input_label，先保存残差输入
+        keep = b.switch()
+        keep.indata, keep.outdata = cur, pre + "residual_in"
+        lead_a.append(keep)
+        cur = keep.outdata
+    norm1 = b.norm()
+    norm1.indata, norm1.outdata = "_" + cur, pre + "norm1_out"
+    split1 = b.split()
+    split1.indata, split1.outdata = norm1.outdata, pre + "split1_out"
+    lead_a += [norm1, split1]
+
+    job_a = Job(1 if first else 0, lead_a)
+    job_a.cast = [{"dest": f} for f in followers]
+    job_b = Job(0, b.attention_slice(pre, split1.outdata, False))
+
+    merge1 = b.merge()
+    merge1.indata = "input_label " + job_b.prims[-1].outdata
+    merge1.outdata = pre + "merge1_out"
+    res1 = b.residual()
+    res1.indata = cur + " " + merge1.outdata
+    res1.outdata = pre + "residual1_out"
+    norm2 = b.norm()
+    norm2.indata, norm2.outdata = "_" + res1.outdata, pre + "norm2_out"
+    lead_c = [merge1, res1, norm2]
+    if m.moe:
+        gate = b.gate()
+        gate.indata, gate.outdata = "_" + norm2.outdata, pre + "gate_out"
+        lead_c.append(gate)
+    split2 = b.split()
+    split2.indata, split2.outdata = norm2.outdata, pre + "split2_out"
+    lead_c.append(split2)
+    job_c = Job(len(followers), lead_c, t1)
+    job_c.cast = [{"dest": f} for f in followers]
+
+    job_d = Job(0, b.ffn_slice(pre, split2.outdata))
+
+    merge2 = b.merge()
+    merge2.indata = "input_label " + job_d.prims[-1].outdata
+    merge2.outdata = pre + "merge2_out"
+    res2 = b.residual()
+    res2.indata = res1.outdata + " " + merge2.outdata
+    res2.outdata = pre + "residual2_out"
+    job_e = Job(len(followers), [merge2, res2], t2)
+
+    follower_jobs = []
+    for f in followers:
+        f1 = Job(1, b.attention_slice(pre, "input_label", False))
+        f1.cast = [{"dest": leader, "tag": t1}]
+        f2 = Job(1, b.ffn_slice(pre, "input_label"))
+        f2.cast = [{"dest": leader, "tag": t2}]
+        follower_jobs.append([f1, f2])
+
+    return {"leader": [job_a, job_b, job_c, job_d, job_e],
+            "followers": follower_jobs}
+
+
+def prim_bytes(model, p):
+    bw = byte_width(model.datatype)
+    inp = sum(p.inputs) * bw
+    data = 0
+    for name, n in p.chunks:
+        if name.startswith("weight") or name.startswith("bias"):
+            data += datatype_bytes(model.weight_datatype, n)
+        else:
+            data += n * bw
+    return inp, data
+
+
+def allocate_dram(model, jobs):
+    """每个核的 DRAM 独立编址，按照 parseAddress() 的 input / data / output 布局顺序分配"""
+    pos = 0
+    for job in jobs:
+        for p in job.prims:
+            inp, data = prim_bytes(model, p)
+            out = p.output_elements() * byte_width(model.datatype)
+            p.dram = {"input": pos, "data": pos + inp,
+                      "output": pos + inp + data}
+            pos += ceil_div(inp + data + out, DRAM_ALIGN) * DRAM_ALIGN
+    if pos >= 1 << 32:
+        print("[WARN] DRAM footprint %d exceeds the 32-bit offset field." % pos)
+    return pos
+
+
+# ---------------- 估计 ----------------
+
+def core_footprint(model, jobs):
+    """核上的权重字节数，以及同一时刻存活的激活值的粗略上限"""
+    weights, peak = 0, 0
+    for job in jobs:
+        live = 0
+        for p in job.prims:
+            weights += datatype_bytes(model.weight_datatype,
+                                      p.weight_elements())
+            live += (sum(p.inputs) + p.output_elements()) * \
+                byte_width(model.datatype)
+        peak = max(peak, live)
+    return weights, peak
+
+
+def plan_info(model, hw, plan, cores):
+    overflow = False
+    for jobs in cores.values():
+        weights, peak = core_footprint(model, jobs)
+        overflow |= weights + peak > hw.sram_size
+    return {"plan": plan.name(), "tp": plan.tp, "pp": plan.pp, "dp": plan.dp,
+            "placement": plan.placement, "cores": len(cores),
+            "sram_overflow": overflow}
+
+
+def run_estimator(config_file, work_dir, opts, sram_size):
+    """用 npu_estimate 估计一个方案的端到端时间，失败时返回 None"""
+    work_dir = sweep.prepare_run_dir(work_dir)
+    cmd = [os.path.abspath(opts.estimator),
+           "--config-file", config_file,
+           "--core-config-file", os.path.abspath(opts.core_config),
+           "--sram-max", str(sram_size), "--df_dram_bw", str(opts.dram_bw),
+           "--headless", "true"]
+    for a in opts.est_arg or []:
+        cmd += a.split("=", 1)
+    proc = subprocess.run(cmd, cwd=work_dir, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, text=True,
+                          timeout=opts.timeout)
+    with open(os.path.join(work_dir, "npu_estimate.log"), "w") as f:
+        f.write(proc.stdout)
+
+    m = re.findall(r"\[ESTIMATE\] end-to-end (\d+) ns", proc.stdout)
+    if proc.returncode != 0 or not m:
+        return None
+    return int(m[-1])
+
+
+def estimate_all(results, hw, opts, est_dir):
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = {pool.submit(run_estimator, r["config_file"],
+                               os.path.join(est_dir, r["plan"]), opts,
+                               hw.sram_size): r for r in results}
+        for fut in as_completed(futures):
+            r = futures[fut]
+            try:
+                r["est_total_ns"] = fut.result()
+            except Exception as e:
+                r["est_total_ns"] = None
+                r["error"] = str(e)
+            if r["est_total_ns"] is None:
+                print("[WARN] npu_estimate failed for %s, see %s" %
+                      (r["plan"], os.path.join(est_dir, r["plan"])))
+
+
+# ---------------- 搜索 ----------------
+
+def candidates(model, hw, opts):
+    tps = [t for t in range(1, hw.size + 1) if model.tp_ok(t)]
+    for tp in tps:
+        if opts.tp and tp != opts.tp:
+            continue
+        for pp in range(1, min(model.layers, hw.size // tp) + 1):
+            if opts.pp and pp != opts.pp:
+                continue
+            for dp in range(1, hw.size // (tp * pp) + 1):
+                if opts.dp and dp != opts.dp:
+                    continue
+                for placement in PLACEMENTS:
+                    if opts.placement and placement != opts.placement:
+                        continue
+                    yield Plan(tp, pp, dp, placement)
+
+
+def write_json(path, j):
+    with open(path, "w") as f:
+        json.dump(j, f, indent=2)
+
+
+def search(model, hw, opts):
+    out_dir = os.path.abspath(opts.output)
+    os.makedirs(out_dir, exist_ok=True)
+
+    results = []
+    for plan in candidates(model, hw, opts):
+        config, info = map_model(model, hw, plan, opts.iters)
+        info["config_file"] = os.path.join(out_dir, plan.name() + ".json")
+        write_json(info["config_file"], config)
+        results.append(info)
+    estimate_all(results, hw, opts, os.path.join(out_dir, "estimate"))
+
+    # SRAM 放不下以及估计失败的方案排在后面
+    results.sort(key=lambda r: (r["sram_overflow"], r["est_total_ns"] is None,
+                                r["est_total_ns"] or 0))
+    print("Search: %d candidate mappings" % len(results))
+    top = [r for r in results[:opts.top_k] if r["est_total_ns"] is not None]
+    for r in top:
+        print("  %-24s est %.3f ms%s" % (r["plan"], r["est_total_ns"] / 1e6,
+                                         " (sram overflow)"
+                                         if r["sram_overflow"] else ""))
+
+    if opts.npusim:
+        simulate(top, opts, out_dir)
+
+    write_json(os.path.join(out_dir, "map_results.json"), results)
+    fields = []
+    for r in results:
+        for k in r:
+            if k not in fields:
+                fields.append(k)
+    with open(os.path.join(out_dir, "map_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(results)
+    print("Results written to " + out_dir)
+
+
+def simulate(top, opts, out_dir):
+    """用 sweep.run_one 在独立的工作目录中仿真 top-k 个方案"""
+    args = {}
+    for a in opts.sim_arg or []:
+        name, _, value = a.partition("=")
+        args[name] = value
+    sim_dir = os.path.join(out_dir, "sim")
+    os.makedirs(sim_dir, exist_ok=True)
+
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = {}
+        for i, r in enumerate(top):
+            spec = {"npusim": os.path.abspath(opts.npusim),
+                    "config_file": r["config_file"],
+                    "core_config_file": os.path.abspath(opts.core_config),
+                    "args": args, "timeout": opts.timeout}
+            futures[pool.submit(sweep.run_one, i, {}, spec, sim_dir)] = r
+        for fut in as_completed(futures):
+            r = futures[fut]
+            try:
+                res = fut.result()
+                r["returncode"] = res["returncode"]
+                r["sim_time_ns"] = res.get("sim_time_ns")
+                r["run_dir"] = res["run_dir"]
+            except Exception as e:
+                r["returncode"] = -1
+                r["error"] = str(e)
+            print("  simulated %-24s sim %s ns" % (r["plan"],
+                                                  r.get("sim_time_ns")))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="map a model onto the core grid and emit a dataflow config")
+    parser.add_argument("model", help="model description json")
+    parser.add_argument("--core-config", required=True,
+                        help="core config json (test/core_configs/*.json)")
+    parser.add_argument("--tp", type=int, help="tensor parallel degree")
+    parser.add_argument("--pp", type=int, help="pipeline parallel degree")
+    parser.add_argument("--dp", type=int, help="data parallel degree")
+    parser.add_argument("--placement", choices=PLACEMENTS,
+                        help="core placement policy")
+    parser.add_argument("--iters", type=int, default=4,
+                        help="number of inputs, split across DP replicas")
+    parser.add_argument("-o", "--output", default="map_out",
+                        help="config file, or result dir in search mode")
+    parser.add_argument("--search", action="store_true",
+                        help="enumerate plans (fixing the given degrees)")
+    parser.add_argument("--top-k", type=int, default=4,
+                        help="number of best estimated plans to keep")
+    parser.add_argument("--estimator", required=True,
+                        help="npu_estimate executable, gives the datatype "
+                             "table and the plan estimates")
+    parser.add_argument("--est-arg", action="append",
+                        help="extra npu_estimate argument, e.g. --est-arg=--dataflow=os")
+    parser.add_argument("--npusim", help="simulate the top-k plans")
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=int, default=None)
+    parser.add_argument("--sram-size", type=int, default=8388608,
+                        help="sram bytes when the core config does not give it")
+    parser.add_argument("--dram-bw", type=float, default=8,
+                        help="per-core dram bytes per ns, same as --df_dram_bw")
+    opts = parser.parse_args()
+
+    load_datatypes(opts.estimator)
+    with open(opts.model) as f:
+        model = Model(json.load(f))
+    with open(opts.core_config) as f:
+        hw = Hardware(json.load(f), opts)
+
+    if opts.search:
+        search(model, hw, opts)
+        return
+
+    plan = Plan(opts.tp or 1, opts.pp or 1, opts.dp or 1,
+                opts.placement or "snake")
+    config, info = map_model(model, hw, plan, opts.iters)
+    write_json(opts.output, config)
+    info["config_file"] = os.path.abspath(opts.output)
+    estimate_all([info], hw, opts, os.path.join(
+        os.path.dirname(info["config_file"]), "estimate"))
+    est = info["est_total_ns"]
+    print("Mapped %s (%s) onto %d cores, estimated %s -> %s" %
+          (model.name, plan.name(), info["cores"],
+           "%.3f ms" % (est / 1e6) if est is not None else "n/a",
+           opts.output))
+
+
+if __name__ == "__main__":
+    main()
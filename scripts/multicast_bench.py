@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# 片上网络多播的收益评估：同一组配置分别以 --noc-multicast true / false 运行 npusim，
+# 从 stats_summary.csv 中汇总核注入的flit数、路由器链路上传输的flit数与多播复制次数，
+# 对比注入流量、链路流量与仿真时间的变化
+#
+# 用法：
+#   python3 multicast_bench.py --core-config ../llm/test/core_configs/core_4x4.json \
+#       --npusim ../build/npusim -o multicast_out \
+#       ../llm/test/gpt2_small/tp_4.json ../llm/test/gpt2_small/tp_8.json
+
+import argparse
+import csv
+import json
+import os
+from concurrent.futures import ProcessPoolExecutor
+
+import sweep
+
+
+def read_counters(run_dir):
+    """汇总 stats_summary.csv 中与多播相关的计数器"""
+    totals = {"injected_flits": 0, "link_flits": 0, "mcast_copies": 0}
+    path = os.path.join(run_dir, "build", "stats_summary.csv")
+    if not os.path.exists(path):
+        return totals
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            if row["type"] != "counter":
+                continue
+            name, value = row["name"], int(float(row["value"]))
+            if name.startswith("core") and name.endswith(".injected_flits"):
+                totals["injected_flits"] += value
+            elif name.startswith("router") and name.endswith(".flits"):
+                totals["link_flits"] += value
+            elif name.startswith("router") and name.endswith(".mcast_copies"):
+                totals["mcast_copies"] += value
+    return totals
+
+
+def run_config(index, config, multicast, opts, args, out_dir):
+    spec = {"npusim": os.path.abspath(opts.npusim),
+            "config_file": os.path.abspath(config),
+            "core_config_file": os.path.abspath(opts.core_config),
+            "args": args, "timeout": opts.timeout}
+    result = sweep.run_one(index, {"--noc-multicast": multicast}, spec, out_dir)
+    result["config"] = config
+    result.update(read_counters(result["run_dir"]))
+    return result
+
+
+def ratio(a, b):
+    if a is None or not b:
+        return None
+    return round(a / b, 4)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="NoC multicast vs unicast")
+    parser.add_argument("configs", nargs="+", help="dataflow config files")
+    parser.add_argument("--core-config", required=True)
+    parser.add_argument("--npusim", required=True)
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-o", "--out-dir", default="multicast_out")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=int, default=None)
+    opts = parser.parse_args()
+
+    args = {}
+    for a in opts.sim_arg or []:
+        name, _, value = a.partition("=")
+        args[name] = value
+
+    out_dir = os.path.abspath(opts.out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+    jobs = []
+    for config in opts.configs:
+        for multicast in (False, True):
+            jobs.append((len(jobs), config, multicast))
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = [pool.submit(run_config, i, c, m, opts, args, out_dir)
+                   for i, c, m in jobs]
+        results = [f.result() for f in futures]
+
+    # 以单播的结果为基准
+    print("%-40s %10s %10s %12s %14s" % ("config", "injected", "link",
+                                         "mcast_copies", "sim_time"))
+    rows = []
+    for config in opts.configs:
+        base = next(r for r in results
+                    if r["config"] == config and not r["--noc-multicast"])
+        mcast = next(r for r in results
+                     if r["config"] == config and r["--noc-multicast"])
+        row = {"config": config,
+               "unicast_injected_flits": base["injected_flits"],
+               "multicast_injected_flits": mcast["injected_flits"],
+               "injected_ratio": ratio(mcast["injected_flits"], base["injected_flits"]),
+               "unicast_link_flits": base["link_flits"],
+               "multicast_link_flits": mcast["link_flits"],
+               "link_ratio": ratio(mcast["link_flits"], base["link_flits"]),
+               "mcast_copies": mcast["mcast_copies"],
+               "unicast_sim_time_ns": base.get("sim_time_ns"),
+               "multicast_sim_time_ns": mcast.get("sim_time_ns"),
+               "sim_time_ratio": ratio(mcast.get("sim_time_ns"),
+                                       base.get("sim_time_ns"))}
+        rows.append(row)
+        print("%-40s %10s %10s %12s %14s" % (os.path.basename(config),
+                                             row["injected_ratio"],
+                                             row["link_ratio"],
+                                             row["mcast_copies"],
+                                             row["sim_time_ratio"]))
+
+    with open(os.path.join(out_dir, "multicast_results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    with open(os.path.join(out_dir, "multicast_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        writer.writerows(rows)
+    print("Results written to " + out_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+# 片上网络路由算法与虚通道数的对比：同一组配置分别以不同的 --noc-routing / --noc-vcs 运行 npusim，
+# 从 stats_summary.csv 中汇总每条链路的flit数与等待时间直方图，
+# 输出最忙链路的利用率、平均与最大链路等待时间、router停顿周期与仿真时间
+#
+# 用法：
+#   python3 noc_bench.py --core-config ../llm/test/core_configs/core_4x4.json \
+#       --npusim ../build/npusim --routings xy,west_first,odd_even,o1turn \
+#       --vcs 1,2,4 -o noc_out ../llm/test/gpt2_small/tp_8.json
+
+import argparse
+import csv
+import json
+import os
+import re
+from concurrent.futures import ProcessPoolExecutor
+
+import sweep
+
+LINK_RE = re.compile(r"router(\d+)\.link_(\w+)\.(flits|wait)$")
+
+
+def read_links(run_dir):
+    """读取每条链路的flit数与等待时间，以及全部router的停顿周期"""
+    links = {}
+    stalls = 0
+    path = os.path.join(run_dir, "build", "stats_summary.csv")
+    if not os.path.exists(path):
+        return links, stalls
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            name = row["name"]
+            if name.startswith("router") and name.endswith(".stalls"):
+                stalls += int(float(row["value"]))
+                continue
+            m = LINK_RE.match(name)
+            if not m:
+                continue
+            link = links.setdefault((int(m.group(1)), m.group(2)), {})
+            if m.group(3) == "flits":
+                link["flits"] = int(float(row["value"]))
+            else:
+                link["count"] = int(float(row["value"]))
+                link["mean"] = float(row["mean"] or 0)
+                link["max"] = float(row["max"] or 0)
+    return links, stalls
+
+
+def summarize(result, cycle_ns):
+    links, stalls = read_links(result["run_dir"])
+    result["router_stalls"] = stalls
+    sim_time = result.get("sim_time_ns")
+    busy = [l for l in links.values() if l.get("flits")]
+    if not busy:
+        return result
+
+    hottest = max(links.items(), key=lambda kv: kv[1].get("flits", 0))
+    result["hottest_link"] = "router%d.%s" % hottest[0]
+    result["links_used"] = len(busy)
+    if sim_time:
+        result["max_link_util"] = round(
+            hottest[1]["flits"] * cycle_ns / sim_time, 4)
+        result["mean_link_util"] = round(
+            sum(l["flits"] for l in busy) * cycle_ns / sim_time / len(busy), 4)
+    count = sum(l.get("count", 0) for l in busy)
+    if count:
+        result["mean_link_wait_ns"] = round(
+            sum(l.get("count", 0) * l.get("mean", 0) for l in busy) / count, 3)
+    result["max_link_wait_ns"] = max(l.get("max", 0) for l in busy)
+    return result
+
+
+def run_config(index, config, combo, opts, args, out_dir):
+    spec = {"npusim": os.path.abspath(opts.npusim),
+            "config_file": os.path.abspath(config),
+            "core_config_file": os.path.abspath(opts.core_config),
+            "args": args, "timeout": opts.timeout}
+    result = sweep.run_one(index, combo, spec, out_dir)
+    result["config"] = config
+    return summarize(result, opts.cycle_ns)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="NoC routing / VC comparison")
+    parser.add_argument("configs", nargs="+", help="config files")
+    parser.add_argument("--core-config", required=True)
+    parser.add_argument("--npusim", required=True)
+    parser.add_argument("--routings", default="xy,west_first,odd_even,o1turn")
+    parser.add_argument("--vcs", default="1,2,4",
+                        help="comma separated --noc-vcs values")
+    parser.add_argument("--cycle-ns", type=float, default=2,
+                        help="router cycle (CYCLE in macros.h)")
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-o", "--out-dir", default="noc_out")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=int, default=None)
+    opts = parser.parse_args()
+
+    args = {}
+    for a in opts.sim_arg or []:
+        name, _, value = a.partition("=")
+        args[name] = value
+
+    # o1turn 至少需要两个虚通道
+    combos = []
+    for routing in opts.routings.split(","):
+        for vcs in opts.vcs.split(","):
+            if routing == "o1turn" and int(vcs) < 2:
+                continue
+            combos.append({"--noc-routing": routing, "--noc-vcs": int(vcs)})
+
+    out_dir = os.path.abspath(opts.out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+    jobs = [(c, combo) for c in opts.configs for combo in combos]
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = [pool.submit(run_config, i, c, combo, opts, args, out_dir)
+                   for i, (c, combo) in enumerate(jobs)]
+        results = [f.result() for f in futures]
+
+    # 以 xy + 1个虚通道（原有的router）为基准
+    print("%-24s %-11s %4s %14s %8s %9s %9s %8s" % (
+        "config", "routing", "vcs", "sim_time(ns)", "speedup", "max_util",
+        "mean_wait", "stalls"))
+    for r in results:
+        base = next((b for b in results if b["config"] == r["config"] and
+                     b["--noc-routing"] == "xy" and b["--noc-vcs"] == 1), None)
+        if base and base.get("sim_time_ns") and r.get("sim_time_ns"):
+            r["speedup"] = round(base["sim_time_ns"] / r["sim_time_ns"], 4)
+        print("%-24s %-11s %4d %14s %8s %9s %9s %8s" % (
+            os.path.basename(r["config"]), r["--noc-routing"], r["--noc-vcs"],
+            r.get("sim_time_ns"), r.get("speedup"), r.get("max_link_util"),
+            r.get("mean_link_wait_ns"), r.get("router_stalls")))
+
+    with open(os.path.join(out_dir, "noc_results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    fields = ["config", "--noc-routing", "--noc-vcs", "sim_time_ns", "speedup",
+              "hottest_link", "max_link_util", "mean_link_util", "links_used",
+              "mean_link_wait_ns", "max_link_wait_ns", "router_stalls",
+              "wall_seconds", "returncode", "run_dir"]
+    with open(os.path.join(out_dir, "noc_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+    print("Results written to " + out_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+# 分区并行仿真的扩展性基准：同一个多芯片配置（需要 "link" 条目）先以默认方式
+# （不加 --parallel-chips，各分区依次推进）运行一次作为参考，再分别以
+# --parallel-jobs 1, 2, 4, ..., P 运行 npusim --parallel-chips，
+# 记录墙钟时间与加速比。两种方式使用同一个逐跳预约的链路模型并仿真所有芯片的核，
+# 因此各分区的结束时间、统计汇总与链路统计必须与参考结果完全一致
+#
+# 用法：
+#   python3 parallel_bench.py --config ../llm/test/multi_chip.json \
+#       --core-config ../llm/test/core_configs/core_4x4.json \
+#       --npusim ../build/npusim --jobs 1,2,4 -o parallel_out
+
+import argparse
+import csv
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+import sweep
+
+
+def read_csv(path):
+    if not os.path.exists(path):
+        return None
+    with open(path) as f:
+        return list(csv.DictReader(f))
+
+
+def link_stats(work_dir, chips):
+    """合并各分区的链路统计，每条链路只由一个分区预约"""
+    merged = {}
+    for k in range(chips):
+        rows = read_csv(os.path.join(work_dir, "partition_%d" % k, "build",
+                                     "link_stats.csv")) or []
+        for r in rows:
+            if int(r["bytes"]):
+                merged[r["link"]] = (r["bytes"], r["packets"], r["flits"])
+    return merged
+
+
+def partition_stats(work_dir, chips):
+    """各分区的 stats_summary.csv"""
+    return [read_csv(os.path.join(work_dir, "partition_%d" % k, "build",
+                                  "stats_summary.csv"))
+            for k in range(chips)]
+
+
+def run(opts, jobs, out_dir, args):
+    """jobs为None时不加 --parallel-chips，即默认的依次推进"""
+    name = "jobs_%d" % jobs if jobs else "default"
+    work_dir = sweep.prepare_run_dir(os.path.join(out_dir, name))
+    cmd = [os.path.abspath(opts.npusim),
+           "--config-file", os.path.abspath(opts.config),
+           "--core-config-file", os.path.abspath(opts.core_config)] + args
+    if jobs:
+        cmd += ["--parallel-chips", "true", "--parallel-jobs", str(jobs)]
+    t0 = time.time()
+    proc = subprocess.run(cmd, cwd=work_dir, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, text=True,
+                          timeout=opts.timeout)
+    wall = time.time() - t0
+    with open(os.path.join(work_dir, "npusim.log"), "w") as f:
+        f.write(proc.stdout)
+
+    m = re.search(r"\[PARALLEL\] windows (\d+)", proc.stdout)
+    return {"jobs": jobs or 0, "returncode": proc.returncode,
+            "wall_s": round(wall, 3),
+            "windows": int(m.group(1)) if m else None,
+            "partitions": read_csv(os.path.join(work_dir,
+                                                "parallel_summary.csv")),
+            "work_dir": work_dir}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="parallel chip simulation scaling")
+    parser.add_argument("--config", required=True, help="multi-chip config json")
+    parser.add_argument("--core-config", required=True)
+    parser.add_argument("--npusim", required=True)
+    parser.add_argument("--jobs", help="comma separated, default 1,2,4,...,P")
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-o", "--out-dir", default="parallel_out")
+    parser.add_argument("--timeout", type=int, default=None)
+    opts = parser.parse_args()
+
+    with open(opts.config) as f:
+        chips = len(json.load(f).get("chips", []))
+    if opts.jobs:
+        job_list = [int(j) for j in opts.jobs.split(",")]
+    else:
+        job_list, j = [], 1
+        while j < chips:
+            job_list.append(j)
+            j *= 2
+        job_list.append(chips)
+
+    args = []
+    for a in opts.sim_arg or []:
+        args += a.split("=", 1)
+
+    out_dir = os.path.abspath(opts.out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+
+    results = []
+    for jobs in [None] + job_list:
+        r = run(opts, jobs, out_dir, args)
+        r["links"] = link_stats(r["work_dir"], chips)
+        r["stats"] = partition_stats(r["work_dir"], chips)
+        results.append(r)
+
+    # 默认运行为参考结果，jobs列为0
+    ref = results[0]
+    ref_end = [p["end_ns"] for p in ref["partitions"] or []]
+    print("%6s %10s %10s %10s %12s" % ("jobs", "wall(s)", "speedup", "windows",
+                                       "identical"))
+    for r in results:
+        end = [p["end_ns"] for p in r["partitions"] or []]
+        r["identical"] = (r["returncode"] == 0 and bool(end) and
+                          end == ref_end and r["links"] == ref["links"] and
+                          r["stats"] == ref["stats"])
+        r["speedup"] = round(ref["wall_s"] / r["wall_s"], 3) if r["wall_s"] else None
+        print("%6d %10.3f %10s %10s %12s" % (r["jobs"], r["wall_s"], r["speedup"],
+                                             r["windows"], r["identical"]))
+
+    with open(os.path.join(out_dir, "parallel_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=["jobs", "wall_s", "speedup",
+                                               "windows", "identical",
+                                               "returncode", "work_dir"],
+                                extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+    print("Results written to " + out_dir)
+    if not all(r["identical"] for r in results):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+# 原语执行记录分析脚本（输入为 npusim --prim-records 写出的csv）：
+# 1. 按照 send/recv 的 tag 匹配跨核依赖（core S 上 tag=T、des=D 的 SEND_DATA
+#    对应 core D 上 tag=T 的 recv），与核内的顺序依赖一起构成依赖图
+# 2. 从最后结束的原语开始反向回溯，每一步选择最晚结束的前驱，得到关键路径
+# 3. 计算每条计算原语在 roofline 中的位置（算术强度、理论上限、实际达到的算力）
+# 4. 汇总关键路径上耗时最多的原语，以及效率最低的原语
+#
+# 用法：python3 prim_analyzer.py prim_records.csv [--loop 3] [--top 10] [-o out]
+
+import argparse
+import csv
+import math
+import os
+import sys
+from collections import defaultdict
+
+INT_FIELDS = ["core", "start_ns", "end_ns", "exu_ops", "sfu_ops", "compute_ns",
+              "dram_bytes", "dram_time_ns", "spill_bytes", "recv_wait_ns",
+              "tag", "peer", "loop_cnt"]
+
+
+def load_records(path):
+    records = []
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            for k in INT_FIELDS:
+                row[k] = int(row[k])
+            row["ops"] = row["exu_ops"] + row["sfu_ops"]
+            row["duration"] = row["end_ns"] - row["start_ns"]
+            records.append(row)
+    return records
+
+
+def select_records(records, opts):
+    """按照循环次数或时间窗口选出一次迭代"""
+    selected = records
+    if opts.loop is not None:
+        selected = [r for r in selected if r["loop_cnt"] == opts.loop]
+    if opts.start is not None:
+        selected = [r for r in selected if r["start_ns"] >= opts.start]
+    if opts.end is not None:
+        selected = [r for r in selected if r["end_ns"] <= opts.end]
+    return selected
+
+
+def build_graph(records):
+    """为每个记录填写 prev（核内前一条原语）与 deps（跨核的 send）"""
+    by_core = defaultdict(list)
+    for r in records:
+        by_core[r["core"]].append(r)
+    for rs in by_core.values():
+        rs.sort(key=lambda r: (r["start_ns"], r["end_ns"]))
+        for i, r in enumerate(rs):
+            r["prev"] = rs[i - 1] if i > 0 else None
+            r["deps"] = []
+
+    # 尚未被接收的 SEND_DATA，按照 (目的核, tag) 分组，按结束时间排序
+    pending = defaultdict(list)
+    for r in records:
+        if r["kind"] == "send" and r["name"] == "SEND_DATA":
+            pending[(r["peer"], r["tag"])].append(r)
+    for sends in pending.values():
+        sends.sort(key=lambda r: r["end_ns"])
+
+    unmatched = 0
+    for r in sorted(records, key=lambda r: r["end_ns"]):
+        if r["kind"] != "recv" or r["name"] == "RECV_ACK":
+            continue
+        sends = pending.get((r["core"], r["tag"]), [])
+        # 一个recv原语可以接收多个发送方的数据，所有在其结束前完成的send都视为依赖
+        while sends and sends[0]["end_ns"] <= r["end_ns"]:
+            r["deps"].append(sends.pop(0))
+        if not r["deps"] and r["name"] == "RECV_DATA":
+            unmatched += 1
+
+    edges = sum(len(r["deps"]) for r in records)
+    return edges, unmatched
+
+
+def critical_path(records):
+    """从最后结束的原语反向回溯，每一步走向最晚结束的前驱"""
+    if not records:
+        return []
+
+    node = max(records, key=lambda r: r["end_ns"])
+    path = []
+    while node is not None:
+        preds = list(node["deps"])
+        if node["prev"] is not None:
+            preds.append(node["prev"])
+        pred = max(preds, key=lambda r: r["end_ns"]) if preds else None
+
+        # 该原语在关键路径上贡献的时间：从前驱结束（或自身开始）到自身结束
+        begin = node["start_ns"]
+        if pred is not None:
+            begin = max(begin, min(pred["end_ns"], node["end_ns"]))
+        node["critical_ns"] = node["end_ns"] - begin
+        node["cross_core"] = pred is not None and pred["core"] != node["core"]
+
+        path.append(node)
+        node = pred
+
+    path.reverse()
+    return path
+
+
+def roofline(records, opts):
+    """每个核的峰值算力由 ops/compute_ns 推算，带宽由 dram_bytes/dram_time_ns 推算，
+    也可以通过命令行参数直接给出"""
+    peak = defaultdict(float)
+    bw = defaultdict(float)
+    for r in records:
+        if r["kind"] != "comp":
+            continue
+        if r["compute_ns"] > 0 and r["exu_ops"] > 0:
+            peak[r["core"]] = max(peak[r["core"]], r["ops"] / r["compute_ns"])
+        if r["dram_time_ns"] > 0 and r["dram_bytes"] > 0:
+            bw[r["core"]] = max(bw[r["core"]], r["dram_bytes"] / r["dram_time_ns"])
+
+    points = []
+    for r in records:
+        if r["kind"] != "comp" or r["ops"] == 0:
+            continue
+        p = opts.peak_ops or peak[r["core"]]
+        b = opts.dram_bw or bw[r["core"]]
+        if p <= 0:
+            continue
+
+        intensity = r["ops"] / r["dram_bytes"] if r["dram_bytes"] else math.inf
+        ridge = p / b if b > 0 else 0
+        attainable = min(p, intensity * b) if b > 0 else p
+        achieved = r["ops"] / r["duration"] if r["duration"] > 0 else 0
+
+        r["intensity"] = intensity
+        r["bound"] = "compute" if intensity >= ridge else "memory"
+        r["attainable"] = attainable
+        r["achieved"] = achieved
+        r["efficiency"] = achieved / attainable if attainable > 0 else 0
+        points.append(r)
+    return points
+
+
+def print_table(title, header, rows):
+    widths = [max(len(str(x)) for x in col) for col in zip(header, *rows)]
+    print("\n" + title)
+    print("  ".join(str(h).ljust(w) for h, w in zip(header, widths)))
+    for row in rows:
+        print("  ".join(str(x).ljust(w) for x, w in zip(row, widths)))
+
+
+def fmt(v):
+    if v == math.inf:
+        return "inf"
+    return "%.3g" % v
+
+
+def report(records, path, points, opts):
+    total = path[-1]["end_ns"] - path[0]["start_ns"] if path else 0
+    print("Records: %d, cores: %d, critical path: %d prims, %d ns" %
+          (len(records), len(set(r["core"] for r in records)), len(path), total))
+
+    # 关键路径按原语类型汇总
+    by_name = defaultdict(lambda: [0, 0, 0])
+    for r in path:
+        key = (r["kind"], r["name"])
+        by_name[key][0] += 1
+        by_name[key][1] += r["critical_ns"]
+        by_name[key][2] += r["recv_wait_ns"]
+    rows = sorted(by_name.items(), key=lambda kv: -kv[1][1])[:opts.top]
+    print_table("Top bottlenecks on the critical path",
+                ["kind", "name", "count", "critical_ns", "share", "recv_wait_ns"],
+                [[k[0], k[1], v[0], v[1], "%.1f%%" % (100.0 * v[1] / total if total else 0), v[2]]
+                 for k, v in rows])
+
+    # 关键路径上单条耗时最多的原语
+    rows = sorted(path, key=lambda r: -r["critical_ns"])[:opts.top]
+    print_table("Longest prims on the critical path",
+                ["core", "kind", "name", "start_ns", "critical_ns", "bound", "spill_bytes"],
+                [[r["core"], r["kind"], r["name"], r["start_ns"], r["critical_ns"],
+                  r.get("bound", "-"), r["spill_bytes"]] for r in rows])
+
+    # roofline：按原语名汇总，按照损失的时间排序
+    agg = defaultdict(lambda: {"count": 0, "time": 0, "ops": 0, "bytes": 0, "lost": 0.0,
+                               "memory": 0})
+    for r in points:
+        a = agg[r["name"]]
+        a["count"] += 1
+        a["time"] += r["duration"]
+        a["ops"] += r["ops"]
+        a["bytes"] += r["dram_bytes"]
+        a["lost"] += r["duration"] * (1 - min(r["efficiency"], 1.0))
+        a["memory"] += r["bound"] == "memory"
+    rows = sorted(agg.items(), key=lambda kv: -kv[1]["lost"])[:opts.top]
+    print_table("Roofline summary (sorted by time lost to the roofline bound)",
+                ["name", "count", "time_ns", "intensity", "memory_bound", "lost_ns"],
+                [[n, a["count"], a["time"],
+                  fmt(a["ops"] / a["bytes"] if a["bytes"] else math.inf),
+                  "%d/%d" % (a["memory"], a["count"]), int(a["lost"])]
+                 for n, a in rows])
+
+
+def write_outputs(out, path, points):
+    os.makedirs(os.path.dirname(os.path.abspath(out)) or ".", exist_ok=True)
+
+    with open(out + "_critical_path.csv", "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["core", "kind", "name", "start_ns", "end_ns", "critical_ns",
+                    "cross_core", "tag"])
+        for r in path:
+            w.writerow([r["core"], r["kind"], r["name"], r["start_ns"], r["end_ns"],
+                        r["critical_ns"], int(r["cross_core"]), r["tag"]])
+
+    with open(out + "_roofline.csv", "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["core", "name", "start_ns", "ops", "dram_bytes", "intensity",
+                    "bound", "attainable_ops_per_ns", "achieved_ops_per_ns",
+                    "efficiency"])
+        for r in points:
+            w.writerow([r["core"], r["name"], r["start_ns"], r["ops"], r["dram_bytes"],
+                        fmt(r["intensity"]), r["bound"], fmt(r["attainable"]),
+                        fmt(r["achieved"]), fmt(r["efficiency"])])
+
+    print("\nCritical path and roofline written to %s_*.csv" % out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="npusim prim record analyzer")
+    parser.add_argument("records", help="csv written by npusim --prim-records")
+    parser.add_argument("--loop", type=int, help="only analyze records of this loop_cnt")
+    parser.add_argument("--start", type=int, help="window start (ns)")
+    parser.add_argument("--end", type=int, help="window end (ns)")
+    parser.add_argument("--peak-ops", type=float, default=0,
+                        help="peak ops per ns of a core, inferred from records if not given")
+    parser.add_argument("--dram-bw", type=float, default=0,
+                        help="dram bytes per ns of a core, inferred from records if not given")
+    parser.add_argument("--top", type=int, default=10, help="number of bottlenecks to print")
+    parser.add_argument("-o", "--out", help="prefix of the critical path / roofline csv")
+    opts = parser.parse_args()
+
+    records = select_records(load_records(opts.records), opts)
+    if not records:
+        sys.exit("[ERROR] No prim records in the selected range.")
+
+    edges, unmatched = build_graph(records)
+    print("Cross-core dependencies: %d, unmatched RECV_DATA: %d" % (edges, unmatched))
+
+    path = critical_path(records)
+    points = roofline(records, opts)
+    report(records, path, points, opts)
+
+    if opts.out:
+        write_outputs(opts.out, path, points)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# 采样仿真的误差检查：同一个配置分别做一次完整仿真（--sample-warmup 0）与若干次采样仿真，
+# 对比仿真时间的误差与墙钟时间的加速比
+#
+# 用法：
+#   python3 sampling_check.py --config ../llm/test/chores/dataflow_tp.json \
+#       --core-config ../llm/test/core_configs/core_4x4.json \
+#       --npusim ../build/npusim --warmups 1,2,4 -o sampling_out
+
+import argparse
+import csv
+import json
+import os
+from concurrent.futures import ProcessPoolExecutor
+
+import sweep
+
+
+def main():
+    parser = argparse.ArgumentParser(description="sampled vs full simulation")
+    parser.add_argument("--config", required=True)
+    parser.add_argument("--core-config", required=True)
+    parser.add_argument("--npusim", required=True)
+    parser.add_argument("--warmups", default="1,2,4",
+                        help="comma separated --sample-warmup values")
+    parser.add_argument("--revalidate", type=int, default=16)
+    parser.add_argument("--sim-arg", action="append",
+                        help="extra npusim argument, e.g. --sim-arg=--df_dram_bw=16")
+    parser.add_argument("-o", "--out-dir", default="sampling_out")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=int, default=None)
+    opts = parser.parse_args()
+
+    args = {"--sample-revalidate": opts.revalidate}
+    for a in opts.sim_arg or []:
+        name, _, value = a.partition("=")
+        args[name] = value
+
+    spec = {"npusim": os.path.abspath(opts.npusim),
+            "config_file": os.path.abspath(opts.config),
+            "core_config_file": os.path.abspath(opts.core_config),
+            "args": args, "timeout": opts.timeout}
+    combos = [{"--sample-warmup": 0}]
+    combos += [{"--sample-warmup": int(w)} for w in opts.warmups.split(",")]
+
+    out_dir = os.path.abspath(opts.out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = [pool.submit(sweep.run_one, i, c, spec, out_dir)
+                   for i, c in enumerate(combos)]
+        results = [f.result() for f in futures]
+
+    full = results[0]
+    print("%8s %14s %10s %10s %10s" % ("warmup", "sim_time(ns)", "error",
+                                       "wall(s)", "speedup"))
+    for r in results:
+        t, t0 = r.get("sim_time_ns"), full.get("sim_time_ns")
+        if t is not None and t0:
+            r["error"] = round((t - t0) / t0, 6)
+        if r.get("wall_seconds"):
+            r["speedup"] = round(full["wall_seconds"] / r["wall_seconds"], 3)
+        print("%8d %14s %10s %10s %10s" % (r["--sample-warmup"], t,
+                                           r.get("error"), r.get("wall_seconds"),
+                                           r.get("speedup")))
+
+    with open(os.path.join(out_dir, "sampling_results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    fields = ["--sample-warmup", "sim_time_ns", "error", "wall_seconds",
+              "speedup", "returncode", "run_dir"]
+    with open(os.path.join(out_dir, "sampling_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+    print("Results written to " + out_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+# 参数扫描脚本：
+# 1. 读取扫描描述文件（json），按照 cartesian / zip 的方式展开参数组合
+# 2. 每一组参数在独立的工作目录中运行 npusim，日志与结果文件互不干扰
+# 3. 多进程并行执行
+# 4. 汇总每次运行的指标到 sweep_results.csv / sweep_results.json
+#
+# 扫描描述文件示例（见 scripts/sweep_example.json）：
+# {
+#     "npusim": "../build/npusim",
+#     "config_file": "../llm/test/config_pds.json",
+#     "core_config_file": "../llm/test/core_configs/core_4x4.json",
+#     "mode": "cartesian",
+#     "args": {"--use-dramsys": "true"},
+#     "params": {
+#         "--sram-max": [4194304, 8388608],
+#         "--df_dram_bw": [8, 16],
+#         "config:requests.batch_size": [1, 2]
+#     }
+# }
+# 以 "--" 开头的参数直接传给 npusim；批量运行默认加上 --headless，不绘图也不写VCD；
+# 以 "config:" / "core_config:" 开头的参数按点分路径改写对应的 json 文件，写入运行目录。
+#
+# 用法：python3 sweep.py sweep.json -j 8 -o sweep_out
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+from concurrent.futures import ProcessPoolExecutor, as_completed
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+CONFIG_PREFIX = "config:"
+CORE_CONFIG_PREFIX = "core_config:"
+
+
+def expand_params(params, mode):
+    """展开参数组合，返回 [{name: value}, ...]"""
+    names = list(params.keys())
+    values = [params[n] if isinstance(params[n], list) else [params[n]] for n in names]
+
+    if mode == "cartesian":
+        combos = itertools.product(*values)
+    elif mode == "zip":
+        lengths = set(len(v) for v in values)
+        if len(lengths) > 1:
+            sys.exit("[ERROR] zip mode requires all parameter lists to have the same length.")
+        combos = zip(*values)
+    else:
+        sys.exit("[ERROR] Unknown sweep mode: " + mode)
+
+    return [dict(zip(names, c)) for c in combos]
+
+
+def set_json_path(j, path, value):
+    """按照 a.b.0.c 的路径改写 json 中的字段"""
+    keys = path.split(".")
+    node = j
+    for k in keys[:-1]:
+        node = node[int(k)] if isinstance(node, list) else node[k]
+    last = keys[-1]
+    if isinstance(node, list):
+        node[int(last)] = value
+    else:
+        node[last] = value
+
+
+def patch_json(src, overrides, dst):
+    with open(src) as f:
+        j = json.load(f)
+    for path, value in overrides.items():
+        set_json_path(j, path, value)
+    with open(dst, "w") as f:
+        json.dump(j, f, indent=4)
+
+
+def prepare_run_dir(run_dir):
+    """npusim 以 ../DRAMSys/configs 与 ../font 的相对路径工作，且日志写在当前目录下。
+    DRAMSys 配置在运行时只读（推导配置保存在内存中），因此直接共享，工作目录为 run_dir/build"""
+    if os.path.exists(run_dir):
+        shutil.rmtree(run_dir)
+    os.makedirs(os.path.join(run_dir, "build"))
+    os.symlink(os.path.join(REPO_ROOT, "DRAMSys"), os.path.join(run_dir, "DRAMSys"))
+    os.symlink(os.path.join(REPO_ROOT, "font"), os.path.join(run_dir, "font"))
+    return os.path.join(run_dir, "build")
+
+
+def parse_time(text):
+    """将 systemc 的时间字符串（如 '123 ns'）转为 ns"""
+    units = {"fs": 1e-6, "ps": 1e-3, "ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    m = re.match(r"([\d.eE+-]+)\s*(fs|ps|ns|us|ms|s)", text.strip())
+    if not m:
+        return None
+    return float(m.group(1)) * units[m.group(2)]
+
+
+def collect_metrics(work_dir, stdout):
+    metrics = {}
+
+    m = re.findall(r"\[CATCH TEST\]\s*([\d.eE+-]+\s*[a-z]+)", stdout)
+    if m:
+        metrics["sim_time_ns"] = parse_time(m[-1])
+
+    # npu_estimate 的一阶估计结果
+    m = re.findall(r"\[ESTIMATE\] end-to-end (\d+) ns", stdout)
+    if m:
+        metrics["estimate_ns"] = int(m[-1])
+
+    m = re.findall(r"花费了([\d.]+)秒", stdout)
+    if m:
+        metrics["host_seconds"] = float(m[-1])
+
+    # pd serving 模式下，根据 token_records.txt 计算首token时间与平均token间隔
+    token_file = os.path.join(work_dir, "token_records.txt")
+    if os.path.exists(token_file):
+        reqs = []
+        with open(token_file) as f:
+            for line in f:
+                if line.startswith("Request"):
+                    reqs.append([])
+                elif line.startswith("Token") and reqs:
+                    reqs[-1].append(float(line.split(":")[1]))
+        ttft = [r[0] for r in reqs if r]
+        tpot = [(r[-1] - r[0]) / (len(r) - 1) for r in reqs if len(r) > 1]
+        if ttft:
+            metrics["requests"] = len(reqs)
+            metrics["avg_first_token"] = sum(ttft) / len(ttft)
+        if tpot:
+            metrics["avg_token_interval"] = sum(tpot) / len(tpot)
+
+    # 所有核的spill与重新读入字节数，用于比较 --spill-policy
+    stats_file = os.path.join(work_dir, "stats.csv")
+    if os.path.exists(stats_file):
+        with open(stats_file) as f:
+            for row in csv.DictReader(f):
+                for name in ("spill_bytes", "reload_bytes"):
+                    if re.match(r"core\d+\." + name + "$", row["name"]):
+                        metrics[name] = metrics.get(name, 0) + int(row["value"])
+
+    return metrics
+
+
+def run_one(index, combo, spec, out_dir):
+    run_dir = os.path.join(out_dir, "run_%04d" % index)
+    work_dir = prepare_run_dir(run_dir)
+
+    config_overrides = {}
+    core_config_overrides = {}
+    args = dict(spec.get("args", {}))
+    args.setdefault("--headless", True)
+    for name, value in combo.items():
+        if name.startswith(CONFIG_PREFIX):
+            config_overrides[name[len(CONFIG_PREFIX):]] = value
+        elif name.startswith(CORE_CONFIG_PREFIX):
+            core_config_overrides[name[len(CORE_CONFIG_PREFIX):]] = value
+        else:
+            args[name] = value
+
+    config_file = spec.get("config_file")
+    if config_file and config_overrides:
+        patched = os.path.join(run_dir, "config.json")
+        patch_json(config_file, config_overrides, patched)
+        config_file = patched
+    if config_file:
+        args["--config-file"] = config_file
+
+    core_config_file = spec.get("core_config_file")
+    if core_config_file and core_config_overrides:
+        patched = os.path.join(run_dir, "core_config.json")
+        patch_json(core_config_file, core_config_overrides, patched)
+        core_config_file = patched
+    if core_config_file:
+        args["--core-config-file"] = core_config_file
+
+    cmd = [spec["npusim"]]
+    for name, value in args.items():
+        if isinstance(value, bool):
+            value = "true" if value else "false"
+        cmd += [name, str(value)]
+
+    start = time.time()
+    with open(os.path.join(run_dir, "stdout.log"), "w") as log:
+        proc = subprocess.run(cmd, cwd=work_dir, stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT, text=True,
+                              timeout=spec.get("timeout"))
+        log.write(proc.stdout)
+
+    result = {"run": index, "run_dir": run_dir, "returncode": proc.returncode,
+              "wall_seconds": round(time.time() - start, 3)}
+    result.update(combo)
+    result.update(collect_metrics(work_dir, proc.stdout))
+    return result
+
+
+def resolve(path, base):
+    if path is None or os.path.isabs(path):
+        return path
+    return os.path.abspath(os.path.join(base, path))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="npusim parameter sweep driver")
+    parser.add_argument("spec", help="sweep description json")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                        help="number of parallel simulations")
+    parser.add_argument("-o", "--out-dir", default="sweep_out",
+                        help="directory for per-run working dirs and results")
+    parser.add_argument("--dry-run", action="store_true",
+                        help="only print the expanded parameter combinations")
+    opts = parser.parse_args()
+
+    with open(opts.spec) as f:
+        spec = json.load(f)
+
+    # 相对路径以扫描描述文件所在目录为基准
+    base = os.path.dirname(os.path.abspath(opts.spec))
+    for key in ("npusim", "config_file", "core_config_file"):
+        spec[key] = resolve(spec.get(key), base)
+    if not spec.get("npusim"):
+        sys.exit("[ERROR] Sweep spec must give the npusim executable.")
+
+    combos = expand_params(spec.get("params", {}), spec.get("mode", "cartesian"))
+    print("Sweep: %d runs, %d parallel jobs" % (len(combos), opts.jobs))
+    if opts.dry_run:
+        for i, c in enumerate(combos):
+            print(i, c)
+        return
+
+    out_dir = os.path.abspath(opts.out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+
+    results = []
+    with ProcessPoolExecutor(max_workers=opts.jobs) as pool:
+        futures = {pool.submit(run_one, i, c, spec, out_dir): i
+                   for i, c in enumerate(combos)}
+        for fut in as_completed(futures):
+            i = futures[fut]
+            try:
+                r = fut.result()
+            except Exception as e:
+                r = {"run": i, "returncode": -1, "error": str(e)}
+                r.update(combos[i])
+            status = "ok" if r.get("returncode") == 0 else "FAILED"
+            print("[%d/%d] run %d %s" % (len(results) + 1, len(combos), i, status))
+            results.append(r)
+
+    results.sort(key=lambda r: r["run"])
+
+    with open(os.path.join(out_dir, "sweep_results.json"), "w") as f:
+        json.dump(results, f, indent=4)
+
+    fields = []
+    for r in results:
+        for k in r:
+            if k not in fields:
+                fields.append(k)
+    with open(os.path.join(out_dir, "sweep_results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(results)
+
+    print("Results written to " + out_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -14,6 +14,11 @@ sio = socketio.AsyncServer(async_mode='asgi', cors_allowed_origins='*')
 events = []
 last_mtime = 0.0
 TRACE_FILE = "../build/events.json"
+# npusim --heatmap-window 写出的热力图数据流，第一行为网格信息，之后每行一个窗口
+HEATMAP_FILE = "../build/heatmap_stream.jsonl"
+heatmap_meta = None
+heatmap_frames = []
+heatmap_offset = 0
 
 # 全局变量：当前运行的模拟器进程和任务
 current_proc = None
@@ -28,6 +33,7 @@ app.mount("/static", StaticFiles(directory="static"), name="static")
 class SimulationRequest(BaseModel):
     config_file: str = "../llm/test/gpt2_small/original.json"
     core_config_file: str = "../llm/test/core_configs/core_4x4.json"
+    heatmap_window: int = 0  # >0 时同时输出热力图数据流（ns）
 
 
 @app.on_event("startup")
@@ -43,6 +49,7 @@ async def startup():
             print("Load error:", e)
             events = []
     asyncio.create_task(poll_trace())
+    asyncio.create_task(poll_heatmap())
 
 
 import re
@@ -142,6 +149,44 @@ async def poll_trace():
             print("Poll error:", e)
         await asyncio.sleep(0.5)
         
+async def poll_heatmap():
+    """增量读取热力图数据流，只解析新写入的完整行"""
+    global heatmap_meta, heatmap_offset
+    while True:
+        try:
+            if os.path.exists(HEATMAP_FILE):
+                size = os.path.getsize(HEATMAP_FILE)
+                if size < heatmap_offset:
+                    # 文件被新的仿真重新创建
+                    heatmap_meta = None
+                    heatmap_frames.clear()
+                    heatmap_offset = 0
+                    await sio.emit("heatmap_clear")
+                if size > heatmap_offset:
+                    with open(HEATMAP_FILE, 'r', encoding='utf-8') as f:
+                        f.seek(heatmap_offset)
+                        chunk = f.read()
+                    end = chunk.rfind('\n')
+                    if end != -1:
+                        heatmap_offset += len(chunk[:end + 1].encode('utf-8'))
+                        new_frames = []
+                        for line in chunk[:end].split('\n'):
+                            if not line.strip():
+                                continue
+                            obj = json.loads(line)
+                            if heatmap_meta is None and "grid_x" in obj:
+                                heatmap_meta = obj
+                                await sio.emit("heatmap_meta", obj)
+                            else:
+                                new_frames.append(obj)
+                        if new_frames:
+                            heatmap_frames.extend(new_frames)
+                            await sio.emit("heatmap_frames", new_frames)
+        except Exception as e:
+            print("Heatmap poll error:", e)
+        await asyncio.sleep(0.5)
+
+
 @sio.event
 async def log_visibility(sid, hidden):
     """前端通知日志是否隐藏"""
@@ -220,6 +265,8 @@ async def run_simulation(request: SimulationRequest):
             "--config-file", request.config_file,
             "--core-config-file", request.core_config_file
         ]
+        if request.heatmap_window > 0:
+            cmd += ["--heatmap-window", str(request.heatmap_window)]
 
         # 启动子进程，捕获 stdout/stderr
         current_proc = subprocess.Popen(
@@ -263,9 +310,17 @@ async def index():
     return FileResponse("static/index.html")
 
 
+@app.get("/heatmap")
+async def heatmap():
+    return FileResponse("static/heatmap.html")
+
+
 @sio.event
 async def connect(sid, environ):
     await sio.emit("init_events", events, to=sid)
+    if heatmap_meta is not None:
+        await sio.emit("heatmap_meta", heatmap_meta, to=sid)
+        await sio.emit("heatmap_frames", heatmap_frames, to=sid)
 
 
 app_asgi = socketio.ASGIApp(sio, other_asgi_app=app)
\ No newline at end of file